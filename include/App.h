@@ -57,9 +57,17 @@ private:
     asdx::VertexShader                  m_EditorSkinningVS;
     asdx::VertexShader                  m_ShadowVS;
     asdx::VertexShader                  m_ShadowSkinningVS;
+    asdx::VertexShader                  m_ShadowDepthVS;
+    asdx::VertexShader                  m_ShadowDepthSkinningVS;
     asdx::VertexShader                  m_TriangleVS;
     asdx::VertexShader                  m_GuideVS;
     asdx::VertexShader                  m_ShapeVS;
+    asdx::RefPtr<ID3D11InputLayout>     m_EditorQuantizedIL;
+    asdx::RefPtr<ID3D11InputLayout>     m_EditorSkinningQuantizedIL;
+    asdx::RefPtr<ID3D11InputLayout>     m_ShadowQuantizedIL;
+    asdx::RefPtr<ID3D11InputLayout>     m_ShadowSkinningQuantizedIL;
+    asdx::RefPtr<ID3D11InputLayout>     m_ShadowDepthQuantizedIL;
+    asdx::RefPtr<ID3D11InputLayout>     m_ShadowDepthSkinningQuantizedIL;
     asdx::PixelShader                   m_DefaultPS;
     asdx::PixelShader                   m_CopyPS;
     asdx::PixelShader                   m_OETFPS;
@@ -163,6 +171,16 @@ private:
     //-------------------------------------------------------------------------
     void DrawModel(bool lightingPass, asdx::BlendType blendType);
 
+    //-------------------------------------------------------------------------
+    //! @brief      メッシュに合わせた頂点シェーダを設定して描画します.
+    //!
+    //! @param[in]      mesh            メッシュです.
+    //! @param[in]      lod             描画するLOD番号です.
+    //! @param[in]      lightingPass    ライティングパスかどうか.
+    //! @param[in]      depthOnly       位置座標のみのストリームで描画するかどうか.
+    //-------------------------------------------------------------------------
+    void DrawMesh(const EditorMesh& mesh, uint32_t lod, bool lightingPass, bool depthOnly);
+
     //-------------------------------------------------------------------------
     //! @brief      ガイドオブジェクトを描画します.
     //-------------------------------------------------------------------------
@@ -0,0 +1,88 @@
+﻿//-----------------------------------------------------------------------------
+// File : Benchmark.h
+// Desc : Benchmark Helper.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cfloat>
+#include <chrono>
+#include <asdxLogger.h>
+
+
+//-----------------------------------------------------------------------------
+//! @brief      処理を指定回数実行し, 最短の処理時間を計測します.
+//!
+//! @param[in]      loopCount   計測回数です.
+//! @param[in]      prepare     void() 形式の準備処理です. 計測時間には含めません.
+//! @param[in]      func        bool() 形式の計測する処理です. false を返すと計測を中断します.
+//! @param[out]     result      最短の処理時間(秒)の格納先です.
+//! @retval true    計測に成功.
+//! @retval false   計測に失敗.
+//-----------------------------------------------------------------------------
+template<typename Prepare, typename Func>
+bool MeasureBest(uint32_t loopCount, Prepare prepare, Func func, double& result)
+{
+    using Clock = std::chrono::high_resolution_clock;
+
+    if (loopCount == 0)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    result = DBL_MAX;
+    for(auto i=0u; i<loopCount; ++i)
+    {
+        prepare();
+
+        auto begin = Clock::now();
+        if (!func())
+        { return false; }
+        auto time = std::chrono::duration<double>(Clock::now() - begin).count();
+
+        if (time < result)
+        { result = time; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//! @brief      処理を指定回数実行し, 最短の処理時間を計測します.
+//!
+//! @param[in]      loopCount   計測回数です.
+//! @param[in]      func        bool() 形式の計測する処理です. false を返すと計測を中断します.
+//! @param[out]     result      最短の処理時間(秒)の格納先です.
+//! @retval true    計測に成功.
+//! @retval false   計測に失敗.
+//-----------------------------------------------------------------------------
+template<typename Func>
+bool MeasureBest(uint32_t loopCount, Func func, double& result)
+{ return MeasureBest(loopCount, [](){}, func, result); }
+
+//-----------------------------------------------------------------------------
+//! @brief      計測結果を1行出力します.
+//!
+//! @param[in]      label       項目名です.
+//! @param[in]      seconds     処理時間(秒)です.
+//! @param[in]      baseline    比較元の処理時間(秒)です. 0 以下の場合は速度比を出力しません.
+//! @param[in]      note        末尾に追加する文字列です. nullptr の場合は出力しません.
+//-----------------------------------------------------------------------------
+void LogBenchmark(const char* label, double seconds, double baseline = 0.0, const char* note = nullptr);
+
+//-----------------------------------------------------------------------------
+//! @brief      コマンドライン引数で指定された計測を実行します.
+//!
+//! @param[in]      argc        引数の数です.
+//! @param[in]      argv        引数です. argv[1] に -bench_xxx を指定します.
+//! @param[out]     exitCode    計測を実行した場合の終了コードの格納先です.
+//! @retval true    計測を実行した.
+//! @retval false   計測の指定が無い.
+//! @note       各計測は対応する ENABLE_XXX_BENCHMARK が有効な場合のみ登録されます.
+//-----------------------------------------------------------------------------
+bool RunBenchmark(int argc, char** argv, int& exitCode);
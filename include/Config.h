@@ -9,6 +9,7 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <asdxEditParam.h>
+#include <MeshPostProcess.h>
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -121,6 +122,8 @@ struct ModelPreviewSetting
     asdx::EditFloat3    Translation;
     asdx::EditBool      AutoRotation;
     asdx::EditFloat     AutoRotationSpeed;
+    asdx::EditBool      EnableLod;
+    asdx::EditFloat     LodThreshold;       //!< LOD切り替えの許容誤差(ピクセル).
 
     //-------------------------------------------------------------------------
     //! @brief      コンストラクタです.
@@ -144,6 +147,47 @@ struct ModelPreviewSetting
 };
 
 
+///////////////////////////////////////////////////////////////////////////////
+// ImportSetting structure
+///////////////////////////////////////////////////////////////////////////////
+struct ImportSetting
+{
+    asdx::EditBool  Deduplicate;
+    asdx::EditBool  OptimizeVertexCache;
+    asdx::EditBool  OptimizeOverdraw;
+    asdx::EditBool  OptimizeVertexFetch;
+    asdx::EditBool  GenerateLod;
+    asdx::EditBool  LodAttributes;
+    asdx::EditBool  GenerateMeshlet;
+    asdx::EditBool  QuantizePosition;
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    ImportSetting();
+
+    //-------------------------------------------------------------------------
+    //! @brief      シリアライズします.
+    //-------------------------------------------------------------------------
+    tinyxml2::XMLElement* Serialize(tinyxml2::XMLDocument* doc);
+
+    //-------------------------------------------------------------------------
+    //! @brief      デシリアライズします.
+    //-------------------------------------------------------------------------
+    void Deserialize(tinyxml2::XMLElement* element);
+
+    //-------------------------------------------------------------------------
+    //! @brief      編集処理を行います.
+    //-------------------------------------------------------------------------
+    void Edit();
+
+    //-------------------------------------------------------------------------
+    //! @brief      メッシュ後処理のオプションを取得します.
+    //-------------------------------------------------------------------------
+    MeshPostProcessOption GetOption() const;
+};
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // DebugSetting structure
 ///////////////////////////////////////////////////////////////////////////////
@@ -194,6 +238,7 @@ struct Config
     BackgroundSetting   Background;
     CameraSetting       Camera;
     ModelPreviewSetting ModelPreview;
+    ImportSetting       Import;
     DebugSetting        Debug;
 
     bool Load(const char* path);
@@ -0,0 +1,60 @@
+﻿//-----------------------------------------------------------------------------
+// File : DepthStream.h
+// Desc : Position Only Stream For Depth Rendering.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxResModel.h>
+#include <VertexPacking.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// DepthStream structure
+///////////////////////////////////////////////////////////////////////////////
+struct DepthStream
+{
+    std::vector<uint32_t>   VertexRemap;    //!< 深度用の頂点から元の頂点番号への対応です.
+    std::vector<uint32_t>   Indices;        //!< 深度用の頂点を参照するインデックスです(入力と同じ並び).
+};
+
+
+//-----------------------------------------------------------------------------
+//! @brief      深度描画用の頂点とインデックスを構築します.
+//!
+//! @param[in]      mesh        メッシュです.
+//! @param[in]      pIndices    元の頂点を参照するインデックスです(LODを連結したものでも構いません).
+//! @param[in]      indexCount  インデックス数です.
+//! @param[out]     result      構築結果の格納先です.
+//! @retval true    構築に成功.
+//! @retval false   構築に失敗.
+//! @note       位置座標(スキニングする場合はボーンも)が同じ頂点を統合するため,
+//!             法線やテクスチャ座標の不連続で分割された頂点が1つにまとまります.
+//!             三角形の並びは変わらないため, LODの範囲は元のインデックスと共通です.
+//-----------------------------------------------------------------------------
+bool BuildDepthStream(
+    const asdx::ResMesh&    mesh,
+    const uint32_t*         pIndices,
+    size_t                  indexCount,
+    DepthStream&            result);
+
+//-----------------------------------------------------------------------------
+//! @brief      深度描画用の頂点座標を圧縮します.
+//!
+//! @param[in]      mesh        メッシュです.
+//! @param[in]      stream      深度描画用のストリームです.
+//! @param[in]      format      メッシュの圧縮形式です(量子化の有無と範囲を共有します).
+//! @param[out]     data        頂点バッファに設定するデータの格納先です.
+//! @retval true    圧縮に成功.
+//! @retval false   圧縮に失敗.
+//-----------------------------------------------------------------------------
+bool PackDepthVertices(
+    const asdx::ResMesh&        mesh,
+    const DepthStream&          stream,
+    const PackedVertexFormat&   format,
+    std::vector<uint8_t>&       data);
@@ -119,8 +119,10 @@ public:
 
     //-------------------------------------------------------------------------
     //! @brief      描画処理を行います.
+    //!
+    //! @param[in]      material    シェーダ側のステート宣言を確認するマテリアルです(nullptr可).
     //-------------------------------------------------------------------------
-    void Draw();
+    void Draw(const PluginMaterial* material = nullptr);
 
     //-------------------------------------------------------------------------
     //! @brief      定数バッファを更新します.
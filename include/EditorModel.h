@@ -9,16 +9,20 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <string>
+#include <vector>
 #include <asdxMath.h>
 #include <asdxResModel.h>
 #include <asdxVertexBuffer.h>
 #include <asdxIndexBuffer.h>
+#include <MeshPostProcess.h>
+#include <VertexPacking.h>
+#include <DepthStream.h>
 
 
 //-----------------------------------------------------------------------------
 // Constant Values.
 //-----------------------------------------------------------------------------
-static const uint32_t kMaxInstanceCount = 32;   // 最大32.
+static const uint32_t kMaxInstanceCount = 32;   // 既定の最大数(インポートしたインスタンスがこれを超える場合は拡張).
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -63,8 +67,21 @@ public:
 
     //-------------------------------------------------------------------------
     //! @brief      初期化処理を行います.
-    //-------------------------------------------------------------------------
-    bool Init(ID3D11Device* pDevice, const asdx::ResMesh& mesh);
+    //!
+    //! @param[in]      pDevice         デバイスです.
+    //! @param[in]      mesh            メッシュリソースです.
+    //! @param[in]      pInstances      インスタンス行列です. nullptr の場合は単位行列1つとなります.
+    //! @param[in]      instanceCount   インスタンス数です.
+    //! @param[in]      pAux            LODなどの派生データです. nullptr の場合はLOD0のみとなります.
+    //! @param[in]      quantizePosition    頂点座標をAABB基準で16bitに量子化するかどうか.
+    //-------------------------------------------------------------------------
+    bool Init(
+        ID3D11Device*           pDevice,
+        const asdx::ResMesh&    mesh,
+        const asdx::Matrix*     pInstances       = nullptr,
+        uint32_t                instanceCount    = 0,
+        const MeshAuxData*      pAux             = nullptr,
+        bool                    quantizePosition = true);
 
     //-------------------------------------------------------------------------
     //! @brief      終了処理を行います.
@@ -83,14 +100,58 @@ public:
 
     //-------------------------------------------------------------------------
     //! @brief      描画処理を行います.
+    //!
+    //! @param[in]      pContext    デバイスコンテキストです.
+    //! @param[in]      lod         描画するLOD番号です.
+    //-------------------------------------------------------------------------
+    void Draw(ID3D11DeviceContext* pContext, uint32_t lod = 0) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      位置座標のみのストリームで深度描画を行います.
+    //!
+    //! @param[in]      pContext    デバイスコンテキストです.
+    //! @param[in]      lod         描画するLOD番号です.
     //-------------------------------------------------------------------------
-    void Draw(ID3D11DeviceContext* pContext) const;
+    void DrawDepth(ID3D11DeviceContext* pContext, uint32_t lod = 0) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      LOD数を取得します(LOD0を含む).
+    //-------------------------------------------------------------------------
+    uint32_t GetLodCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      LODの誤差を取得します(オブジェクト空間の距離).
+    //-------------------------------------------------------------------------
+    float GetLodError(uint32_t lod) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      画面上の大きさからLODを選択します.
+    //!
+    //! @param[in]      world       ワールド行列です.
+    //! @param[in]      cameraPos   カメラ位置です.
+    //! @param[in]      projScale   距離1における1単位あたりのピクセル数です(画面の高さ * 0.5 * Proj._22).
+    //! @param[in]      threshold   許容する誤差のピクセル数です.
+    //! @return     誤差が許容範囲に収まる最も粗いLOD番号を返却します.
+    //! @note       全インスタンスのうち最もカメラに近いもので判定します.
+    //-------------------------------------------------------------------------
+    uint32_t SelectLod(
+        const asdx::Matrix&     world,
+        const asdx::Vector3&    cameraPos,
+        float                   projScale,
+        float                   threshold) const;
 
     //-------------------------------------------------------------------------
     //! @brief      スキニングデータを持つかどうか?
     //-------------------------------------------------------------------------
     bool HasSkinningData() const;
 
+    //-------------------------------------------------------------------------
+    //! @brief      頂点座標が量子化されているかどうか?
+    //!
+    //! @note       量子化されている場合は POSITION を R16G16B16A16_UNORM とした入力レイアウトが必要です.
+    //-------------------------------------------------------------------------
+    bool IsQuantizedPosition() const;
+
     //-------------------------------------------------------------------------
     //! @brief      バウンディングボックスを取得します.
     //-------------------------------------------------------------------------
@@ -99,7 +160,7 @@ public:
     //-------------------------------------------------------------------------
     //! @brief      ポリゴン数を取得します.
     //-------------------------------------------------------------------------
-    uint32_t GetPolygonCount() const;
+    uint32_t GetPolygonCount(uint32_t lod = 0) const;
 
     //-------------------------------------------------------------------------
     //! @brief      インスタンス数を設定します.
@@ -113,6 +174,11 @@ public:
 
     //-------------------------------------------------------------------------
     //! @brief      インスタンス行列を設定します.
+    //!
+    //! @param[in]      index       インスタンス番号です.
+    //! @param[in]      matrix      インスタンス行列です.
+    //! @note       メッシュのローカル座標に対して, モデルのワールド行列より先に適用されます.
+    //!             (ローカル -> インスタンス -> ワールド の順).
     //-------------------------------------------------------------------------
     void SetInstanceMatrix(uint32_t index, const asdx::Matrix& matrix);
 
@@ -132,6 +198,16 @@ public:
     uint32_t GetMaterialId() const;
 
 private:
+    ///////////////////////////////////////////////////////////////////////////
+    // LodRange structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct LodRange
+    {
+        uint32_t    IndexOffset;
+        uint32_t    IndexCount;
+        float       Error;
+    };
+
     //=========================================================================
     // private variables.
     //=========================================================================
@@ -139,16 +215,23 @@ private:
     std::string                 m_MaterialName;
     BoundingBox                 m_Box;
     bool                        m_HasSkinningData;
-    uint32_t                    m_IndexCount;
+    std::vector<LodRange>       m_Lods;         // 全LODのインデックスは1つのバッファに連結する.
+    PackedVertexFormat          m_VertexFormat; // 全ストリームは m_VB に連続して格納する.
     asdx::VertexBuffer          m_VB;
     asdx::VertexBuffer          m_SkinVB;
     asdx::IndexBuffer           m_IB;
+    asdx::VertexBuffer          m_DepthVB;      // 位置座標が同じ頂点を統合した深度描画用.
+    asdx::VertexBuffer          m_DepthSkinVB;
+    asdx::IndexBuffer           m_DepthIB;
+    DXGI_FORMAT                 m_IndexFormat       = DXGI_FORMAT_R32_UINT;    // 頂点数に合わせて16bitを選択する.
+    DXGI_FORMAT                 m_DepthIndexFormat  = DXGI_FORMAT_R32_UINT;
     uint32_t                    m_InstanceCount;
-    asdx::Matrix                m_InstanceMatrix[kMaxInstanceCount];
+    std::vector<asdx::Matrix>   m_InstanceMatrix;
     uint32_t                    m_MaterialId;
 
     asdx::RefPtr<ID3D11Buffer>              m_InstanceMatrixResource;
     asdx::RefPtr<ID3D11ShaderResourceView>  m_InstanceMatrixSRV;
+    asdx::RefPtr<ID3D11Buffer>              m_DecodeCB;
 
     //=========================================================================
     // private methods.
@@ -190,10 +273,15 @@ public:
     //! @brief      初期化処理を行います.
     //!
     //! @param[in]      path        ファイルパスです.
+    //! @param[in]      option      インポート後のメッシュ後処理オプションです.
+    //! @param[in]      cacheDir    バイナリキャッシュを置くディレクトリです(nullptrの場合は使用しない).
     //! @retval true    初期化に成功.
     //! @retval false   初期化に失敗.
     //-------------------------------------------------------------------------
-    bool Init(const char* model);
+    bool Init(
+        const char*                     model,
+        const MeshPostProcessOption&    option   = MeshPostProcessOption(),
+        const char*                     cacheDir = nullptr);
 
     //-------------------------------------------------------------------------
     //! @brief      終了処理を行います.
@@ -281,6 +369,11 @@ public:
     //-------------------------------------------------------------------------
     const asdx::ResModel& GetResource() const;
 
+    //-------------------------------------------------------------------------
+    //! @brief      メッシュごとの派生データ(LOD, メッシュレット)を取得します.
+    //-------------------------------------------------------------------------
+    const std::vector<MeshAuxData>& GetAuxData() const;
+
 private:
     //=========================================================================
     // private variables.
@@ -294,9 +387,10 @@ private:
     std::vector<EditorMesh> m_Meshes;       //!< メッシュ.
     bool                    m_DirtyWorld;   //!< ダーティフラグ.
     asdx::ResModel          m_Resource;     //!< リソース.
+    std::vector<MeshAuxData> m_AuxData;     //!< メッシュごとの派生データ.
 
     //=========================================================================
     // private methods.
     //=========================================================================
-    /* NOTHING */
+    bool Import(const char* path, std::vector<std::vector<asdx::Matrix>>& instances);
 };
@@ -139,6 +139,16 @@ struct ExportMesh
     const uint32_t* Indices;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// ExportMeshIndex structure
+///////////////////////////////////////////////////////////////////////////////
+struct ExportMeshIndex
+{
+    const uint16_t* Indices16;          //!< 16bitインデックス(頂点数が65536以下の場合のみ, それ以外は nullptr).
+    uint32_t        EncodedIndexSize;   //!< 圧縮インデックスのバイト数.
+    const uint8_t*  EncodedIndices;     //!< meshopt_encodeIndexBuffer で圧縮したインデックス(三角形リストでない場合は nullptr).
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // ExportContext structure
 ///////////////////////////////////////////////////////////////////////////////
@@ -147,7 +157,8 @@ struct ExportContext
     char*               OutputPath;     //!< 出力ファイルパス.
     uint32_t            MaterialCount;  //!< マテリアル数.
     ExportMaterial*     Materials;      //!< マテリアル.
-    uint32_t            MeshCount;      //!< メッシュ数.
-    ExportMesh*         Meshes;         //!< メッシュ.
+    uint32_t            MeshCount;      //!< メッシュ数(インスタンスごとに1つ).
+    ExportMesh*         Meshes;         //!< メッシュ(インスタンス行列を適用したワールド座標).
+    ExportMeshIndex*    MeshIndices;    //!< メッシュごとの16bit・圧縮インデックス(MeshCount 個, Meshes と同じ並び).
 };
 
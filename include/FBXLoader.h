@@ -11,9 +11,11 @@
 //-------------------------------------------------------------------------------------------------
 #include <string>
 #include <vector>
+#include <unordered_map>
 #include <fbxsdk.h>
 #include <asdxMath.h>
 #include <asdxResModel.h>
+#include <MotionClip.h>
 
 
 //-------------------------------------------------------------------------------------------------
@@ -21,6 +23,8 @@
 //-------------------------------------------------------------------------------------------------
 constexpr int MaxLayerCount = 4;
 
+struct MeshSourceFBX;
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 // PROJECTION_TYPE
@@ -109,26 +113,7 @@ struct ResMeshFBX
     std::vector<asdx::Vector4>      Colors;
     std::vector<ResSubsetFBX>       Subsets;
     std::vector<uint32_t>           Indices;
-};
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// ResKeyPoseFBX structure
-///////////////////////////////////////////////////////////////////////////////////////////////////
-struct ResKeyPoseFBX
-{
-    uint32_t            FrameIndex;
-    asdx::Vector3       Translation;
-    asdx::Vector3       Scale;
-    asdx::Quaternion    Rotation;
-};
-
-///////////////////////////////////////////////////////////////////////////////////////////////////
-// ResBoneMotionFBX structure
-///////////////////////////////////////////////////////////////////////////////////////////////////
-struct ResBoneMotionFBX
-{
-    std::string                 BoneName;
-    std::vector<ResKeyPoseFBX>  KeyFrames;
+    std::vector<asdx::Matrix>       Instances;      // world matrix per node reference (empty if baked into vertices)
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -136,9 +121,9 @@ struct ResBoneMotionFBX
 ///////////////////////////////////////////////////////////////////////////////////////////////////
 struct ResMotionFBX
 {
-    std::string                     Name;
-    uint32_t                        Duration;
-    std::vector<ResBoneMotionFBX>   Bones;
+    std::string     Name;
+    uint32_t        Duration;
+    MotionClip      Clip;           // reduced and quantized tracks (one per bone)
 };
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////
@@ -210,7 +195,7 @@ public:
     FBXLoader();
     ~FBXLoader();
 
-    bool Load(const char* path, bool skipTriangulate = false);
+    bool Load(const char* path, bool skipTriangulate = false, bool parseMotion = false);
     void Term();
 
     const std::vector<ResMeshFBX>&     GetMeshes   () const { return m_Meshes;    }
@@ -226,6 +211,7 @@ public:
     const char* GetErrorString  () const { return m_ErrorString.c_str(); }
 
     bool Load(const char* path, asdx::ResModel& model);
+    const std::vector<std::vector<asdx::Matrix>>& GetInstances() const { return m_Instances; }
 
 private:
     //=============================================================================================
@@ -244,20 +230,26 @@ private:
     std::string                 m_FolderPath;
     std::string                 m_Path;
     std::string                 m_ErrorString;
+    std::unordered_map<FbxMesh*, size_t>    m_MeshMap;
+    std::unordered_map<FbxSurfaceMaterial*, int>    m_MaterialMap;
+    std::vector<FbxNode*>                   m_MeshNodes;    // source node of each m_Meshes entry
+    std::vector<std::vector<asdx::Matrix>>  m_Instances;
 
     //=============================================================================================
     // private methods.
     //=============================================================================================
-    void ParseContent   ();
+    void ParseContent   ( bool parseMotion );
     void ParseNode      ( FbxNode* pNode, const std::string& parentName );
     void ParseMesh      ( FbxNode* pNode, const std::string& parentName );
+    void ParseMeshes    ();
     void ParseSkeleton  ( FbxNode* pNode );
     void ParseCamera    ( FbxNode* pNode );
     void ParseLight     ( FbxNode* pNode );
     void ParseNull      ( FbxNode* pNode );
 
-    void ParseVertex    ( FbxMesh* pSrcMesh, ResMeshFBX& dstMesh );
-    void ParseSubset    ( FbxMesh* pSrcMesh, ResMeshFBX& dstMesh );
+    void ExtractMesh    ( FbxMesh* pSrcMesh, MeshSourceFBX& dst );
+    void ParseVertex    ( const MeshSourceFBX& src, const asdx::Matrix& world, ResMeshFBX& dstMesh, std::string& errors );
+    void ParseSubset    ( const MeshSourceFBX& src, ResMeshFBX& dstMesh );
     void ParseMotion    ( FbxAnimStack* pSrcStack, ResMotionFBX& dstMotion );
     void ParseMaterial  ( FbxSurfaceMaterial* pSrcMaterial, ResMaterialFBX& dstMaterial );
 
@@ -0,0 +1,74 @@
+﻿//-----------------------------------------------------------------------------
+// File : FBXReader.h
+// Desc : Native Binary FBX Reader.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <vector>
+#include <asdxMath.h>
+#include <asdxResModel.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FBXReader class
+///////////////////////////////////////////////////////////////////////////////
+class FBXReader
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    FBXReader() = default;
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~FBXReader() = default;
+
+    //-------------------------------------------------------------------------
+    //! @brief      バイナリ形式のFBXファイル(7.x)をロードします.
+    //!
+    //! @param[in]      path        ファイルパスです.
+    //! @param[out]     model       モデルの格納先です.
+    //! @retval true    ロードに成功.
+    //! @retval false   ロードに失敗(ASCII形式や非対応バージョンを含む).
+    //! @note       FBX SDK には依存しません.
+    //-------------------------------------------------------------------------
+    bool Load(const char* path, asdx::ResModel& model);
+
+    //-------------------------------------------------------------------------
+    //! @brief      インスタンス行列を取得します.
+    //!
+    //! @return     ResModel::Meshes と同じ並びで, メッシュごとのワールド行列を返却します.
+    //-------------------------------------------------------------------------
+    const std::vector<std::vector<asdx::Matrix>>& GetInstances() const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<std::vector<asdx::Matrix>>  m_Instances;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
@@ -394,7 +394,7 @@ struct Member
     std::string     Name;                   //!< メンバー名です.
     MEMBER_TYPE     Type;                   //!< データ型です.
     TYPE_MODIFIER   Modifier;               //!< 修飾子です.
-    uint32_t        PackOffset;             //!< パックオフセットです.
+    uint32_t        PackOffset;             //!< パックオフセットです(バイト単位, 指定無しは-1).
 };
 
 ///////////////////////////////////////////////////////////////////////////////
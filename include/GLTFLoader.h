@@ -8,6 +8,8 @@
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
+#include <vector>
+#include <asdxMath.h>
 #include <asdxResModel.h>
 
 
@@ -51,11 +53,19 @@ public:
     //-------------------------------------------------------------------------
     bool Load(const char* path, asdx::ResModel& model);
 
+    //-------------------------------------------------------------------------
+    //! @brief      インスタンス行列を取得します.
+    //!
+    //! @return     ResModel::Meshes と同じ並びで, メッシュごとのワールド行列を返却します.
+    //!             メッシュはローカル空間のまま出力されるので, 描画時にこの行列を適用します.
+    //-------------------------------------------------------------------------
+    const std::vector<std::vector<asdx::Matrix>>& GetInstances() const;
+
 private:
     //=========================================================================
     // private variables.
     //=========================================================================
-    /* NOTHING */
+    std::vector<std::vector<asdx::Matrix>>  m_Instances;
 
     //=========================================================================
     // private methods.
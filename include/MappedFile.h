@@ -0,0 +1,85 @@
+﻿//-----------------------------------------------------------------------------
+// File : MappedFile.h
+// Desc : Memory Mapped File.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstddef>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////
+class MappedFile
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    MappedFile() = default;
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~MappedFile();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルを読み取り専用でマッピングします.
+    //!
+    //! @param[in]      path        ファイルパスです.
+    //! @retval true    マッピングに成功.
+    //! @retval false   マッピングに失敗.
+    //-------------------------------------------------------------------------
+    bool Open(const char* path);
+
+    //-------------------------------------------------------------------------
+    //! @brief      マッピングを解除します.
+    //-------------------------------------------------------------------------
+    void Close();
+
+    //-------------------------------------------------------------------------
+    //! @brief      先頭ポインタを取得します.
+    //-------------------------------------------------------------------------
+    const uint8_t* GetData() const
+    { return m_pData; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ファイルサイズを取得します.
+    //-------------------------------------------------------------------------
+    size_t GetSize() const
+    { return m_Size; }
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    void*           m_hFile     = nullptr;                  //!< ファイルハンドル.
+    void*           m_hMapping  = nullptr;                  //!< マッピングハンドル.
+    const uint8_t*  m_pData     = nullptr;                  //!< 先頭ポインタ.
+    size_t          m_Size      = 0;                        //!< ファイルサイズ.
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    MappedFile              (const MappedFile&) = delete;
+    MappedFile& operator =  (const MappedFile&) = delete;
+};
@@ -0,0 +1,155 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshPostProcess.h
+// Desc : Post Import Mesh Processing.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxResModel.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+#ifndef ENABLE_MESH_BENCHMARK
+#define ENABLE_MESH_BENCHMARK   (0)     // 1 にするとメッシュ後処理の計測が有効になります.
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshPostProcessOption structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshPostProcessOption
+{
+    bool        Deduplicate         = true;     //!< 同一頂点を統合します.
+    bool        VertexCache         = true;     //!< 頂点キャッシュ向けに三角形を並べ替えます.
+    bool        Overdraw            = true;     //!< オーバードローが減るように三角形を並べ替えます.
+    bool        VertexFetch         = true;     //!< 参照順に頂点を並べ替えます.
+    float       OverdrawThreshold   = 1.05f;    //!< 頂点キャッシュ効率の劣化許容率です.
+    bool        GenerateLod         = true;     //!< LODを生成します.
+    bool        LodAttributes       = false;    //!< 法線とテクスチャ座標も考慮して簡略化します.
+    uint32_t    LodCount            = 4;        //!< LOD0を除く最大LOD数です.
+    float       LodRatio            = 0.5f;     //!< LODごとのインデックス数の削減率です.
+    float       LodTargetError      = 0.02f;    //!< 簡略化の許容誤差です(メッシュサイズに対する比率).
+    bool        GenerateMeshlet     = false;    //!< メッシュレットを生成します.
+    uint32_t    MeshletMaxVertices  = 64;       //!< メッシュレットあたりの最大頂点数です.
+    uint32_t    MeshletMaxTriangles = 124;      //!< メッシュレットあたりの最大三角形数です(4の倍数).
+    float       MeshletConeWeight   = 0.25f;    //!< 法線コーンの狭さを優先する度合いです.
+    bool        QuantizePosition    = false;    //!< 頂点座標をAABB基準で16bitに量子化します(GPU転送時のみ, キャッシュには影響しません. 精度が落ちるため明示的に有効化します).
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュのキーに使うハッシュ値を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetHash() const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshLod structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshLod
+{
+    float                   Error = 0.0f;   //!< LOD0に対する誤差です(オブジェクト空間の距離).
+    std::vector<uint32_t>   Indices;        //!< LOD0と頂点を共有するインデックスです.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Meshlet structure
+///////////////////////////////////////////////////////////////////////////////
+struct Meshlet
+{
+    uint32_t    VertexOffset;       //!< MeshletVertices 内の先頭位置です.
+    uint32_t    TriangleOffset;     //!< MeshletTriangles 内の先頭位置です.
+    uint32_t    VertexCount;        //!< 頂点数です.
+    uint32_t    TriangleCount;      //!< 三角形数です.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletBounds structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletBounds
+{
+    asdx::Vector3   Center;         //!< バウンディング球の中心です.
+    float           Radius;         //!< バウンディング球の半径です.
+    asdx::Vector3   ConeApex;       //!< 法線コーンの頂点です.
+    float           ConeCutoff;     //!< 法線コーンの半角の余弦です(1の場合は背面カリングできません).
+    asdx::Vector3   ConeAxis;       //!< 法線コーンの軸です.
+    float           Reserved;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshAuxData structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshAuxData
+{
+    std::vector<MeshLod>        Lods;               //!< LOD1以降です (LOD0は ResMesh::Indices).
+    std::vector<Meshlet>        Meshlets;           //!< LOD0のメッシュレットです.
+    std::vector<uint32_t>       MeshletVertices;    //!< メッシュレットが参照する頂点番号です.
+    std::vector<uint8_t>        MeshletTriangles;   //!< メッシュレット内の頂点番号 (3つで1三角形).
+    std::vector<MeshletBounds>  Bounds;             //!< メッシュレットごとのカリング情報です.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshPostProcessStats structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshPostProcessStats
+{
+    uint32_t    VertexCountBefore   = 0;
+    uint32_t    VertexCountAfter    = 0;
+    uint32_t    IndexCount          = 0;
+    float       AcmrBefore          = 0.0f;     //!< 三角形あたりの頂点変換数(処理前).
+    float       AcmrAfter           = 0.0f;     //!< 三角形あたりの頂点変換数(処理後).
+    float       AtvrBefore          = 0.0f;     //!< 頂点あたりの頂点変換数(処理前).
+    float       AtvrAfter           = 0.0f;     //!< 頂点あたりの頂点変換数(処理後).
+    uint32_t    LodCount            = 0;        //!< 生成したLOD数(LOD0を除く).
+    uint32_t    MeshletCount        = 0;        //!< 生成したメッシュレット数.
+};
+
+
+//-----------------------------------------------------------------------------
+//! @brief      インポートしたメッシュを最適化します.
+//!
+//! @param[in,out]  mesh        処理するメッシュです.
+//! @param[in]      option      処理オプションです.
+//! @param[out]     pAux        LODなどの派生データの格納先です(nullptrの場合は生成しません).
+//! @param[out]     pStats      統計情報の格納先です(nullptrの場合は計測しません).
+//! @retval true    処理に成功.
+//! @retval false   頂点ストリームの要素数が一致しないため処理できません.
+//! @note       インデックスが無い場合は生成します. GPUを使わないのでヘッドレスで実行できます.
+//-----------------------------------------------------------------------------
+bool PostProcessMesh(
+    asdx::ResMesh&                  mesh,
+    const MeshPostProcessOption&    option,
+    MeshAuxData*                    pAux   = nullptr,
+    MeshPostProcessStats*           pStats = nullptr);
+
+//-----------------------------------------------------------------------------
+//! @brief      モデル内の全メッシュを並列に最適化します.
+//!
+//! @param[in,out]  model       処理するモデルです.
+//! @param[in]      option      処理オプションです.
+//! @param[out]     pAux        メッシュごとの派生データの格納先です(nullptrの場合は生成しません).
+//! @param[out]     pStats      メッシュごとの統計情報の格納先です(nullptrの場合は計測しません).
+//! @retval true    全メッシュの処理に成功.
+//! @retval false   処理できなかったメッシュがあります(そのメッシュは変更されません).
+//-----------------------------------------------------------------------------
+bool PostProcessModel(
+    asdx::ResModel&                     model,
+    const MeshPostProcessOption&        option,
+    std::vector<MeshAuxData>*           pAux   = nullptr,
+    std::vector<MeshPostProcessStats>*  pStats = nullptr);
+
+#if ENABLE_MESH_BENCHMARK
+//-----------------------------------------------------------------------------
+//! @brief      LOD生成の処理時間を計測します.
+//!
+//! @param[in]      loopCount   計測回数です(最小値を採用します).
+//! @retval true    計測に成功.
+//! @retval false   計測に失敗.
+//-----------------------------------------------------------------------------
+bool BenchmarkLod(uint32_t loopCount);
+#endif
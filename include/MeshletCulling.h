@@ -0,0 +1,81 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletCulling.h
+// Desc : CPU Meshlet Culling.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxMath.h>
+#include <MeshPostProcess.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletCullingView structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletCullingView
+{
+    asdx::Vector4   Planes[6];      //!< オブジェクト空間の視錐台平面です(法線は内向き).
+    asdx::Vector3   CameraPos;      //!< オブジェクト空間のカメラ位置です.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshletCullingStats structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshletCullingStats
+{
+    uint32_t    MeshletCount        = 0;    //!< 判定したメッシュレット数.
+    uint32_t    TriangleCount       = 0;    //!< 判定した三角形数.
+    uint32_t    VisibleMeshlets     = 0;    //!< 残ったメッシュレット数.
+    uint32_t    VisibleTriangles    = 0;    //!< 残った三角形数.
+    uint32_t    FrustumCulled       = 0;    //!< 視錐台で除外した三角形数.
+    uint32_t    ConeCulled          = 0;    //!< 法線コーンで除外した三角形数.
+};
+
+
+//-----------------------------------------------------------------------------
+//! @brief      カリング用のビューを作成します.
+//!
+//! @param[in]      world       メッシュのワールド行列です.
+//! @param[in]      viewProj    ビュー射影行列です.
+//! @param[in]      cameraPos   ワールド空間のカメラ位置です.
+//! @return     オブジェクト空間に変換したカリング用のビューを返却します.
+//! @note       判定をオブジェクト空間で行うため, メッシュレットごとの座標変換は不要です.
+//-----------------------------------------------------------------------------
+MeshletCullingView CreateMeshletCullingView(
+    const asdx::Matrix&     world,
+    const asdx::Matrix&     viewProj,
+    const asdx::Vector3&    cameraPos);
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュレットをカリングします.
+//!
+//! @param[in]      aux         メッシュレットを持つ派生データです.
+//! @param[in]      view        カリング用のビューです.
+//! @param[out]     visible     残ったメッシュレット番号の格納先です.
+//! @param[out]     pStats      統計情報の格納先です(nullptrの場合は集計しません).
+//! @return     残ったメッシュレット数を返却します.
+//! @note       視錐台とバウンディング球, カメラ位置と法線コーンで判定します.
+//!             非一様スケールを含むワールド行列では法線コーンの判定は近似になります.
+//-----------------------------------------------------------------------------
+uint32_t CullMeshlets(
+    const MeshAuxData&          aux,
+    const MeshletCullingView&   view,
+    std::vector<uint32_t>&      visible,
+    MeshletCullingStats*        pStats = nullptr);
+
+#if ENABLE_MESH_BENCHMARK
+//-----------------------------------------------------------------------------
+//! @brief      メッシュレット生成とカリングの処理時間, 三角形の除外率を計測します.
+//!
+//! @param[in]      path        OBJファイルパスです(nullptrの場合は疑似的なメッシュを使用します).
+//! @param[in]      loopCount   計測回数です(最小値を採用します).
+//! @retval true    計測に成功.
+//! @retval false   計測に失敗.
+//-----------------------------------------------------------------------------
+bool BenchmarkMeshlet(const char* path, uint32_t loopCount);
+#endif
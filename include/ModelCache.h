@@ -0,0 +1,101 @@
+﻿//-----------------------------------------------------------------------------
+// File : ModelCache.h
+// Desc : Binary Model Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <asdxMath.h>
+#include <asdxResModel.h>
+#include <MeshPostProcess.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ModelCache class
+///////////////////////////////////////////////////////////////////////////////
+class ModelCache
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    static const uint32_t FormatVersion     = 5;    //!< キャッシュファイルのレイアウトを変更したら更新します.
+    static const uint32_t ImporterVersion   = 5;    //!< ローダーや後処理の出力が変わったら更新します.
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュファイルのパスを取得します.
+    //!
+    //! @param[in]      cacheDir    キャッシュを置くディレクトリです.
+    //! @param[in]      sourcePath  元のモデルファイルパスです.
+    //! @return     キャッシュファイルのパスを返却します.
+    //! @note       ファイル名には正規化したフルパスのハッシュ値が付くため, 別フォルダの同名ファイルとは衝突しません.
+    //-------------------------------------------------------------------------
+    static std::string GetPath(const char* cacheDir, const char* sourcePath);
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュを読み込みます.
+    //!
+    //! @param[in]      cachePath   キャッシュファイルパスです.
+    //! @param[in]      sourcePath  元のモデルファイルパスです.
+    //! @param[in]      optionHash  インポート時の後処理オプションのハッシュ値です.
+    //! @param[out]     model       モデルの格納先です.
+    //! @param[out]     instances   メッシュごとのインスタンス行列の格納先です.
+    //! @param[out]     aux         メッシュごとの派生データ(LOD, メッシュレット)の格納先です.
+    //! @retval true    キャッシュが有効で読み込みに成功.
+    //! @retval false   キャッシュが無い, 古い, または壊れている.
+    //! @note       元ファイルのパス, サイズ, 更新日時, インポーターのバージョン, 後処理オプションが一致する場合のみ有効です.
+    //-------------------------------------------------------------------------
+    static bool Load(
+        const char*                             cachePath,
+        const char*                             sourcePath,
+        uint32_t                                optionHash,
+        asdx::ResModel&                         model,
+        std::vector<std::vector<asdx::Matrix>>& instances,
+        std::vector<MeshAuxData>&               aux);
+
+    //-------------------------------------------------------------------------
+    //! @brief      キャッシュを書き出します.
+    //!
+    //! @param[in]      cachePath   キャッシュファイルパスです.
+    //! @param[in]      sourcePath  元のモデルファイルパスです.
+    //! @param[in]      optionHash  インポート時の後処理オプションのハッシュ値です.
+    //! @param[in]      model       書き出すモデルです.
+    //! @param[in]      instances   メッシュごとのインスタンス行列です.
+    //! @param[in]      aux         メッシュごとの派生データ(LOD, メッシュレット)です.
+    //! @retval true    書き出しに成功.
+    //! @retval false   書き出しに失敗.
+    //-------------------------------------------------------------------------
+    static bool Save(
+        const char*                                     cachePath,
+        const char*                                     sourcePath,
+        uint32_t                                        optionHash,
+        const asdx::ResModel&                           model,
+        const std::vector<std::vector<asdx::Matrix>>&   instances,
+        const std::vector<MeshAuxData>&                 aux);
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    ModelCache() = delete;
+};
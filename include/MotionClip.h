@@ -0,0 +1,201 @@
+﻿//-----------------------------------------------------------------------------
+// File : MotionClip.h
+// Desc : Reduced And Quantized Motion Clip.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <asdxMath.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MotionPose structure
+///////////////////////////////////////////////////////////////////////////////
+struct MotionPose
+{
+    asdx::Vector3       Translation;
+    asdx::Quaternion    Rotation;
+    asdx::Vector3       Scale;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MotionPoseBlock structure
+///////////////////////////////////////////////////////////////////////////////
+struct MotionPoseBlock
+{
+    static const uint32_t Size = 4;         //!< 1ブロックのボーン数.
+
+    alignas(16) float Translation[3][Size]; //!< 平行移動 (成分ごと).
+    alignas(16) float Rotation   [4][Size]; //!< 回転 (成分ごと).
+    alignas(16) float Scale      [3][Size]; //!< スケール (成分ごと).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MotionTolerance structure
+///////////////////////////////////////////////////////////////////////////////
+struct MotionTolerance
+{
+    float   Translation = 1e-3f;    //!< 平行移動の許容誤差です.
+    float   Rotation    = 1e-3f;    //!< 回転(クォータニオン成分)の許容誤差です(約0.1度).
+    float   Scale       = 1e-3f;    //!< スケールの許容誤差です.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MotionClip class
+///////////////////////////////////////////////////////////////////////////////
+class MotionClip
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    static const uint32_t MaxFrameCount = 65536;   //!< キー位置を16bitで保持するため.
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    MotionClip() = default;
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~MotionClip() = default;
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      boneCount       ボーン数です.
+    //! @param[in]      frameCount      フレーム数です(MaxFrameCount 以下).
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //-------------------------------------------------------------------------
+    bool Init(uint32_t boneCount, uint32_t frameCount);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ボーンのトラックを設定します.
+    //!
+    //! @param[in]      bone        ボーン番号です.
+    //! @param[in]      name        ボーン名です.
+    //! @param[in]      pPoses      フレーム数分の姿勢です.
+    //! @param[in]      tolerance   キー削減の許容誤差です.
+    //! @note       許容誤差は量子化後の値に対して判定します. 量子化誤差が許容誤差を超える場合は全フレームがキーになります.
+    //! @note       異なるボーンに対しては複数スレッドから同時に呼び出せます.
+    //-------------------------------------------------------------------------
+    void SetTrack(
+        uint32_t                bone,
+        const std::string&      name,
+        const MotionPose*       pPoses,
+        const MotionTolerance&  tolerance = MotionTolerance());
+
+    //-------------------------------------------------------------------------
+    //! @brief      全ボーンの姿勢をサンプリングします.
+    //!
+    //! @param[in]      frame       フレーム位置です.
+    //! @param[out]     pPoses      ボーン数分の格納先です.
+    //-------------------------------------------------------------------------
+    void Sample(float frame, MotionPose* pPoses) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ボーンの姿勢をサンプリングします.
+    //!
+    //! @param[in]      bone        ボーン番号です.
+    //! @param[in]      frame       フレーム位置です.
+    //! @return     補間された姿勢を返却します.
+    //-------------------------------------------------------------------------
+    MotionPose Sample(uint32_t bone, float frame) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      連続する4ボーンの姿勢をSIMDでサンプリングします.
+    //!
+    //! @param[in]      firstBone   先頭のボーン番号です.
+    //! @param[in]      frame       フレーム位置です.
+    //! @param[in,out]  pCursors    ボーンごとの T/R/S キー探索開始位置(3要素ずつ)です.
+    //! @param[out]     result      成分ごとに並べた姿勢の格納先です.
+    //! @note       前回のキー位置の近傍から線形探索し, 見つからない場合は二分探索します.
+    //!             ボーン数を超えるレーンには単位姿勢が格納されます.
+    //-------------------------------------------------------------------------
+    void SampleBlock(
+        uint32_t            firstBone,
+        float               frame,
+        uint16_t*           pCursors,
+        MotionPoseBlock&    result) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ボーン数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetBoneCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      フレーム数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetFrameCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ボーン名を取得します.
+    //-------------------------------------------------------------------------
+    const std::string& GetBoneName(uint32_t bone) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      全チャンネルのキー数の合計を取得します.
+    //-------------------------------------------------------------------------
+    size_t GetKeyCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      キーデータのメモリサイズを取得します.
+    //-------------------------------------------------------------------------
+    size_t GetMemorySize() const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Channel structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Channel
+    {
+        std::vector<uint16_t>   Frames;         // キー位置.
+        std::vector<uint16_t>   Values;         // キー値 (3要素ずつ).
+        float                   Min[3]  = {};   // 範囲量子化の最小値.
+        float                   Ext[3]  = {};   // 範囲量子化の幅.
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    // Track structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Track
+    {
+        std::string     Name;
+        Channel         Translation;
+        Channel         Rotation;       // smallest-three 形式.
+        Channel         Scale;
+    };
+
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<Track>  m_Tracks;
+    uint32_t            m_FrameCount = 0;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
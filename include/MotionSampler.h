@@ -0,0 +1,131 @@
+﻿//-----------------------------------------------------------------------------
+// File : MotionSampler.h
+// Desc : SIMD Motion Sampler And Matrix Palette Evaluator.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxMath.h>
+#include <MotionClip.h>
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+#ifndef ENABLE_MOTION_BENCHMARK
+#define ENABLE_MOTION_BENCHMARK     (0)     // 1 にするとサンプリングのスループット計測が有効になります.
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MotionSampler class
+///////////////////////////////////////////////////////////////////////////////
+class MotionSampler
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    static const uint32_t BlockSize = MotionPoseBlock::Size;    //!< SIMDで同時に処理するボーン数.
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    MotionSampler() = default;
+
+    //-------------------------------------------------------------------------
+    //! @brief      デストラクタです.
+    //-------------------------------------------------------------------------
+    ~MotionSampler() = default;
+
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      pClip           サンプリングするクリップです.
+    //! @param[in]      pInvBindPoses   ボーン数分の逆バインド行列です(nullptrの場合は単位行列).
+    //! @retval true    初期化に成功.
+    //! @retval false   初期化に失敗.
+    //! @note       クリップの姿勢はモデル空間(FBXLoader::ParseMotion の出力)として扱います.
+    //-------------------------------------------------------------------------
+    bool Init(const MotionClip* pClip, const asdx::Matrix* pInvBindPoses);
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      全ボーンをサンプリングしてスキニング行列を更新します.
+    //!
+    //! @param[in]      frame       フレーム位置です.
+    //! @param[in]      multiThread 複数スレッドで処理する場合は true.
+    //-------------------------------------------------------------------------
+    void Update(float frame, bool multiThread);
+
+    //-------------------------------------------------------------------------
+    //! @brief      指定範囲のボーンをサンプリングしてスキニング行列を更新します.
+    //!
+    //! @param[in]      frame       フレーム位置です.
+    //! @param[in]      firstBlock  開始ブロック番号です.
+    //! @param[in]      blockCount  処理するブロック数です.
+    //! @note       重ならないブロック範囲に対しては複数スレッドから同時に呼び出せます.
+    //-------------------------------------------------------------------------
+    void Update(float frame, uint32_t firstBlock, uint32_t blockCount);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ボーン数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetBoneCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ブロック数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetBlockCount() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      スキニング行列を取得します.
+    //!
+    //! @return     ボーン数分の行列を返却します. BoneTransforms にそのまま転送できます.
+    //-------------------------------------------------------------------------
+    const asdx::Matrix* GetPalette() const;
+
+#if ENABLE_MOTION_BENCHMARK
+    //-------------------------------------------------------------------------
+    //! @brief      1k～10kボーンでのサンプリングスループットを計測します.
+    //!
+    //! @param[in]      loopCount   計測回数です. 最速値を結果とします.
+    //! @retval true    計測に成功.
+    //! @retval false   計測に失敗.
+    //-------------------------------------------------------------------------
+    static bool Benchmark(uint32_t loopCount);
+#endif
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    const MotionClip*           m_pClip = nullptr;
+    std::vector<asdx::Matrix>   m_InvBindPoses;
+    std::vector<asdx::Matrix>   m_Palette;
+    std::vector<uint16_t>       m_Cursors;      // ボーンごとの T/R/S キー位置のキャッシュ.
+    uint32_t                    m_BoneCount = 0;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
@@ -13,6 +13,14 @@
 #include <map>
 
 
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+#ifndef ENABLE_OBJ_BENCHMARK
+#define ENABLE_OBJ_BENCHMARK    (0)     // 1 にすると旧実装とのスループット比較が有効になります.
+#endif
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // OBJLoader class
 ///////////////////////////////////////////////////////////////////////////////
@@ -53,6 +61,18 @@ public:
     //-------------------------------------------------------------------------
     bool Load(const char* path, asdx::ResModel& model);
 
+#if ENABLE_OBJ_BENCHMARK
+    //-------------------------------------------------------------------------
+    //! @brief      旧実装(std::ifstream)と逐次版・並列版の解析スループットを比較します.
+    //! 
+    //! @param[in]      path        OBJファイルパスです.
+    //! @param[in]      loopCount   計測回数です. 最速値を結果とします.
+    //! @retval true    計測に成功.
+    //! @retval false   計測に失敗.
+    //-------------------------------------------------------------------------
+    static bool Benchmark(const char* path, uint32_t loopCount);
+#endif
+
 private:
     //=========================================================================
     // private variables.
@@ -0,0 +1,63 @@
+﻿//-----------------------------------------------------------------------------
+// File : ParallelFor.h
+// Desc : Parallel For Loop.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <vector>
+
+
+//-----------------------------------------------------------------------------
+//! @brief      インデックス範囲 [0, count) を複数スレッドで処理します.
+//!
+//! @param[in]      count       処理数です.
+//! @param[in]      func        void(size_t index) 形式の処理関数です.
+//! @note       各インデックスはちょうど1回処理されます. 処理順は不定です.
+//-----------------------------------------------------------------------------
+template<typename Func>
+void ParallelFor(size_t count, Func func)
+{
+    auto threadCount = size_t(std::thread::hardware_concurrency());
+    if (threadCount > count)
+    { threadCount = count; }
+
+    // 並列化する意味が無い場合はその場で処理.
+    if (threadCount <= 1)
+    {
+        for(size_t i=0; i<count; ++i)
+        { func(i); }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]()
+    {
+        for(;;)
+        {
+            auto index = next.fetch_add(1);
+            if (index >= count)
+            { break; }
+
+            func(index);
+        }
+    };
+
+    // 呼び出しスレッドもワーカーとして使う.
+    std::vector<std::future<void>> tasks;
+    tasks.reserve(threadCount - 1);
+    for(size_t i=1; i<threadCount; ++i)
+    { tasks.push_back(std::async(std::launch::async, worker)); }
+
+    worker();
+
+    for(auto& task : tasks)
+    { task.wait(); }
+}
@@ -19,6 +19,7 @@
 #include <asdxDisposer.h>
 #include <ExportContext.h>
 #include <FxParser.h>
+#include <RenderStateCache.h>
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -121,6 +122,15 @@ public:
     //-------------------------------------------------------------------------
     ~PluginShader();
 
+    //-------------------------------------------------------------------------
+    //! @brief      ͌ʂoCfBOCAEg\z܂.
+    //!
+    //! @param[in]      parser      ͍ς݂̃p[Tł.
+    //! @retval true    \zɐ. RpC̃tNVȗ܂.
+    //! @retval false   錾ł͊młȂ, RpCɃtNVō\z܂.
+    //-------------------------------------------------------------------------
+    bool SetupLayout(const asura::FxParser& parser);
+
     //-------------------------------------------------------------------------
     //! @brief      RpC܂.
     //-------------------------------------------------------------------------
@@ -177,6 +187,11 @@ public:
     //-------------------------------------------------------------------------
     const std::map<std::string, BufferInfo>& GetBufferInfo() const;
 
+    //-------------------------------------------------------------------------
+    //! @brief      ʒuWȊO̒_QƂ邩ǂ?
+    //-------------------------------------------------------------------------
+    bool ReadsAttributes() const;
+
 private:
     //=========================================================================
     // private variables.
@@ -187,6 +202,8 @@ private:
     std::map<std::string, uint8_t>          m_TableUAV;
     std::map<std::string, BufferInfo>       m_BufferInfo;
     std::string                             m_EntryPoint;
+    bool                                    m_HasLayout = false;
+    bool                                    m_ReadsAttributes = true;
 
     //=========================================================================
     // private methods.
@@ -301,6 +318,21 @@ public:
     //-------------------------------------------------------------------------
     const std::string& GetShaderPath() const;
 
+    //-------------------------------------------------------------------------
+    //! @brief      VF[_ŃuhXe[g錾Ă邩ǂ?
+    //-------------------------------------------------------------------------
+    bool HasBlendState() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      VF[_ŃX^CU[Xe[g錾Ă邩ǂ?
+    //-------------------------------------------------------------------------
+    bool HasRasterizerState() const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      VF[_Ő[xXeVXe[g錾Ă邩ǂ?
+    //-------------------------------------------------------------------------
+    bool HasDepthStencilState() const;
+
 private:
     //=========================================================================
     // private variables.
@@ -311,6 +343,9 @@ private:
     PluginShader                    m_ShadowingShader;
     asura::Properties               m_Properties;
     asdx::RefPtr<ID3D11Buffer>      m_EditableCB;
+    RenderStateHandle               m_BlendState        = kInvalidRenderStateHandle;
+    RenderStateHandle               m_RasterizerState   = kInvalidRenderStateHandle;
+    RenderStateHandle               m_DepthStencilState = kInvalidRenderStateHandle;
 
     //=========================================================================
     // private methods.
@@ -0,0 +1,264 @@
+﻿//-----------------------------------------------------------------------------
+// File : RenderStateCache.h
+// Desc : Render State Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+#include <d3d11.h>
+#include <asdxRef.h>
+#include <FxParser.h>
+
+
+#ifndef ENABLE_RENDER_STATE_TEST
+#define ENABLE_RENDER_STATE_TEST    (0)     // 1 にするとデバイス無しでのステート登録テストが有効になります.
+#endif
+
+
+//-----------------------------------------------------------------------------
+// Type Definitions.
+//-----------------------------------------------------------------------------
+using RenderStateHandle = uint32_t;
+
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const RenderStateHandle kInvalidRenderStateHandle = UINT32_MAX;  // 無効ハンドル.
+
+
+//-----------------------------------------------------------------------------
+//! @brief      ブレンドステートをネイティブ形式に変換します.
+//-----------------------------------------------------------------------------
+D3D11_BLEND_DESC ToNativeDesc(const asura::BlendState& state);
+
+//-----------------------------------------------------------------------------
+//! @brief      ラスタライザーステートをネイティブ形式に変換します.
+//-----------------------------------------------------------------------------
+D3D11_RASTERIZER_DESC ToNativeDesc(const asura::RasterizerState& state);
+
+//-----------------------------------------------------------------------------
+//! @brief      深度ステンシルステートをネイティブ形式に変換します.
+//-----------------------------------------------------------------------------
+D3D11_DEPTH_STENCIL_DESC ToNativeDesc(const asura::DepthStencilState& state);
+
+#if ENABLE_RENDER_STATE_TEST
+//-----------------------------------------------------------------------------
+//! @brief      ステートの変換と重複排除をデバイス無しでテストします.
+//!
+//! @retval true    全てのテストに成功しました.
+//! @retval false   いずれかのテストに失敗しました.
+//-----------------------------------------------------------------------------
+bool TestRenderStateTable();
+#endif//ENABLE_RENDER_STATE_TEST
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RenderStateTable class
+///////////////////////////////////////////////////////////////////////////////
+template<typename Desc>
+class RenderStateTable
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      ステート記述を登録します.
+    //!
+    //! @param[in]      desc        ステート記述です.
+    //! @param[out]     pAdded      新規に登録された場合に true が設定されます.
+    //! @return     ハンドルを返却します. 同じ記述には常に同じハンドルを返却します.
+    //-------------------------------------------------------------------------
+    RenderStateHandle Register(const Desc& desc, bool* pAdded = nullptr)
+    {
+        auto hash  = CalcHash(desc);
+        auto range = m_Table.equal_range(hash);
+        for(auto itr = range.first; itr != range.second; ++itr)
+        {
+            if (memcmp(&m_Descs[itr->second], &desc, sizeof(Desc)) == 0)
+            {
+                if (pAdded != nullptr)
+                { *pAdded = false; }
+                return itr->second;
+            }
+        }
+
+        auto handle = RenderStateHandle(m_Descs.size());
+        m_Descs.push_back(desc);
+        m_Table.insert(std::make_pair(hash, handle));
+
+        if (pAdded != nullptr)
+        { *pAdded = true; }
+        return handle;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ステート記述を取得します.
+    //-------------------------------------------------------------------------
+    const Desc& GetDesc(RenderStateHandle handle) const
+    { return m_Descs[handle]; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      登録数を取得します.
+    //-------------------------------------------------------------------------
+    uint32_t GetCount() const
+    { return uint32_t(m_Descs.size()); }
+
+    //-------------------------------------------------------------------------
+    //! @brief      最後に登録したステート記述を破棄します.
+    //!
+    //! @note       オブジェクト生成に失敗した場合に, 無効なハンドルが再利用されないようにするために使用します.
+    //-------------------------------------------------------------------------
+    void RemoveLast()
+    {
+        if (m_Descs.empty())
+        { return; }
+
+        auto handle = RenderStateHandle(m_Descs.size() - 1);
+        auto range  = m_Table.equal_range(CalcHash(m_Descs.back()));
+        for(auto itr = range.first; itr != range.second; ++itr)
+        {
+            if (itr->second == handle)
+            {
+                m_Table.erase(itr);
+                break;
+            }
+        }
+
+        m_Descs.pop_back();
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      登録を全て破棄します.
+    //-------------------------------------------------------------------------
+    void Clear()
+    {
+        m_Descs.clear();
+        m_Table.clear();
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ハッシュ値を計算します(FNV-1a).
+    //-------------------------------------------------------------------------
+    static uint64_t CalcHash(const Desc& desc)
+    {
+        auto ptr  = reinterpret_cast<const uint8_t*>(&desc);
+        auto hash = 14695981039346656037ull;
+        for(size_t i=0; i<sizeof(Desc); ++i)
+        {
+            hash ^= ptr[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    std::vector<Desc>                                       m_Descs;
+    std::unordered_multimap<uint64_t, RenderStateHandle>    m_Table;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RenderStateCache class
+///////////////////////////////////////////////////////////////////////////////
+class RenderStateCache
+{
+    //=========================================================================
+    // list of friend classes and methods.
+    //=========================================================================
+    /* NOTHING */
+
+public:
+    //=========================================================================
+    // public variables.
+    //=========================================================================
+    /* NOTHING */
+
+    //=========================================================================
+    // public methods.
+    //=========================================================================
+
+    //-------------------------------------------------------------------------
+    //! @brief      シングルトンインスタンスを取得します.
+    //-------------------------------------------------------------------------
+    static RenderStateCache& Instance();
+
+    //-------------------------------------------------------------------------
+    //! @brief      終了処理を行います.
+    //-------------------------------------------------------------------------
+    void Term();
+
+    //-------------------------------------------------------------------------
+    //! @brief      ブレンドステートを登録します.
+    //-------------------------------------------------------------------------
+    RenderStateHandle RegisterBS(const asura::BlendState& state);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ラスタライザーステートを登録します.
+    //-------------------------------------------------------------------------
+    RenderStateHandle RegisterRS(const asura::RasterizerState& state);
+
+    //-------------------------------------------------------------------------
+    //! @brief      深度ステンシルステートを登録します.
+    //-------------------------------------------------------------------------
+    RenderStateHandle RegisterDSS(const asura::DepthStencilState& state);
+
+    //-------------------------------------------------------------------------
+    //! @brief      ブレンドステートを取得します.
+    //-------------------------------------------------------------------------
+    ID3D11BlendState* GetBS(RenderStateHandle handle) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ラスタライザーステートを取得します.
+    //-------------------------------------------------------------------------
+    ID3D11RasterizerState* GetRS(RenderStateHandle handle) const;
+
+    //-------------------------------------------------------------------------
+    //! @brief      深度ステンシルステートを取得します.
+    //-------------------------------------------------------------------------
+    ID3D11DepthStencilState* GetDSS(RenderStateHandle handle) const;
+
+private:
+    //=========================================================================
+    // private variables.
+    //=========================================================================
+    static RenderStateCache                                 s_Instance;
+    RenderStateTable<D3D11_BLEND_DESC>                      m_BlendTable;
+    RenderStateTable<D3D11_RASTERIZER_DESC>                 m_RasterizerTable;
+    RenderStateTable<D3D11_DEPTH_STENCIL_DESC>              m_DepthStencilTable;
+    std::vector<asdx::RefPtr<ID3D11BlendState>>             m_BS;
+    std::vector<asdx::RefPtr<ID3D11RasterizerState>>        m_RS;
+    std::vector<asdx::RefPtr<ID3D11DepthStencilState>>      m_DSS;
+
+    //=========================================================================
+    // private methods.
+    //=========================================================================
+    /* NOTHING */
+};
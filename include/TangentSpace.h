@@ -0,0 +1,39 @@
+﻿//-----------------------------------------------------------------------------
+// File : TangentSpace.h
+// Desc : Normal And Tangent Generation.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <asdxResModel.h>
+#include <MeshPostProcess.h>
+
+
+//-----------------------------------------------------------------------------
+//! @brief      持っていない法線ベクトルと接線ベクトルを生成します.
+//!
+//! @param[in,out]  mesh        メッシュです.
+//! @retval true    生成に成功.
+//! @retval false   生成に失敗.
+//! @note       法線は面積で重み付けした面法線の合計です.
+//!             接線は MikkTSpace と同じく, 面の接線を頂点法線の接平面に射影し, 角の大きさで重み付けして合計します.
+//!             インデックス化済みのため頂点の分割は行わず, 同じ頂点を共有するUVの向きが反転した面も1つにまとめます.
+//!             テクスチャ座標0が無い場合は法線に直交する任意の接線を設定します.
+//!             合計は頂点ごとに面の順で行うため, スレッド数によらず同じ結果になります.
+//-----------------------------------------------------------------------------
+bool GenerateTangentSpace(asdx::ResMesh& mesh);
+
+#if ENABLE_MESH_BENCHMARK
+//-----------------------------------------------------------------------------
+//! @brief      法線・接線生成の処理時間と誤差を asdx::CalcNormals(), asdx::CalcTangents() と比較します.
+//!
+//! @param[in]      loopCount   計測回数です(最小値を採用します).
+//! @retval true    計測に成功.
+//! @retval false   計測に失敗.
+//-----------------------------------------------------------------------------
+bool BenchmarkTangentSpace(uint32_t loopCount);
+#endif
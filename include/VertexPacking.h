@@ -0,0 +1,135 @@
+﻿//-----------------------------------------------------------------------------
+// File : VertexPacking.h
+// Desc : Compact Vertex Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#pragma once
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <cstdint>
+#include <vector>
+#include <asdxResModel.h>
+#include <MeshPostProcess.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// VERTEX_STREAM enum
+///////////////////////////////////////////////////////////////////////////////
+enum VERTEX_STREAM
+{
+    VERTEX_STREAM_POSITION = 0,     //!< R32G32B32_FLOAT または R16G16B16A16_UNORM (AABB基準).
+    VERTEX_STREAM_NORMAL_TANGENT,   //!< R16G16_SNORM x 2 (八面体エンコード).
+    VERTEX_STREAM_COLOR,            //!< R8G8B8A8_UNORM.
+    VERTEX_STREAM_TEXCOORD0,        //!< R16G16_FLOAT.
+    VERTEX_STREAM_TEXCOORD1,        //!< R16G16_FLOAT.
+    VERTEX_STREAM_TEXCOORD2,        //!< R16G16_FLOAT.
+    VERTEX_STREAM_TEXCOORD3,        //!< R16G16_FLOAT.
+    VERTEX_STREAM_COUNT,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// PackedVertexFormat structure
+///////////////////////////////////////////////////////////////////////////////
+struct PackedVertexFormat
+{
+    bool            QuantizedPosition = false;          //!< 頂点座標を量子化したかどうか.
+    uint32_t        Offset[VERTEX_STREAM_COUNT] = {};   //!< バッファ先頭からのオフセットです.
+    uint32_t        Stride[VERTEX_STREAM_COUNT] = {};   //!< ストライドです(0の場合は既定値を全頂点で共有します).
+    asdx::Vector3   PositionScale;                      //!< 頂点座標の復元スケールです.
+    asdx::Vector3   PositionOffset;                     //!< 頂点座標の復元オフセットです.
+};
+
+
+//-----------------------------------------------------------------------------
+//! @brief      メッシュが持つ属性に合わせて頂点データを圧縮します.
+//!
+//! @param[in]      mesh                メッシュです.
+//! @param[in]      quantizePosition    頂点座標をAABB基準で16bitに量子化するかどうか.
+//! @param[out]     format              圧縮形式の格納先です.
+//! @param[out]     data                頂点バッファに設定するデータの格納先です.
+//! @retval true    圧縮に成功.
+//! @retval false   圧縮に失敗.
+//! @note       ストリームごとに連続して格納し, 持たない属性は末尾の既定値をストライド0で参照します.
+//-----------------------------------------------------------------------------
+bool PackVertices(
+    const asdx::ResMesh&    mesh,
+    bool                    quantizePosition,
+    PackedVertexFormat&     format,
+    std::vector<uint8_t>&   data);
+
+//-----------------------------------------------------------------------------
+//! @brief      法線と接線を八面体エンコードします.
+//!
+//! @param[in]      pNormals    法線ベクトルです.
+//! @param[in]      pTangents   接線ベクトルです.
+//! @param[in]      count       頂点数です.
+//! @param[out]     pResult     頂点あたり2要素(法線, 接線の順)の格納先です.
+//-----------------------------------------------------------------------------
+void EncodeOctahedral(
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector3*    pTangents,
+    size_t                  count,
+    uint32_t*               pResult);
+
+//-----------------------------------------------------------------------------
+//! @brief      テクスチャ座標を半精度浮動小数に変換します.
+//!
+//! @param[in]      pTexCoords  テクスチャ座標です.
+//! @param[in]      count       頂点数です.
+//! @param[out]     pResult     頂点あたり1要素の格納先です.
+//-----------------------------------------------------------------------------
+void EncodeHalf2(const asdx::Vector2* pTexCoords, size_t count, uint32_t* pResult);
+
+//-----------------------------------------------------------------------------
+//! @brief      カラーを8bit正規化整数に変換します.
+//!
+//! @param[in]      pColors     カラーです.
+//! @param[in]      count       頂点数です.
+//! @param[out]     pResult     頂点あたり1要素の格納先です.
+//-----------------------------------------------------------------------------
+void EncodeColor(const asdx::Vector4* pColors, size_t count, uint32_t* pResult);
+
+//-----------------------------------------------------------------------------
+//! @brief      頂点座標をAABB基準で16bit正規化整数に量子化します.
+//!
+//! @param[in]      pPositions  頂点座標です.
+//! @param[in]      count       頂点数です.
+//! @param[in]      mini        AABBの最小値です.
+//! @param[in]      maxi        AABBの最大値です.
+//! @param[out]     pResult     頂点あたり4要素(w は 0)の格納先です.
+//-----------------------------------------------------------------------------
+void QuantizePositions(
+    const asdx::Vector3*    pPositions,
+    size_t                  count,
+    const asdx::Vector3&    mini,
+    const asdx::Vector3&    maxi,
+    uint16_t*               pResult);
+
+//-----------------------------------------------------------------------------
+//! @brief      頂点数に合わせてインデックスを16bitまたは32bitで格納します.
+//!
+//! @param[in]      pIndices    インデックスです.
+//! @param[in]      count       インデックス数です.
+//! @param[in]      vertexCount 参照される頂点数です.
+//! @param[out]     data        インデックスバッファに設定するデータの格納先です.
+//! @return     インデックス1つあたりのバイト数(2 または 4)を返却します.
+//! @note       頂点数が65536以下であれば16bitで格納します.
+//-----------------------------------------------------------------------------
+uint32_t PackIndices(
+    const uint32_t*         pIndices,
+    size_t                  count,
+    size_t                  vertexCount,
+    std::vector<uint8_t>&   data);
+
+#if ENABLE_MESH_BENCHMARK
+//-----------------------------------------------------------------------------
+//! @brief      頂点圧縮の処理時間, メモリ削減率, 誤差を計測します.
+//!
+//! @param[in]      loopCount   計測回数です(最小値を採用します).
+//! @retval true    計測に成功.
+//! @retval false   計測に失敗.
+//-----------------------------------------------------------------------------
+bool BenchmarkVertexPacking(uint32_t loopCount);
+#endif
@@ -44,18 +44,27 @@ public:
 
     //-------------------------------------------------------------------------
     //! @brief      ワークスペースを新規作成します.
+    //!
+    //! @param[in]      modelPath   モデルファイルパスです.
+    //! @param[in]      option      インポート時のメッシュ後処理オプションです.
     //-------------------------------------------------------------------------
-    bool New(const char* modelPath);
+    bool New(const char* modelPath, const MeshPostProcessOption& option = MeshPostProcessOption());
 
     //-------------------------------------------------------------------------
     //! @brief      読み込みを行います.
+    //!
+    //! @param[in]      path        ワークスペースファイルパスです.
+    //! @param[in]      option      インポート時のメッシュ後処理オプションです.
     //-------------------------------------------------------------------------
-    bool Load(const char* path);
+    bool Load(const char* path, const MeshPostProcessOption& option = MeshPostProcessOption());
 
     //-------------------------------------------------------------------------
     //! @brief      非同期読み込みを行います.
+    //!
+    //! @param[in]      path        ワークスペースファイルパスです.
+    //! @param[in]      option      インポート時のメッシュ後処理オプションです.
     //-------------------------------------------------------------------------
-    bool LoadAsync(const char* path);
+    bool LoadAsync(const char* path, const MeshPostProcessOption& option = MeshPostProcessOption());
 
     //-------------------------------------------------------------------------
     //! @brief      名前を付けて保存を行います.
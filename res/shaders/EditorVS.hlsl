@@ -7,6 +7,8 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include "Math.hlsli"
+#include "VertexDecode.hlsli"
+#include "InstanceTransform.hlsli"
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -14,9 +16,9 @@
 ///////////////////////////////////////////////////////////////////////////////
 struct VSInput
 {
-    float3  Position     : POSITION;        // ʒuW.
-    float3  Normal       : NORMAL;          // @xNg.
-    float3  Tangent      : TANGENT;         // ڐxNg.
+    float3  Position     : POSITION;        // ʒuW(ʎqĂꍇ܂).
+    float2  Normal       : NORMAL;          // @xNg(ʑ̃GR[h).
+    float2  Tangent      : TANGENT;         // ڐxNg(ʑ̃GR[h).
     float4  Color        : COLOR;           // J[.
     float2  TexCoord0    : TEXCOORD0;       // eNX`W0.
     float2  TexCoord1    : TEXCOORD1;       // eNX`W1
@@ -74,15 +76,17 @@ VSOutput main(const VSInput input, uint instanceId : SV_InstanceID)
 {
     VSOutput output = (VSOutput)0;
 
-    float4 localPos = float4(input.Position, 1.0f);
+    // CX^Xs̓f̃[hsɓKp.
+    float4x4 instanceMatrix = InstanceMatrix[instanceId];
+
+    float4 localPos = mul(instanceMatrix, float4(DecodePosition(input.Position), 1.0f));
     float4 worldPos = mul(World, localPos);
-    worldPos = mul(InstanceMatrix[instanceId], worldPos);
 
     float4 viewPos  = mul(View, worldPos);
     float4 projPos  = mul(Proj, viewPos);
 
-    float3 worldNormal  = mul((float3x3)World, input.Normal);
-    float3 worldTangent = mul((float3x3)World, input.Tangent);
+    float3 worldNormal  = mul((float3x3)World, TransformInstanceNormal(instanceMatrix, DecodeOctahedral(input.Normal)));
+    float3 worldTangent = mul((float3x3)World, TransformInstanceTangent(instanceMatrix, DecodeOctahedral(input.Tangent)));
 
     output.Position     = projPos;
     output.Normal       = worldNormal;
@@ -0,0 +1,31 @@
+//-----------------------------------------------------------------------------
+// File : InstanceTransform.hlsli
+// Desc : Instance Matrix Transform.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#ifndef INSTANCE_TRANSFORM_HLSLI
+#define INSTANCE_TRANSFORM_HLSLI
+
+//-----------------------------------------------------------------------------
+//      CX^XsŖ@xNgϊ܂.
+//-----------------------------------------------------------------------------
+float3 TransformInstanceNormal(float4x4 instanceMatrix, float3 normal)
+{
+    // lXP[Řc܂Ȃ悤, ]qs(t]us̍s񎮔{)ŕϊ.
+    float3x3 m = (float3x3)instanceMatrix;
+    float3 c0 = cross(m[1], m[2]);
+    float3 c1 = cross(m[2], m[0]);
+    float3 c2 = cross(m[0], m[1]);
+
+    // ϊł]Ȃ悤s񎮂̕|.
+    float  s = (dot(m[0], c0) < 0.0f) ? -1.0f : 1.0f;
+    return normalize(float3(dot(c0, normal), dot(c1, normal), dot(c2, normal)) * s);
+}
+
+//-----------------------------------------------------------------------------
+//      CX^XsŐڐxNgϊ܂.
+//-----------------------------------------------------------------------------
+float3 TransformInstanceTangent(float4x4 instanceMatrix, float3 tangent)
+{ return normalize(mul((float3x3)instanceMatrix, tangent)); }
+
+#endif//INSTANCE_TRANSFORM_HLSLI
@@ -0,0 +1,94 @@
+//-----------------------------------------------------------------------------
+// File : ShadowDepthSkinningVS.hlsl
+// Desc : Editor Position Only Skinning Vertex Shader for Shadow.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "Math.hlsli"
+#include "VertexDecode.hlsli"
+
+
+///////////////////////////////////////////////////////////////////////////////
+// VSInput structure
+///////////////////////////////////////////////////////////////////////////////
+struct VSInput
+{
+    float3  Position     : POSITION;        // ʒuW(ʎqĂꍇ܂).
+    uint4   BoneIndex    : BONE_INDEX;      // {[CfbNX.
+    float4  BoneWeight   : BONE_WEIGHT;     // {[EFCg.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VSOutput structure
+// VhEpsNZVF[_ƃNł悤ɏo͂ ShadowVS Ƌʂɂ.
+///////////////////////////////////////////////////////////////////////////////
+struct VSOutput
+{
+    float4 Position   : SV_POSITION;    // ʒuW.
+    float4 Color      : COLOR;          // J[.
+    float3 Normal     : NORMAL;         // @xNg.
+    float3 Tangent    : TANGENT;        // ڐxNg.
+    float4 TexCoord01 : TEXCOORD0;      // eNX`W0, eNX`W1.
+    float4 TexCoord23 : TEXCOORD1;      // eNX`W2, eNX`W3.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CbMesh constant buffer.
+///////////////////////////////////////////////////////////////////////////////
+cbuffer CbMesh : register(b1)
+{
+    float4x4 World;     // [hs.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CbShadow constant buffer.
+///////////////////////////////////////////////////////////////////////////////
+cbuffer CbShadow : register(b2)
+{
+    float4x4 ShadowMatrix;  // VhEpr[ˉes.
+};
+
+//-----------------------------------------------------------------------------
+// Textures and Samplers.
+//-----------------------------------------------------------------------------
+StructuredBuffer<float4x4>  BoneTransforms : register(t0);
+StructuredBuffer<float4x4>  InstanceMatrix : register(t1);
+
+//-----------------------------------------------------------------------------
+//      XLjOs܂.
+//-----------------------------------------------------------------------------
+float4 Skinning(float4 value, uint4 boneIndex, float4 boneWeight)
+{
+    float4 ret = 0;
+    ret += mul(BoneTransforms[boneIndex.x], value) * boneWeight.x;
+    ret += mul(BoneTransforms[boneIndex.y], value) * boneWeight.y;
+    ret += mul(BoneTransforms[boneIndex.z], value) * boneWeight.z;
+    ret += mul(BoneTransforms[boneIndex.w], value) * boneWeight.w;
+    return ret;
+}
+
+
+//-----------------------------------------------------------------------------
+//      CGg[|Cgł.
+//-----------------------------------------------------------------------------
+VSOutput main(const VSInput input, uint instanceId : SV_InstanceID)
+{
+    VSOutput output = (VSOutput)0;
+
+    float4 localPos     = float4(DecodePosition(input.Position), 1.0f);
+    float4 skinningPos  = Skinning(localPos, input.BoneIndex, input.BoneWeight);
+
+    // CX^Xs̓f̃[hsɓKp.
+    float4x4 instanceMatrix = InstanceMatrix[instanceId];
+    float4 worldPos     = mul(World, mul(instanceMatrix, skinningPos));
+
+    float4 projPos = mul(ShadowMatrix, worldPos);
+
+    // ʒuWȊȎ̓[̂܂܏o͂.
+    output.Position      = projPos;
+
+    return output;
+}
\ No newline at end of file
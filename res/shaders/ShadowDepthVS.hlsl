@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+// File : ShadowDepthVS.hlsl
+// Desc : Editor Position Only Vertex Shader for Shadow
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include "Math.hlsli"
+#include "VertexDecode.hlsli"
+
+
+///////////////////////////////////////////////////////////////////////////////
+// VSInput structure
+///////////////////////////////////////////////////////////////////////////////
+struct VSInput
+{
+    float3  Position     : POSITION;        // ʒuW(ʎqĂꍇ܂).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// VSOutput structure
+// VhEpsNZVF[_ƃNł悤ɏo͂ ShadowVS Ƌʂɂ.
+///////////////////////////////////////////////////////////////////////////////
+struct VSOutput
+{
+    float4 Position   : SV_POSITION;    // ʒuW.
+    float4 Color      : COLOR;          // J[.
+    float3 Normal     : NORMAL;         // @xNg.
+    float3 Tangent    : TANGENT;        // ڐxNg.
+    float4 TexCoord01 : TEXCOORD0;      // eNX`W0, eNX`W1.
+    float4 TexCoord23 : TEXCOORD1;      // eNX`W2, eNX`W3.
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// CbMesh constant buffer
+///////////////////////////////////////////////////////////////////////////////
+cbuffer CbMesh : register(b1)
+{
+    float4x4 World;     // [hs.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CbShadow constant buffer.
+///////////////////////////////////////////////////////////////////////////////
+cbuffer CbShadow : register(b2)
+{
+    float4x4 ShadowMatrix; // VhEpr[ˉes.
+};
+
+//-----------------------------------------------------------------------------
+// Resources.
+//-----------------------------------------------------------------------------
+StructuredBuffer<float4x4>  InstanceMatrix : register(t1);
+
+//-----------------------------------------------------------------------------
+//      CGg[|Cgł.
+//-----------------------------------------------------------------------------
+VSOutput main(const VSInput input, uint instanceId : SV_InstanceID)
+{
+    VSOutput output = (VSOutput)0;
+
+    // CX^Xs̓f̃[hsɓKp.
+    float4x4 instanceMatrix = InstanceMatrix[instanceId];
+
+    float4 localPos = mul(instanceMatrix, float4(DecodePosition(input.Position), 1.0f));
+    float4 worldPos = mul(World, localPos);
+    float4 projPos = mul(ShadowMatrix, worldPos);
+
+    // ʒuWȊȎ̓[̂܂܏o͂.
+    output.Position      = projPos;
+
+    return output;
+}
\ No newline at end of file
@@ -8,6 +8,8 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include "Math.hlsli"
+#include "VertexDecode.hlsli"
+#include "InstanceTransform.hlsli"
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -15,9 +17,9 @@
 ///////////////////////////////////////////////////////////////////////////////
 struct VSInput
 {
-    float3  Position     : POSITION;        // ʒuW.
-    float3  Normal       : NORMAL;          // @xNg.
-    float3  Tangent      : TANGENT;         // ڐxNg.
+    float3  Position     : POSITION;        // ʒuW(ʎqĂꍇ܂).
+    float2  Normal       : NORMAL;          // @xNg(ʑ̃GR[h).
+    float2  Tangent      : TANGENT;         // ڐxNg(ʑ̃GR[h).
     float4  Color        : COLOR;           // J[.
     float2  TexCoord0    : TEXCOORD0;       // eNX`W0.
     float2  TexCoord1    : TEXCOORD1;       // eNX`W1
@@ -83,15 +85,17 @@ VSOutput main(const VSInput input, uint instanceId : SV_InstanceID)
 {
     VSOutput output = (VSOutput)0;
 
-    float4 localPos     = float4(input.Position, 1.0f);
+    float4 localPos     = float4(DecodePosition(input.Position), 1.0f);
     float4 skinningPos  = Skinning(localPos, input.BoneIndex, input.BoneWeight);
-    float4 worldPos     = mul(World, skinningPos);
-    worldPos = mul(InstanceMatrix[instanceId], worldPos);
+
+    // CX^Xs̓f̃[hsɓKp.
+    float4x4 instanceMatrix = InstanceMatrix[instanceId];
+    float4 worldPos     = mul(World, mul(instanceMatrix, skinningPos));
 
     float4 projPos = mul(ShadowMatrix, worldPos);
 
-    float3 normal  = mul((float3x3)World, input.Normal);
-    float3 tangent = mul((float3x3)World, input.Tangent);
+    float3 normal  = mul((float3x3)World, TransformInstanceNormal(instanceMatrix, DecodeOctahedral(input.Normal)));
+    float3 tangent = mul((float3x3)World, TransformInstanceTangent(instanceMatrix, DecodeOctahedral(input.Tangent)));
 
     float4 skinningNormal  = Skinning(float4(normal,  0), input.BoneIndex, input.BoneWeight);
     float4 skinningTangent = Skinning(float4(tangent, 0), input.BoneIndex, input.BoneWeight);
@@ -0,0 +1,35 @@
+//-----------------------------------------------------------------------------
+// File : VertexDecode.hlsli
+// Desc : Compact Vertex Decode.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+#ifndef VERTEX_DECODE_HLSLI
+#define VERTEX_DECODE_HLSLI
+
+///////////////////////////////////////////////////////////////////////////////
+// CbVertexDecode constant buffer.
+///////////////////////////////////////////////////////////////////////////////
+cbuffer CbVertexDecode : register(b3)
+{
+    float3  PositionScale   : packoffset(c0);   // 頂点座標の復元スケール.
+    float3  PositionOffset  : packoffset(c1);   // 頂点座標の復元オフセット.
+};
+
+//-----------------------------------------------------------------------------
+//      AABB基準で量子化された頂点座標を復元します.
+//-----------------------------------------------------------------------------
+float3 DecodePosition(float3 value)
+{ return value * PositionScale + PositionOffset; }
+
+//-----------------------------------------------------------------------------
+//      八面体エンコードされたベクトルを復元します.
+//-----------------------------------------------------------------------------
+float3 DecodeOctahedral(float2 value)
+{
+    float3 result = float3(value.x, value.y, 1.0f - abs(value.x) - abs(value.y));
+    float  t = saturate(-result.z);
+    result.xy += (result.xy >= 0.0f) ? -t : t;
+    return normalize(result);
+}
+
+#endif//VERTEX_DECODE_HLSLI
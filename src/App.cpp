@@ -15,6 +15,8 @@
 #include <asdxMisc.h>
 #include <asdxAppHistoryMgr.h>
 #include <LightMgr.h>
+#include <RenderStateCache.h>
+#include <cstring>
 
 
 namespace {
@@ -29,6 +31,8 @@ namespace {
 #include "../res/shaders/Compiled/GuidePS.inc"
 #include "../res/shaders/Compiled/ShadowVS.inc"
 #include "../res/shaders/Compiled/ShadowSkinningVS.inc"
+#include "../res/shaders/Compiled/ShadowDepthVS.inc"
+#include "../res/shaders/Compiled/ShadowDepthSkinningVS.inc"
 #include "../res/shaders/Compiled/TriangleVS.inc"
 #include "../res/shaders/Compiled/ShapeVS.inc"
 #include "../res/shaders/Compiled/ShapePS.inc"
@@ -41,25 +45,35 @@ namespace {
 // Global Varaibles.
 //-----------------------------------------------------------------------------
 static const D3D11_INPUT_ELEMENT_DESC kElements[] = {
-    { "POSITION",      0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "NORMAL",        0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TANGENT",       0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "COLOR",         0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD",      0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD",      1, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD",      2, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD",      3, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "POSITION",      0, DXGI_FORMAT_R32G32B32_FLOAT,    VERTEX_STREAM_POSITION,       D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "NORMAL",        0, DXGI_FORMAT_R16G16_SNORM,       VERTEX_STREAM_NORMAL_TANGENT, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TANGENT",       0, DXGI_FORMAT_R16G16_SNORM,       VERTEX_STREAM_NORMAL_TANGENT, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "COLOR",         0, DXGI_FORMAT_R8G8B8A8_UNORM,     VERTEX_STREAM_COLOR,          D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",      0, DXGI_FORMAT_R16G16_FLOAT,       VERTEX_STREAM_TEXCOORD0,      D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",      1, DXGI_FORMAT_R16G16_FLOAT,       VERTEX_STREAM_TEXCOORD1,      D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",      2, DXGI_FORMAT_R16G16_FLOAT,       VERTEX_STREAM_TEXCOORD2,      D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",      3, DXGI_FORMAT_R16G16_FLOAT,       VERTEX_STREAM_TEXCOORD3,      D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 };
 
 static const D3D11_INPUT_ELEMENT_DESC kSkinningElements[] = {
+    { "POSITION",      0, DXGI_FORMAT_R32G32B32_FLOAT,    VERTEX_STREAM_POSITION,       D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "NORMAL",        0, DXGI_FORMAT_R16G16_SNORM,       VERTEX_STREAM_NORMAL_TANGENT, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TANGENT",       0, DXGI_FORMAT_R16G16_SNORM,       VERTEX_STREAM_NORMAL_TANGENT, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "COLOR",         0, DXGI_FORMAT_R8G8B8A8_UNORM,     VERTEX_STREAM_COLOR,          D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",      0, DXGI_FORMAT_R16G16_FLOAT,       VERTEX_STREAM_TEXCOORD0,      D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",      1, DXGI_FORMAT_R16G16_FLOAT,       VERTEX_STREAM_TEXCOORD1,      D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",      2, DXGI_FORMAT_R16G16_FLOAT,       VERTEX_STREAM_TEXCOORD2,      D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD",      3, DXGI_FORMAT_R16G16_FLOAT,       VERTEX_STREAM_TEXCOORD3,      D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "BONE_INDEX",    0, DXGI_FORMAT_R16G16B16A16_UINT,  VERTEX_STREAM_COUNT,          D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "BONE_WEIGHT",   0, DXGI_FORMAT_R32G32B32A32_FLOAT, VERTEX_STREAM_COUNT,          D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+};
+
+static const D3D11_INPUT_ELEMENT_DESC kDepthElements[] = {
+    { "POSITION",      0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+};
+
+static const D3D11_INPUT_ELEMENT_DESC kDepthSkinningElements[] = {
     { "POSITION",      0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "NORMAL",        0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TANGENT",       0, DXGI_FORMAT_R32G32B32_FLOAT,    0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "COLOR",         0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD",      0, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD",      1, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD",      2, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-    { "TEXCOORD",      3, DXGI_FORMAT_R32G32_FLOAT,       0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
     { "BONE_INDEX",    0, DXGI_FORMAT_R16G16B16A16_UINT,  1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 },
     { "BONE_WEIGHT",   0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 }
 };
@@ -283,6 +297,37 @@ asdx::Vector3 ToDirection(const asdx::Vector2& angle)
         cos(theta) * sin(phi));
 }
 
+//-----------------------------------------------------------------------------
+//      頂点座標を量子化したメッシュ用の入力レイアウトを生成します.
+//-----------------------------------------------------------------------------
+bool CreateQuantizedLayout
+(
+    ID3D11Device*                   pDevice,
+    const void*                     pBinary,
+    size_t                          binarySize,
+    const D3D11_INPUT_ELEMENT_DESC* pElements,
+    uint32_t                        count,
+    ID3D11InputLayout**             ppLayout
+)
+{
+    // シェーダ側は float3 のままなので, 入力フォーマットだけを差し替える.
+    std::vector<D3D11_INPUT_ELEMENT_DESC> elements(pElements, pElements + count);
+    for(auto& element : elements)
+    {
+        if (strcmp(element.SemanticName, "POSITION") == 0)
+        { element.Format = DXGI_FORMAT_R16G16B16A16_UNORM; }
+    }
+
+    auto hr = pDevice->CreateInputLayout(elements.data(), count, pBinary, binarySize, ppLayout);
+    if (FAILED(hr))
+    {
+        ELOGA("Error : ID3D11Device::CreateInputLayout() Failed. errcode = 0x%x", hr);
+        return false;
+    }
+
+    return true;
+}
+
 } // namespace
 
 
@@ -373,6 +418,29 @@ bool App::OnInit()
             return false;
         }
 
+        if (!m_ShadowDepthVS.Init(m_pDevice, ASDX_SHADER_BIN(ShadowDepthVS), _countof(kDepthElements), kDepthElements))
+        {
+            ELOG("Error : ShadowDepthVS Init Failed.");
+            return false;
+        }
+
+        if (!m_ShadowDepthSkinningVS.Init(m_pDevice, ASDX_SHADER_BIN(ShadowDepthSkinningVS), _countof(kDepthSkinningElements), kDepthSkinningElements))
+        {
+            ELOG("Error : ShadowDepthSkinningVS Init Failed.");
+            return false;
+        }
+
+        if (!CreateQuantizedLayout(m_pDevice, ASDX_SHADER_BIN(EditorVS), kElements, _countof(kElements), m_EditorQuantizedIL.GetAddress())
+         || !CreateQuantizedLayout(m_pDevice, ASDX_SHADER_BIN(EditorSkinningVS), kSkinningElements, _countof(kSkinningElements), m_EditorSkinningQuantizedIL.GetAddress())
+         || !CreateQuantizedLayout(m_pDevice, ASDX_SHADER_BIN(ShadowVS), kElements, _countof(kElements), m_ShadowQuantizedIL.GetAddress())
+         || !CreateQuantizedLayout(m_pDevice, ASDX_SHADER_BIN(ShadowSkinningVS), kSkinningElements, _countof(kSkinningElements), m_ShadowSkinningQuantizedIL.GetAddress())
+         || !CreateQuantizedLayout(m_pDevice, ASDX_SHADER_BIN(ShadowDepthVS), kDepthElements, _countof(kDepthElements), m_ShadowDepthQuantizedIL.GetAddress())
+         || !CreateQuantizedLayout(m_pDevice, ASDX_SHADER_BIN(ShadowDepthSkinningVS), kDepthSkinningElements, _countof(kDepthSkinningElements), m_ShadowDepthSkinningQuantizedIL.GetAddress()))
+        {
+            ELOG("Error : Quantized InputLayout Init Failed.");
+            return false;
+        }
+
         if (!m_TriangleVS.Init(m_pDevice, ASDX_SHADER_BIN(TriangleVS), _countof(kTriangleElements), kTriangleElements))
         {
             ELOG("Error : TriangleVS Init Failed.");
@@ -631,6 +699,8 @@ void App::OnTerm()
     m_EditorSkinningVS  .Term();
     m_ShadowVS          .Term();
     m_ShadowSkinningVS  .Term();
+    m_ShadowDepthVS     .Term();
+    m_ShadowDepthSkinningVS.Term();
     m_TriangleVS        .Term();
     m_GuideVS           .Term();
     m_ShapeVS           .Term();
@@ -641,6 +711,13 @@ void App::OnTerm()
     m_ShapePS           .Term();
     m_CompositePS       .Term();
 
+    m_EditorQuantizedIL         .Reset();
+    m_EditorSkinningQuantizedIL .Reset();
+    m_ShadowQuantizedIL         .Reset();
+    m_ShadowSkinningQuantizedIL .Reset();
+    m_ShadowDepthQuantizedIL    .Reset();
+    m_ShadowDepthSkinningQuantizedIL.Reset();
+
     m_SceneCB.Term();
     m_GuideCB.Term();
     m_LightCB.Term();
@@ -667,6 +744,8 @@ void App::OnTerm()
     PluginMgr::Instance().Term();
     LightMgr ::Instance().Term();
 
+    RenderStateCache::Instance().Term();
+
     asdx::GuiMgr       ::GetInstance().Term();
     asdx::AppHistoryMgr::GetInstance().Term();
 }
@@ -999,13 +1078,13 @@ void App::OnDrop(const std::vector<std::string>& dropFiles)
          || ext == "gltf"
          || ext == "glb")
         {
-            if (m_WorkSpace.New(dropFiles[i].c_str()))
+            if (m_WorkSpace.New(dropFiles[i].c_str(), m_Config.Import.GetOption()))
             { return; }
         }
         // ワークスペース.
         else if (ext == "work")
         {
-            if (m_WorkSpace.LoadAsync(dropFiles[i].c_str()))
+            if (m_WorkSpace.LoadAsync(dropFiles[i].c_str(), m_Config.Import.GetOption()))
             { return; }
         }
     }
@@ -1032,6 +1111,12 @@ void App::DrawModel(bool lightingPass, asdx::BlendType blendType)
 
     auto light = LightMgr::Instance().GetLight();
 
+    // LOD選択に使う距離1における1単位あたりのピクセル数.
+    auto enableLod    = m_Config.ModelPreview.EnableLod.GetValue();
+    auto lodThreshold = m_Config.ModelPreview.LodThreshold.GetValue();
+    auto cameraPos    = m_CameraController.GetCamera().GetPosition();
+    auto projScale    = 0.5f * float(m_Height) * m_Proj._22;
+
     for(auto i=0u; i<count; ++i)
     {
         auto& mesh      = model->GetMesh(i);
@@ -1044,20 +1129,7 @@ void App::DrawModel(bool lightingPass, asdx::BlendType blendType)
         if (material.GetBlendState() != blendType)
         { continue; }
 
-        if (mesh.HasSkinningData())
-        {
-            if (lightingPass)
-            { m_EditorSkinningVS.Bind(m_pDeviceContext); }
-            else
-            { m_ShadowSkinningVS.Bind(m_pDeviceContext); }
-        }
-        else
-        {
-            if (lightingPass)
-            { m_EditorVS.Bind(m_pDeviceContext); }
-            else
-            { m_ShadowVS.Bind(m_pDeviceContext); }
-        }
+        auto lod = (enableLod) ? mesh.SelectLod(model->GetWorld(), cameraPos, projScale, lodThreshold) : 0u;
 
         m_pDeviceContext->VSSetConstantBuffers(0, 1, &pSceneCB);
         m_pDeviceContext->VSSetConstantBuffers(1, 1, &pMeshCB);
@@ -1081,7 +1153,8 @@ void App::DrawModel(bool lightingPass, asdx::BlendType blendType)
             }
 
             // メッシュを描画.
-            mesh.Draw(m_pDeviceContext);
+            // シャドウパスで頂点属性を参照しない場合は位置座標のみで描画する.
+            DrawMesh(mesh, lod, lightingPass, !lightingPass && !shader->ReadsAttributes());
 
             // マテリアル設定を解除.
             material.Unbind(m_pDeviceContext, shader);
@@ -1112,7 +1185,7 @@ void App::DrawModel(bool lightingPass, asdx::BlendType blendType)
             m_pDeviceContext->OMSetDepthStencilState(pDSS, 0);
             m_pDeviceContext->RSSetState(pRS);
 
-            mesh.Draw(m_pDeviceContext);
+            DrawMesh(mesh, lod, lightingPass, !lightingPass);
 
             ID3D11ShaderResourceView* pNullSRV[] = { nullptr };
             ID3D11SamplerState* pNullSmp[] = { nullptr };
@@ -1128,6 +1201,42 @@ void App::DrawModel(bool lightingPass, asdx::BlendType blendType)
     }
 }
 
+//-----------------------------------------------------------------------------
+//      メッシュに合わせた頂点シェーダを設定して描画します.
+//-----------------------------------------------------------------------------
+void App::DrawMesh(const EditorMesh& mesh, uint32_t lod, bool lightingPass, bool depthOnly)
+{
+    auto skinning = mesh.HasSkinningData();
+
+    // 量子化された頂点座標は入力レイアウトだけを差し替える.
+    asdx::VertexShader* pVS     = nullptr;
+    ID3D11InputLayout*  pLayout = nullptr;
+    if (lightingPass)
+    {
+        pVS     = (skinning) ? &m_EditorSkinningVS : &m_EditorVS;
+        pLayout = (skinning) ? m_EditorSkinningQuantizedIL.GetPtr() : m_EditorQuantizedIL.GetPtr();
+    }
+    else if (depthOnly)
+    {
+        pVS     = (skinning) ? &m_ShadowDepthSkinningVS : &m_ShadowDepthVS;
+        pLayout = (skinning) ? m_ShadowDepthSkinningQuantizedIL.GetPtr() : m_ShadowDepthQuantizedIL.GetPtr();
+    }
+    else
+    {
+        pVS     = (skinning) ? &m_ShadowSkinningVS : &m_ShadowVS;
+        pLayout = (skinning) ? m_ShadowSkinningQuantizedIL.GetPtr() : m_ShadowQuantizedIL.GetPtr();
+    }
+
+    pVS->Bind(m_pDeviceContext);
+    if (mesh.IsQuantizedPosition())
+    { m_pDeviceContext->IASetInputLayout(pLayout); }
+
+    if (depthOnly)
+    { mesh.DrawDepth(m_pDeviceContext, lod); }
+    else
+    { mesh.Draw(m_pDeviceContext, lod); }
+}
+
 //-----------------------------------------------------------------------------
 //      ガイドを描画します.
 //-----------------------------------------------------------------------------
@@ -131,7 +131,7 @@ void DrawFPS(float fps, uint64_t polygonCount, bool connect)
 //-----------------------------------------------------------------------------
 //      ファイルメニューを表示します.
 //-----------------------------------------------------------------------------
-void DrawFileMenu(WorkSpace* workSpace)
+void DrawFileMenu(WorkSpace* workSpace, const Config* config)
 {
     if (!ImGui::BeginMenu(kTagFile.c_str()))
     { return; }
@@ -144,7 +144,7 @@ void DrawFileMenu(WorkSpace* workSpace)
             if (asdx::OpenFileDlg(kWorkFilter, path, ""))
             {
                 // ワークスペースをロード.
-                workSpace->LoadAsync(path.c_str());
+                workSpace->LoadAsync(path.c_str(), config->Import.GetOption());
             }
         }
 
@@ -319,7 +319,7 @@ void DrawPopupMenu(MenuContext& context)
     { return; }
 
     // ファイルメニュー.
-    DrawFileMenu(context.pWorkSpace);
+    DrawFileMenu(context.pWorkSpace, context.pConfig);
 
     // エクスポートメニュー.
     DrawExportMenu(context);
@@ -452,6 +452,8 @@ void DrawConfigTab(MenuContext& context)
     // モデルプレビュー.
     context.pConfig->ModelPreview.Edit();
 
+    // インポート.
+    context.pConfig->Import.Edit();
 
     // デバッグ.
     context.pConfig->Debug.Edit();
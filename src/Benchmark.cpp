@@ -0,0 +1,116 @@
+﻿//-----------------------------------------------------------------------------
+// File : Benchmark.cpp
+// Desc : Benchmark Helper.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <Benchmark.h>
+#include <OBJLoader.h>
+#include <MotionSampler.h>
+#include <MeshPostProcess.h>
+#include <MeshletCulling.h>
+#include <VertexPacking.h>
+#include <TangentSpace.h>
+#include <cstdio>
+#include <cstring>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kLoopCount = 5;   // 計測回数(最短値を採用).
+
+///////////////////////////////////////////////////////////////////////////////
+// BenchmarkEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct BenchmarkEntry
+{
+    const char*     Option;                                     //!< コマンドラインオプションです.
+    bool            RequirePath;                                //!< ファイルパスが必須かどうか?
+    bool          (*Func)(const char* path, uint32_t loopCount); //!< 計測処理です. path は省略時 nullptr です.
+};
+
+//-----------------------------------------------------------------------------
+//      登録されている計測の一覧.
+//-----------------------------------------------------------------------------
+const BenchmarkEntry kEntries[] = {
+#if ENABLE_OBJ_BENCHMARK
+    // -bench_obj <path> : OBJ解析のスループット.
+    { "-bench_obj", true, [](const char* path, uint32_t loopCount) { return OBJLoader::Benchmark(path, loopCount); } },
+#endif
+#if ENABLE_MOTION_BENCHMARK
+    // -bench_motion : モーションサンプリングのスループット.
+    { "-bench_motion", false, [](const char*, uint32_t loopCount) { return MotionSampler::Benchmark(loopCount); } },
+#endif
+#if ENABLE_MESH_BENCHMARK
+    // -bench_lod : LOD生成の処理時間.
+    { "-bench_lod", false, [](const char*, uint32_t loopCount) { return BenchmarkLod(loopCount); } },
+
+    // -bench_meshlet [path] : メッシュレットのカリング効率.
+    { "-bench_meshlet", false, [](const char* path, uint32_t loopCount) { return BenchmarkMeshlet(path, loopCount); } },
+
+    // -bench_vertex : 頂点圧縮の処理時間とメモリ削減率.
+    { "-bench_vertex", false, [](const char*, uint32_t loopCount) { return BenchmarkVertexPacking(loopCount); } },
+
+    // -bench_tangent : 法線・接線生成の処理時間.
+    { "-bench_tangent", false, [](const char*, uint32_t loopCount) { return BenchmarkTangentSpace(loopCount); } },
+#endif
+    { nullptr, false, nullptr },
+};
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      計測結果を1行出力します.
+//-----------------------------------------------------------------------------
+void LogBenchmark(const char* label, double seconds, double baseline, const char* note)
+{
+    // 値の大きさに合わせて単位を選ぶ.
+    char time[64];
+    if (seconds >= 1.0)
+    { sprintf_s(time, "%.3lf sec", seconds); }
+    else if (seconds >= 1e-3)
+    { sprintf_s(time, "%.3lf ms", seconds * 1e3); }
+    else
+    { sprintf_s(time, "%.3lf us", seconds * 1e6); }
+
+    char speedup[32] = "";
+    if (baseline > 0.0 && seconds > 0.0)
+    { sprintf_s(speedup, " (x%.2lf)", baseline / seconds); }
+
+    ILOGA("    %-10s : %s%s%s%s", label, time, (note != nullptr) ? " " : "", (note != nullptr) ? note : "", speedup);
+}
+
+//-----------------------------------------------------------------------------
+//      コマンドライン引数で指定された計測を実行します.
+//-----------------------------------------------------------------------------
+bool RunBenchmark(int argc, char** argv, int& exitCode)
+{
+    if (argc < 2 || argv == nullptr)
+    { return false; }
+
+    for(auto entry = kEntries; entry->Option != nullptr; ++entry)
+    {
+        if (strcmp(argv[1], entry->Option) != 0)
+        { continue; }
+
+        const char* path = (argc >= 3) ? argv[2] : nullptr;
+        if (entry->RequirePath && path == nullptr)
+        {
+            ELOGA("Error : Invalid Argument. option = %s requires a path.", entry->Option);
+            exitCode = -1;
+            return true;
+        }
+
+        exitCode = entry->Func(path, kLoopCount) ? 0 : -1;
+        return true;
+    }
+
+    return false;
+}
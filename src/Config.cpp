@@ -41,6 +41,17 @@ static const asdx::Localization kTagRotation(u8"回転", u8"Rotation");
 static const asdx::Localization kTagTranslation(u8"平行移動", u8"Transliation");
 static const asdx::Localization kTagAutoTurn(u8"自動回転", u8"Auto Turn");
 static const asdx::Localization kTagAutoTurnSpeed(u8"自動回転速度", u8"Auto Turn Speed");
+static const asdx::Localization kTagImport(u8"インポート", u8"Import");
+static const asdx::Localization kTagDeduplicate(u8"重複頂点の統合", u8"Deduplicate Vertices");
+static const asdx::Localization kTagOptimizeVertexCache(u8"頂点キャッシュ最適化", u8"Optimize Vertex Cache");
+static const asdx::Localization kTagOptimizeOverdraw(u8"オーバードロー最適化", u8"Optimize Overdraw");
+static const asdx::Localization kTagOptimizeVertexFetch(u8"頂点フェッチ最適化", u8"Optimize Vertex Fetch");
+static const asdx::Localization kTagGenerateLod(u8"LOD生成", u8"Generate LOD");
+static const asdx::Localization kTagLodAttributes(u8"属性を考慮した簡略化", u8"Attribute Aware Simplification");
+static const asdx::Localization kTagGenerateMeshlet(u8"メッシュレット生成", u8"Generate Meshlet");
+static const asdx::Localization kTagQuantizePosition(u8"頂点座標の量子化", u8"Quantize Position");
+static const asdx::Localization kTagEnableLod(u8"LOD切り替え", u8"Enable LOD");
+static const asdx::Localization kTagLodThreshold(u8"LOD許容誤差(ピクセル)", u8"LOD Threshold (Pixels)");
 static const asdx::Localization kTagDebug(u8"デバッグ", u8"Debug");
 static const asdx::Localization kTagDrawBone(u8"ボーンの表示", u8"Draw Bone");
 static const asdx::Localization kTagDrawSunLightDir(u8"サンライト方向の表示", u8"Sun Light Direction");
@@ -221,6 +232,8 @@ ModelPreviewSetting::ModelPreviewSetting()
 , Translation       (0.0f, 0.0f, 0.0f)
 , AutoRotation      (false)
 , AutoRotationSpeed (0.0f)
+, EnableLod         (true)
+, LodThreshold      (1.0f)
 { /* DO_NOTHING */ }
 
 //-----------------------------------------------------------------------------
@@ -234,6 +247,8 @@ tinyxml2::XMLElement* ModelPreviewSetting::Serialize(tinyxml2::XMLDocument* doc)
     e->InsertEndChild(asdx::Serialize(doc, "Translation", Translation));
     e->InsertEndChild(asdx::Serialize(doc, "AutoRotation", AutoRotation));
     e->InsertEndChild(asdx::Serialize(doc, "AutoRotationSpeed", AutoRotationSpeed));
+    e->InsertEndChild(asdx::Serialize(doc, "EnableLod", EnableLod));
+    e->InsertEndChild(asdx::Serialize(doc, "LodThreshold", LodThreshold));
     return e;
 }
 
@@ -251,6 +266,8 @@ void ModelPreviewSetting::Deserialize(tinyxml2::XMLElement* element)
     asdx::Deserialize(e, "Translation", Translation);
     asdx::Deserialize(e, "AutoRotation", AutoRotation);
     asdx::Deserialize(e, "AutoRotationSpeed", AutoRotationSpeed);
+    asdx::Deserialize(e, "EnableLod", EnableLod);
+    asdx::Deserialize(e, "LodThreshold", LodThreshold);
 }
 
 //-----------------------------------------------------------------------------
@@ -266,10 +283,102 @@ void ModelPreviewSetting::Edit()
     Translation      .DrawSlider(kTagTranslation.c_str());
     AutoRotation     .DrawCheckbox(kTagAutoTurn.c_str());
     AutoRotationSpeed.DrawSlider(kTagAutoTurnSpeed.c_str());
+    EnableLod        .DrawCheckbox(kTagEnableLod.c_str());
+    LodThreshold     .DrawSlider(kTagLodThreshold.c_str(), 0.1f, 0.1f, 16.0f);
 }
 
 
 
+///////////////////////////////////////////////////////////////////////////////
+// ImportSetting structure
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      コンストラクタです.
+//-----------------------------------------------------------------------------
+ImportSetting::ImportSetting()
+: Deduplicate           (true)
+, OptimizeVertexCache   (true)
+, OptimizeOverdraw      (true)
+, OptimizeVertexFetch   (true)
+, GenerateLod           (true)
+, LodAttributes         (false)
+, GenerateMeshlet       (false)
+, QuantizePosition      (false)
+{ /* DO_NOTHING */ }
+
+//-----------------------------------------------------------------------------
+//      シリアライズします.
+//-----------------------------------------------------------------------------
+tinyxml2::XMLElement* ImportSetting::Serialize(tinyxml2::XMLDocument* doc)
+{
+    auto e = doc->NewElement("ImportSetting");
+    e->InsertEndChild(asdx::Serialize(doc, "Deduplicate", Deduplicate));
+    e->InsertEndChild(asdx::Serialize(doc, "OptimizeVertexCache", OptimizeVertexCache));
+    e->InsertEndChild(asdx::Serialize(doc, "OptimizeOverdraw", OptimizeOverdraw));
+    e->InsertEndChild(asdx::Serialize(doc, "OptimizeVertexFetch", OptimizeVertexFetch));
+    e->InsertEndChild(asdx::Serialize(doc, "GenerateLod", GenerateLod));
+    e->InsertEndChild(asdx::Serialize(doc, "LodAttributes", LodAttributes));
+    e->InsertEndChild(asdx::Serialize(doc, "GenerateMeshlet", GenerateMeshlet));
+    e->InsertEndChild(asdx::Serialize(doc, "QuantizePosition", QuantizePosition));
+    return e;
+}
+
+//-----------------------------------------------------------------------------
+//      デシリアライズします.
+//-----------------------------------------------------------------------------
+void ImportSetting::Deserialize(tinyxml2::XMLElement* element)
+{
+    auto e = element->FirstChildElement("ImportSetting");
+    if (e == nullptr)
+    { return; }
+
+    asdx::Deserialize(e, "Deduplicate", Deduplicate);
+    asdx::Deserialize(e, "OptimizeVertexCache", OptimizeVertexCache);
+    asdx::Deserialize(e, "OptimizeOverdraw", OptimizeOverdraw);
+    asdx::Deserialize(e, "OptimizeVertexFetch", OptimizeVertexFetch);
+    asdx::Deserialize(e, "GenerateLod", GenerateLod);
+    asdx::Deserialize(e, "LodAttributes", LodAttributes);
+    asdx::Deserialize(e, "GenerateMeshlet", GenerateMeshlet);
+    asdx::Deserialize(e, "QuantizePosition", QuantizePosition);
+}
+
+//-----------------------------------------------------------------------------
+//      編集処理を行います.
+//-----------------------------------------------------------------------------
+void ImportSetting::Edit()
+{
+    if (!ImGui::CollapsingHeader(kTagImport.c_str()))
+    { return; }
+
+    Deduplicate         .DrawCheckbox(kTagDeduplicate.c_str());
+    OptimizeVertexCache .DrawCheckbox(kTagOptimizeVertexCache.c_str());
+    OptimizeOverdraw    .DrawCheckbox(kTagOptimizeOverdraw.c_str());
+    OptimizeVertexFetch .DrawCheckbox(kTagOptimizeVertexFetch.c_str());
+    GenerateLod         .DrawCheckbox(kTagGenerateLod.c_str());
+    LodAttributes       .DrawCheckbox(kTagLodAttributes.c_str());
+    GenerateMeshlet     .DrawCheckbox(kTagGenerateMeshlet.c_str());
+    QuantizePosition    .DrawCheckbox(kTagQuantizePosition.c_str());
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュ後処理のオプションを取得します.
+//-----------------------------------------------------------------------------
+MeshPostProcessOption ImportSetting::GetOption() const
+{
+    MeshPostProcessOption result;
+    result.Deduplicate      = Deduplicate.GetValue();
+    result.VertexCache      = OptimizeVertexCache.GetValue();
+    result.Overdraw         = OptimizeOverdraw.GetValue();
+    result.VertexFetch      = OptimizeVertexFetch.GetValue();
+    result.GenerateLod      = GenerateLod.GetValue();
+    result.LodAttributes    = LodAttributes.GetValue();
+    result.GenerateMeshlet  = GenerateMeshlet.GetValue();
+    result.QuantizePosition = QuantizePosition.GetValue();
+    return result;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////////
 // DebugSetting structure
 ///////////////////////////////////////////////////////////////////////////////
@@ -380,6 +489,7 @@ bool Config::Load(const char* path)
     Background.Deserialize(root);
     Camera.Deserialize(root);
     ModelPreview.Deserialize(root);
+    Import.Deserialize(root);
     Debug.Deserialize(root);
 
     return true;
@@ -416,6 +526,7 @@ bool Config::Save(const char* path)
     root->InsertEndChild(Background.Serialize(&doc));
     root->InsertEndChild(Camera.Serialize(&doc));
     root->InsertEndChild(ModelPreview.Serialize(&doc));
+    root->InsertEndChild(Import.Serialize(&doc));
     root->InsertEndChild(Debug.Serialize(&doc));
 
 
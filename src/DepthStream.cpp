@@ -0,0 +1,117 @@
+﻿//-----------------------------------------------------------------------------
+// File : DepthStream.cpp
+// Desc : Position Only Stream For Depth Rendering.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <DepthStream.h>
+#include <meshoptimizer.h>
+#include <cstring>
+
+
+//-----------------------------------------------------------------------------
+//      深度描画用の頂点とインデックスを構築します.
+//-----------------------------------------------------------------------------
+bool BuildDepthStream
+(
+    const asdx::ResMesh&    mesh,
+    const uint32_t*         pIndices,
+    size_t                  indexCount,
+    DepthStream&            result
+)
+{
+    result.VertexRemap.clear();
+    result.Indices    .clear();
+
+    auto vertexCount = mesh.Positions.size();
+    if (vertexCount == 0 || pIndices == nullptr || indexCount == 0 || (indexCount % 3) != 0)
+    { return false; }
+
+    for(size_t i=0; i<indexCount; ++i)
+    {
+        if (pIndices[i] >= vertexCount)
+        { return false; }
+    }
+
+    // スキニングする場合はボーンが異なる頂点を統合しない.
+    std::vector<meshopt_Stream> streams;
+    streams.push_back({ mesh.Positions.data(), sizeof(asdx::Vector3), sizeof(asdx::Vector3) });
+    if (mesh.BoneIndices.size() == vertexCount && mesh.BoneWeights.size() == vertexCount)
+    {
+        streams.push_back({ mesh.BoneIndices.data(), sizeof(asdx::ResBoneIndex), sizeof(asdx::ResBoneIndex) });
+        streams.push_back({ mesh.BoneWeights.data(), sizeof(asdx::Vector4),      sizeof(asdx::Vector4) });
+    }
+
+    std::vector<uint32_t> shadowIndices(indexCount);
+    meshopt_generateShadowIndexBufferMulti(
+        shadowIndices.data(),
+        pIndices,
+        indexCount,
+        vertexCount,
+        streams.data(),
+        streams.size());
+
+    // 参照される頂点だけを参照順に詰める.
+    std::vector<uint32_t> remap(vertexCount);
+    auto count = meshopt_optimizeVertexFetchRemap(remap.data(), shadowIndices.data(), indexCount, vertexCount);
+
+    result.Indices.resize(indexCount);
+    meshopt_remapIndexBuffer(result.Indices.data(), shadowIndices.data(), indexCount, remap.data());
+
+    result.VertexRemap.resize(count);
+    for(size_t i=0; i<vertexCount; ++i)
+    {
+        if (remap[i] != ~0u)
+        { result.VertexRemap[remap[i]] = uint32_t(i); }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      深度描画用の頂点座標を圧縮します.
+//-----------------------------------------------------------------------------
+bool PackDepthVertices
+(
+    const asdx::ResMesh&        mesh,
+    const DepthStream&          stream,
+    const PackedVertexFormat&   format,
+    std::vector<uint8_t>&       data
+)
+{
+    auto count = stream.VertexRemap.size();
+    if (count == 0)
+    { return false; }
+
+    std::vector<asdx::Vector3> positions(count);
+    for(size_t i=0; i<count; ++i)
+    {
+        auto index = stream.VertexRemap[i];
+        if (index >= mesh.Positions.size())
+        { return false; }
+
+        positions[i] = mesh.Positions[index];
+    }
+
+    if (format.QuantizedPosition)
+    {
+        // 通常の描画と同じ範囲で量子化して, 復元用の定数を共有する.
+        data.resize(sizeof(uint16_t) * 4 * count);
+        QuantizePositions(
+            positions.data(),
+            count,
+            format.PositionOffset,
+            format.PositionOffset + format.PositionScale,
+            reinterpret_cast<uint16_t*>(data.data()));
+    }
+    else
+    {
+        data.resize(sizeof(asdx::Vector3) * count);
+        memcpy(data.data(), positions.data(), data.size());
+    }
+
+    return true;
+}
@@ -13,6 +13,7 @@
 #include <asdxLogger.h>
 #include <asdxRenderState.h>
 #include <asdxLocalization.h>
+#include <RenderStateCache.h>
 
 
 namespace {
@@ -67,6 +68,7 @@ static const asdx::Localization kTagDisplaceFace(u8"表示面", u8"Display Face"
 static const asdx::Localization kTagBlendSettings(u8"ブレンド設定", u8"Blend State");
 static const asdx::Localization kTagDepthSettings(u8"深度設定", u8"Depth State");
 static const asdx::Localization kTagInvalidMaterial(u8"無効なマテリアルです", u8"Invalid Material");
+static const asdx::Localization kTagShaderOverride(u8"シェーダの宣言が優先されます", u8"Overridden by shader declaration");
 
 } // namespace 
 
@@ -597,24 +599,32 @@ void EditMaterialView::Deserialize(const char* tag, tinyxml2::XMLElement* elemen
 //-----------------------------------------------------------------------------
 //      描画処理します.
 //-----------------------------------------------------------------------------
-void EditMaterialView::Draw()
+void EditMaterialView::Draw(const PluginMaterial* material)
 {
+    const ImVec4 kOverrideColor(1.0f, 1.0f, 0.0f, 1.0f);
+
     m_ShadowCast.DrawCheckbox(kTagShadowCast.c_str());
     m_ShadowReceive.DrawCheckbox(kTagShadowReceive.c_str());
     m_BlendState.DrawCombo(
             kTagBlendSettings.c_str(),
             _countof(kBlendState),
             kBlendState);
+    if (material != nullptr && material->HasBlendState())
+    { ImGui::TextColored(kOverrideColor, kTagShaderOverride.c_str()); }
 
     m_RasterizerState.DrawCombo(
             kTagDisplaceFace.c_str(),
             _countof(kRasterizerState),
             kRasterizerState);
+    if (material != nullptr && material->HasRasterizerState())
+    { ImGui::TextColored(kOverrideColor, kTagShaderOverride.c_str()); }
 
     m_DepthState.DrawCombo(
             kTagDepthSettings.c_str(),
             _countof(kDepthState),
             kDepthState);
+    if (material != nullptr && material->HasDepthStencilState())
+    { ImGui::TextColored(kOverrideColor, kTagShaderOverride.c_str()); }
 
     for(auto& itr : m_Params)
     { itr.Draw(); }
@@ -901,13 +911,19 @@ const PluginShader* EditorMaterial::Bind(ID3D11DeviceContext* pContext, bool lig
     instance->SetTextures(pContext, shader);
 
     // レンダリングステート設定.
-    auto blendType      = asdx::BlendType(instance->GetBlendState());
-    auto depthType      = asdx::DepthType(instance->GetDepthState());
-    auto rasterizerType = asdx::RasterizerType(instance->GetRasterizerState());
- 
-    auto pBS  = asdx::RenderState::GetInstance().GetBS(blendType);
-    auto pDSS = asdx::RenderState::GetInstance().GetDSS(depthType);
-    auto pRS  = asdx::RenderState::GetInstance().GetRS(rasterizerType);
+    // シェーダ側で宣言されている場合はキャッシュ済みのステートを優先する.
+    // 優先されている項目は編集画面とログで通知している.
+    auto& cache = RenderStateCache::Instance();
+    auto pBS  = cache.GetBS (material->m_BlendState);
+    auto pDSS = cache.GetDSS(material->m_DepthStencilState);
+    auto pRS  = cache.GetRS (material->m_RasterizerState);
+
+    if (pBS == nullptr)
+    { pBS = asdx::RenderState::GetInstance().GetBS(asdx::BlendType(instance->GetBlendState())); }
+    if (pDSS == nullptr)
+    { pDSS = asdx::RenderState::GetInstance().GetDSS(asdx::DepthType(instance->GetDepthState())); }
+    if (pRS == nullptr)
+    { pRS = asdx::RenderState::GetInstance().GetRS(asdx::RasterizerType(instance->GetRasterizerState())); }
 
     float blendFactor[] = { 1.0f, 1.0f, 1.0f, 1.0f };
     uint32_t sampleMask = 0xffff;
@@ -974,7 +990,7 @@ void EditorMaterial::Edit(const std::string& filterType)
             // マテリアル編集.
             auto instance = m_EditViews.at(m_SelectedMaterial);
             assert(instance != nullptr);
-            instance->Draw();
+            instance->Draw(material);
         }
         else
         {
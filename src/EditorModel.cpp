@@ -13,25 +13,26 @@
 #include <asdxMisc.h>
 #include <asdxDeviceContext.h>
 #include <OBJLoader.h>
-#include <FBXLoader.h>
+#include <FBXReader.h>
 #include <GLTFLoader.h>
+#include <ModelCache.h>
+
+#if ENABLE_FBX
+#include <FBXLoader.h>
+#endif
 
 
 namespace {
 
 ///////////////////////////////////////////////////////////////////////////////
-// Vertex structure
+// DecodeBuffer structure
 ///////////////////////////////////////////////////////////////////////////////
-struct Vertex
+struct DecodeBuffer
 {
-    asdx::Vector3   Position;
-    asdx::Vector3   Normal;
-    asdx::Vector3   Tangent;
-    asdx::Vector4   Color;
-    asdx::Vector2   TexCoord0;
-    asdx::Vector2   TexCoord1;
-    asdx::Vector2   TexCoord2;
-    asdx::Vector2   TexCoord3;
+    asdx::Vector3   PositionScale;
+    float           Padding0;
+    asdx::Vector3   PositionOffset;
+    float           Padding1;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -43,6 +44,35 @@ struct SkinningData
     asdx::Vector4       Weights;
 };
 
+//-----------------------------------------------------------------------------
+//      バウンディングボックスを変換します.
+//-----------------------------------------------------------------------------
+BoundingBox TransformBox(const BoundingBox& box, const asdx::Matrix& matrix)
+{
+    BoundingBox result;
+    for(auto i=0; i<8; ++i)
+    {
+        asdx::Vector3 corner(
+            (i & 0x1) ? box.maxi.x : box.mini.x,
+            (i & 0x2) ? box.maxi.y : box.mini.y,
+            (i & 0x4) ? box.maxi.z : box.mini.z);
+        corner = asdx::Vector3::TransformCoord(corner, matrix);
+
+        if (i == 0)
+        {
+            result.mini = corner;
+            result.maxi = corner;
+        }
+        else
+        {
+            result.mini = asdx::Vector3::Min(result.mini, corner);
+            result.maxi = asdx::Vector3::Max(result.maxi, corner);
+        }
+    }
+
+    return result;
+}
+
 } // namespace
 
 
@@ -67,7 +97,15 @@ EditorMesh::~EditorMesh()
 //-----------------------------------------------------------------------------
 //      初期化処理を行います.
 //-----------------------------------------------------------------------------
-bool EditorMesh::Init(ID3D11Device* pDevice, const asdx::ResMesh& mesh)
+bool EditorMesh::Init
+(
+    ID3D11Device*           pDevice,
+    const asdx::ResMesh&    mesh,
+    const asdx::Matrix*     pInstances,
+    uint32_t                instanceCount,
+    const MeshAuxData*      pAux,
+    bool                    quantizePosition
+)
 {
     if (pDevice == nullptr)
     {
@@ -75,49 +113,64 @@ bool EditorMesh::Init(ID3D11Device* pDevice, const asdx::ResMesh& mesh)
         return false;
     }
 
-    std::vector<Vertex> vertices;
-    vertices.resize(mesh.Positions.size());
-
     m_MeshName      = mesh.MeshName;
     m_MaterialName  = mesh.MaterialName;
 
+    assert(mesh.Positions.empty() == false);
+    assert(mesh.Normals  .empty() == false);
+    assert(mesh.Tangents .empty() == false);
+
     m_Box.maxi = m_Box.mini = mesh.Positions[0];
+    for(const auto& position : mesh.Positions)
+    {
+        m_Box.maxi = asdx::Vector3::Max(m_Box.maxi, position);
+        m_Box.mini = asdx::Vector3::Min(m_Box.mini, position);
+    }
 
-    for(size_t i=0; i<vertices.size(); ++i)
+    // 持っている属性だけを圧縮して格納する.
+    std::vector<uint8_t> vertices;
+    if (!PackVertices(mesh, quantizePosition, m_VertexFormat, vertices))
     {
-        assert(mesh.Positions.empty() == false);
-        assert(mesh.Normals  .empty() == false);
-        assert(mesh.Tangents .empty() == false);
-
-        auto& vertex = vertices[i];
-        vertex.Position     = mesh.Positions[i];
-        vertex.Color        = (mesh.Colors.empty()) ? asdx::Vector4(1.0f, 1.0f, 1.0f, 1.0f) : mesh.Colors[i];
-        vertex.Normal       = mesh.Normals[i];
-        vertex.Tangent      = mesh.Tangents[i];
-        vertex.TexCoord0    = (mesh.TexCoords[0].empty()) ? asdx::Vector2(0.0f, 0.0f) : mesh.TexCoords[0][i];
-        vertex.TexCoord1    = (mesh.TexCoords[1].empty()) ? asdx::Vector2(0.0f, 0.0f) : mesh.TexCoords[1][i];
-        vertex.TexCoord2    = (mesh.TexCoords[2].empty()) ? asdx::Vector2(0.0f, 0.0f) : mesh.TexCoords[2][i];
-        vertex.TexCoord3    = (mesh.TexCoords[3].empty()) ? asdx::Vector2(0.0f, 0.0f) : mesh.TexCoords[3][i];
-
-        m_Box.maxi = asdx::Vector3::Max(m_Box.maxi, vertex.Position);
-        m_Box.mini = asdx::Vector3::Min(m_Box.mini, vertex.Position);
+        ELOG("Error : PackVertices() Failed.");
+        return false;
     }
 
     if (!m_VB.Init(
         pDevice,
-        sizeof(Vertex) * vertices.size(),
-        sizeof(Vertex),
+        vertices.size(),
+        m_VertexFormat.Stride[VERTEX_STREAM_POSITION],
         vertices.data()))
     {
         ELOG("Error : VertexBuffer::Init() Failed.");
         return false;
     }
 
+    {
+        DecodeBuffer decode = {};
+        decode.PositionScale  = m_VertexFormat.PositionScale;
+        decode.PositionOffset = m_VertexFormat.PositionOffset;
+
+        D3D11_BUFFER_DESC desc = {};
+        desc.ByteWidth  = sizeof(DecodeBuffer);
+        desc.Usage      = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags  = D3D11_BIND_CONSTANT_BUFFER;
+
+        D3D11_SUBRESOURCE_DATA res = {};
+        res.pSysMem = &decode;
+
+        auto hr = pDevice->CreateBuffer(&desc, &res, m_DecodeCB.GetAddress());
+        if (FAILED(hr))
+        {
+            ELOGA("Error : ID3D11Device::CreateBuffer() Failed. errcode = 0x%x", hr);
+            return false;
+        }
+    }
+
     m_HasSkinningData = false;
 
+    std::vector<SkinningData> skinningData;
     if (mesh.BoneWeights.size() > 0)
     {
-        std::vector<SkinningData> skinningData;
         skinningData.resize(mesh.BoneWeights.size());
 
         for(size_t i=0; i<mesh.BoneWeights.size(); ++i)
@@ -140,24 +193,110 @@ bool EditorMesh::Init(ID3D11Device* pDevice, const asdx::ResMesh& mesh)
         m_HasSkinningData = true;
     }
 
+    // LOD0の後ろに各LODのインデックスを連結する.
+    m_Lods.clear();
+    m_Lods.push_back(LodRange{ 0, uint32_t(mesh.Indices.size()), 0.0f });
+
+    std::vector<uint32_t> lodIndices;
+    if (pAux != nullptr && !pAux->Lods.empty())
+    {
+        auto total = mesh.Indices.size();
+        for(auto& lod : pAux->Lods)
+        { total += lod.Indices.size(); }
+
+        lodIndices.reserve(total);
+        lodIndices.insert(lodIndices.end(), mesh.Indices.begin(), mesh.Indices.end());
+        for(auto& lod : pAux->Lods)
+        {
+            m_Lods.push_back(LodRange{ uint32_t(lodIndices.size()), uint32_t(lod.Indices.size()), lod.Error });
+            lodIndices.insert(lodIndices.end(), lod.Indices.begin(), lod.Indices.end());
+        }
+    }
+    const auto& indices = (lodIndices.empty()) ? mesh.Indices : lodIndices;
+
+    // 頂点数が収まる場合は16bitインデックスにする.
+    std::vector<uint8_t> packedIndices;
+    auto indexSize = PackIndices(indices.data(), indices.size(), mesh.Positions.size(), packedIndices);
+    m_IndexFormat  = (indexSize == sizeof(uint16_t)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
     if (!m_IB.Init(
         pDevice,
-        sizeof(uint32_t) * mesh.Indices.size(),
-        mesh.Indices.data()))
+        packedIndices.size(),
+        reinterpret_cast<const uint32_t*>(packedIndices.data())))
     {
         ELOG("Error : IndexBuffer::Init() Failed.");
         return false;
     }
-    m_IndexCount = uint32_t(mesh.Indices.size());
 
-    m_InstanceCount = 1;
+    // シャドウ・深度パス用に位置座標のみのストリームを構築する.
+    {
+        DepthStream depth;
+        if (!BuildDepthStream(mesh, indices.data(), indices.size(), depth))
+        {
+            ELOG("Error : BuildDepthStream() Failed.");
+            return false;
+        }
+
+        std::vector<uint8_t> depthVertices;
+        if (!PackDepthVertices(mesh, depth, m_VertexFormat, depthVertices))
+        {
+            ELOG("Error : PackDepthVertices() Failed.");
+            return false;
+        }
+
+        if (!m_DepthVB.Init(
+            pDevice,
+            depthVertices.size(),
+            m_VertexFormat.Stride[VERTEX_STREAM_POSITION],
+            depthVertices.data()))
+        {
+            ELOG("Error : VertexBuffer::Init() Failed.");
+            return false;
+        }
+
+        indexSize = PackIndices(depth.Indices.data(), depth.Indices.size(), depth.VertexRemap.size(), packedIndices);
+        m_DepthIndexFormat = (indexSize == sizeof(uint16_t)) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+
+        if (!m_DepthIB.Init(
+            pDevice,
+            packedIndices.size(),
+            reinterpret_cast<const uint32_t*>(packedIndices.data())))
+        {
+            ELOG("Error : IndexBuffer::Init() Failed.");
+            return false;
+        }
+
+        if (m_HasSkinningData)
+        {
+            std::vector<SkinningData> depthSkinning(depth.VertexRemap.size());
+            for(size_t i=0; i<depth.VertexRemap.size(); ++i)
+            { depthSkinning[i] = skinningData[depth.VertexRemap[i]]; }
+
+            if (!m_DepthSkinVB.Init(
+                pDevice,
+                sizeof(SkinningData) * depthSkinning.size(),
+                sizeof(SkinningData),
+                depthSkinning.data()))
+            {
+                ELOG("Error : VertexBuffer::Init() Failed.");
+                return false;
+            }
+        }
+    }
+
+    if (pInstances == nullptr)
+    { instanceCount = 0; }
+
+    m_InstanceCount = (instanceCount > 0) ? instanceCount : 1;
     {
-        // 単位行列で初期化.
-        for(auto i=0u; i<kMaxInstanceCount; ++i)
-        { m_InstanceMatrix[i] = asdx::Matrix::CreateIdentity(); }
+        // 単位行列で初期化し, インポートしたインスタンス行列を設定.
+        auto capacity = (instanceCount > kMaxInstanceCount) ? instanceCount : kMaxInstanceCount;
+        m_InstanceMatrix.resize(capacity);
+        for(auto i=0u; i<capacity; ++i)
+        { m_InstanceMatrix[i] = (i < instanceCount) ? pInstances[i] : asdx::Matrix::CreateIdentity(); }
 
         D3D11_BUFFER_DESC desc = {};
-        desc.ByteWidth              = sizeof(asdx::Matrix) * kMaxInstanceCount;
+        desc.ByteWidth              = sizeof(asdx::Matrix) * capacity;
         desc.Usage                  = D3D11_USAGE_DYNAMIC;
         desc.BindFlags              = D3D11_BIND_SHADER_RESOURCE;
         desc.CPUAccessFlags         = D3D11_CPU_ACCESS_WRITE;
@@ -165,8 +304,8 @@ bool EditorMesh::Init(ID3D11Device* pDevice, const asdx::ResMesh& mesh)
         desc.StructureByteStride    = sizeof(asdx::Matrix);
 
         D3D11_SUBRESOURCE_DATA res = {};
-        res.pSysMem             = reinterpret_cast<const void*>(m_InstanceMatrix);
-        res.SysMemPitch         = sizeof(asdx::Matrix) * kMaxInstanceCount;
+        res.pSysMem             = reinterpret_cast<const void*>(m_InstanceMatrix.data());
+        res.SysMemPitch         = sizeof(asdx::Matrix) * capacity;
         res.SysMemSlicePitch    = res.SysMemSlicePitch;
 
         auto hr = pDevice->CreateBuffer(&desc, &res, m_InstanceMatrixResource.GetAddress()); 
@@ -180,7 +319,7 @@ bool EditorMesh::Init(ID3D11Device* pDevice, const asdx::ResMesh& mesh)
         srvDesc.Format              = DXGI_FORMAT_UNKNOWN;
         srvDesc.ViewDimension       = D3D11_SRV_DIMENSION_BUFFER;
         srvDesc.Buffer.FirstElement = 0;
-        srvDesc.Buffer.NumElements  = kMaxInstanceCount;
+        srvDesc.Buffer.NumElements  = capacity;
 
         hr = pDevice->CreateShaderResourceView(
             m_InstanceMatrixResource.GetPtr(), &srvDesc, m_InstanceMatrixSRV.GetAddress());
@@ -202,14 +341,22 @@ void EditorMesh::Term()
     m_MeshName      .clear();
     m_MaterialName  .clear();
 
-    m_IndexCount        = 0;
+    m_Lods.clear();
     m_HasSkinningData   = false;
 
     m_IB    .Term();
     m_VB    .Term();
     m_SkinVB.Term();
+    m_DepthIB     .Term();
+    m_DepthVB     .Term();
+    m_DepthSkinVB .Term();
+    m_IndexFormat       = DXGI_FORMAT_R32_UINT;
+    m_DepthIndexFormat  = DXGI_FORMAT_R32_UINT;
+    m_DecodeCB.Reset();
+    m_VertexFormat = PackedVertexFormat();
 
     m_InstanceCount = 0;
+    m_InstanceMatrix.clear();
     m_InstanceMatrixResource.Reset();
     m_InstanceMatrixSRV.Reset();
 
@@ -231,16 +378,27 @@ const std::string& EditorMesh::GetMaterialName() const
 //-----------------------------------------------------------------------------
 //      描画処理を行います.
 //-----------------------------------------------------------------------------
-void EditorMesh::Draw(ID3D11DeviceContext* pContext) const
+void EditorMesh::Draw(ID3D11DeviceContext* pContext, uint32_t lod) const
 {
-    auto pVB0    = m_VB.GetBuffer();
-    auto stride0 = m_VB.GetStride();
-    auto offset0 = 0u;
-    auto pSRV    = m_InstanceMatrixSRV.GetPtr();
+    if (m_Lods.empty())
+    { return; }
+
+    if (lod >= m_Lods.size())
+    { lod = uint32_t(m_Lods.size() - 1); }
+
+
+    // 1つのバッファをストリームごとのオフセットで各スロットに設定する.
+    ID3D11Buffer* pVBs[VERTEX_STREAM_COUNT];
+    for(auto i=0; i<VERTEX_STREAM_COUNT; ++i)
+    { pVBs[i] = m_VB.GetBuffer(); }
+
+    auto pSRV = m_InstanceMatrixSRV.GetPtr();
+    auto pCB  = m_DecodeCB.GetPtr();
 
-    pContext->IASetVertexBuffers(0, 1, &pVB0, &stride0, &offset0);
+    pContext->IASetVertexBuffers(0, VERTEX_STREAM_COUNT, pVBs, m_VertexFormat.Stride, m_VertexFormat.Offset);
     pContext->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     pContext->VSSetShaderResources(1, 1, &pSRV);
+    pContext->VSSetConstantBuffers(3, 1, &pCB);
 
     if (m_HasSkinningData)
     {
@@ -248,11 +406,51 @@ void EditorMesh::Draw(ID3D11DeviceContext* pContext) const
         auto stride1 = m_SkinVB.GetStride();
         auto offset1 = 0u;
 
+        pContext->IASetVertexBuffers(VERTEX_STREAM_COUNT, 1, &pVB1, &stride1, &offset1);
+    }
+
+    pContext->IASetIndexBuffer(m_IB.GetBuffer(), m_IndexFormat, 0);
+    pContext->DrawIndexedInstanced(m_Lods[lod].IndexCount, m_InstanceCount, m_Lods[lod].IndexOffset, 0, 0);
+
+    ID3D11ShaderResourceView* pNullSRV[] = { nullptr };
+    pContext->VSSetShaderResources(1, 1, pNullSRV);
+}
+
+//-----------------------------------------------------------------------------
+//      位置座標のみのストリームで深度描画を行います.
+//-----------------------------------------------------------------------------
+void EditorMesh::DrawDepth(ID3D11DeviceContext* pContext, uint32_t lod) const
+{
+    if (m_Lods.empty())
+    { return; }
+
+    if (lod >= m_Lods.size())
+    { lod = uint32_t(m_Lods.size() - 1); }
+
+    auto pVB    = m_DepthVB.GetBuffer();
+    auto stride = m_DepthVB.GetStride();
+    auto offset = 0u;
+
+    auto pSRV = m_InstanceMatrixSRV.GetPtr();
+    auto pCB  = m_DecodeCB.GetPtr();
+
+    pContext->IASetVertexBuffers(0, 1, &pVB, &stride, &offset);
+    pContext->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    pContext->VSSetShaderResources(1, 1, &pSRV);
+    pContext->VSSetConstantBuffers(3, 1, &pCB);
+
+    if (m_HasSkinningData)
+    {
+        auto pVB1    = m_DepthSkinVB.GetBuffer();
+        auto stride1 = m_DepthSkinVB.GetStride();
+        auto offset1 = 0u;
+
         pContext->IASetVertexBuffers(1, 1, &pVB1, &stride1, &offset1);
     }
 
-    pContext->IASetIndexBuffer(m_IB.GetBuffer(), DXGI_FORMAT_R32_UINT, 0);
-    pContext->DrawIndexedInstanced(m_IndexCount, m_InstanceCount, 0, 0, 0);
+    // 三角形の並びは共通なので, LODの範囲はそのまま使える.
+    pContext->IASetIndexBuffer(m_DepthIB.GetBuffer(), m_DepthIndexFormat, 0);
+    pContext->DrawIndexedInstanced(m_Lods[lod].IndexCount, m_InstanceCount, m_Lods[lod].IndexOffset, 0, 0);
 
     ID3D11ShaderResourceView* pNullSRV[] = { nullptr };
     pContext->VSSetShaderResources(1, 1, pNullSRV);
@@ -264,6 +462,12 @@ void EditorMesh::Draw(ID3D11DeviceContext* pContext) const
 bool EditorMesh::HasSkinningData() const
 { return m_HasSkinningData; }
 
+//-----------------------------------------------------------------------------
+//      頂点座標が量子化されているかどうか?
+//-----------------------------------------------------------------------------
+bool EditorMesh::IsQuantizedPosition() const
+{ return m_VertexFormat.QuantizedPosition; }
+
 //-----------------------------------------------------------------------------
 //      バウンディングボックスを取得します.
 //-----------------------------------------------------------------------------
@@ -273,15 +477,78 @@ const BoundingBox& EditorMesh::GetBox() const
 //-----------------------------------------------------------------------------
 //      ポリゴン数を取得します.
 //-----------------------------------------------------------------------------
-uint32_t EditorMesh::GetPolygonCount() const
-{ return m_IndexCount / 3; }
+uint32_t EditorMesh::GetPolygonCount(uint32_t lod) const
+{ return (lod < m_Lods.size()) ? m_Lods[lod].IndexCount / 3 : 0; }
+
+//-----------------------------------------------------------------------------
+//      LOD数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t EditorMesh::GetLodCount() const
+{ return uint32_t(m_Lods.size()); }
+
+//-----------------------------------------------------------------------------
+//      LODの誤差を取得します.
+//-----------------------------------------------------------------------------
+float EditorMesh::GetLodError(uint32_t lod) const
+{ return (lod < m_Lods.size()) ? m_Lods[lod].Error : 0.0f; }
+
+//-----------------------------------------------------------------------------
+//      画面上の大きさからLODを選択します.
+//-----------------------------------------------------------------------------
+uint32_t EditorMesh::SelectLod
+(
+    const asdx::Matrix&     world,
+    const asdx::Vector3&    cameraPos,
+    float                   projScale,
+    float                   threshold
+) const
+{
+    if (m_Lods.size() <= 1)
+    { return 0; }
+
+    auto center = (m_Box.mini + m_Box.maxi) * 0.5f;
+    auto radius = (m_Box.maxi - m_Box.mini).Length() * 0.5f;
+
+    // 最も近いインスタンスでの1単位あたりのピクセル数を求める.
+    auto pixelsPerUnit = 0.0f;
+    for(auto i=0u; i<m_InstanceCount; ++i)
+    {
+        auto matrix = m_InstanceMatrix[i] * world;
+
+        // 誤差は等方的に扱うので最大の拡大率を使う.
+        auto sx = asdx::Vector3(matrix._11, matrix._12, matrix._13).Length();
+        auto sy = asdx::Vector3(matrix._21, matrix._22, matrix._23).Length();
+        auto sz = asdx::Vector3(matrix._31, matrix._32, matrix._33).Length();
+        auto scale = (sx > sy) ? ((sx > sz) ? sx : sz) : ((sy > sz) ? sy : sz);
+
+        auto position = asdx::Vector3::TransformCoord(center, matrix);
+        auto distance = (position - cameraPos).Length() - radius * scale;
+
+        // バウンディング球の内側にカメラがある場合は最も詳細なLODを使う.
+        if (distance <= 0.0f)
+        { return 0; }
+
+        auto value = projScale * scale / distance;
+        if (value > pixelsPerUnit)
+        { pixelsPerUnit = value; }
+    }
+
+    // 誤差が許容範囲に収まる最も粗いLODを選ぶ.
+    for(auto lod = uint32_t(m_Lods.size() - 1); lod > 0; --lod)
+    {
+        if (m_Lods[lod].Error * pixelsPerUnit <= threshold)
+        { return lod; }
+    }
+
+    return 0;
+}
 
 //-----------------------------------------------------------------------------
 //      インスタンス数を設定します.
 //-----------------------------------------------------------------------------
 void EditorMesh::SetInstanceCount(uint32_t count)
 {
-    if (count == 0 || count > kMaxInstanceCount)
+    if (count == 0 || count > m_InstanceMatrix.size())
     { return; }
 
     m_InstanceCount = count;
@@ -298,7 +565,7 @@ uint32_t EditorMesh::GetInstanceCount() const
 //-----------------------------------------------------------------------------
 const asdx::Matrix& EditorMesh::GetInstanceMatrix(uint32_t index) const
 {
-    assert(index < kMaxInstanceCount);
+    assert(index < m_InstanceMatrix.size());
     return m_InstanceMatrix[index];
 }
 
@@ -307,7 +574,7 @@ const asdx::Matrix& EditorMesh::GetInstanceMatrix(uint32_t index) const
 //-----------------------------------------------------------------------------
 void EditorMesh::SetInstanceMatrix(uint32_t index, const asdx::Matrix& matrix)
 {
-    assert(index < kMaxInstanceCount);
+    assert(index < m_InstanceMatrix.size());
     m_InstanceMatrix[index] = matrix;
 }
 
@@ -348,12 +615,131 @@ EditorModel::~EditorModel()
 //-----------------------------------------------------------------------------
 //      初期化処理を行います.
 //-----------------------------------------------------------------------------
-bool EditorModel::Init(const char* path)
+bool EditorModel::Init
+(
+    const char*                     path,
+    const MeshPostProcessOption&    option,
+    const char*                     cacheDir
+)
 {
-    auto ext = asdx::GetExtA(path);
     auto pDevice = asdx::DeviceContext::Instance().GetDevice();
 
     asdx::Dispose(m_Resource);
+    m_AuxData.clear();
+
+    // メッシュごとのインスタンス行列(空の場合は単位行列).
+    std::vector<std::vector<asdx::Matrix>> instances;
+
+    // キャッシュが有効であればインポートを省略する.
+    std::string cachePath;
+    if (cacheDir != nullptr)
+    { cachePath = ModelCache::GetPath(cacheDir, path); }
+
+    auto optionHash = option.GetHash();
+    if (!cachePath.empty() && ModelCache::Load(cachePath.c_str(), path, optionHash, m_Resource, instances, m_AuxData))
+    { ILOGA("Info : Model Cache Hit. path = %s", cachePath.c_str()); }
+    else
+    {
+        asdx::Dispose(m_Resource);
+        instances.clear();
+        m_AuxData.clear();
+
+        if (!Import(path, instances))
+        { return false; }
+
+        // GPUに渡す前にインデックス化と並べ替えを行う.
+        std::vector<MeshPostProcessStats> stats;
+        if (!PostProcessModel(m_Resource, option, &m_AuxData, &stats))
+        { WLOGA("Warning : Mesh Post Process Skipped For Invalid Mesh. path = %s", path); }
+
+        size_t vertexBefore = 0;
+        size_t vertexAfter  = 0;
+        double acmrBefore   = 0.0;
+        double acmrAfter    = 0.0;
+        double atvrBefore   = 0.0;
+        double atvrAfter    = 0.0;
+        size_t triangles    = 0;
+        size_t lods         = 0;
+        for(auto& item : stats)
+        {
+            // ACMR は三角形数, ATVR は頂点数で重み付けして集計する.
+            auto count = item.IndexCount / 3;
+            vertexBefore += item.VertexCountBefore;
+            vertexAfter  += item.VertexCountAfter;
+            acmrBefore   += double(item.AcmrBefore) * count;
+            acmrAfter    += double(item.AcmrAfter)  * count;
+            atvrBefore   += double(item.AtvrBefore) * item.VertexCountBefore;
+            atvrAfter    += double(item.AtvrAfter)  * item.VertexCountAfter;
+            triangles    += count;
+            lods         += item.LodCount;
+        }
+
+        if (triangles > 0)
+        {
+            ILOGA("Info : Mesh Post Process. vertex %zu -> %zu, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, LOD %zu",
+                vertexBefore, vertexAfter,
+                acmrBefore / triangles, acmrAfter / triangles,
+                (vertexBefore > 0) ? atvrBefore / vertexBefore : 0.0,
+                (vertexAfter  > 0) ? atvrAfter  / vertexAfter  : 0.0,
+                lods);
+        }
+
+        if (!cachePath.empty() && !ModelCache::Save(cachePath.c_str(), path, optionHash, m_Resource, instances, m_AuxData))
+        { WLOGA("Warning : Model Cache Save Failed. path = %s", cachePath.c_str()); }
+    }
+
+    m_Meshes.resize(m_Resource.Meshes.size());
+
+    auto first = true;
+    for(size_t i=0; i<m_Resource.Meshes.size(); ++i)
+    {
+        const asdx::Matrix* pInstances    = nullptr;
+        uint32_t            instanceCount = 0;
+        if (i < instances.size() && !instances[i].empty())
+        {
+            pInstances    = instances[i].data();
+            instanceCount = uint32_t(instances[i].size());
+        }
+
+        auto pAux = (i < m_AuxData.size()) ? &m_AuxData[i] : nullptr;
+        if (!m_Meshes[i].Init(pDevice, m_Resource.Meshes[i], pInstances, instanceCount, pAux, option.QuantizePosition))
+        {
+            ELOG("Error : EditorMesh::Init() Failed.");
+            return false;
+        }
+
+        // メッシュのボックスはローカル空間なので, インスタンスごとに変換して統合する.
+        for(auto j=0u; j<m_Meshes[i].GetInstanceCount(); ++j)
+        {
+            auto box = TransformBox(m_Meshes[i].GetBox(), m_Meshes[i].GetInstanceMatrix(j));
+            if (first)
+            {
+                m_Box = box;
+                first = false;
+            }
+            else
+            {
+                m_Box.mini = asdx::Vector3::Min(m_Box.mini, box.mini);
+                m_Box.maxi = asdx::Vector3::Max(m_Box.maxi, box.maxi);
+            }
+        }
+    }
+
+    m_Path        = path;
+    m_Scale       = asdx::Vector3(1.0f, 1.0f, 1.0f);
+    m_Rotation    = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    m_Translation = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    m_World       = asdx::Matrix::CreateIdentity();
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      モデルファイルをインポートします.
+//-----------------------------------------------------------------------------
+bool EditorModel::Import(const char* path, std::vector<std::vector<asdx::Matrix>>& instances)
+{
+    auto ext = asdx::GetExtA(path);
 
     // OBJファイル.
     if (_stricmp(ext.c_str(), "obj") == 0)
@@ -368,11 +754,28 @@ bool EditorModel::Init(const char* path)
     // FBXファイル.
     else if (_stricmp(ext.c_str(), "fbx") == 0)
     {
-        FBXLoader loader;
-        if (!loader.Load(path, m_Resource))
+        // バイナリ形式はSDKを介さずに読み込む.
+        FBXReader reader;
+        if (reader.Load(path, m_Resource))
+        { instances = reader.GetInstances(); }
+        else
         {
-            ELOGA("Error : FBXLoader::Load() Failed. path = %s", path);
+        #if ENABLE_FBX
+            // ASCII形式などは FBX SDK にフォールバック.
+            asdx::Dispose(m_Resource);
+
+            FBXLoader loader;
+            if (!loader.Load(path, m_Resource))
+            {
+                ELOGA("Error : FBXLoader::Load() Failed. path = %s", path);
+                return false;
+            }
+
+            instances = loader.GetInstances();
+        #else
+            ELOGA("Error : FBXReader::Load() Failed. path = %s", path);
             return false;
+        #endif
         }
     }
     // GLTFファイル.
@@ -384,6 +787,8 @@ bool EditorModel::Init(const char* path)
             ELOGA("Error : GLTFLoader::Load() Failed. path = %s", path);
             return false;
         }
+
+        instances = loader.GetInstances();
     }
     else
     {
@@ -392,34 +797,6 @@ bool EditorModel::Init(const char* path)
         return false;
     }
 
-
-    m_Meshes.resize(m_Resource.Meshes.size());
-
-    for(size_t i=0; i<m_Resource.Meshes.size(); ++i)
-    {
-        if (!m_Meshes[i].Init(pDevice, m_Resource.Meshes[i]))
-        {
-            ELOG("Error : EditorMesh::Init() Failed.");
-            return false;
-        }
-
-        if (i == 0)
-        {
-            m_Box = m_Meshes[i].GetBox();
-        }
-        else
-        {
-            m_Box.mini = asdx::Vector3::Min(m_Box.mini, m_Meshes[i].GetBox().mini);
-            m_Box.maxi = asdx::Vector3::Max(m_Box.maxi, m_Meshes[i].GetBox().maxi);
-        }
-    }
-
-    m_Path        = path;
-    m_Scale       = asdx::Vector3(1.0f, 1.0f, 1.0f);
-    m_Rotation    = asdx::Vector3(0.0f, 0.0f, 0.0f);
-    m_Translation = asdx::Vector3(0.0f, 0.0f, 0.0f);
-    m_World       = asdx::Matrix::CreateIdentity();
-
     return true;
 }
 
@@ -433,6 +810,7 @@ void EditorModel::Term()
 
     m_Meshes.clear();
     asdx::Dispose(m_Resource);
+    m_AuxData.clear();
 
     m_Scale       = asdx::Vector3(1.0f, 1.0f, 1.0f);
     m_Rotation    = asdx::Vector3(0.0f, 0.0f, 0.0f);
@@ -551,3 +929,9 @@ uint64_t EditorModel::CalcPolygonCount() const
 //-----------------------------------------------------------------------------
 const asdx::ResModel& EditorModel::GetResource() const
 { return m_Resource; }
+
+//-----------------------------------------------------------------------------
+//      メッシュごとの派生データを取得します.
+//-----------------------------------------------------------------------------
+const std::vector<MeshAuxData>& EditorModel::GetAuxData() const
+{ return m_AuxData; }
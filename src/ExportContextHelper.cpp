@@ -8,6 +8,46 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <ExportContextHelper.h>
+#include <meshoptimizer.h>
+#include <cstring>
+#include <vector>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      位置座標をインスタンス行列で変換した複製を生成します.
+//-----------------------------------------------------------------------------
+const Vec3* TransformPositions(const std::vector<asdx::Vector3>& src, const asdx::Matrix& matrix)
+{
+    auto dst = new Vec3[src.size()];
+    for(size_t i=0; i<src.size(); ++i)
+    {
+        auto p = asdx::Vector3::TransformCoord(src[i], matrix);
+        dst[i] = Vec3{ p.x, p.y, p.z };
+    }
+    return dst;
+}
+
+//-----------------------------------------------------------------------------
+//      方向ベクトルを行列で変換し, 正規化した複製を生成します.
+//-----------------------------------------------------------------------------
+const Vec3* TransformDirections(const std::vector<asdx::Vector3>& src, const asdx::Matrix& matrix)
+{
+    if (src.empty())
+    { return nullptr; }
+
+    auto dst = new Vec3[src.size()];
+    for(size_t i=0; i<src.size(); ++i)
+    {
+        auto v = asdx::Vector3::SafeNormalize(
+            asdx::Vector3::TransformNormal(src[i], matrix), src[i]);
+        dst[i] = Vec3{ v.x, v.y, v.z };
+    }
+    return dst;
+}
+
+} // namespace
 
 
 //-----------------------------------------------------------------------------
@@ -36,64 +76,95 @@ bool Create(const WorkSpace& workSpace, ExportContext** context)
 
     // メッシュ生成.
     {
-        auto count = workSpace.GetModel()->GetMeshCount();
+        auto pModel = workSpace.GetModel();
+        auto& srcModel = pModel->GetResource();
 
-        ctx->MeshCount = count;
-        ctx->Meshes    = new ExportMesh[count];
+        // メッシュはローカル座標で保持しているので, インスタンスごとにワールド座標へ変換した複製を出力する.
+        uint32_t count = 0;
+        for(auto i=0u; i<pModel->GetMeshCount(); ++i)
+        { count += pModel->GetMesh(i).GetInstanceCount(); }
 
-        auto& srcModel = workSpace.GetModel()->GetResource();
+        ctx->MeshCount = count;
+        ctx->Meshes      = new ExportMesh[count]();
+        ctx->MeshIndices = new ExportMeshIndex[count]();
 
-        for(size_t i=0; i<count; ++i)
+        auto index = 0u;
+        for(auto i=0u; i<pModel->GetMeshCount(); ++i)
         {
-            auto& src = srcModel.Meshes[i];
-            auto& dst = ctx->Meshes[i];
-            dst.VertexCount = uint32_t(src.Positions.size());
-
-            dst.Positions   = reinterpret_cast<const Vec3*>(src.Positions.data());
-            dst.Normals     = reinterpret_cast<const Vec3*>(src.Normals  .data());
-
-            if (src.Tangents.empty())
-            { dst.Tangents = nullptr; }
-            else
-            { dst.Tangents = reinterpret_cast<const Vec3*>(src.Tangents.data()); }
-
-            if (src.Colors.empty())
-            { dst.Colors = nullptr; }
-            else
-            { dst.Colors = reinterpret_cast<const Vec4*>(src.Colors.data()); }
-
-            if (src.TexCoords[0].empty())
-            { dst.TexCoord0 = nullptr; }
-            else
-            { dst.TexCoord0 = reinterpret_cast<const Vec2*>(src.TexCoords[0].data()); }
-
-            if (src.TexCoords[1].empty())
-            { dst.TexCoord1 = nullptr; }
-            else
-            { dst.TexCoord1 = reinterpret_cast<const Vec2*>(src.TexCoords[1].data()); }
-
-            if (src.TexCoords[2].empty())
-            { dst.TexCoord2 = nullptr; }
-            else
-            { dst.TexCoord2 = reinterpret_cast<const Vec2*>(src.TexCoords[2].data()); }
-
-            if (src.TexCoords[3].empty())
-            { dst.TexCoord3 = nullptr; }
-            else
-            { dst.TexCoord3 = reinterpret_cast<const Vec2*>(src.TexCoords[3].data()); }
-
-            if (src.BoneIndices.empty())
-            { dst.BoneIndices = nullptr; }
-            else
-            { dst.BoneIndices = reinterpret_cast<const Vec4s*>(src.BoneIndices.data()); }
-
-            if (src.BoneWeights.empty())
-            { dst.BoneWeights = nullptr; }
-            else
-            { dst.BoneWeights = reinterpret_cast<const Vec4*>(src.BoneWeights.data()); }
-
-            dst.IndexCount  = uint32_t(src.Indices.size());
-            dst.Indices     = src.Indices.data();
+            auto& mesh = pModel->GetMesh(i);
+            for(auto j=0u; j<mesh.GetInstanceCount(); ++j, ++index)
+            {
+                const auto& matrix = mesh.GetInstanceMatrix(j);
+                auto& src = srcModel.Meshes[i];
+                auto& dst = ctx->Meshes[index];
+                auto& idx = ctx->MeshIndices[index];
+                dst.VertexCount = uint32_t(src.Positions.size());
+
+                // 法線は逆転置行列, 接線は行列そのもので変換する.
+                dst.Positions   = TransformPositions (src.Positions, matrix);
+                dst.Normals     = TransformDirections(src.Normals,   asdx::Matrix::Transpose(asdx::Matrix::Invert(matrix)));
+                dst.Tangents    = TransformDirections(src.Tangents,  matrix);
+
+                if (src.Colors.empty())
+                { dst.Colors = nullptr; }
+                else
+                { dst.Colors = reinterpret_cast<const Vec4*>(src.Colors.data()); }
+
+                if (src.TexCoords[0].empty())
+                { dst.TexCoord0 = nullptr; }
+                else
+                { dst.TexCoord0 = reinterpret_cast<const Vec2*>(src.TexCoords[0].data()); }
+
+                if (src.TexCoords[1].empty())
+                { dst.TexCoord1 = nullptr; }
+                else
+                { dst.TexCoord1 = reinterpret_cast<const Vec2*>(src.TexCoords[1].data()); }
+
+                if (src.TexCoords[2].empty())
+                { dst.TexCoord2 = nullptr; }
+                else
+                { dst.TexCoord2 = reinterpret_cast<const Vec2*>(src.TexCoords[2].data()); }
+
+                if (src.TexCoords[3].empty())
+                { dst.TexCoord3 = nullptr; }
+                else
+                { dst.TexCoord3 = reinterpret_cast<const Vec2*>(src.TexCoords[3].data()); }
+
+                if (src.BoneIndices.empty())
+                { dst.BoneIndices = nullptr; }
+                else
+                { dst.BoneIndices = reinterpret_cast<const Vec4s*>(src.BoneIndices.data()); }
+
+                if (src.BoneWeights.empty())
+                { dst.BoneWeights = nullptr; }
+                else
+                { dst.BoneWeights = reinterpret_cast<const Vec4*>(src.BoneWeights.data()); }
+
+                dst.IndexCount  = uint32_t(src.Indices.size());
+                dst.Indices     = src.Indices.data();
+
+                // 出力側でそのまま書き出せるよう, 16bit化と圧縮を済ませておく.
+                if (!src.Indices.empty() && src.Positions.size() <= 0x10000)
+                {
+                    auto indices16 = new uint16_t[src.Indices.size()];
+                    for(size_t k=0; k<src.Indices.size(); ++k)
+                    { indices16[k] = uint16_t(src.Indices[k]); }
+                    idx.Indices16 = indices16;
+                }
+
+                if (!src.Indices.empty() && src.Indices.size() % 3 == 0)
+                {
+                    std::vector<uint8_t> encoded(meshopt_encodeIndexBufferBound(src.Indices.size(), src.Positions.size()));
+                    auto size = meshopt_encodeIndexBuffer(encoded.data(), encoded.size(), src.Indices.data(), src.Indices.size());
+                    if (size > 0)
+                    {
+                        auto pEncoded = new uint8_t[size];
+                        memcpy(pEncoded, encoded.data(), size);
+                        idx.EncodedIndexSize = uint32_t(size);
+                        idx.EncodedIndices   = pEncoded;
+                    }
+                }
+            }
         }
     }
 
@@ -133,10 +204,30 @@ void Dispose(ExportContext*& context)
 
     if (context->Meshes != nullptr)
     {
+        // 変換済みの頂点データはコンテキストが所有している.
+        for(auto i=0u; i<context->MeshCount; ++i)
+        {
+            delete[] context->Meshes[i].Positions;
+            delete[] context->Meshes[i].Normals;
+            delete[] context->Meshes[i].Tangents;
+        }
+
         delete[] context->Meshes;
         context->Meshes = nullptr;
     }
 
+    if (context->MeshIndices != nullptr)
+    {
+        for(auto i=0u; i<context->MeshCount; ++i)
+        {
+            delete[] context->MeshIndices[i].Indices16;
+            delete[] context->MeshIndices[i].EncodedIndices;
+        }
+
+        delete[] context->MeshIndices;
+        context->MeshIndices = nullptr;
+    }
+
     delete context;
     context = nullptr;
 }
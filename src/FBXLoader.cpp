@@ -7,15 +7,59 @@
 //-------------------------------------------------------------------------------------------------
 // Includes
 //-------------------------------------------------------------------------------------------------
+#if ENABLE_FBX
 #include <FBXLoader.h>
+#include <ParallelFor.h>
+#include <TangentSpace.h>
 #include <asdxLogger.h>
 #include <asdxMisc.h>
 #include <algorithm>
 #include <tuple>
-
-#if ENABLE_FBX
+#include <cstring>
 #include <fbxsdk.h>
-#endif
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ElementFBX structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+struct ElementFBX
+{
+    bool                                Exists  = false;
+    FbxGeometryElement::EMappingMode    MapMode = FbxGeometryElement::eNone;
+    FbxGeometryElement::EReferenceMode  RefMode = FbxGeometryElement::eDirect;
+    std::vector<T>                      Direct;
+    std::vector<int>                    Indices;    // eIndexToDirect ̏ꍇ̂.
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// ClusterFBX structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct ClusterFBX
+{
+    std::vector<int>        Indices;
+    std::vector<double>     Weights;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// MeshSourceFBX structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct MeshSourceFBX
+{
+    std::string                         Name;
+    FbxUInt64                           UniqueID = 0;
+    std::vector<FbxVector4>             ControlPoints;
+    std::vector<int>                    PolygonVertices;    // Op`ς݂Ȃ̂3.
+    ElementFBX<FbxColor>                Colors;
+    ElementFBX<FbxVector4>              Normals;
+    ElementFBX<FbxVector4>              Tangents;
+    ElementFBX<FbxVector2>              TexCoords[MaxLayerCount];
+    int                                 LayerCount = 0;
+    std::vector<std::vector<ClusterFBX>>    Skins;
+    FbxGeometryElement::EMappingMode    MaterialMapMode = FbxGeometryElement::eNone;
+    std::vector<int>                    MaterialIds;        // f̃}eAԍ (Ȃꍇ -1).
+};
+
 
 namespace {
 
@@ -258,6 +302,211 @@ void AddTexture(FbxSurfaceMaterial* pMaterial, const char* propName, std::vector
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// Corner structure
+///////////////////////////////////////////////////////////////////////////////////////////////////
+struct Corner
+{
+    asdx::Vector3   Position;
+    asdx::Vector3   Normal;
+    asdx::Vector4   Tangent;
+    asdx::Vector4   Color;
+    asdx::Vector2   TexCoord[ MaxLayerCount ];
+    int             BoneId[ 4 ];
+    asdx::Vector4   BoneWeight;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexWelder class
+///////////////////////////////////////////////////////////////////////////////////////////////////
+class VertexWelder
+{
+public:
+    //---------------------------------------------------------------------------------------------
+    //! @brief      RXgN^ł.
+    //!
+    //! @param[in]      count       o^钸_̏ł.
+    //---------------------------------------------------------------------------------------------
+    explicit VertexWelder(size_t count)
+    {
+        // `TȂȂ悤ɕח 0.5 ȉɗ}.
+        size_t capacity = 64;
+        while(capacity < count * 2)
+        { capacity <<= 1; }
+
+        m_Table.resize(capacity, UINT32_MAX);
+        m_Mask = capacity - 1;
+        m_Vertices.reserve(count);
+    }
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      _o^܂.
+    //!
+    //! @param[in]      vertex      o^钸_ł.
+    //! @param[out]     added       VKɓo^ꂽꍇ true ݒ肳܂.
+    //! @return     nڌ̒_ԍԋp܂.
+    //---------------------------------------------------------------------------------------------
+    uint32_t Register(const Corner& vertex, bool& added)
+    {
+        auto slot = size_t(CalcHash(vertex)) & m_Mask;
+        for(;;)
+        {
+            auto index = m_Table[slot];
+            if (index == UINT32_MAX)
+            {
+                index = uint32_t(m_Vertices.size());
+                m_Table[slot] = index;
+                m_Vertices.push_back(vertex);
+                added = true;
+                return index;
+            }
+
+            if (memcmp(&m_Vertices[index], &vertex, sizeof(Corner)) == 0)
+            {
+                added = false;
+                return index;
+            }
+
+            slot = (slot + 1) & m_Mask;
+        }
+    }
+
+private:
+    std::vector<uint32_t>   m_Table;
+    std::vector<Corner>     m_Vertices;
+    size_t                  m_Mask;
+
+    //---------------------------------------------------------------------------------------------
+    //! @brief      nbVlvZ܂(FNV-1a, 4oCgP).
+    //---------------------------------------------------------------------------------------------
+    static uint64_t CalcHash(const Corner& vertex)
+    {
+        static_assert(sizeof(Corner) % sizeof(uint32_t) == 0, "Invalid Corner Size.");
+
+        uint32_t words[sizeof(Corner) / sizeof(uint32_t)];
+        memcpy(words, &vertex, sizeof(Corner));
+
+        auto hash = 14695981039346656037ull;
+        for(auto word : words)
+        {
+            hash ^= word;
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+};
+
+//-------------------------------------------------------------------------------------------------
+//      C[Gg̒lRs[܂.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename Element>
+void CopyElement(Element* pElement, ElementFBX<T>& result)
+{
+    if (pElement == nullptr)
+    { return; }
+
+    auto& direct = pElement->GetDirectArray();
+    auto  count  = direct.GetCount();
+    if (count <= 0)
+    { return; }
+
+    result.Exists  = true;
+    result.MapMode = pElement->GetMappingMode();
+    result.RefMode = pElement->GetReferenceMode();
+
+    result.Direct.resize(count);
+    for(auto i=0; i<count; ++i)
+    { result.Direct[i] = direct.GetAt(i); }
+
+    if (result.RefMode == FbxGeometryElement::eIndexToDirect)
+    {
+        auto& indices = pElement->GetIndexArray();
+        result.Indices.resize(indices.GetCount());
+        for(auto i=0; i<indices.GetCount(); ++i)
+        { result.Indices[i] = indices.GetAt(i); }
+    }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      sȃCfbNX̃G[ǉ܂.
+//-------------------------------------------------------------------------------------------------
+void AddIndexError(const MeshSourceFBX& src, const std::string& label, size_t index, std::string& errors)
+{
+    errors += "Invalid Data Index. ";
+    errors += label;
+    errors += " index (";
+    errors += std::to_string(index);
+    errors += "), Mesh name = ";
+    errors += src.Name;
+    errors += ", UniqueID = ";
+    errors += std::to_string(src.UniqueID);
+    errors += "\n";
+}
+
+//-------------------------------------------------------------------------------------------------
+//      ʂ̊pƂɃC[Gg̎QƐ߂܂.
+//-------------------------------------------------------------------------------------------------
+template<typename T, typename Func>
+void ResolveIndices
+(
+    const ElementFBX<T>&        element,
+    const MeshSourceFBX&        src,
+    const std::string&          label,
+    std::vector<Face>&          faces,
+    std::string&                errors,
+    Func                        setIndex
+)
+{
+    auto resolve = [&](size_t i)
+    {
+        auto index = (element.RefMode == FbxGeometryElement::eIndexToDirect)
+            ? ((i < element.Indices.size()) ? element.Indices[i] : -1)
+            : int(i);
+
+        if (index < 0 || size_t(index) >= element.Direct.size())
+        {
+            AddIndexError(src, label, i, errors);
+            index = 0;
+        }
+
+        return uint32_t(index);
+    };
+
+    switch( element.MapMode )
+    {
+    case FbxGeometryElement::eByControlPoint:
+        {
+            std::vector<uint32_t> indices;
+            indices.resize( src.ControlPoints.size() );
+
+            for( size_t i=0; i<indices.size(); ++i )
+            { indices[i] = resolve(i); }
+
+            for( size_t i=0; i<faces.size(); ++i )
+            {
+                for( auto j=0; j<3; ++j )
+                { setIndex(faces[i], j, indices[ faces[i].IndexP[j] ]); }
+            }
+        }
+        break;
+
+    case FbxGeometryElement::eByPolygonVertex:
+        {
+            size_t idx = 0;
+            for( size_t i=0; i<faces.size(); ++i )
+            {
+                for( auto j=0; j<3; ++j )
+                { setIndex(faces[i], j, resolve(idx++)); }
+            }
+        }
+        break;
+
+    default:
+        { /* DO_NOTHING */ }
+        break;
+    }
+}
+
 } // namespace
 
 
@@ -280,7 +529,7 @@ FBXLoader::~FBXLoader()
 //-------------------------------------------------------------------------------------------------
 //      ǂݍݏł.
 //-------------------------------------------------------------------------------------------------
-bool FBXLoader::Load(const char* path, bool skipTriangulate)
+bool FBXLoader::Load(const char* path, bool skipTriangulate, bool parseMotion)
 {
     if (path == nullptr)
     {
@@ -370,7 +619,7 @@ bool FBXLoader::Load(const char* path, bool skipTriangulate)
     }
 
     // Rec.
-    ParseContent();
+    ParseContent(parseMotion);
 
     m_pMgr->Destroy();
     m_pMgr      = nullptr;
@@ -412,13 +661,18 @@ void FBXLoader::Term()
     m_NullNodes.clear();
     m_NullNodes.shrink_to_fit();
 
+    m_MeshMap.clear();
+    m_MaterialMap.clear();
+    m_MeshNodes.clear();
+    m_Instances.clear();
+
     m_FolderPath.clear();
 }
 
 //-------------------------------------------------------------------------------------------------
 //      Rec͂܂
 //-------------------------------------------------------------------------------------------------
-void FBXLoader::ParseContent()
+void FBXLoader::ParseContent(bool parseMotion)
 {
     // [gm[h擾.
     FbxNode* pRootNode = m_pScene->GetRootNode();
@@ -442,15 +696,37 @@ void FBXLoader::ParseContent()
     m_Materials.resize(materialCount);
 
     // }eA.
+    std::unordered_map<std::string, int> nameMap;
     for(auto i=0; i<materialCount; ++i)
     {
         auto mat = m_pScene->GetMaterial(i);
         ParseMaterial(mat, m_Materials[i]);
+
+        // ̃}eA͍ŏɌ̂QƂ.
+        auto itr = nameMap.emplace(m_Materials[i].Name, i).first;
+        m_MaterialMap[mat] = itr->second;
     }
 
     // m[h.
     std::string parent = "";
     ParseNode(pRootNode, parent);
+
+    // bV.
+    ParseMeshes();
+
+    // [V͑S{[~St[̃TvOd̂, vꂽꍇ̂݉͂.
+    if (!parseMotion)
+    { return; }
+
+    // [V.
+    auto stackCount = m_pScene->GetSrcObjectCount<FbxAnimStack>();
+    m_Motions.resize(stackCount);
+    for(auto i=0; i<stackCount; ++i)
+    {
+        auto pStack = m_pScene->GetSrcObject<FbxAnimStack>(i);
+        m_pScene->SetCurrentAnimationStack(pStack);
+        ParseMotion(pStack, m_Motions[i]);
+    }
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -533,14 +809,184 @@ void FBXLoader::ParseMesh(FbxNode* pNode, const std::string& parentNode)
     auto pMesh = pNode->GetMesh();
     assert( pMesh != nullptr );
 
+    // XLȂbV̓[JԂ̂܂ܕێ, bVQƂm[h̓CX^XƂ.
+    auto world   = FromFbxMatrix(pNode->EvaluateGlobalTransform());
+    auto skinned = pMesh->GetDeformerCount(FbxDeformer::eSkin) > 0;
+    if (!skinned)
+    {
+        auto itr = m_MeshMap.find(pMesh);
+        if (itr != m_MeshMap.end())
+        {
+            m_Meshes[itr->second].Instances.push_back(world);
+            return;
+        }
+
+        m_MeshMap[pMesh] = m_Meshes.size();
+    }
+
     ResMeshFBX dst;
     dst.ParentNode = parentNode;
     dst.Name       = pNode->GetInitialName();
 
-    ParseVertex( pMesh, dst );
-    ParseSubset( pMesh, dst );
+    if (!skinned)
+    { dst.Instances.push_back(world); }
+
+    // _f[^͑Sm[h𑖍ɕŉ͂.
+    m_Meshes   .push_back(std::move(dst));
+    m_MeshNodes.push_back(pNode);
+}
+
+//-------------------------------------------------------------------------------------------------
+//      WbV̒_f[^ɉ͂܂.
+//-------------------------------------------------------------------------------------------------
+void FBXLoader::ParseMeshes()
+{
+    // FBX SDK ̓V[̓QƂۏ؂Ȃ, SDK ̌Ăяo̓VOXbhōς܂Ă.
+    std::vector<asdx::Matrix>                   worlds(m_Meshes.size());
+    std::vector<std::vector<size_t>>            groups;
+    std::vector<MeshSourceFBX>                  sources;
+    std::unordered_map<FbxMesh*, size_t>        groupMap;
+    for(size_t i=0; i<m_Meshes.size(); ++i)
+    {
+        auto pNode = m_MeshNodes[i];
+        auto pMesh = pNode->GetMesh();
+
+        // CX^XƂĈbV̓[JԂ̂܂, ȊO̓[hϊĂ.
+        worlds[i] = m_Meshes[i].Instances.empty()
+            ? FromFbxMatrix(pNode->EvaluateGlobalTransform())
+            : asdx::Matrix::CreateIdentity();
+
+        //  FbxMesh QƂXLbV͓^XNŏ.
+        auto itr = groupMap.find(pMesh);
+        if (itr != groupMap.end())
+        {
+            groups[itr->second].push_back(i);
+            continue;
+        }
+
+        // ڐf[^ΐ.
+        if (pMesh->GetElementTangent() == nullptr && pMesh->GetElementUVCount() > 0)
+        {
+            pMesh->GenerateTangentsData(0, true);
+            assert(pMesh->GetElementTangent() != nullptr);
+        }
+
+        groupMap[pMesh] = groups.size();
+        groups.emplace_back();
+        groups.back().push_back(i);
+
+        sources.emplace_back();
+        ExtractMesh(pMesh, sources.back());
+    }
+
+    // G[̓^XNƂɏW߂, ŌɌ̏ԂŘA.
+    std::vector<std::string> errors(m_Meshes.size());
+
+    // ȍ~͎of[^݂̂.
+    ParallelFor(groups.size(), [&](size_t index)
+    {
+        const auto& src = sources[index];
+        for(auto i : groups[index])
+        {
+            ParseVertex( src, worlds[i], m_Meshes[i], errors[i] );
+            ParseSubset( src, m_Meshes[i] );
+        }
+
+        sources[index] = MeshSourceFBX();
+    });
+
+    for(const auto& error : errors)
+    { m_ErrorString += error; }
+}
+
+//-------------------------------------------------------------------------------------------------
+//      bṼf[^ FBX SDK o܂.
+//-------------------------------------------------------------------------------------------------
+void FBXLoader::ExtractMesh(FbxMesh* pSrcMesh, MeshSourceFBX& dst)
+{
+    dst.Name     = pSrcMesh->GetNode()->GetInitialName();
+    dst.UniqueID = pSrcMesh->GetUniqueID();
+
+    auto pPosition = pSrcMesh->GetControlPoints();
+    dst.ControlPoints.assign(pPosition, pPosition + pSrcMesh->GetControlPointsCount());
+
+    auto polygonCount = pSrcMesh->GetPolygonCount();
+    dst.PolygonVertices.resize(size_t(polygonCount) * 3);
+    for( auto i=0; i<polygonCount; ++i )
+    {
+        assert( pSrcMesh->GetPolygonSize(i) == 3 );  // OɎOp`Ă̕K3ɂȂĂ邱Ƃ`FbN.
+        for( auto j=0; j<3; ++j )
+        { dst.PolygonVertices[i * 3 + j] = pSrcMesh->GetPolygonVertex(i, j); }
+    }
+
+    CopyElement(pSrcMesh->GetElementVertexColor(), dst.Colors);
+    CopyElement(pSrcMesh->GetElementNormal(),      dst.Normals);
+    CopyElement(pSrcMesh->GetElementTangent(),     dst.Tangents);
+
+    dst.LayerCount = pSrcMesh->GetElementUVCount();
+    if ( dst.LayerCount > MaxLayerCount )
+    {
+        ILOG( "Info : Texture Layer Count Clamp %d ---> %d", dst.LayerCount, MaxLayerCount );
+        dst.LayerCount = MaxLayerCount;
+    }
+
+    for( auto i=0; i<dst.LayerCount; ++i )
+    { CopyElement(pSrcMesh->GetElementUV(i), dst.TexCoords[i]); }
+
+    // XL.
+    auto deformerCount = pSrcMesh->GetDeformerCount(FbxDeformer::eSkin);
+    for(auto i=0; i<deformerCount; ++i)
+    {
+        auto pSkin = FbxCast<FbxSkin>(pSrcMesh->GetDeformer(i, FbxDeformer::eSkin));
+        if (pSkin == nullptr)
+        { continue; }
+
+        dst.Skins.emplace_back();
+        auto& clusters = dst.Skins.back();
+        clusters.resize(pSkin->GetClusterCount());
+
+        for(auto j=0; j<int(clusters.size()); ++j)
+        {
+            auto pCluster = pSkin->GetCluster(j);
+            if (pCluster == nullptr)
+            { continue; }
+
+            auto count   = pCluster->GetControlPointIndicesCount();
+            auto indices = pCluster->GetControlPointIndices();
+            auto weights = pCluster->GetControlPointWeights();
+            if (count <= 0)
+            { continue; }
+
+            clusters[j].Indices.assign(indices, indices + count);
+            clusters[j].Weights.assign(weights, weights + count);
+        }
+    }
+
+    // }eAԍ.
+    if ( pSrcMesh->GetElementMaterial() != nullptr )
+    {
+        FbxLayerElementArrayTemplate<int>* pIndices = nullptr;
+        pSrcMesh->GetMaterialIndices( &pIndices );
+        dst.MaterialMapMode = pSrcMesh->GetElementMaterial()->GetMappingMode();
+
+        // m[h̃}eAԍ烂f̃}eAԍւ̕ϊe[u.
+        auto pNode = pSrcMesh->GetNode();
+        std::vector<int> table(pNode->GetMaterialCount(), -1);
+        for(auto i=0; i<int(table.size()); ++i)
+        {
+            auto itr = m_MaterialMap.find(pNode->GetMaterial(i));
+            if (itr != m_MaterialMap.end())
+            { table[i] = itr->second; }
+        }
 
-    m_Meshes.push_back(dst);
+        auto count = (pIndices != nullptr) ? pIndices->GetCount() : 0;
+        dst.MaterialIds.resize(count);
+        for(auto i=0; i<count; ++i)
+        {
+            auto id = pIndices->GetAt(i);
+            dst.MaterialIds[i] = (0 <= id && id < int(table.size())) ? table[id] : -1;
+        }
+    }
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -654,63 +1100,33 @@ void FBXLoader::ParseLight(FbxNode* pNode)
 //-------------------------------------------------------------------------------------------------
 //      _f[^͂܂.
 //-------------------------------------------------------------------------------------------------
-void FBXLoader::ParseVertex(FbxMesh* pSrcMesh, ResMeshFBX& dstMesh)
+void FBXLoader::ParseVertex
+(
+    const MeshSourceFBX&    src,
+    const asdx::Matrix&     world,
+    ResMeshFBX&             dstMesh,
+    std::string&            errors
+)
 {
-    auto pPosition  = pSrcMesh->GetControlPoints();
-    auto pNormal    = pSrcMesh->GetElementNormal();
-    auto pTangent   = pSrcMesh->GetElementTangent();
-    auto pBinormal  = pSrcMesh->GetElementBinormal();
-    auto pColors    = pSrcMesh->GetElementVertexColor();
-
-    auto world = FromFbxMatrix(pSrcMesh->GetNode()->EvaluateGlobalTransform());
-
-    FbxGeometryElementUV* pUV[MaxLayerCount];
-    auto layerCount = pSrcMesh->GetElementUVCount();
-
-    if ( layerCount > MaxLayerCount )
-    {
-        ILOG( "Info : Texture Layer Count Clamp %d ---> %d", layerCount, MaxLayerCount );
-        layerCount = MaxLayerCount;
-    }
-
-    for( auto i=0; i<MaxLayerCount; ++i )
-    { pUV[i] = pSrcMesh->GetElementUV(i); }
-
-    // ڐf[^ΐ.
-    if (pTangent == nullptr && layerCount > 0)
-    {
-        pSrcMesh->GenerateTangentsData(0, true);
-        pTangent = pSrcMesh->GetElementTangent();
-        assert(pTangent != nullptr);
-    }
+    auto layerCount = src.LayerCount;
 
     // ʃf[^̃m.
     std::vector<Face> faces;
-    faces.resize( pSrcMesh->GetPolygonCount() );
+    faces.resize( src.PolygonVertices.size() / 3 );
 
     // ʒuWCfbNXi[.
     for( size_t i=0; i<faces.size(); ++i )
     {
-        auto count = pSrcMesh->GetPolygonSize(int(i));
-        assert( count == 3 );  // OɎOp`Ă̕K3ɂȂĂ邱Ƃ`FbN.
-
-        for( auto j=0; j<count; ++j )
+        for( auto j=0; j<3; ++j )
         {
-            auto indexP = pSrcMesh->GetPolygonVertex(int(i), j);
-            if (indexP < 0)
+            auto indexP = src.PolygonVertices[i * 3 + j];
+            if (indexP < 0 || size_t(indexP) >= src.ControlPoints.size())
             {
-                m_ErrorString += "Invalid Data Index. Polygon Vertex Index (";
-                m_ErrorString += std::to_string(int(i));
-                m_ErrorString += " , ";
-                m_ErrorString += std::to_string(j);
-                m_ErrorString += "), Mesh name = ";
-                m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                m_ErrorString += ", UniqueID = ";
-                m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                m_ErrorString += "\n";
+                AddIndexError(src, "Polygon Vertex", i * 3 + j, errors);
                 indexP = 0;
             }
             faces[i].IndexP[j] = uint32_t(indexP);
+            faces[i].IndexC[j] = 0;
             faces[i].IndexN[j] = 0;
             faces[i].IndexT[j] = 0;
 
@@ -720,518 +1136,67 @@ void FBXLoader::ParseVertex(FbxMesh* pSrcMesh, ResMeshFBX& dstMesh)
     }
 
     // _J[݂ꍇ.
-    if ( pColors != nullptr )
+    if ( src.Colors.Exists )
     {
-        auto mapMode = pColors->GetMappingMode();
-        auto refMode = pColors->GetReferenceMode();
-
-        switch( mapMode )
-        {
-        case FbxGeometryElement::eByControlPoint:
-            {
-                std::vector<uint32_t> indices;
-                indices.resize( pSrcMesh->GetControlPointsCount() );
-
-                if ( refMode == FbxGeometryElement::eDirect )
-                {
-                    for( auto i=0; i<pSrcMesh->GetControlPointsCount(); ++i )
-                    { indices[i] = static_cast<uint32_t>(i); }
-                }
-                else if ( refMode == FbxGeometryElement::eIndexToDirect )
-                {
-                    auto& container = pColors->GetIndexArray();
-                    for( auto i=0; i<pSrcMesh->GetControlPointsCount(); ++i )
-                    {
-                        auto indexC = container.GetAt(i);
-                        if (indexC < 0)
-                        {
-                            m_ErrorString += "Invalid Data Index. VertexColor index (";
-                            m_ErrorString += std::to_string(i);
-                            m_ErrorString += "), Mesh name = ";
-                            m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                            m_ErrorString += ", UniqueID = ";
-                            m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                            m_ErrorString += "\n";
-                            indexC = 0;
-                        }
-                        indices[i] = static_cast<uint32_t>(indexC);
-                    }
-                }
+        ResolveIndices(src.Colors, src, "VertexColor", faces, errors,
+            [](Face& face, int j, uint32_t index) { face.IndexC[j] = index; });
+    }
 
-                for( size_t i=0; i<faces.size(); ++i )
-                {
-                    for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                    { faces[i].IndexC[j] = indices[ faces[i].IndexP[j] ]; }
-                }
+    // @xNg݂ꍇ.
+    if ( src.Normals.Exists )
+    {
+        ResolveIndices(src.Normals, src, "Normal", faces, errors,
+            [](Face& face, int j, uint32_t index) { face.IndexN[j] = index; });
+    }
 
-                indices.clear();
-            }
-            break;
+    // ڐxNg
+    if ( src.Tangents.Exists )
+    {
+        ResolveIndices(src.Tangents, src, "Tangent", faces, errors,
+            [](Face& face, int j, uint32_t index) { face.IndexT[j] = index; });
+    }
 
-        case FbxGeometryElement::eByPolygonVertex:
-            {
-                int idx = 0;
-                if ( refMode == FbxGeometryElement::eDirect )
-                {
-                    for( size_t i=0; i<faces.size(); ++i )
-                    {
-                        for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                        {
-                            faces[i].IndexC[j] = static_cast<uint32_t>(idx);
-                            idx++;
-                        }
-                    }
-                }
-                else if ( refMode == FbxGeometryElement::eIndexToDirect )
-                {
-                    auto& container = pColors->GetIndexArray();
-                    for( size_t i=0; i<faces.size(); ++i )
-                    {
-                        for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                        {
-                            auto indexC = container.GetAt(idx);
-                            if (indexC < 0)
-                            {
-                                m_ErrorString += "Invalid Data Index. VertexColor index (";
-                                m_ErrorString += std::to_string(idx);
-                                m_ErrorString += "), Mesh name = ";
-                                m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                                m_ErrorString += ", UniqueID = ";
-                                m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                                m_ErrorString += "\n";
-                                indexC = 0;
-                            }
+    // eNX`W.
+    for( auto layer=0; layer<layerCount; ++layer )
+    {
+        if ( !src.TexCoords[layer].Exists )
+        { continue; }
 
-                            faces[i].IndexC[j] = uint32_t(indexC);
-                            idx++;
-                        }
-                    }
-                }
-            }
-            break;
-        }
+        ResolveIndices(src.TexCoords[layer], src, "TexCoord(" + std::to_string(layer) + ")", faces, errors,
+            [layer](Face& face, int j, uint32_t index) { face.IndexU[layer][j] = index; });
     }
 
-    // @xNg݂ꍇ.
-    if ( pNormal != nullptr )
+    // {[IDƃ{[̏d(_P). XLꍇ̂ݐݒ.
+    std::vector<ResBoneIdFBX>   boneIndices;
+    std::vector<asdx::Vector4>  boneWeights;
+
+    if (!src.Skins.empty())
     {
-        auto mapMode = pNormal->GetMappingMode();
-        auto refMode = pNormal->GetReferenceMode();
+        auto point_count = src.ControlPoints.size();
+        boneIndices.resize(point_count);
+        boneWeights.resize(point_count, asdx::Vector4(0.0f, 0.0f, 0.0f, 0.0f));
 
-        switch( mapMode )
+        for(const auto& skin : src.Skins)
         {
-        case FbxGeometryElement::eByControlPoint:
+            for(auto j=0; j<int(skin.size()); ++j)
             {
-                std::vector<uint32_t> indices;
-                indices.resize( pSrcMesh->GetControlPointsCount() );
-
-                if ( refMode == FbxGeometryElement::eDirect )
-                {
-                    for( auto i=0; i<pSrcMesh->GetControlPointsCount(); ++i )
-                    { indices[i] = static_cast<uint32_t>(i); }
-                }
-                else if ( refMode == FbxGeometryElement::eIndexToDirect )
+                const auto& cluster = skin[j];
+                for(size_t k=0; k<cluster.Indices.size(); ++k)
                 {
-                    auto& container = pNormal->GetIndexArray();
-                    for( auto i=0; i<pSrcMesh->GetControlPointsCount(); ++i )
-                    {
-                        auto indexN = container.GetAt(i);
-                        if (indexN < 0)
-                        {
-                            m_ErrorString += "Invalid Data Index. Normal index (";
-                            m_ErrorString += std::to_string(i);
-                            m_ErrorString += "), Mesh name = ";
-                            m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                            m_ErrorString += ", UniqueID = ";
-                            m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                            m_ErrorString += "\n";
-                            indexN = 0;
-                        }
+                    auto id  = cluster.Indices[k];
+                    auto w   = float(cluster.Weights[k]);
 
-                        indices[i] = uint32_t(indexN);
+                    if (id < 0 || size_t(id) >= point_count)
+                    {
+                        AddIndexError(src, "Cluster(" + std::to_string(j) + ")", k, errors);
+                        continue;
                     }
-                }
-
-                for( size_t i=0; i<faces.size(); ++i )
-                {
-                    for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                    { faces[i].IndexN[j] = indices[ faces[i].IndexP[j] ]; }
-                }
 
-                indices.clear();
-            }
-            break;
-
-        case FbxGeometryElement::eByPolygonVertex:
-            {
-                int idx = 0;
-                if ( refMode == FbxGeometryElement::eDirect )
-                {
-                    for( size_t i=0; i<faces.size(); ++i )
+                    // 󂢂ĂƂ납珇ԂɓĂ.
+                    if (boneIndices[id].x < 0)
                     {
-                        for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                        {
-                            faces[i].IndexN[j] = static_cast<uint32_t>(idx);
-                            idx++;
-                        }
-                    }
-                }
-                else if ( refMode == FbxGeometryElement::eIndexToDirect )
-                {
-                    auto& container = pNormal->GetIndexArray();
-                    for( size_t i=0; i<faces.size(); ++i )
-                    {
-                        for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                        {
-                            auto indexN = container.GetAt(idx);
-                            if (indexN < 0)
-                            {
-                                m_ErrorString += "Invalid Data Index. Normal index (";
-                                m_ErrorString += std::to_string(i);
-                                m_ErrorString += "), Mesh name = ";
-                                m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                                m_ErrorString += ", UniqueID = ";
-                                m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                                m_ErrorString += "\n";
-                                indexN = 0;
-                            }
-
-                            faces[i].IndexN[j] = uint32_t(indexN);
-                            idx++;
-                        }
-                    }
-                }
-            }
-            break;
-        }
-    }
-
-    // ڐxNg
-    if ( pTangent != nullptr )
-    {
-        auto mapMode = pTangent->GetMappingMode();
-        auto refMode = pTangent->GetReferenceMode();
-
-        switch( mapMode )
-        {
-        case FbxGeometryElement::eByControlPoint:
-            {
-                std::vector<uint32_t> indices;
-                indices.resize( pSrcMesh->GetControlPointsCount() );
-
-                if ( refMode == FbxGeometryElement::eDirect )
-                {
-                    for( auto i=0; i<pSrcMesh->GetControlPointsCount(); ++i )
-                    { indices[i] = static_cast<uint32_t>(i); }
-                }
-                else if ( refMode == FbxGeometryElement::eIndexToDirect )
-                {
-                    auto& container = pTangent->GetIndexArray();
-                    for( auto i=0; i<pSrcMesh->GetControlPointsCount(); ++i )
-                    {
-                        auto indexT = container.GetAt(i);
-                        if (indexT < 0)
-                        {
-                            m_ErrorString += "Invalid Data Index. Tangent index (";
-                            m_ErrorString += std::to_string(i);
-                            m_ErrorString += "), Mesh name = ";
-                            m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                            m_ErrorString += ", UniqueID = ";
-                            m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                            m_ErrorString += "\n";
-                            indexT = 0;
-                        }
-
-                        indices[i] = uint32_t(indexT);
-                    }
-                }
-
-                for( size_t i=0; i<faces.size(); ++i )
-                {
-                    for( size_t j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                    { faces[i].IndexT[j] = indices[ faces[i].IndexP[j] ]; }
-                }
-
-                indices.clear();
-            }
-            break;
-
-        case FbxGeometryElement::eByPolygonVertex:
-            {
-                int idx = 0;
-                if ( refMode == FbxGeometryElement::eDirect )
-                {
-                    for( size_t i=0; i<faces.size(); ++i )
-                    {
-                        for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                        {
-                            faces[i].IndexT[j] = static_cast<uint32_t>(idx);
-                            idx++;
-                        }
-                    }
-                }
-                else if ( refMode == FbxGeometryElement::eIndexToDirect )
-                {
-                    auto& container = pTangent->GetIndexArray();
-                    for( size_t i=0; i<faces.size(); ++i )
-                    {
-                        for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                        {
-                            auto indexT = container.GetAt(idx);
-                            if (indexT < 0)
-                            {
-                                m_ErrorString += "Invalid Data Index. Tangent index (";
-                                m_ErrorString += std::to_string(idx);
-                                m_ErrorString += "), Mesh name = ";
-                                m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                                m_ErrorString += ", UniqueID = ";
-                                m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                                m_ErrorString += "\n";
-                                indexT = 0;
-                            }
-                            faces[i].IndexT[j] = uint32_t(indexT);
-                            idx++;
-                        }
-                    }
-                }
-            }
-            break;
-
-        default:
-            ELOG("Unexpect case.");
-            break;
-        }
-    }
-
-    // eNX`W.
-    for( auto layer=0; layer<layerCount; ++layer )
-    {
-        if ( pUV[layer] == nullptr )
-        { continue; }
-
-        auto pTexCoord = pUV[layer];
-        auto mapMode = pTexCoord->GetMappingMode();
-        auto refMode = pTexCoord->GetReferenceMode();
-
-        switch( mapMode )
-        {
-        case FbxGeometryElement::eByControlPoint:
-            {
-                std::vector<uint32_t> indices;
-                indices.resize( pSrcMesh->GetControlPointsCount() );
-
-                if ( refMode == FbxGeometryElement::eDirect )
-                {
-                    for( auto i=-0; i<pSrcMesh->GetControlPointsCount(); ++i )
-                    { indices[i] = static_cast<uint32_t>(i); }
-                }
-                else if ( refMode == FbxGeometryElement::eIndexToDirect )
-                {
-                    auto& container = pTexCoord->GetIndexArray();
-                    for( auto i=0; i<pSrcMesh->GetControlPointsCount(); ++i )
-                    {
-                        auto indexU = container.GetAt(i);
-                        if (indexU < 0)
-                        {
-                            m_ErrorString += "Invalid Data Index. TexCoord(";
-                            m_ErrorString += std::to_string(layer);
-                            m_ErrorString += ") index (";
-                            m_ErrorString += std::to_string(i);
-                            m_ErrorString += "), Mesh name = ";
-                            m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                            m_ErrorString += ", UniqueID = ";
-                            m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                            m_ErrorString += "\n";
-                            indexU = 0;
-                        }
-                        indices[i] = uint32_t(indexU);
-                    }
-                }
-
-                for( size_t i=0; i<faces.size(); ++i )
-                {
-                    for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                    { faces[i].IndexU[layer][j] = indices[ faces[i].IndexP[j] ]; }
-                }
-
-                indices.clear();
-            }
-            break;
-
-        case FbxGeometryElement::eByPolygonVertex:
-            {
-                int idx = 0;
-
-                if ( refMode == FbxGeometryElement::eDirect )
-                {
-                    for( size_t i=0; i<faces.size(); ++i )
-                    {
-                        for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                        {
-                            faces[i].IndexU[layer][j] = static_cast<uint32_t>(idx);
-                            idx++;
-                        }
-                    }
-                }
-                else if ( refMode == FbxGeometryElement::eIndexToDirect )
-                {
-                    auto& container = pTexCoord->GetIndexArray();
-
-                    for( size_t i=0; i<faces.size(); ++i )
-                    {
-                        for( auto j=0; j<pSrcMesh->GetPolygonSize(int(i)); ++j )
-                        {
-                            auto indexU = container.GetAt(idx);
-                            if (indexU < 0)
-                            {
-                                m_ErrorString += "Invalid Data Index. TexCoord(";
-                                m_ErrorString += std::to_string(layer);
-                                m_ErrorString += ") index (";
-                                m_ErrorString += std::to_string(idx);
-                                m_ErrorString += "), Mesh name = ";
-                                m_ErrorString += pSrcMesh->GetNode()->GetInitialName();
-                                m_ErrorString += ", UniqueID = ";
-                                m_ErrorString += std::to_string(pSrcMesh->GetUniqueID());
-                                m_ErrorString += "\n";
-                                indexU = 0;
-                            }
-                            faces[i].IndexU[layer][j] = uint32_t(indexU);
-                            idx++;
-                        }
-                    }
-                }
-            }
-            break;
-        }
-    }
-
-    // _gݗĂ.
-    {
-        dstMesh.Positions.resize( faces.size() * 3 );
-        if (pNormal != nullptr)
-        { dstMesh.Normals  .resize( faces.size() * 3 ); }
-        if (pTangent != nullptr)
-        { dstMesh.Tangents.resize( faces.size() * 3 ); }
-        for( auto i=0; i<layerCount; ++i )
-        { dstMesh.TexCoords[i].resize( faces.size() * 3 ); }
-        if (pColors != nullptr)
-        { dstMesh.Colors.resize( faces.size() * 3 ); }
-
-        uint32_t idx = 0;
-        for( size_t i=0; i<faces.size(); ++i )
-        {
-            for( auto j=0; j<3; ++j )
-            {
-                auto& position = pPosition[ faces[i].IndexP[j] ];
-                dstMesh.Positions[idx].x = static_cast<float>( position[0] );
-                dstMesh.Positions[idx].y = static_cast<float>( position[1] );
-                dstMesh.Positions[idx].z = static_cast<float>( position[2] );
-                dstMesh.Positions[idx] = asdx::Vector3::TransformCoord(dstMesh.Positions[idx], world);
-
-                if ( pColors != nullptr )
-                {
-                    const auto& color = pColors->GetDirectArray()[ faces[i].IndexC[j] ];
-                    dstMesh.Colors[idx].x = static_cast<float>( color[0] );
-                    dstMesh.Colors[idx].y = static_cast<float>( color[1] );
-                    dstMesh.Colors[idx].z = static_cast<float>( color[2] );
-                    dstMesh.Colors[idx].w = static_cast<float>( color[3] );
-                }
-
-                if ( pNormal != nullptr )
-                {
-                    const auto& normal = pNormal->GetDirectArray()[ faces[i].IndexN[j] ];
-                    dstMesh.Normals[idx].x = static_cast<float>( normal[0] * normal[3] );
-                    dstMesh.Normals[idx].y = static_cast<float>( normal[1] * normal[3] );
-                    dstMesh.Normals[idx].z = static_cast<float>( normal[2] * normal[3] );
-                    dstMesh.Normals[idx] = asdx::Vector3::TransformNormal(dstMesh.Normals[idx], world);
-                    dstMesh.Normals[idx] = asdx::Vector3::SafeNormalize(dstMesh.Normals[idx], dstMesh.Normals[idx]);
-                }
-
-                if ( pTangent != nullptr )
-                {
-                    const auto& tangent = pTangent->GetDirectArray()[ faces[i].IndexT[j] ];
-                    asdx::Vector3 T;
-                    T.x = static_cast<float>( tangent[0] * tangent[3] );
-                    T.y = static_cast<float>( tangent[1] * tangent[3] );
-                    T.z = static_cast<float>( tangent[2] * tangent[3] );
-                    T = asdx::Vector3::TransformNormal(T, world);
-                    T = asdx::Vector3::SafeNormalize(T, T);
-                    dstMesh.Tangents[idx].x = T.x;
-                    dstMesh.Tangents[idx].y = T.y;
-                    dstMesh.Tangents[idx].z = T.z;
-                    dstMesh.Tangents[idx].w = 1.0f;
-                }
-
-                for( auto k=0; k<layerCount; ++k)
-                {
-                    if ( pUV[k] != nullptr )
-                    {
-                        const auto& texcoord = pUV[k]->GetDirectArray()[ faces[i].IndexU[k][j] ];
-                        dstMesh.TexCoords[k][idx].x = static_cast<float>( texcoord[0] );
-                        dstMesh.TexCoords[k][idx].y = static_cast<float>( texcoord[1] );
-                    }
-                }
-
-                idx++;
-            }
-        }
-    }
-
-    // _CfbNXݒ.
-    {
-        dstMesh.Indices.resize( faces.size() * 3 );
-        for( size_t i=0; i<faces.size() * 3; i+=3 )
-        {
-            dstMesh.Indices[i + 0] = static_cast<uint32_t>(i + 0);
-            dstMesh.Indices[i + 1] = static_cast<uint32_t>(i + 1);
-            dstMesh.Indices[i + 2] = static_cast<uint32_t>(i + 2);
-        }
-    }
-
-    // {[IDƃ{[̏dݐݒ.
-    {
-        dstMesh.BoneIds.resize( faces.size() * 3 );
-        dstMesh.BoneWeights.resize( faces.size() * 3 );
-
-        std::vector<ResBoneIdFBX>   boneIndices;
-        std::vector<asdx::Vector4>  boneWeights;
-
-        auto point_count = pSrcMesh->GetControlPointsCount();
-        boneIndices.resize(point_count);
-        boneWeights.resize(point_count);
-
-        auto deformerCount = pSrcMesh->GetDeformerCount(FbxDeformer::eSkin);
-        for(auto i=0; i<deformerCount; ++i)
-        {
-            auto pSkin = FbxCast<FbxSkin>(pSrcMesh->GetDeformer(i, FbxDeformer::eSkin));
-            if (pSkin == nullptr)
-            { continue; }
-
-            auto clusterCount = pSkin->GetClusterCount();
-            for(auto j=0; j<clusterCount; ++j)
-            {
-                auto pCluster = pSkin->GetCluster(j);
-                if (pCluster == nullptr)
-                { continue; }
-
-                auto count   = pCluster->GetControlPointIndicesCount();
-                auto indices = pCluster->GetControlPointIndices();
-                auto weights = pCluster->GetControlPointWeights();
-
-                if (count == 0)
-                { continue; }
-
-                // ̃JEg pSrcMesh->GetControlPointsCount() ƓɂȂ.
-                for(auto k=0l; k<count; ++k)
-                {
-                    auto id  = indices[k];
-                    auto w   = float(weights[k]);
-
-                    // 󂢂ĂƂ납珇ԂɓĂ.
-                    if (boneIndices[id].x < 0)
-                    {
-                        boneIndices[id].x = j;
-                        boneWeights[id].x = w;
+                        boneIndices[id].x = j;
+                        boneWeights[id].x = w;
                     }
                     else if (boneIndices[id].y < 0)
                     {
@@ -1310,72 +1275,166 @@ void FBXLoader::ParseVertex(FbxMesh* pSrcMesh, ResMeshFBX& dstMesh)
             } // end for
         }
 
-        // S{[Ȃ߂ŏIIȃf[^.
-        auto idx = 0;
-        for(size_t i=0; i<faces.size(); ++i)
+        // S{[Ȃ߂疢gpXbg𖄂߂ĐK.
+        for(size_t i=0; i<boneIndices.size(); ++i)
+        {
+            auto& bi = boneIndices[i];
+            auto& bw = boneWeights[i];
+
+            if (bi.x < 0) { bi.x = 0; bw.x = 0.0f; }
+            if (bi.y < 0) { bi.y = 0; bw.y = 0.0f; }
+            if (bi.z < 0) { bi.z = 0; bw.z = 0.0f; }
+            if (bi.w < 0) { bi.w = 0; bw.w = 0.0f; }
+
+            auto total_weight = bw.x + bw.y + bw.z + bw.w;
+            if (total_weight > 0.0f)
+            {
+                bw.x /= total_weight;
+                bw.y /= total_weight;
+                bw.z /= total_weight;
+                bw.w /= total_weight;
+            }
+
+            if (bw.x < 0.0f) { bw.x = 0.0f; }
+            if (bw.y < 0.0f) { bw.y = 0.0f; }
+            if (bw.z < 0.0f) { bw.z = 0.0f; }
+            if (bw.w < 0.0f) { bw.w = 0.0f; }
+        }
+    }
+
+
+    // _gݗ, Svp1̒_ɗnڂ.
+    {
+        auto cornerCount  = faces.size() * 3;
+        auto reserveCount = src.ControlPoints.size();
+        if (reserveCount > cornerCount)
+        { reserveCount = cornerCount; }
+
+        dstMesh.Positions.reserve( reserveCount );
+        if (src.Normals.Exists)
+        { dstMesh.Normals.reserve( reserveCount ); }
+        if (src.Tangents.Exists)
+        { dstMesh.Tangents.reserve( reserveCount ); }
+        for( auto i=0; i<layerCount; ++i )
+        {
+            if (src.TexCoords[i].Exists)
+            { dstMesh.TexCoords[i].reserve( reserveCount ); }
+        }
+        if (src.Colors.Exists)
+        { dstMesh.Colors.reserve( reserveCount ); }
+        if (!boneIndices.empty())
         {
-            for(auto j=0; j<3; ++j)
+            dstMesh.BoneIds    .reserve( reserveCount );
+            dstMesh.BoneWeights.reserve( reserveCount );
+        }
+        dstMesh.Indices.resize( cornerCount );
+
+        VertexWelder welder(cornerCount);
+
+        Corner corner;
+        memset(&corner, 0, sizeof(corner));
+
+        uint32_t idx = 0;
+        for( size_t i=0; i<faces.size(); ++i )
+        {
+            for( auto j=0; j<3; ++j )
             {
-                auto bi = boneIndices[ faces[i].IndexP[j] ];
-                auto bw = boneWeights[ faces[i].IndexP[j] ];
+                auto& position = src.ControlPoints[ faces[i].IndexP[j] ];
+                corner.Position.x = static_cast<float>( position[0] );
+                corner.Position.y = static_cast<float>( position[1] );
+                corner.Position.z = static_cast<float>( position[2] );
+                corner.Position = asdx::Vector3::TransformCoord(corner.Position, world);
 
-                if (bi.x < 0)
+                if ( src.Colors.Exists )
                 {
-                    bi.x = 0;
-                    bw.x = 0.0f;
+                    const auto& color = src.Colors.Direct[ faces[i].IndexC[j] ];
+                    corner.Color.x = static_cast<float>( color[0] );
+                    corner.Color.y = static_cast<float>( color[1] );
+                    corner.Color.z = static_cast<float>( color[2] );
+                    corner.Color.w = static_cast<float>( color[3] );
                 }
-                if (bi.y < 0)
+
+                if ( src.Normals.Exists )
                 {
-                    bi.y = 0;
-                    bw.y = 0.0f;
+                    const auto& normal = src.Normals.Direct[ faces[i].IndexN[j] ];
+                    corner.Normal.x = static_cast<float>( normal[0] * normal[3] );
+                    corner.Normal.y = static_cast<float>( normal[1] * normal[3] );
+                    corner.Normal.z = static_cast<float>( normal[2] * normal[3] );
+                    corner.Normal = asdx::Vector3::TransformNormal(corner.Normal, world);
+                    corner.Normal = asdx::Vector3::SafeNormalize(corner.Normal, corner.Normal);
                 }
-                if (bi.z < 0)
+
+                if ( src.Tangents.Exists )
                 {
-                    bi.z = 0;
-                    bw.z = 0.0f;
+                    const auto& tangent = src.Tangents.Direct[ faces[i].IndexT[j] ];
+                    asdx::Vector3 T;
+                    T.x = static_cast<float>( tangent[0] * tangent[3] );
+                    T.y = static_cast<float>( tangent[1] * tangent[3] );
+                    T.z = static_cast<float>( tangent[2] * tangent[3] );
+                    T = asdx::Vector3::TransformNormal(T, world);
+                    T = asdx::Vector3::SafeNormalize(T, T);
+                    corner.Tangent.x = T.x;
+                    corner.Tangent.y = T.y;
+                    corner.Tangent.z = T.z;
+                    corner.Tangent.w = 1.0f;
                 }
-                if (bi.w < 0)
+
+                for( auto k=0; k<layerCount; ++k)
                 {
-                    bi.w = 0;
-                    bw.w = 0.0f;
+                    if ( src.TexCoords[k].Exists )
+                    {
+                        const auto& texcoord = src.TexCoords[k].Direct[ faces[i].IndexU[k][j] ];
+                        corner.TexCoord[k].x = static_cast<float>( texcoord[0] );
+                        corner.TexCoord[k].y = static_cast<float>( texcoord[1] );
+                    }
                 }
 
-                auto total_weight = 0.0f;
-                total_weight += bw.x;
-                total_weight += bw.y;
-                total_weight += bw.z;
-                total_weight += bw.w;
+                if ( !boneIndices.empty() )
+                {
+                    const auto& bi = boneIndices[ faces[i].IndexP[j] ];
+                    corner.BoneId[0]  = bi.x;
+                    corner.BoneId[1]  = bi.y;
+                    corner.BoneId[2]  = bi.z;
+                    corner.BoneId[3]  = bi.w;
+                    corner.BoneWeight = boneWeights[ faces[i].IndexP[j] ];
+                }
 
-                dstMesh.BoneIds[idx].x     = bi.x;
-                dstMesh.BoneWeights[idx].x = bw.x / total_weight;
+                auto added = false;
+                auto index = welder.Register(corner, added);
+                dstMesh.Indices[idx++] = index;
 
-                dstMesh.BoneIds[idx].y     = bi.y;
-                dstMesh.BoneWeights[idx].y = bw.y / total_weight;
+                if (!added)
+                { continue; }
 
-                dstMesh.BoneIds[idx].z     = bi.z;
-                dstMesh.BoneWeights[idx].z = bw.z / total_weight;
+                dstMesh.Positions.push_back(corner.Position);
 
-                dstMesh.BoneIds[idx].w     = bi.w;
-                dstMesh.BoneWeights[idx].w = bw.w / total_weight;
+                if ( src.Colors.Exists )
+                { dstMesh.Colors.push_back(corner.Color); }
 
-                idx++;
-            }
-        }
-    }
-
-    for(size_t i=0; i<dstMesh.BoneWeights.size(); ++i)
-    {
-        if (dstMesh.BoneWeights[i].x < 0.0f)
-        { dstMesh.BoneWeights[i].x = 0.0f; }
+                if ( src.Normals.Exists )
+                { dstMesh.Normals.push_back(corner.Normal); }
 
-        if (dstMesh.BoneWeights[i].y < 0.0f)
-        { dstMesh.BoneWeights[i].y = 0.0f; }
+                if ( src.Tangents.Exists )
+                { dstMesh.Tangents.push_back(corner.Tangent); }
 
-        if (dstMesh.BoneWeights[i].z < 0.0f)
-        { dstMesh.BoneWeights[i].z = 0.0f; }
+                for( auto k=0; k<layerCount; ++k)
+                {
+                    if ( src.TexCoords[k].Exists )
+                    { dstMesh.TexCoords[k].push_back(corner.TexCoord[k]); }
+                }
 
-        if (dstMesh.BoneWeights[i].w < 0.0f)
-        { dstMesh.BoneWeights[i].w = 0.0f; }
+                if ( !boneIndices.empty() )
+                {
+                    ResBoneIdFBX id;
+                    id.x = corner.BoneId[0];
+                    id.y = corner.BoneId[1];
+                    id.z = corner.BoneId[2];
+                    id.w = corner.BoneId[3];
+                    dstMesh.BoneIds    .push_back(id);
+                    dstMesh.BoneWeights.push_back(corner.BoneWeight);
+                }
+            }
+        }
     }
 
     faces.clear();
@@ -1413,44 +1472,23 @@ void FBXLoader::ParseMaterial(FbxSurfaceMaterial* pSrcMaterial, ResMaterialFBX&
 //-------------------------------------------------------------------------------------------------
 //      TuZbg͂܂.
 //-------------------------------------------------------------------------------------------------
-void FBXLoader::ParseSubset(FbxMesh* pSrcMesh, ResMeshFBX& dstMesh)
+void FBXLoader::ParseSubset(const MeshSourceFBX& src, ResMeshFBX& dstMesh)
 {
-    FbxLayerElementArrayTemplate<int>* pIndices = nullptr;
-    auto mappingMode = FbxGeometryElement::eNone;
-
-    if ( pSrcMesh->GetElementMaterial() != nullptr )
-    {
-        pSrcMesh->GetMaterialIndices( &pIndices );
-        mappingMode = pSrcMesh->GetElementMaterial()->GetMappingMode();
-    }
+    auto polygonCount = src.PolygonVertices.size() / 3;
+    auto toMaterialId = [&](size_t i)
+    { return (i < src.MaterialIds.size()) ? src.MaterialIds[i] : -1; };
 
-    switch( mappingMode )
+    switch( src.MaterialMapMode )
     {
-    case FbxGeometryElement::eNone:
-        { /* DO_NOTHING */ }
-        break;
-
     case FbxGeometryElement::eAllSame:
         {
-            auto id         = pIndices->GetAt(0);
-            auto material   = pSrcMesh->GetNode()->GetMaterial(id);
-            auto index      = -1;
-            
-            for(int i=0; i<int(m_Materials.size()); ++i)
-            {
-                if (strcmp(material->GetName(), m_Materials[i].Name.c_str()) == 0)
-                {
-                    index = i;
-                    break;
-                }
-            }
-
+            auto index = toMaterialId(0);
             assert(index >= 0);
 
             dstMesh.Subsets.resize(1);
 
             dstMesh.Subsets[0].Offset     = 0;
-            dstMesh.Subsets[0].Count      = pSrcMesh->GetPolygonCount() * 3;
+            dstMesh.Subsets[0].Count      = uint32_t(polygonCount * 3);
             dstMesh.Subsets[0].MaterialId = index;
         }
         break;
@@ -1459,21 +1497,9 @@ void FBXLoader::ParseSubset(FbxMesh* pSrcMesh, ResMeshFBX& dstMesh)
         {
             int prevId = -1;
             int subset = -1;
-            for(auto i=0; i<pSrcMesh->GetPolygonCount(); ++i)
+            for(size_t i=0; i<polygonCount; ++i)
             {
-                auto id         = pIndices->GetAt(i);
-                auto material   = pSrcMesh->GetNode()->GetMaterial(id);
-                auto index      = -1;
-
-                for(int i=0; i<int(m_Materials.size()); ++i)
-                {
-                    if (strcmp(material->GetName(), m_Materials[i].Name.c_str()) == 0)
-                    {
-                        index = i;
-                        break;
-                    }
-                }
-
+                auto index = toMaterialId(i);
                 assert(index >= 0);
 
                 if ( prevId != index )
@@ -1494,6 +1520,10 @@ void FBXLoader::ParseSubset(FbxMesh* pSrcMesh, ResMeshFBX& dstMesh)
             }
         }
         break;
+
+    default:
+        { /* DO_NOTHING */ }
+        break;
     }
 }
 
@@ -1506,7 +1536,11 @@ void FBXLoader::ParseMotion(FbxAnimStack* pSrcStack, ResMotionFBX& dstMotion)
     dstMotion.Name = stackName;
 
     auto takeInfo = m_pScene->GetTakeInfo(stackName);
-    assert( takeInfo != nullptr );
+    if (takeInfo == nullptr)
+    {
+        ELOG("Error : Take Info Not Found. name = %s", dstMotion.Name.c_str());
+        return;
+    }
 
     // Q[prɍ킹60FPSƂĂ.
     auto timeUnit = FbxTime::eFrames60;
@@ -1515,11 +1549,19 @@ void FBXLoader::ParseMotion(FbxAnimStack* pSrcStack, ResMotionFBX& dstMotion)
     auto end   = takeInfo->mLocalTimeSpan.GetStop() .GetFrameCount(timeUnit);
 
     dstMotion.Duration = static_cast<uint32_t>(end - start + 1);
+    if (dstMotion.Duration > MotionClip::MaxFrameCount)
+    {
+        ELOG("Error : Motion is too long. name = %s, frames = %u", dstMotion.Name.c_str(), dstMotion.Duration);
+        return;
+    }
 
-    // e{[.
+    // O烊Nm[h擾.
+    std::vector<FbxNode*>       links;
+    std::vector<std::string>    names;
+    links.reserve(m_Bones.size());
+    names.reserve(m_Bones.size());
     for(size_t i=0; i<m_Bones.size(); ++i)
     {
-        // O烊Nm[h擾.
         auto pLinkNode = m_pScene->FindNodeByName(FbxString(m_Bones[i].Name.c_str()));
         if ( pLinkNode == nullptr )
         {
@@ -1527,53 +1569,62 @@ void FBXLoader::ParseMotion(FbxAnimStack* pSrcStack, ResMotionFBX& dstMotion)
             continue;
         }
 
-        ResBoneMotionFBX boneMotion;
-        boneMotion.BoneName = m_Bones[i].Name;
-        boneMotion.KeyFrames.reserve(dstMotion.Duration);
+        links.push_back(pLinkNode);
+        names.push_back(m_Bones[i].Name);
+    }
+
+    if (!dstMotion.Clip.Init(uint32_t(links.size()), dstMotion.Duration) || links.empty())
+    { return; }
 
-        FbxAMatrix prevTransform;
-        prevTransform.SetIdentity();
+    // L[팸̂߈USt[̎pWJ.
+    // FBX SDK ̕]̓V[̏Ԃ邽, TvO̓VOXbhōs.
+    std::vector<std::vector<MotionPose>> poses(links.size());
+    auto pEvaluator = m_pScene->GetAnimationEvaluator();
+    for(size_t bone=0; bone<links.size(); ++bone)
+    {
+        auto pLinkNode = links[bone];
+        poses[bone].resize(dstMotion.Duration);
 
-        // L[t[ݒ.
-        for(auto idx=start; idx<=end; ++idx)
+        auto pDst = poses[bone].data();
+        for(auto idx=start; idx<=end; ++idx, ++pDst)
         {
             FbxTime curTime;
             curTime.SetFrame(idx, timeUnit);
 
             // ϊs擾.
-            auto transform = pLinkNode->EvaluateGlobalTransform(curTime);
-
-            // ϊsłΐݒ肵Ȃ.
-            if (prevTransform != transform)
-            {
-                auto t = transform.GetT();  // sړ.
-                auto s = transform.GetS();  // XP[.
-                auto q = transform.GetQ();  // ].
-
-                ResKeyPoseFBX key;
-                key.FrameIndex  = static_cast<uint32_t>(idx);
-                key.Translation = asdx::Vector3(float(t[0]), float(t[1]), float(t[2]));
-                key.Scale       = asdx::Vector3(float(s[0]), float(s[1]), float(s[2]));
-                key.Rotation    = asdx::Quaternion(float(q[0]), float(q[1]), float(q[2]), float(q[3]));
-
-            #if 0
-                // sŎ肽ꍇ͂.
-                //key.Transform  = FromFbxMatrix(transform);
-            #endif
-
-                boneMotion.KeyFrames.push_back(key);
-                prevTransform = transform;
-            }
-        }
+            auto transform = pEvaluator->GetNodeGlobalTransform(pLinkNode, curTime);
 
-        // œK.
-        boneMotion.KeyFrames.shrink_to_fit();
+            auto t = transform.GetT();  // sړ.
+            auto s = transform.GetS();  // XP[.
+            auto q = transform.GetQ();  // ].
 
-        // i[.
-        dstMotion.Bones.push_back(boneMotion);
+            pDst->Translation = asdx::Vector3(float(t[0]), float(t[1]), float(t[2]));
+            pDst->Scale       = asdx::Vector3(float(s[0]), float(s[1]), float(s[2]));
+            pDst->Rotation    = asdx::Quaternion(float(q[0]), float(q[1]), float(q[2]), float(q[3]));
+        }
     }
+
+    // {[PʂŃL[팸Ɨʎqs (SDK Ă΂Ȃ̂ŕɏł).
+    ParallelFor(links.size(), [&](size_t bone)
+    {
+        dstMotion.Clip.SetTrack(uint32_t(bone), names[bone], poses[bone].data());
+
+        poses[bone].clear();
+        poses[bone].shrink_to_fit();
+    });
+
+    ILOG("Info : Motion %s, bones = %zu, frames = %u, keys = %zu, raw = %zu bytes, reduced = %zu bytes",
+        dstMotion.Name.c_str(),
+        links.size(),
+        dstMotion.Duration,
+        dstMotion.Clip.GetKeyCount(),
+        links.size() * dstMotion.Duration * sizeof(MotionPose),
+        dstMotion.Clip.GetMemorySize());
 }
 
+//-------------------------------------------------------------------------------------------------
+//      fƂēǂݍ݂܂.
+//-------------------------------------------------------------------------------------------------
 bool FBXLoader::Load(const char* path, asdx::ResModel& model)
 {
     if (!Load(path))
@@ -1592,118 +1643,160 @@ bool FBXLoader::Load(const char* path, asdx::ResModel& model)
 
     auto meshId = 0u;
 
+    std::vector<uint32_t> remap;
+
     for(size_t i=0; i<m_Meshes.size(); ++i)
     {
-        std::stable_sort(m_Meshes[i].Subsets.begin(), m_Meshes[i].Subsets.end(),
+        auto& srcMesh = m_Meshes[i];
+
+        std::stable_sort(srcMesh.Subsets.begin(), srcMesh.Subsets.end(),
             [](const ResSubsetFBX& lhs, const ResSubsetFBX& rhs)
             {
                 return std::tie(lhs.MaterialId, lhs.Offset) < std::tie(rhs.MaterialId, rhs.Offset);
             });
 
-        auto hasNormal      = m_Meshes[i].Normals.size() > 0;
-        auto hasTangent     = m_Meshes[i].Tangents.size() > 0;
-        auto hasUV0         = m_Meshes[i].TexCoords[0].size() > 0;
-        auto hasUV1         = m_Meshes[i].TexCoords[1].size() > 0;
-        auto hasUV2         = m_Meshes[i].TexCoords[2].size() > 0;
-        auto hasUV3         = m_Meshes[i].TexCoords[3].size() > 0;
-        auto hasBoneId      = m_Meshes[i].BoneIds.size() > 0;
-        auto hasBoneWeight  = m_Meshes[i].BoneWeights.size() > 0;
-        auto hasColor       = m_Meshes[i].Colors.size() > 0;
-
-        auto materialId = -1;
-        auto index = 0;
-
-        auto dstMesh = asdx::ResMesh();
+        auto hasNormal      = srcMesh.Normals.size() > 0;
+        auto hasTangent     = srcMesh.Tangents.size() > 0;
+        auto hasBoneId      = srcMesh.BoneIds.size() > 0;
+        auto vertexCount    = srcMesh.Positions.size();
 
-        for(size_t j=0; j<m_Meshes[i].Subsets.size(); ++j)
+        // }eAQƂTuZbg1̃bVɂ܂Ƃ߂.
+        size_t begin = 0;
+        while(begin < srcMesh.Subsets.size())
         {
-            auto& subset = m_Meshes[i].Subsets[j];
-            auto count = subset.Count;
-
-            if (materialId != subset.MaterialId)
+            auto materialId = srcMesh.Subsets[begin].MaterialId;
+            auto end        = begin + 1;
+            auto indexCount = size_t(srcMesh.Subsets[begin].Count);
+            while(end < srcMesh.Subsets.size() && srcMesh.Subsets[end].MaterialId == materialId)
             {
-                if (materialId >= 0)
-                {
-                    if (!hasNormal)
-                    { asdx::CalcNormals(dstMesh); }
+                indexCount += srcMesh.Subsets[end].Count;
+                end++;
+            }
 
-                    if (!hasTangent)
-                    { asdx::CalcTangents(dstMesh); }
+            auto dstMesh = asdx::ResMesh();
+            dstMesh.MeshName     = "mesh";
+            dstMesh.MeshName     += std::to_string(meshId);
+            dstMesh.MaterialName = m_Materials[materialId].Name;
+            meshId++;
 
-                    model.Meshes.emplace_back(dstMesh);
-                    dstMesh = asdx::ResMesh();
-                }
-
-                dstMesh.MeshName     = "mesh";
-                dstMesh.MeshName     += std::to_string(meshId);
-                dstMesh.MaterialName = m_Materials[subset.MaterialId].Name;
+            if (begin == 0 && end == srcMesh.Subsets.size() && indexCount == srcMesh.Indices.size())
+            {
+                // P}eȀꍇ͂̂܂܈ڏ(CfbNX̕т̓}eAŕςȂ).
+                dstMesh.Positions   = std::move(srcMesh.Positions);
+                dstMesh.Normals     = std::move(srcMesh.Normals);
+                dstMesh.Colors      = std::move(srcMesh.Colors);
+                dstMesh.BoneWeights = std::move(srcMesh.BoneWeights);
+                dstMesh.Indices     = std::move(srcMesh.Indices);
+                for(auto k=0; k<MaxLayerCount; ++k)
+                { dstMesh.TexCoords[k] = std::move(srcMesh.TexCoords[k]); }
 
-                materialId = subset.MaterialId;
+                if (hasTangent)
+                {
+                    dstMesh.Tangents.resize(vertexCount);
+                    for(size_t k=0; k<vertexCount; ++k)
+                    {
+                        const auto& T = srcMesh.Tangents[k];
+                        dstMesh.Tangents[k] = asdx::Vector3(T.x, T.y, T.z);
+                    }
+                }
 
-                index = 0;
-                meshId++;
+                if (hasBoneId)
+                {
+                    dstMesh.BoneIndices.resize(vertexCount);
+                    for(size_t k=0; k<vertexCount; ++k)
+                    {
+                        const auto& id = srcMesh.BoneIds[k];
+                        dstMesh.BoneIndices[k] = asdx::ResBoneIndex(
+                            uint16_t(id.x), uint16_t(id.y), uint16_t(id.z), uint16_t(id.w));
+                    }
+                }
             }
-
-            for(size_t k=0; k<count; ++k)
+            else
             {
-                auto idx = k + subset.Offset;
+                // QƂ钸_l߂ĐVԍU.
+                remap.assign(vertexCount, UINT32_MAX);
 
-                dstMesh.Positions.push_back(m_Meshes[i].Positions[idx]);
-
-                if (hasColor)
-                { dstMesh.Colors.push_back(m_Meshes[i].Colors[idx]); }
+                uint32_t count = 0;
+                dstMesh.Indices.resize(indexCount);
+                auto idx = 0u;
+                for(auto j=begin; j<end; ++j)
+                {
+                    const auto& subset = srcMesh.Subsets[j];
+                    for(size_t k=0; k<subset.Count; ++k)
+                    {
+                        auto src = srcMesh.Indices[subset.Offset + k];
+                        if (remap[src] == UINT32_MAX)
+                        { remap[src] = count++; }
+                        dstMesh.Indices[idx++] = remap[src];
+                    }
+                }
 
+                dstMesh.Positions.resize(count);
                 if (hasNormal)
-                { dstMesh.Normals.push_back(m_Meshes[i].Normals[idx]); }
-
+                { dstMesh.Normals.resize(count); }
                 if (hasTangent)
+                { dstMesh.Tangents.resize(count); }
+                if (!srcMesh.Colors.empty())
+                { dstMesh.Colors.resize(count); }
+                if (hasBoneId)
+                {
+                    dstMesh.BoneIndices.resize(count);
+                    dstMesh.BoneWeights.resize(count);
+                }
+                for(auto k=0; k<MaxLayerCount; ++k)
                 {
-                    dstMesh.Tangents.push_back(asdx::Vector3(
-                        m_Meshes[i].Tangents[idx].x,
-                        m_Meshes[i].Tangents[idx].y,
-                        m_Meshes[i].Tangents[idx].z));
+                    if (!srcMesh.TexCoords[k].empty())
+                    { dstMesh.TexCoords[k].resize(count); }
                 }
 
-                if (hasUV0)
-                { dstMesh.TexCoords[0].push_back(m_Meshes[i].TexCoords[0][idx]); }
+                for(size_t src=0; src<vertexCount; ++src)
+                {
+                    auto dst = remap[src];
+                    if (dst == UINT32_MAX)
+                    { continue; }
 
-                if (hasUV1)
-                { dstMesh.TexCoords[1].push_back(m_Meshes[i].TexCoords[1][idx]); }
+                    dstMesh.Positions[dst] = srcMesh.Positions[src];
 
-                if (hasUV2)
-                { dstMesh.TexCoords[2].push_back(m_Meshes[i].TexCoords[2][idx]); }
+                    if (hasNormal)
+                    { dstMesh.Normals[dst] = srcMesh.Normals[src]; }
 
-                if (hasUV3)
-                { dstMesh.TexCoords[3].push_back(m_Meshes[i].TexCoords[3][idx]); }
+                    if (hasTangent)
+                    {
+                        const auto& T = srcMesh.Tangents[src];
+                        dstMesh.Tangents[dst] = asdx::Vector3(T.x, T.y, T.z);
+                    }
 
-                if (hasBoneId)
-                {
-                    dstMesh.BoneIndices.push_back(asdx::ResBoneIndex(
-                        uint16_t(m_Meshes[i].BoneIds[idx].x),
-                        uint16_t(m_Meshes[i].BoneIds[idx].y),
-                        uint16_t(m_Meshes[i].BoneIds[idx].z),
-                        uint16_t(m_Meshes[i].BoneIds[idx].w)));
-                }
+                    if (!srcMesh.Colors.empty())
+                    { dstMesh.Colors[dst] = srcMesh.Colors[src]; }
 
-                if (hasBoneWeight)
-                { dstMesh.BoneWeights.push_back(m_Meshes[i].BoneWeights[idx]); }
+                    if (hasBoneId)
+                    {
+                        const auto& id = srcMesh.BoneIds[src];
+                        dstMesh.BoneIndices[dst] = asdx::ResBoneIndex(
+                            uint16_t(id.x), uint16_t(id.y), uint16_t(id.z), uint16_t(id.w));
+                        dstMesh.BoneWeights[dst] = srcMesh.BoneWeights[src];
+                    }
 
-                dstMesh.Indices.push_back(index);
-                index++;
+                    for(auto k=0; k<MaxLayerCount; ++k)
+                    {
+                        if (!srcMesh.TexCoords[k].empty())
+                        { dstMesh.TexCoords[k][dst] = srcMesh.TexCoords[k][src]; }
+                    }
+                }
             }
-        }
 
-        if (materialId > 0)
-        {
-            if (!hasNormal)
-            { asdx::CalcNormals(dstMesh); }
+            // @Eڐf[^ΐ.
+            if (!GenerateTangentSpace(dstMesh))
+            { return false; }
 
-            if (!hasTangent)
-            { asdx::CalcTangents(dstMesh); }
+            model.Meshes.emplace_back(std::move(dstMesh));
+            m_Instances.push_back(srcMesh.Instances);
 
-            model.Meshes.emplace_back(dstMesh);
+            begin = end;
         }
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+#endif//ENABLE_FBX
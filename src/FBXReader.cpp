@@ -0,0 +1,1636 @@
+﻿//-----------------------------------------------------------------------------
+// File : FBXReader.cpp
+// Desc : Native Binary FBX Reader.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <FBXReader.h>
+#include <MappedFile.h>
+#include <ParallelFor.h>
+#include <TangentSpace.h>
+#include <asdxLogger.h>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <atomic>
+#include <unordered_map>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const char       FBX_MAGIC[]             = "Kaydara FBX Binary  ";  // 末尾に '\0' を含めて21バイト.
+static const size_t     FBX_HEADER_SIZE         = 27;
+static const uint32_t   FBX_MIN_VERSION         = 7000;
+static const uint32_t   FBX_LARGE_VERSION       = 7500;     // これ以降はノードレコードが64bit.
+static const int        FBX_MAX_DEPTH           = 64;
+static const char       FBX_CLASS_SEPARATOR[]   = { '\0', '\x01' };
+static const int        FBX_MAX_UV_COUNT        = 4;        // ResMesh::TexCoords の数.
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Inflater class
+///////////////////////////////////////////////////////////////////////////////
+class Inflater
+{
+public:
+    //-------------------------------------------------------------------------
+    //! @brief      zlib形式のデータを展開します.
+    //!
+    //! @param[in]      pSrc        圧縮データです.
+    //! @param[in]      srcSize     圧縮データのサイズです.
+    //! @param[out]     pDst        出力先です.
+    //! @param[in]      dstSize     展開後のサイズです. 一致しない場合は失敗とします.
+    //-------------------------------------------------------------------------
+    static bool Decode(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstSize)
+    {
+        // zlibヘッダ (CM = 8, プリセット辞書なし).
+        if (srcSize < 2 || (pSrc[0] & 0x0F) != 8 || ((pSrc[0] << 8) | pSrc[1]) % 31 != 0 || (pSrc[1] & 0x20) != 0)
+        { return false; }
+
+        Inflater state(pSrc + 2, srcSize - 2, pDst, dstSize);
+
+        int final = 0;
+        do
+        {
+            uint32_t header;
+            if (!state.GetBits(3, header))
+            { return false; }
+
+            final = header & 0x1;
+
+            bool result = false;
+            switch(header >> 1)
+            {
+            case 0: result = state.Stored();  break;
+            case 1: result = state.Fixed();   break;
+            case 2: result = state.Dynamic(); break;
+            default: break;
+            }
+
+            if (!result)
+            { return false; }
+        }
+        while(!final);
+
+        return state.m_DstPos == dstSize;
+    }
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // Huffman structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct Huffman
+    {
+        uint16_t    Count [16];
+        uint16_t    Symbol[288];
+    };
+
+    const uint8_t*  m_pSrc;
+    size_t          m_SrcSize;
+    size_t          m_SrcPos;
+    uint8_t*        m_pDst;
+    size_t          m_DstSize;
+    size_t          m_DstPos;
+    uint32_t        m_BitBuf;
+    int             m_BitCount;
+
+    Inflater(const uint8_t* pSrc, size_t srcSize, uint8_t* pDst, size_t dstSize)
+    : m_pSrc    (pSrc)
+    , m_SrcSize (srcSize)
+    , m_SrcPos  (0)
+    , m_pDst    (pDst)
+    , m_DstSize (dstSize)
+    , m_DstPos  (0)
+    , m_BitBuf  (0)
+    , m_BitCount(0)
+    { /* DO_NOTHING */ }
+
+    bool GetBits(int count, uint32_t& value)
+    {
+        while(m_BitCount < count)
+        {
+            if (m_SrcPos >= m_SrcSize)
+            { return false; }
+
+            m_BitBuf   |= uint32_t(m_pSrc[m_SrcPos++]) << m_BitCount;
+            m_BitCount += 8;
+        }
+
+        value = m_BitBuf & ((1u << count) - 1);
+        m_BitBuf   >>= count;
+        m_BitCount  -= count;
+        return true;
+    }
+
+    static bool Build(Huffman& h, const uint8_t* lengths, int count)
+    {
+        memset(h.Count, 0, sizeof(h.Count));
+        for(auto i=0; i<count; ++i)
+        { h.Count[lengths[i]]++; }
+
+        if (h.Count[0] == count)
+        { return true; }
+
+        // 過剰な符号割り当てをチェック.
+        int left = 1;
+        for(auto len=1; len<16; ++len)
+        {
+            left <<= 1;
+            left -= h.Count[len];
+            if (left < 0)
+            { return false; }
+        }
+
+        uint16_t offsets[16];
+        offsets[1] = 0;
+        for(auto len=1; len<15; ++len)
+        { offsets[len + 1] = offsets[len] + h.Count[len]; }
+
+        for(auto i=0; i<count; ++i)
+        {
+            if (lengths[i] != 0)
+            { h.Symbol[offsets[lengths[i]]++] = uint16_t(i); }
+        }
+
+        return true;
+    }
+
+    int DecodeSymbol(const Huffman& h)
+    {
+        int code  = 0;
+        int first = 0;
+        int index = 0;
+        for(auto len=1; len<16; ++len)
+        {
+            uint32_t bit;
+            if (!GetBits(1, bit))
+            { return -1; }
+
+            code |= int(bit);
+            auto count = int(h.Count[len]);
+            if (code - count < first)
+            { return h.Symbol[index + (code - first)]; }
+
+            index += count;
+            first += count;
+            first <<= 1;
+            code  <<= 1;
+        }
+
+        return -1;
+    }
+
+    bool Stored()
+    {
+        // バイト境界に揃える.
+        m_BitBuf   = 0;
+        m_BitCount = 0;
+
+        if (m_SrcPos + 4 > m_SrcSize)
+        { return false; }
+
+        auto len  = uint32_t(m_pSrc[m_SrcPos + 0]) | (uint32_t(m_pSrc[m_SrcPos + 1]) << 8);
+        auto nlen = uint32_t(m_pSrc[m_SrcPos + 2]) | (uint32_t(m_pSrc[m_SrcPos + 3]) << 8);
+        m_SrcPos += 4;
+
+        if (len != (~nlen & 0xFFFF) || m_SrcPos + len > m_SrcSize || m_DstPos + len > m_DstSize)
+        { return false; }
+
+        memcpy(m_pDst + m_DstPos, m_pSrc + m_SrcPos, len);
+        m_SrcPos += len;
+        m_DstPos += len;
+        return true;
+    }
+
+    bool Codes(const Huffman& lencode, const Huffman& distcode)
+    {
+        static const uint16_t kLengthBase[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t kLengthExtra[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+            3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t kDistBase[30] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const uint8_t kDistExtra[30] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+            7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        for(;;)
+        {
+            auto symbol = DecodeSymbol(lencode);
+            if (symbol < 0)
+            { return false; }
+
+            if (symbol < 256)
+            {
+                if (m_DstPos >= m_DstSize)
+                { return false; }
+
+                m_pDst[m_DstPos++] = uint8_t(symbol);
+                continue;
+            }
+
+            if (symbol == 256)
+            { return true; }
+
+            symbol -= 257;
+            if (symbol >= 29)
+            { return false; }
+
+            uint32_t extra;
+            if (!GetBits(kLengthExtra[symbol], extra))
+            { return false; }
+            auto length = size_t(kLengthBase[symbol]) + extra;
+
+            symbol = DecodeSymbol(distcode);
+            if (symbol < 0 || symbol >= 30)
+            { return false; }
+
+            if (!GetBits(kDistExtra[symbol], extra))
+            { return false; }
+            auto dist = size_t(kDistBase[symbol]) + extra;
+
+            if (dist > m_DstPos || m_DstPos + length > m_DstSize)
+            { return false; }
+
+            // 重なりがあり得るのでバイト単位でコピー.
+            auto pDst = m_pDst + m_DstPos;
+            auto pSrc = pDst - dist;
+            for(size_t i=0; i<length; ++i)
+            { pDst[i] = pSrc[i]; }
+            m_DstPos += length;
+        }
+    }
+
+    bool Fixed()
+    {
+        static Huffman lencode;
+        static Huffman distcode;
+        static const bool built = []()
+        {
+            uint8_t lengths[288];
+            auto i = 0;
+            for(; i<144; ++i) { lengths[i] = 8; }
+            for(; i<256; ++i) { lengths[i] = 9; }
+            for(; i<280; ++i) { lengths[i] = 7; }
+            for(; i<288; ++i) { lengths[i] = 8; }
+            Build(lencode, lengths, 288);
+
+            for(i=0; i<30; ++i) { lengths[i] = 5; }
+            Build(distcode, lengths, 30);
+            return true;
+        }();
+        (void)built;
+
+        return Codes(lencode, distcode);
+    }
+
+    bool Dynamic()
+    {
+        static const uint8_t kOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        uint32_t nlen, ndist, ncode;
+        if (!GetBits(5, nlen) || !GetBits(5, ndist) || !GetBits(4, ncode))
+        { return false; }
+
+        nlen  += 257;
+        ndist += 1;
+        ncode += 4;
+        if (nlen > 286 || ndist > 30)
+        { return false; }
+
+        uint8_t lengths[320] = {};
+        for(auto i=0u; i<ncode; ++i)
+        {
+            uint32_t value;
+            if (!GetBits(3, value))
+            { return false; }
+            lengths[kOrder[i]] = uint8_t(value);
+        }
+
+        Huffman lencode;
+        Huffman distcode;
+        if (!Build(lencode, lengths, 19))
+        { return false; }
+
+        auto index = 0u;
+        while(index < nlen + ndist)
+        {
+            auto symbol = DecodeSymbol(lencode);
+            if (symbol < 0)
+            { return false; }
+
+            if (symbol < 16)
+            {
+                lengths[index++] = uint8_t(symbol);
+                continue;
+            }
+
+            uint8_t  length = 0;
+            uint32_t repeat = 0;
+            if (symbol == 16)
+            {
+                if (index == 0 || !GetBits(2, repeat))
+                { return false; }
+                length = lengths[index - 1];
+                repeat += 3;
+            }
+            else if (symbol == 17)
+            {
+                if (!GetBits(3, repeat))
+                { return false; }
+                repeat += 3;
+            }
+            else
+            {
+                if (!GetBits(7, repeat))
+                { return false; }
+                repeat += 11;
+            }
+
+            if (index + repeat > nlen + ndist)
+            { return false; }
+
+            while(repeat--)
+            { lengths[index++] = length; }
+        }
+
+        // 終端符号が無いものは不正.
+        if (lengths[256] == 0)
+        { return false; }
+
+        if (!Build(lencode, lengths, int(nlen)) || !Build(distcode, lengths + nlen, int(ndist)))
+        { return false; }
+
+        return Codes(lencode, distcode);
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+// Property structure
+///////////////////////////////////////////////////////////////////////////////
+struct Property
+{
+    char                    Type        = 0;
+    int64_t                 Integer     = 0;    // 'Y', 'C', 'I', 'L'
+    double                  Real        = 0.0;  // 'F', 'D'
+    const uint8_t*          pData       = nullptr;  // 'S', 'R' および配列の格納データ.
+    uint32_t                Size        = 0;        // pData のバイト数.
+    uint32_t                Count       = 0;        // 配列の要素数.
+    uint32_t                Encoding    = 0;        // 0 : 無圧縮, 1 : zlib.
+    std::vector<uint8_t>    Decoded;                // 展開済み配列.
+
+    //-------------------------------------------------------------------------
+    //! @brief      配列かどうか?
+    //-------------------------------------------------------------------------
+    bool IsArray() const
+    { return Type == 'f' || Type == 'd' || Type == 'l' || Type == 'i' || Type == 'b'; }
+
+    //-------------------------------------------------------------------------
+    //! @brief      配列の要素サイズを取得します.
+    //-------------------------------------------------------------------------
+    size_t GetElementSize() const
+    {
+        switch(Type)
+        {
+        case 'd': case 'l': return 8;
+        case 'f': case 'i': return 4;
+        case 'b':           return 1;
+        default:            return 0;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      数値として取得します.
+    //-------------------------------------------------------------------------
+    double AsDouble() const
+    { return (Type == 'F' || Type == 'D') ? Real : double(Integer); }
+
+    //-------------------------------------------------------------------------
+    //! @brief      文字列として取得します.
+    //-------------------------------------------------------------------------
+    std::string AsString() const
+    { return (Type == 'S') ? std::string(reinterpret_cast<const char*>(pData), Size) : std::string(); }
+
+    //-------------------------------------------------------------------------
+    //! @brief      配列として取得します.
+    //-------------------------------------------------------------------------
+    template<typename T>
+    bool GetArray(std::vector<T>& result) const
+    {
+        if (!IsArray())
+        { return false; }
+
+        const uint8_t* ptr = (Encoding == 0) ? pData : Decoded.data();
+        if (Count > 0 && (ptr == nullptr || (Encoding != 0 && Decoded.size() != Count * GetElementSize())))
+        { return false; }
+
+        result.resize(Count);
+        for(uint32_t i=0; i<Count; ++i)
+        {
+            switch(Type)
+            {
+            case 'd': { double  v; memcpy(&v, ptr + i * 8, 8); result[i] = T(v); } break;
+            case 'f': { float   v; memcpy(&v, ptr + i * 4, 4); result[i] = T(v); } break;
+            case 'l': { int64_t v; memcpy(&v, ptr + i * 8, 8); result[i] = T(v); } break;
+            case 'i': { int32_t v; memcpy(&v, ptr + i * 4, 4); result[i] = T(v); } break;
+            case 'b': { result[i] = T(ptr[i]); } break;
+            }
+        }
+
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Node structure
+///////////////////////////////////////////////////////////////////////////////
+struct Node
+{
+    std::string             Name;
+    std::vector<Property>   Props;
+    std::vector<Node>       Children;
+
+    //-------------------------------------------------------------------------
+    //! @brief      子ノードを検索します.
+    //-------------------------------------------------------------------------
+    const Node* Find(const char* name) const
+    {
+        for(const auto& child : Children)
+        {
+            if (child.Name == name)
+            { return &child; }
+        }
+        return nullptr;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      子ノードの最初のプロパティを検索します.
+    //-------------------------------------------------------------------------
+    const Property* FindProp(const char* name) const
+    {
+        auto node = Find(name);
+        if (node == nullptr || node->Props.empty())
+        { return nullptr; }
+        return &node->Props[0];
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Parser class
+///////////////////////////////////////////////////////////////////////////////
+class Parser
+{
+public:
+    Parser(const uint8_t* pData, size_t size, uint32_t version)
+    : m_pData   (pData)
+    , m_Size    (size)
+    , m_Large   (version >= FBX_LARGE_VERSION)
+    { /* DO_NOTHING */ }
+
+    //-------------------------------------------------------------------------
+    //! @brief      ノードリストを解析します.
+    //-------------------------------------------------------------------------
+    bool ParseList(size_t& offset, size_t end, std::vector<Node>& nodes, int depth)
+    {
+        if (depth > FBX_MAX_DEPTH || end > m_Size)
+        { return false; }
+
+        auto headerSize = m_Large ? size_t(25) : size_t(13);
+        while(offset + headerSize <= end)
+        {
+            uint64_t endOffset, propCount, propSize;
+            if (m_Large)
+            {
+                endOffset = Read<uint64_t>(offset + 0);
+                propCount = Read<uint64_t>(offset + 8);
+                propSize  = Read<uint64_t>(offset + 16);
+            }
+            else
+            {
+                endOffset = Read<uint32_t>(offset + 0);
+                propCount = Read<uint32_t>(offset + 4);
+                propSize  = Read<uint32_t>(offset + 8);
+            }
+            auto nameLen = m_pData[offset + headerSize - 1];
+
+            // 終端レコード.
+            if (endOffset == 0)
+            {
+                offset += headerSize;
+                return true;
+            }
+
+            // 終端位置はファイルサイズ内かつ親ノードの範囲内でなければならない.
+            if (endOffset > end || endOffset > m_Size || propSize > m_Size
+             || endOffset < offset + headerSize + nameLen + propSize)
+            { return false; }
+
+            nodes.emplace_back();
+            auto& node = nodes.back();
+            node.Name.assign(reinterpret_cast<const char*>(m_pData + offset + headerSize), nameLen);
+
+            // プロパティは最低でも型コードの1バイトを持つので, 確保前に数をチェック.
+            if (propCount > propSize)
+            { return false; }
+
+            auto pos     = offset + headerSize + nameLen;
+            auto propEnd = pos + size_t(propSize);
+            node.Props.resize(size_t(propCount));
+            for(auto& prop : node.Props)
+            {
+                if (!ParseProperty(pos, propEnd, prop))
+                { return false; }
+            }
+
+            if (pos != propEnd)
+            { return false; }
+
+            if (pos < endOffset)
+            {
+                if (!ParseList(pos, size_t(endOffset), node.Children, depth + 1))
+                { return false; }
+            }
+
+            offset = size_t(endOffset);
+        }
+
+        return true;
+    }
+
+private:
+    const uint8_t*  m_pData;
+    size_t          m_Size;
+    bool            m_Large;
+
+    template<typename T>
+    T Read(size_t offset) const
+    {
+        T value;
+        memcpy(&value, m_pData + offset, sizeof(T));
+        return value;
+    }
+
+    bool ParseProperty(size_t& pos, size_t end, Property& prop)
+    {
+        if (pos + 1 > end)
+        { return false; }
+
+        prop.Type = char(m_pData[pos++]);
+
+        auto fixed = [&](size_t size) { return pos + size <= end; };
+
+        switch(prop.Type)
+        {
+        case 'Y': if (!fixed(2)) { return false; } prop.Integer = Read<int16_t>(pos); pos += 2; break;
+        case 'C': if (!fixed(1)) { return false; } prop.Integer = m_pData[pos];       pos += 1; break;
+        case 'I': if (!fixed(4)) { return false; } prop.Integer = Read<int32_t>(pos); pos += 4; break;
+        case 'L': if (!fixed(8)) { return false; } prop.Integer = Read<int64_t>(pos); pos += 8; break;
+        case 'F': if (!fixed(4)) { return false; } prop.Real    = Read<float>  (pos); pos += 4; break;
+        case 'D': if (!fixed(8)) { return false; } prop.Real    = Read<double> (pos); pos += 8; break;
+
+        case 'S':
+        case 'R':
+            {
+                if (!fixed(4))
+                { return false; }
+
+                prop.Size = Read<uint32_t>(pos);
+                pos += 4;
+                if (!fixed(prop.Size))
+                { return false; }
+
+                prop.pData = m_pData + pos;
+                pos += prop.Size;
+            }
+            break;
+
+        case 'f':
+        case 'd':
+        case 'l':
+        case 'i':
+        case 'b':
+            {
+                if (!fixed(12))
+                { return false; }
+
+                prop.Count    = Read<uint32_t>(pos + 0);
+                prop.Encoding = Read<uint32_t>(pos + 4);
+                prop.Size     = Read<uint32_t>(pos + 8);
+                pos += 12;
+
+                if (!fixed(prop.Size))
+                { return false; }
+
+                if (prop.Encoding == 0 && uint64_t(prop.Count) * prop.GetElementSize() != prop.Size)
+                { return false; }
+
+                if (prop.Encoding > 1)
+                { return false; }
+
+                prop.pData = m_pData + pos;
+                pos += prop.Size;
+            }
+            break;
+
+        default:
+            return false;
+        }
+
+        return true;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MAPPING_TYPE enum
+///////////////////////////////////////////////////////////////////////////////
+enum MAPPING_TYPE
+{
+    MAPPING_NONE,
+    MAPPING_BY_POLYGON_VERTEX,
+    MAPPING_BY_VERTEX,
+    MAPPING_BY_POLYGON,
+    MAPPING_ALL_SAME,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// LayerElement structure
+///////////////////////////////////////////////////////////////////////////////
+struct LayerElement
+{
+    MAPPING_TYPE            Mapping     = MAPPING_NONE;
+    uint32_t                Components  = 0;
+    std::vector<double>     Values;
+    std::vector<int32_t>    Indices;
+
+    //-------------------------------------------------------------------------
+    //! @brief      要素を読み込みます.
+    //-------------------------------------------------------------------------
+    bool Init(const Node* pNode, const char* valueName, const char* indexName, uint32_t components)
+    {
+        Mapping = MAPPING_NONE;
+        if (pNode == nullptr)
+        { return false; }
+
+        auto pValues = pNode->FindProp(valueName);
+        if (pValues == nullptr || !pValues->GetArray(Values))
+        { return false; }
+
+        auto pMapping   = pNode->FindProp("MappingInformationType");
+        auto pReference = pNode->FindProp("ReferenceInformationType");
+        auto mapping    = (pMapping   != nullptr) ? pMapping  ->AsString() : std::string();
+        auto reference  = (pReference != nullptr) ? pReference->AsString() : std::string();
+
+        if (mapping == "ByPolygonVertex")
+        { Mapping = MAPPING_BY_POLYGON_VERTEX; }
+        else if (mapping == "ByVertex" || mapping == "ByVertice" || mapping == "ByControlPoint")
+        { Mapping = MAPPING_BY_VERTEX; }
+        else if (mapping == "ByPolygon")
+        { Mapping = MAPPING_BY_POLYGON; }
+        else if (mapping == "AllSame")
+        { Mapping = MAPPING_ALL_SAME; }
+        else
+        { return false; }
+
+        Indices.clear();
+        if (reference == "IndexToDirect" || reference == "Index")
+        {
+            auto pIndices = pNode->FindProp(indexName);
+            if (pIndices == nullptr || !pIndices->GetArray(Indices))
+            {
+                Mapping = MAPPING_NONE;
+                return false;
+            }
+        }
+
+        Components = components;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      値へのポインタを取得します. 範囲外の場合は nullptr を返却します.
+    //-------------------------------------------------------------------------
+    const double* Get(size_t polygon, size_t corner, size_t controlPoint) const
+    {
+        size_t index = 0;
+        switch(Mapping)
+        {
+        case MAPPING_BY_POLYGON_VERTEX: index = corner;       break;
+        case MAPPING_BY_VERTEX:         index = controlPoint; break;
+        case MAPPING_BY_POLYGON:        index = polygon;      break;
+        case MAPPING_ALL_SAME:          index = 0;            break;
+        default:                        return nullptr;
+        }
+
+        if (!Indices.empty())
+        {
+            if (index >= Indices.size() || Indices[index] < 0)
+            { return nullptr; }
+            index = size_t(Indices[index]);
+        }
+
+        if ((index + 1) * Components > Values.size())
+        { return nullptr; }
+
+        return Values.data() + index * Components;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Scene class
+///////////////////////////////////////////////////////////////////////////////
+struct Scene
+{
+    std::unordered_map<int64_t, const Node*>            Objects;
+    std::unordered_map<int64_t, std::vector<int64_t>>   Children;   // 接続順を保持.
+    std::unordered_map<int64_t, int64_t>                Parents;    // オブジェクト同士の接続のみ.
+    double                                              UnitScale = 1.0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// GeometryJob structure
+///////////////////////////////////////////////////////////////////////////////
+struct GeometryJob
+{
+    const Node*                 pGeometry;
+    std::vector<std::string>    Materials;      // マテリアルスロット名.
+    std::vector<asdx::Matrix>   Instances;
+    const Node*                 pSkin;
+    std::vector<asdx::ResMesh>  Meshes;
+};
+
+//-----------------------------------------------------------------------------
+//      オブジェクト名を取得します("Name\0\1Class" 形式).
+//-----------------------------------------------------------------------------
+std::string GetObjectName(const Node* pNode)
+{
+    if (pNode == nullptr || pNode->Props.size() < 2)
+    { return std::string(); }
+
+    auto name = pNode->Props[1].AsString();
+    auto pos  = name.find(std::string(FBX_CLASS_SEPARATOR, 2));
+    if (pos != std::string::npos)
+    { name.resize(pos); }
+
+    return name;
+}
+
+//-----------------------------------------------------------------------------
+//      オブジェクトのサブクラスを取得します.
+//-----------------------------------------------------------------------------
+std::string GetObjectClass(const Node* pNode)
+{
+    if (pNode == nullptr || pNode->Props.size() < 3)
+    { return std::string(); }
+
+    return pNode->Props[2].AsString();
+}
+
+//-----------------------------------------------------------------------------
+//      Properties70 からプロパティを検索します.
+//-----------------------------------------------------------------------------
+const Node* FindP(const Node* pNode, const char* name)
+{
+    if (pNode == nullptr)
+    { return nullptr; }
+
+    auto pProps = pNode->Find("Properties70");
+    if (pProps == nullptr)
+    { return nullptr; }
+
+    auto length = strlen(name);
+    for(const auto& child : pProps->Children)
+    {
+        if (child.Name != "P" || child.Props.empty() || child.Props[0].Type != 'S')
+        { continue; }
+
+        const auto& key = child.Props[0];
+        if (key.Size == length && memcmp(key.pData, name, length) == 0)
+        { return &child; }
+    }
+
+    return nullptr;
+}
+
+//-----------------------------------------------------------------------------
+//      Properties70 から3成分のプロパティを取得します.
+//-----------------------------------------------------------------------------
+asdx::Vector3 GetP3(const Node* pNode, const char* name, const asdx::Vector3& defaultValue)
+{
+    auto pP = FindP(pNode, name);
+    if (pP == nullptr || pP->Props.size() < 7)
+    { return defaultValue; }
+
+    return asdx::Vector3(
+        float(pP->Props[4].AsDouble()),
+        float(pP->Props[5].AsDouble()),
+        float(pP->Props[6].AsDouble()));
+}
+
+//-----------------------------------------------------------------------------
+//      Properties70 からスカラーのプロパティを取得します.
+//-----------------------------------------------------------------------------
+double GetP1(const Node* pNode, const char* name, double defaultValue)
+{
+    auto pP = FindP(pNode, name);
+    if (pP == nullptr || pP->Props.size() < 5)
+    { return defaultValue; }
+
+    return pP->Props[4].AsDouble();
+}
+
+//-----------------------------------------------------------------------------
+//      オイラー角(度)から回転行列を生成します.
+//-----------------------------------------------------------------------------
+asdx::Matrix CreateEulerRotation(const asdx::Vector3& degree, int order)
+{
+    auto x = asdx::Matrix::CreateRotationX(asdx::ToRadian(degree.x));
+    auto y = asdx::Matrix::CreateRotationY(asdx::ToRadian(degree.y));
+    auto z = asdx::Matrix::CreateRotationZ(asdx::ToRadian(degree.z));
+
+    // 行ベクトル形式なので, 先に適用する軸から順に掛ける.
+    switch(order)
+    {
+    case 1:  return x * z * y;  // eEulerXZY
+    case 2:  return y * z * x;  // eEulerYZX
+    case 3:  return y * x * z;  // eEulerYXZ
+    case 4:  return z * x * y;  // eEulerZXY
+    case 5:  return z * y * x;  // eEulerZYX
+    default: return x * y * z;  // eEulerXYZ
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      モデルのローカル行列を取得します.
+//-----------------------------------------------------------------------------
+asdx::Matrix GetLocalMatrix(const Node* pModel)
+{
+    auto zero  = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    auto one   = asdx::Vector3(1.0f, 1.0f, 1.0f);
+    auto order = int(GetP1(pModel, "RotationOrder", 0.0));
+
+    auto T    = GetP3(pModel, "Lcl Translation", zero);
+    auto R    = GetP3(pModel, "Lcl Rotation",    zero);
+    auto S    = GetP3(pModel, "Lcl Scaling",     one);
+    auto Rpre = GetP3(pModel, "PreRotation",     zero);
+    auto Rpst = GetP3(pModel, "PostRotation",    zero);
+    auto Roff = GetP3(pModel, "RotationOffset",  zero);
+    auto Rp   = GetP3(pModel, "RotationPivot",   zero);
+    auto Soff = GetP3(pModel, "ScalingOffset",   zero);
+    auto Sp   = GetP3(pModel, "ScalingPivot",    zero);
+
+    // FBX SDK の T * Roff * Rp * Rpre * R * Rpost^-1 * Rp^-1 * Soff * Sp * S * Sp^-1 を行ベクトル形式で逆順に掛ける.
+    auto matrix = asdx::Matrix::CreateTranslation(-Sp.x, -Sp.y, -Sp.z);
+    matrix *= asdx::Matrix::CreateScale(S.x, S.y, S.z);
+    matrix *= asdx::Matrix::CreateTranslation(Sp.x + Soff.x - Rp.x, Sp.y + Soff.y - Rp.y, Sp.z + Soff.z - Rp.z);
+    matrix *= asdx::Matrix::Transpose(CreateEulerRotation(Rpst, 0));
+    matrix *= CreateEulerRotation(R, order);
+    matrix *= CreateEulerRotation(Rpre, 0);
+    matrix *= asdx::Matrix::CreateTranslation(Rp.x + Roff.x + T.x, Rp.y + Roff.y + T.y, Rp.z + Roff.z + T.z);
+    return matrix;
+}
+
+//-----------------------------------------------------------------------------
+//      モデルのジオメトリ行列を取得します(子には継承されない).
+//-----------------------------------------------------------------------------
+asdx::Matrix GetGeometricMatrix(const Node* pModel)
+{
+    auto zero = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    auto one  = asdx::Vector3(1.0f, 1.0f, 1.0f);
+
+    auto T = GetP3(pModel, "GeometricTranslation", zero);
+    auto R = GetP3(pModel, "GeometricRotation",    zero);
+    auto S = GetP3(pModel, "GeometricScaling",     one);
+
+    auto matrix = asdx::Matrix::CreateScale(S.x, S.y, S.z);
+    matrix *= CreateEulerRotation(R, 0);
+    matrix *= asdx::Matrix::CreateTranslation(T.x, T.y, T.z);
+    return matrix;
+}
+
+//-----------------------------------------------------------------------------
+//      モデルのワールド行列を取得します.
+//-----------------------------------------------------------------------------
+asdx::Matrix GetWorldMatrix
+(
+    const Scene&                                    scene,
+    int64_t                                         id,
+    std::unordered_map<int64_t, asdx::Matrix>&      cache,
+    int                                             depth
+)
+{
+    auto cached = cache.find(id);
+    if (cached != cache.end())
+    { return cached->second; }
+
+    auto object = scene.Objects.find(id);
+    if (object == scene.Objects.end() || depth > FBX_MAX_DEPTH)
+    { return asdx::Matrix::CreateScale(float(scene.UnitScale), float(scene.UnitScale), float(scene.UnitScale)); }
+
+    auto world = GetLocalMatrix(object->second);
+
+    // 親モデルがあれば積算, 無ければ単位変換を適用.
+    auto parent = scene.Parents.find(id);
+    auto parentObject = (parent != scene.Parents.end()) ? scene.Objects.find(parent->second) : scene.Objects.end();
+    if (parentObject != scene.Objects.end() && parentObject->second->Name == "Model")
+    { world *= GetWorldMatrix(scene, parent->second, cache, depth + 1); }
+    else
+    { world *= asdx::Matrix::CreateScale(float(scene.UnitScale), float(scene.UnitScale), float(scene.UnitScale)); }
+
+    cache[id] = world;
+    return world;
+}
+
+//-----------------------------------------------------------------------------
+//      多角形を三角形に分割します.
+//-----------------------------------------------------------------------------
+void Triangulate
+(
+    const asdx::Vector3*    pPositions,
+    uint32_t                count,
+    std::vector<uint32_t>&  work,
+    std::vector<uint32_t>&  result
+)
+{
+    if (count < 3)
+    { return; }
+
+    if (count == 3)
+    {
+        result.push_back(0);
+        result.push_back(1);
+        result.push_back(2);
+        return;
+    }
+
+    // Newell法で法線を求め, 最も大きい軸を落として2次元に投影する.
+    double nx = 0.0, ny = 0.0, nz = 0.0;
+    for(auto i=0u; i<count; ++i)
+    {
+        const auto& a = pPositions[i];
+        const auto& b = pPositions[(i + 1) % count];
+        nx += double(a.y - b.y) * double(a.z + b.z);
+        ny += double(a.z - b.z) * double(a.x + b.x);
+        nz += double(a.x - b.x) * double(a.y + b.y);
+    }
+
+    auto ax = fabs(nx), ay = fabs(ny), az = fabs(nz);
+    auto axis = (ax > ay) ? ((ax > az) ? 0 : 2) : ((ay > az) ? 1 : 2);
+    auto sign = (axis == 0) ? nx : (axis == 1) ? ny : nz;
+
+    auto project = [&](uint32_t index, double& u, double& v)
+    {
+        const auto& p = pPositions[index];
+        switch(axis)
+        {
+        case 0:  u = p.y; v = p.z; break;
+        case 1:  u = p.z; v = p.x; break;
+        default: u = p.x; v = p.y; break;
+        }
+    };
+
+    auto cross = [&](uint32_t a, uint32_t b, uint32_t c)
+    {
+        double ua, va, ub, vb, uc, vc;
+        project(a, ua, va);
+        project(b, ub, vb);
+        project(c, uc, vc);
+        auto value = (ub - ua) * (vc - va) - (vb - va) * (uc - ua);
+        return (sign < 0.0) ? -value : value;
+    };
+
+    auto inside = [&](uint32_t p, uint32_t a, uint32_t b, uint32_t c)
+    { return cross(a, b, p) >= 0.0 && cross(b, c, p) >= 0.0 && cross(c, a, p) >= 0.0; };
+
+    // 耳刈り取り法. 耳が見つからなければ扇形分割に切り替える.
+    work.resize(count);
+    for(auto i=0u; i<count; ++i)
+    { work[i] = i; }
+
+    auto remain = count;
+    auto guard  = 0u;
+    auto i      = 0u;
+    while(remain > 3)
+    {
+        auto prev = work[(i + remain - 1) % remain];
+        auto curr = work[i % remain];
+        auto next = work[(i + 1) % remain];
+
+        auto isEar = cross(prev, curr, next) > 0.0;
+        for(auto j=0u; j<remain && isEar; ++j)
+        {
+            auto k = work[j];
+            if (k == prev || k == curr || k == next)
+            { continue; }
+            if (inside(k, prev, curr, next))
+            { isEar = false; }
+        }
+
+        if (isEar)
+        {
+            result.push_back(prev);
+            result.push_back(curr);
+            result.push_back(next);
+            work.erase(work.begin() + (i % remain));
+            remain--;
+            guard = 0;
+            continue;
+        }
+
+        i = (i + 1) % remain;
+        if (++guard > remain)
+        {
+            // 退化した多角形.
+            for(auto j=1u; j+1<remain; ++j)
+            {
+                result.push_back(work[0]);
+                result.push_back(work[j]);
+                result.push_back(work[j + 1]);
+            }
+            return;
+        }
+    }
+
+    result.push_back(work[0]);
+    result.push_back(work[1]);
+    result.push_back(work[2]);
+}
+
+//-----------------------------------------------------------------------------
+//      スキンのボーン情報を読み込みます.
+//-----------------------------------------------------------------------------
+void ParseSkin
+(
+    const Scene&                        scene,
+    const Node*                         pSkin,
+    size_t                              controlPointCount,
+    std::vector<asdx::ResBoneIndex>&    boneIndices,
+    std::vector<asdx::Vector4>&         boneWeights
+)
+{
+    boneIndices.assign(controlPointCount, asdx::ResBoneIndex(0, 0, 0, 0));
+    boneWeights.assign(controlPointCount, asdx::Vector4(0.0f, 0.0f, 0.0f, 0.0f));
+
+    std::vector<uint8_t> used(controlPointCount, 0);
+
+    auto children = scene.Children.find(pSkin->Props[0].Integer);
+    if (children == scene.Children.end())
+    { return; }
+
+    std::vector<int32_t> indices;
+    std::vector<float>   weights;
+
+    uint16_t cluster = 0;
+    for(auto id : children->second)
+    {
+        auto object = scene.Objects.find(id);
+        if (object == scene.Objects.end() || object->second->Name != "Deformer" || GetObjectClass(object->second) != "Cluster")
+        { continue; }
+
+        auto boneIndex = cluster++;
+
+        auto pIndices = object->second->FindProp("Indexes");
+        auto pWeights = object->second->FindProp("Weights");
+        if (pIndices == nullptr || pWeights == nullptr || !pIndices->GetArray(indices) || !pWeights->GetArray(weights))
+        { continue; }
+
+        auto count = (indices.size() < weights.size()) ? indices.size() : weights.size();
+        for(size_t i=0; i<count; ++i)
+        {
+            auto cp = indices[i];
+            if (cp < 0 || size_t(cp) >= controlPointCount)
+            { continue; }
+
+            auto& slot   = used[cp];
+            auto& index  = boneIndices[cp];
+            auto& weight = boneWeights[cp];
+            auto  w      = weights[i];
+
+            uint16_t* pIndex  = &index.x;
+            float*    pWeight = &weight.x;
+            if (slot < 4)
+            {
+                pIndex [slot] = boneIndex;
+                pWeight[slot] = w;
+                slot++;
+                continue;
+            }
+
+            // 空きが無ければ一番ウェイトが小さいところを置き換える.
+            auto mini = 0;
+            for(auto k=1; k<4; ++k)
+            {
+                if (pWeight[k] < pWeight[mini])
+                { mini = k; }
+            }
+
+            if (pWeight[mini] < w)
+            {
+                pIndex [mini] = boneIndex;
+                pWeight[mini] = w;
+            }
+        }
+    }
+
+    // ウェイトを正規化.
+    for(auto& weight : boneWeights)
+    {
+        auto total = weight.x + weight.y + weight.z + weight.w;
+        if (total <= 0.0f)
+        { continue; }
+
+        weight.x /= total;
+        weight.y /= total;
+        weight.z /= total;
+        weight.w /= total;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ジオメトリをメッシュに変換します.
+//-----------------------------------------------------------------------------
+bool ConvertGeometry(const Scene& scene, GeometryJob& job)
+{
+    auto pGeometry = job.pGeometry;
+
+    std::vector<double>  vertices;
+    std::vector<int32_t> polygons;
+
+    auto pVertices = pGeometry->FindProp("Vertices");
+    auto pPolygons = pGeometry->FindProp("PolygonVertexIndex");
+    if (pVertices == nullptr || pPolygons == nullptr || !pVertices->GetArray(vertices) || !pPolygons->GetArray(polygons))
+    { return false; }
+
+    auto controlPointCount = vertices.size() / 3;
+
+    // スキンを持つ場合はワールド変換を頂点に焼き込む.
+    auto bake  = (job.pSkin != nullptr) && !job.Instances.empty();
+    auto world = bake ? job.Instances[0] : asdx::Matrix::CreateIdentity();
+    if (bake)
+    { job.Instances.clear(); }
+
+    std::vector<asdx::Vector3> points(controlPointCount);
+    for(size_t i=0; i<controlPointCount; ++i)
+    {
+        points[i] = asdx::Vector3(float(vertices[i * 3 + 0]), float(vertices[i * 3 + 1]), float(vertices[i * 3 + 2]));
+        if (bake)
+        { points[i] = asdx::Vector3::TransformCoord(points[i], world); }
+    }
+
+    // レイヤー要素 (レイヤー 0 の要素を使用. テクスチャ座標は FBX_MAX_UV_COUNT まで).
+    LayerElement normals;
+    LayerElement tangents;
+    LayerElement colors;
+    LayerElement texcoords[FBX_MAX_UV_COUNT];
+    LayerElement materials;
+    std::vector<int32_t> materialIndices;
+    auto uvCount = 0;
+
+    for(const auto& child : pGeometry->Children)
+    {
+        auto layer = (!child.Props.empty()) ? int(child.Props[0].Integer) : 0;
+
+        if (child.Name == "LayerElementNormal" && normals.Mapping == MAPPING_NONE && layer == 0)
+        { normals.Init(&child, "Normals", "NormalsIndex", 3); }
+        else if (child.Name == "LayerElementTangent" && tangents.Mapping == MAPPING_NONE && layer == 0)
+        { tangents.Init(&child, "Tangents", "TangentsIndex", 3); }
+        else if (child.Name == "LayerElementColor" && colors.Mapping == MAPPING_NONE && layer == 0)
+        { colors.Init(&child, "Colors", "ColorIndex", 4); }
+        else if (child.Name == "LayerElementUV" && uvCount < FBX_MAX_UV_COUNT)
+        {
+            if (texcoords[uvCount].Init(&child, "UV", "UVIndex", 2))
+            { uvCount++; }
+        }
+        else if (child.Name == "LayerElementMaterial" && materials.Mapping == MAPPING_NONE && layer == 0)
+        {
+            auto pMaterials = child.FindProp("Materials");
+            auto pMapping   = child.FindProp("MappingInformationType");
+            if (pMaterials != nullptr && pMaterials->GetArray(materialIndices))
+            { materials.Mapping = (pMapping != nullptr && pMapping->AsString() == "ByPolygon") ? MAPPING_BY_POLYGON : MAPPING_ALL_SAME; }
+        }
+    }
+
+    // 法線変換用の行列(焼き込み時のみ).
+    auto normalMatrix = bake ? asdx::Matrix::Transpose(asdx::Matrix::Invert(world)) : world;
+
+    std::vector<asdx::ResBoneIndex> boneIndices;
+    std::vector<asdx::Vector4>      boneWeights;
+    if (job.pSkin != nullptr)
+    { ParseSkin(scene, job.pSkin, controlPointCount, boneIndices, boneWeights); }
+
+    // マテリアルスロットごとにメッシュを用意.
+    auto slotCount = job.Materials.empty() ? size_t(1) : job.Materials.size();
+    job.Meshes.resize(slotCount);
+    for(size_t i=0; i<slotCount; ++i)
+    {
+        auto& mesh = job.Meshes[i];
+        mesh.MaterialName = job.Materials.empty() ? std::string() : job.Materials[i];
+    }
+
+    std::vector<asdx::Vector3> polygon;
+    std::vector<uint32_t>      work;
+    std::vector<uint32_t>      triangles;
+
+    size_t polygonIndex = 0;
+    size_t start        = 0;
+    for(size_t corner=0; corner<polygons.size(); ++corner)
+    {
+        // 負のインデックスが多角形の終端 (ビット反転で元の値).
+        if (polygons[corner] >= 0)
+        { continue; }
+
+        auto end   = corner + 1;
+        auto count = uint32_t(end - start);
+
+        size_t slot = 0;
+        if (materials.Mapping == MAPPING_BY_POLYGON && polygonIndex < materialIndices.size())
+        { slot = size_t(materialIndices[polygonIndex]); }
+        else if (materials.Mapping == MAPPING_ALL_SAME && !materialIndices.empty())
+        { slot = size_t(materialIndices[0]); }
+        if (slot >= slotCount)
+        { slot = 0; }
+
+        auto& mesh = job.Meshes[slot];
+        auto  base = uint32_t(mesh.Positions.size());
+        auto  valid = true;
+
+        polygon.clear();
+        for(auto i=start; i<end; ++i)
+        {
+            auto cp = polygons[i];
+            if (cp < 0)
+            { cp = ~cp; }
+
+            if (size_t(cp) >= controlPointCount)
+            {
+                valid = false;
+                break;
+            }
+
+            polygon.push_back(points[cp]);
+        }
+
+        if (valid && count >= 3)
+        {
+            for(auto i=start; i<end; ++i)
+            {
+                auto cp = polygons[i];
+                if (cp < 0)
+                { cp = ~cp; }
+
+                mesh.Positions.push_back(points[cp]);
+
+                if (normals.Mapping != MAPPING_NONE)
+                {
+                    auto v = normals.Get(polygonIndex, i, size_t(cp));
+                    auto n = (v != nullptr) ? asdx::Vector3(float(v[0]), float(v[1]), float(v[2])) : asdx::Vector3(0.0f, 0.0f, 1.0f);
+                    if (bake)
+                    {
+                        n = asdx::Vector3::TransformNormal(n, normalMatrix);
+                        n = asdx::Vector3::SafeNormalize(n, n);
+                    }
+                    mesh.Normals.push_back(n);
+                }
+
+                if (tangents.Mapping != MAPPING_NONE)
+                {
+                    auto v = tangents.Get(polygonIndex, i, size_t(cp));
+                    auto t = (v != nullptr) ? asdx::Vector3(float(v[0]), float(v[1]), float(v[2])) : asdx::Vector3(1.0f, 0.0f, 0.0f);
+                    if (bake)
+                    {
+                        t = asdx::Vector3::TransformNormal(t, world);
+                        t = asdx::Vector3::SafeNormalize(t, t);
+                    }
+                    mesh.Tangents.push_back(t);
+                }
+
+                if (colors.Mapping != MAPPING_NONE)
+                {
+                    auto v = colors.Get(polygonIndex, i, size_t(cp));
+                    mesh.Colors.push_back((v != nullptr)
+                        ? asdx::Vector4(float(v[0]), float(v[1]), float(v[2]), float(v[3]))
+                        : asdx::Vector4(1.0f, 1.0f, 1.0f, 1.0f));
+                }
+
+                for(auto layer=0; layer<uvCount; ++layer)
+                {
+                    auto v = texcoords[layer].Get(polygonIndex, i, size_t(cp));
+                    mesh.TexCoords[layer].push_back((v != nullptr)
+                        ? asdx::Vector2(float(v[0]), float(v[1]))
+                        : asdx::Vector2(0.0f, 0.0f));
+                }
+
+                if (!boneIndices.empty())
+                {
+                    mesh.BoneIndices.push_back(boneIndices[cp]);
+                    mesh.BoneWeights.push_back(boneWeights[cp]);
+                }
+            }
+
+            triangles.clear();
+            Triangulate(polygon.data(), count, work, triangles);
+            for(auto index : triangles)
+            { mesh.Indices.push_back(base + index); }
+        }
+
+        start = end;
+        polygonIndex++;
+    }
+
+    // 空のスロットを取り除き, 足りないデータを生成.
+    auto itr = job.Meshes.begin();
+    while(itr != job.Meshes.end())
+    {
+        if (itr->Indices.empty())
+        {
+            itr = job.Meshes.erase(itr);
+            continue;
+        }
+
+        // 法線・接線データが無ければ生成.
+        if (!GenerateTangentSpace(*itr))
+        { return false; }
+
+        ++itr;
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// FBXReader class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      バイナリ形式のFBXファイルをロードします.
+//-----------------------------------------------------------------------------
+bool FBXReader::Load(const char* path, asdx::ResModel& model)
+{
+    m_Instances.clear();
+
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    auto pData = file.GetData();
+    auto size  = file.GetSize();
+
+    // ヘッダーチェック. ASCII形式は扱わない.
+    if (size < FBX_HEADER_SIZE || memcmp(pData, FBX_MAGIC, sizeof(FBX_MAGIC)) != 0)
+    {
+        ILOGA("Info : Not Binary FBX. path = %s", path);
+        return false;
+    }
+
+    uint32_t version;
+    memcpy(&version, pData + 23, sizeof(version));
+    if (version < FBX_MIN_VERSION)
+    {
+        ILOGA("Info : Unsupported FBX Version. path = %s, version = %u", path, version);
+        return false;
+    }
+
+    // ノードツリーを解析.
+    std::vector<Node> roots;
+    {
+        Parser parser(pData, size, version);
+        size_t offset = FBX_HEADER_SIZE;
+        if (!parser.ParseList(offset, size, roots, 0))
+        {
+            ELOGA("Error : FBX Node Parse Failed. path = %s", path);
+            return false;
+        }
+    }
+
+    Node*       pObjects     = nullptr;
+    const Node* pConnections = nullptr;
+    const Node* pSettings    = nullptr;
+    for(auto& node : roots)
+    {
+        if (node.Name == "Objects")
+        { pObjects = &node; }
+        else if (node.Name == "Connections")
+        { pConnections = &node; }
+        else if (node.Name == "GlobalSettings")
+        { pSettings = &node; }
+    }
+
+    if (pObjects == nullptr)
+    {
+        ELOGA("Error : FBX Objects Not Found. path = %s", path);
+        return false;
+    }
+
+    // 圧縮配列を並列に展開する. 対象はジオメトリとデフォーマのみ.
+    {
+        std::vector<Property*> arrays;
+        for(auto& object : pObjects->Children)
+        {
+            if (object.Name != "Geometry" && object.Name != "Deformer")
+            { continue; }
+
+            std::vector<Node*> stack;
+            stack.push_back(&object);
+            while(!stack.empty())
+            {
+                auto pNode = stack.back();
+                stack.pop_back();
+
+                for(auto& prop : pNode->Props)
+                {
+                    if (prop.IsArray() && prop.Encoding == 1)
+                    { arrays.push_back(&prop); }
+                }
+
+                for(auto& child : pNode->Children)
+                { stack.push_back(&child); }
+            }
+        }
+
+        std::atomic<bool> failed(false);
+        ParallelFor(arrays.size(), [&](size_t index)
+        {
+            auto& prop = *arrays[index];
+            prop.Decoded.resize(size_t(prop.Count) * prop.GetElementSize());
+            if (!Inflater::Decode(prop.pData, prop.Size, prop.Decoded.data(), prop.Decoded.size()))
+            { failed = true; }
+        });
+
+        if (failed)
+        {
+            ELOGA("Error : FBX Array Decompress Failed. path = %s", path);
+            return false;
+        }
+    }
+
+    // オブジェクトと接続情報.
+    Scene scene;
+    for(const auto& object : pObjects->Children)
+    {
+        if (!object.Props.empty() && object.Props[0].Type == 'L')
+        { scene.Objects[object.Props[0].Integer] = &object; }
+    }
+
+    if (pConnections != nullptr)
+    {
+        for(const auto& c : pConnections->Children)
+        {
+            if (c.Name != "C" || c.Props.size() < 3)
+            { continue; }
+
+            auto child  = c.Props[1].Integer;
+            auto parent = c.Props[2].Integer;
+            scene.Children[parent].push_back(child);
+
+            if (c.Props[0].AsString() == "OO")
+            { scene.Parents[child] = parent; }
+        }
+    }
+
+    // 単位変換 (FBXLoader と同じく, センチメートル以外はメートルに変換).
+    if (pSettings != nullptr)
+    {
+        auto factor = GetP1(pSettings, "UnitScaleFactor", 1.0);
+        if (factor != 1.0)
+        { scene.UnitScale = factor / 100.0; }
+    }
+
+    // マテリアル.
+    std::unordered_map<int64_t, uint32_t> materialIndices;
+    for(const auto& object : pObjects->Children)
+    {
+        if (object.Name != "Material" || object.Props.empty())
+        { continue; }
+
+        materialIndices[object.Props[0].Integer] = uint32_t(model.Materials.size());
+
+        asdx::ResMaterial material;
+        material.Name = GetObjectName(&object);
+        model.Materials.emplace_back(material);
+    }
+
+    // メッシュモデルをジオメトリとマテリアル構成ごとにまとめ, 参照をインスタンスとする.
+    std::vector<GeometryJob>                    jobs;
+    std::unordered_map<std::string, size_t>     jobMap;
+    std::unordered_map<int64_t, asdx::Matrix>   worldCache;
+
+    for(const auto& object : pObjects->Children)
+    {
+        if (object.Name != "Model" || object.Props.empty() || GetObjectClass(&object) != "Mesh")
+        { continue; }
+
+        auto modelId  = object.Props[0].Integer;
+        auto children = scene.Children.find(modelId);
+        if (children == scene.Children.end())
+        { continue; }
+
+        const Node*              pGeometry = nullptr;
+        std::vector<std::string> materials;
+        std::string              key;
+        for(auto id : children->second)
+        {
+            auto child = scene.Objects.find(id);
+            if (child == scene.Objects.end())
+            { continue; }
+
+            if (child->second->Name == "Geometry" && pGeometry == nullptr && GetObjectClass(child->second) == "Mesh")
+            {
+                pGeometry = child->second;
+                key = std::to_string(id);
+            }
+            else if (child->second->Name == "Material")
+            {
+                materials.push_back(GetObjectName(child->second));
+                key += ":" + std::to_string(id);
+            }
+        }
+
+        if (pGeometry == nullptr)
+        { continue; }
+
+        auto world = GetGeometricMatrix(&object) * GetWorldMatrix(scene, modelId, worldCache, 0);
+
+        // スキン.
+        const Node* pSkin = nullptr;
+        auto deformers = scene.Children.find(pGeometry->Props[0].Integer);
+        if (deformers != scene.Children.end())
+        {
+            for(auto id : deformers->second)
+            {
+                auto child = scene.Objects.find(id);
+                if (child != scene.Objects.end() && child->second->Name == "Deformer" && GetObjectClass(child->second) == "Skin")
+                {
+                    pSkin = child->second;
+                    break;
+                }
+            }
+        }
+
+        // スキンを持つメッシュはインスタンス化しない.
+        if (pSkin != nullptr)
+        { key += "#" + std::to_string(modelId); }
+
+        auto itr = jobMap.find(key);
+        if (itr != jobMap.end())
+        {
+            jobs[itr->second].Instances.push_back(world);
+            continue;
+        }
+
+        jobMap[key] = jobs.size();
+
+        GeometryJob job;
+        job.pGeometry = pGeometry;
+        job.Materials = std::move(materials);
+        job.pSkin     = pSkin;
+        job.Instances.push_back(world);
+        jobs.emplace_back(std::move(job));
+    }
+
+    // ジオメトリ単位で並列に変換.
+    std::atomic<bool> failed(false);
+    ParallelFor(jobs.size(), [&](size_t index)
+    {
+        if (!ConvertGeometry(scene, jobs[index]))
+        { failed = true; }
+    });
+
+    if (failed)
+    {
+        ELOGA("Error : FBX Geometry Convert Failed. path = %s", path);
+        return false;
+    }
+
+    for(auto& job : jobs)
+    {
+        for(auto& mesh : job.Meshes)
+        {
+            mesh.MeshName = "mesh" + std::to_string(model.Meshes.size());
+            model.Meshes.emplace_back(std::move(mesh));
+            m_Instances.push_back(job.Instances);
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      インスタンス行列を取得します.
+//-----------------------------------------------------------------------------
+const std::vector<std::vector<asdx::Matrix>>& FBXReader::GetInstances() const
+{ return m_Instances; }
@@ -30,6 +30,11 @@
 
 namespace asura {
 
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kUserRegisterStart = 11;  // ユーザー定義データの開始スロット番号(10番まではシステム使用).
+
 //-----------------------------------------------------------------------------
 //      シェーダタイプに対応する文字列を返却します.
 //-----------------------------------------------------------------------------
@@ -657,6 +662,72 @@ std::string ToFullPath(const char* path)
     return std::string(fullPath);
 }
 
+//-----------------------------------------------------------------------------
+//      HLSLのパッキング規則に従ってオフセットを調整します.
+//-----------------------------------------------------------------------------
+uint32_t AlignPackOffset(uint32_t offset, uint32_t size)
+{
+    // 16byte境界をまたぐ場合は次のレジスタから配置.
+    if ((offset % 16) + size > 16)
+    { offset = (offset + 15) & ~15u; }
+
+    return offset;
+}
+
+//-----------------------------------------------------------------------------
+//      バイトオフセットをpackoffset文字列に変換します.
+//-----------------------------------------------------------------------------
+std::string ToPackOffset(uint32_t offset)
+{
+    static const char kComponent[] = { 'x', 'y', 'z', 'w' };
+
+    char buf[64] = {};
+    sprintf_s(buf, "c%u.%c", offset / 16, kComponent[(offset % 16) / 4]);
+    return std::string(buf);
+}
+
+//-----------------------------------------------------------------------------
+//      シェーダリソースビューとして扱うリソースタイプかどうか?
+//-----------------------------------------------------------------------------
+bool IsSRVResource(RESOURCE_TYPE type)
+{ return type <= RESOURCE_TYPE_BYTEADDRESS_BUFFER; }
+
+//-----------------------------------------------------------------------------
+//      プロパティタイプをリソースタイプに変換します.
+//-----------------------------------------------------------------------------
+RESOURCE_TYPE ToResourceType(PROPERTY_TYPE type)
+{
+    switch(type)
+    {
+    case PROPERTY_TYPE_TEXTURE1D:           return RESOURCE_TYPE_TEXTURE1D;
+    case PROPERTY_TYPE_TEXTURE1D_ARRAY:     return RESOURCE_TYPE_TEXTURE1DARRAY;
+    case PROPERTY_TYPE_TEXTURE2D_ARRAY:     return RESOURCE_TYPE_TEXTURE2DARRAY;
+    case PROPERTY_TYPE_TEXTURE3D:           return RESOURCE_TYPE_TEXTURE3D;
+    case PROPERTY_TYPE_TEXTURECUBE:         return RESOURCE_TYPE_TEXTURECUBE;
+    case PROPERTY_TYPE_TEXTURECUBE_ARRAY:   return RESOURCE_TYPE_TEXTURECUBEARRAY;
+    default:                                return RESOURCE_TYPE_TEXTURE2D;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      プロパティタイプをメンバー型に変換します.
+//-----------------------------------------------------------------------------
+MEMBER_TYPE ToMemberType(PROPERTY_TYPE type)
+{
+    switch(type)
+    {
+    case PROPERTY_TYPE_BOOL:    return MEMBER_TYPE_INT; // シェーダ上では int として宣言.
+    case PROPERTY_TYPE_INT:     return MEMBER_TYPE_INT;
+    case PROPERTY_TYPE_FLOAT:   return MEMBER_TYPE_FLOAT;
+    case PROPERTY_TYPE_FLOAT2:  return MEMBER_TYPE_FLOAT2;
+    case PROPERTY_TYPE_FLOAT3:  return MEMBER_TYPE_FLOAT3;
+    case PROPERTY_TYPE_FLOAT4:  return MEMBER_TYPE_FLOAT4;
+    case PROPERTY_TYPE_COLOR3:  return MEMBER_TYPE_FLOAT3;
+    case PROPERTY_TYPE_COLOR4:  return MEMBER_TYPE_FLOAT4;
+    default:                    return MEMBER_TYPE_UNKNOWN;
+    }
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // FxParser class
@@ -2080,12 +2151,33 @@ void FxParser::ParseConstantBufferMember
     }
 
     m_Tokenizer.Next();
-    if (m_Tokenizer.Compare("packoffset"))
+    if (m_Tokenizer.Compare(":"))
+    { m_Tokenizer.Next(); }
+
+    if (m_Tokenizer.CompareAsLower("packoffset"))
     {
-        auto offsetStr  = std::string(m_Tokenizer.GetAsChar());
-        pos = offsetStr.find(";");
-        auto offset     = std::stoi(offsetStr.substr(1, pos));
-        member.PackOffset = uint32_t(offset);
+        // 次のフォーマット.
+        // name : packoffset(c16.w);
+        m_Tokenizer.Next();
+        assert(m_Tokenizer.Compare("("));
+        auto offsetStr = std::string(m_Tokenizer.NextAsChar());
+
+        // バイト単位のオフセットに変換.
+        auto offset = uint32_t(std::stoi(offsetStr.substr(1))) * 16;
+        pos = offsetStr.find(".");
+        if (pos != std::string::npos && pos + 1 < offsetStr.size())
+        {
+            switch(offsetStr[pos + 1])
+            {
+            case 'y': case 'g': offset += 4;  break;
+            case 'z': case 'b': offset += 8;  break;
+            case 'w': case 'a': offset += 12; break;
+            }
+        }
+        member.PackOffset = offset;
+
+        m_Tokenizer.Next();
+        assert(m_Tokenizer.Compare(")"));
     }
 
     buffer.Members.push_back(member);
@@ -2659,6 +2751,8 @@ void FxParser::ParseProperties()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(";"));
 
+            offset = AlignPackOffset(offset, sizeof(int));
+
             ValueProperty prop;
             prop.Name           = name;
             prop.DisplayTag     = display_tag;
@@ -2707,6 +2801,8 @@ void FxParser::ParseProperties()
             m_Tokenizer.Next();
             assert(m_Tokenizer.Compare(";"));
 
+            offset = AlignPackOffset(offset, sizeof(int));
+
             ValueProperty prop;
             prop.Name           = name;
             prop.DisplayTag     = display_tag;
@@ -2757,6 +2853,8 @@ void FxParser::ParseProperties()
             m_Tokenizer.Next();
 
 
+            offset = AlignPackOffset(offset, sizeof(float));
+
             ValueProperty prop;
             prop.Name           = name;
             prop.DisplayTag     = display_tag;
@@ -2813,6 +2911,8 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare(";"));
             m_Tokenizer.Next();
 
+            offset = AlignPackOffset(offset, sizeof(float) * 2);
+
             ValueProperty prop;
             prop.Name           = name;
             prop.DisplayTag     = display_tag;
@@ -2871,6 +2971,8 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare(";"));
             m_Tokenizer.Next();
 
+            offset = AlignPackOffset(offset, sizeof(float) * 3);
+
             ValueProperty prop;
             prop.Name           = name;
             prop.DisplayTag     = display_tag;
@@ -2932,6 +3034,8 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare(";"));
             m_Tokenizer.Next();
 
+            offset = AlignPackOffset(offset, sizeof(float) * 4);
+
             ValueProperty prop;
             prop.Name           = name;
             prop.DisplayTag     = display_tag;
@@ -2977,6 +3081,8 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare(")"));
             m_Tokenizer.Next();
 
+            offset = AlignPackOffset(offset, sizeof(float) * 3);
+
             ValueProperty prop;
             prop.Name           = name;
             prop.DisplayTag     = display_tag;
@@ -3022,6 +3128,8 @@ void FxParser::ParseProperties()
             assert(m_Tokenizer.Compare(")"));
             m_Tokenizer.Next();
 
+            offset = AlignPackOffset(offset, sizeof(float) * 4);
+
             ValueProperty prop;
             prop.Name           = name;
             prop.DisplayTag     = display_tag;
@@ -3079,13 +3187,46 @@ void FxParser::ParseProperties()
 
     m_Properties.BufferSize = offset;
 
+    // リフレクション無しでバインドできるようにレジスタ番号を確定させる.
+    // 既に明示的に割り当てられているスロットの後ろから詰める.
+    uint32_t regCBV = kUserRegisterStart;
+    uint32_t regSRV = kUserRegisterStart;
+    for(auto& itr : m_ConstantBuffers)
+    {
+        if (itr.second.Register != uint32_t(-1) && itr.second.Register >= regCBV)
+        { regCBV = itr.second.Register + 1; }
+    }
+    for(auto& itr : m_Resources)
+    {
+        if (!IsSRVResource(itr.second.ResourceType))
+        { continue; }
+
+        if (itr.second.Register != uint32_t(-1) && itr.second.Register >= regSRV)
+        { regSRV = itr.second.Register + 1; }
+    }
+
     if (!m_Properties.Values.empty())
     {
-        m_SourceCode += "cbuffer CbProperties\n";
+        ConstantBuffer buffer = {};
+        buffer.Name     = "CbProperties";
+        buffer.Register = regCBV;
+
+        m_SourceCode += "cbuffer CbProperties : register(b";
+        m_SourceCode += std::to_string(regCBV);
+        m_SourceCode += ")\n";
         m_SourceCode += "{\n";
 
         for(auto& prop : m_Properties.Values)
         {
+            Member member = {};
+            member.Name         = prop.Name;
+            member.Type         = ToMemberType(prop.Type);
+            member.Modifier     = TYPE_MODIFIER_NONE;
+            member.PackOffset   = prop.Offset;
+            buffer.Members.push_back(member);
+
+            auto decl = " : packoffset(" + ToPackOffset(prop.Offset) + ");";
+
             m_SourceCode += "    ";
             switch(prop.Type)
             {
@@ -3094,7 +3235,7 @@ void FxParser::ParseProperties()
                     m_SourceCode += "int";
                     m_SourceCode += " ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3106,7 +3247,7 @@ void FxParser::ParseProperties()
                     m_SourceCode += "int";
                     m_SourceCode += " ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3118,7 +3259,7 @@ void FxParser::ParseProperties()
                     m_SourceCode += "float";
                     m_SourceCode += " ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3130,7 +3271,7 @@ void FxParser::ParseProperties()
                     m_SourceCode += "float2";
                     m_SourceCode += " ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3142,7 +3283,7 @@ void FxParser::ParseProperties()
                     m_SourceCode += "float3";
                     m_SourceCode += " ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3154,7 +3295,7 @@ void FxParser::ParseProperties()
                     m_SourceCode += "float4";
                     m_SourceCode += " ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3166,7 +3307,7 @@ void FxParser::ParseProperties()
                     m_SourceCode += "float3";
                     m_SourceCode += " ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3178,7 +3319,7 @@ void FxParser::ParseProperties()
                     m_SourceCode += "float4";
                     m_SourceCode += " ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3188,19 +3329,33 @@ void FxParser::ParseProperties()
         }
 
         m_SourceCode += "};\n\n";
+
+        if (m_ConstantBuffers.find(buffer.Name) == m_ConstantBuffers.end())
+        { m_ConstantBuffers[buffer.Name] = buffer; }
     }
 
     if (!m_Properties.Textures.empty())
     {
         for(auto& prop : m_Properties.Textures)
         {
+            Resource res = {};
+            res.Name            = prop.Name;
+            res.ResourceType    = ToResourceType(prop.Type);
+            res.DataType        = MEMBER_TYPE_FLOAT4;
+            res.Register        = regSRV++;
+
+            if (m_Resources.find(res.Name) == m_Resources.end())
+            { m_Resources[res.Name] = res; }
+
+            auto decl = " : register(t" + std::to_string(res.Register) + ");";
+
             switch(prop.Type)
             {
             case PROPERTY_TYPE_TEXTURE1D:
                 {
                     m_SourceCode += "Texture1D ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3211,7 +3366,7 @@ void FxParser::ParseProperties()
                 {
                     m_SourceCode += "Texture1DArray ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3222,7 +3377,7 @@ void FxParser::ParseProperties()
                 {
                     m_SourceCode += "Texture2D ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3233,7 +3388,7 @@ void FxParser::ParseProperties()
                 {
                     m_SourceCode += "Texture2DArray ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3244,7 +3399,7 @@ void FxParser::ParseProperties()
                 {
                     m_SourceCode += "Texture3D ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3255,7 +3410,7 @@ void FxParser::ParseProperties()
                 {
                     m_SourceCode += "TextureCube ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -3266,7 +3421,7 @@ void FxParser::ParseProperties()
                 {
                     m_SourceCode += "TextureCubeArray ";
                     m_SourceCode += prop.Name;
-                    m_SourceCode += ";";
+                    m_SourceCode += decl;
                     m_SourceCode += "    //";
                     m_SourceCode += prop.DisplayTag;
                     m_SourceCode += "\n";
@@ -7,14 +7,20 @@
 #define TINYGLTF_IMPLEMENTATION
 #define TINYGLTF_NO_STB_IMAGE
 #define TINYGLTF_NO_STB_IMAGE_WRITE
+#define TINYGLTF_NO_EXTERNAL_IMAGE
 
 //-----------------------------------------------------------------------------
 // Includes
 //-----------------------------------------------------------------------------
 #include <GLTFLoader.h>
+#include <MappedFile.h>
+#include <ParallelFor.h>
+#include <TangentSpace.h>
 #include <asdxMisc.h>
 #include <asdxLogger.h>
 #include <tiny_gltf.h>
+#include <meshoptimizer.h>
+#include <emmintrin.h>
 
 
 namespace {
@@ -29,6 +35,13 @@ static const char* TAG_COLOR        = "COLOR_0";
 static const char* TAG_BONEINDEX    = "JOINTS_0";
 static const char* TAG_BONEWEIGHT   = "WEIGHTS_0";
 static const char* TAG_TEXCOORD[MAX_LAYER_COUNT] = { "TEXCOORD_0", "TEXCOORD_1", "TEXCOORD_2", "TEXCOORD_3" };
+static const uint32_t GLB_MAGIC              = 0x46546C67;   // "glTF"
+static const uint32_t GLB_CHUNK_JSON         = 0x4E4F534A;   // "JSON"
+static const uint32_t GLB_CHUNK_BIN          = 0x004E4942;   // "BIN\0"
+static const size_t   GLB_HEADER_SIZE        = 12;
+static const size_t   GLB_CHUNK_HEADER_SIZE  = 8;
+static const char*    EXT_MESHOPT            = "EXT_meshopt_compression";
+static const char*    KHR_TEXTURE_TRANSFORM  = "KHR_texture_transform";
 
 
 //-----------------------------------------------------------------------------
@@ -81,411 +94,1239 @@ static void QuatToAngleAxis
     axis[2] = float(qz / denom);
 }
 
-} // namespace
+//-----------------------------------------------------------------------------
+//      ノードのローカル行列を取得します.
+//-----------------------------------------------------------------------------
+asdx::Matrix GetLocalMatrix(const tinygltf::Node& node)
+{
+    if (node.matrix.size() == 16)
+    {
+        asdx::Matrix matrix;
+        matrix.row[0] = asdx::Vector4(float(node.matrix[0]),  float(node.matrix[1]),  float(node.matrix[2]),  float(node.matrix[3]));
+        matrix.row[1] = asdx::Vector4(float(node.matrix[4]),  float(node.matrix[5]),  float(node.matrix[6]),  float(node.matrix[7]));
+        matrix.row[2] = asdx::Vector4(float(node.matrix[8]),  float(node.matrix[9]),  float(node.matrix[10]), float(node.matrix[11]));
+        matrix.row[3] = asdx::Vector4(float(node.matrix[12]), float(node.matrix[13]), float(node.matrix[14]), float(node.matrix[15]));
+        return matrix;
+    }
 
+    asdx::Matrix matrix = asdx::Matrix::CreateIdentity();
 
-///////////////////////////////////////////////////////////////////////////////
-// GLTFLoader class
-///////////////////////////////////////////////////////////////////////////////
+    if (node.scale.size() == 3)
+    {
+        matrix *= asdx::Matrix::CreateScale(
+            float(node.scale[0]),
+            float(node.scale[1]),
+            float(node.scale[2]));
+    }
+
+    if (node.rotation.size() == 4)
+    {
+        float angleRad;
+        float axis[3];
+        QuatToAngleAxis(node.rotation, angleRad, axis);
+
+        matrix *= asdx::Matrix::CreateFromAxisAngle(
+            asdx::Vector3(axis[0], axis[1], axis[2]), angleRad);
+    }
+
+    if (node.translation.size() == 3)
+    {
+        matrix *= asdx::Matrix::CreateTranslation(
+            float(node.translation[0]),
+            float(node.translation[1]),
+            float(node.translation[2]));
+    }
+
+    return matrix;
+}
 
 //-----------------------------------------------------------------------------
-//      ファイルをロードします.
+//      ノード階層をたどり, メッシュごとのインスタンス行列を求めます.
 //-----------------------------------------------------------------------------
-bool GLTFLoader::Load(const char* path, asdx::ResModel& model)
+void CollectInstances
+(
+    const tinygltf::Model&                  model,
+    std::vector<std::vector<asdx::Matrix>>& instances
+)
 {
-    auto ext = asdx::GetExtA(path);
+    instances.clear();
+    instances.resize(model.meshes.size());
 
-    tinygltf::Model gltfModel;
+    auto nodeCount = model.nodes.size();
 
-    if (ext == "gltf")
+    // ルートノードを決定. シーンが無ければ親を持たないノード全て.
+    std::vector<int> roots;
+    auto sceneIndex = (model.defaultScene >= 0) ? model.defaultScene : (model.scenes.empty() ? -1 : 0);
+    if (sceneIndex >= 0 && size_t(sceneIndex) < model.scenes.size())
+    {
+        roots = model.scenes[sceneIndex].nodes;
+    }
+    else
+    {
+        std::vector<bool> hasParent(nodeCount, false);
+        for(const auto& node : model.nodes)
+        {
+            for(auto child : node.children)
+            {
+                if (child >= 0 && size_t(child) < nodeCount)
+                { hasParent[child] = true; }
+            }
+        }
+
+        for(size_t i=0; i<nodeCount; ++i)
+        {
+            if (!hasParent[i])
+            { roots.push_back(int(i)); }
+        }
+    }
+
+    struct Entry
+    {
+        int             Node;
+        asdx::Matrix    Parent;
+    };
+
+    // 親の行列を積算しながら深さ優先でたどる. 不正な循環参照は一度しか訪れない.
+    std::vector<bool>  visited(nodeCount, false);
+    std::vector<Entry> stack;
+    for(auto itr = roots.rbegin(); itr != roots.rend(); ++itr)
+    { stack.push_back(Entry{ *itr, asdx::Matrix::CreateIdentity() }); }
+
+    while(!stack.empty())
+    {
+        auto entry = stack.back();
+        stack.pop_back();
+
+        if (entry.Node < 0 || size_t(entry.Node) >= nodeCount || visited[entry.Node])
+        { continue; }
+        visited[entry.Node] = true;
+
+        const auto& node = model.nodes[entry.Node];
+        auto world = GetLocalMatrix(node) * entry.Parent;
+
+        if (node.mesh >= 0 && size_t(node.mesh) < instances.size())
+        { instances[node.mesh].push_back(world); }
+
+        for(auto itr = node.children.rbegin(); itr != node.children.rend(); ++itr)
+        { stack.push_back(Entry{ *itr, world }); }
+    }
+
+    // どのノードからも参照されないメッシュは原点に1つ置く.
+    for(auto& matrices : instances)
+    {
+        if (matrices.empty())
+        { matrices.push_back(asdx::Matrix::CreateIdentity()); }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      EXT_meshopt_compression の代替バッファかどうかチェックします.
+//-----------------------------------------------------------------------------
+bool IsFallbackBuffer(const nlohmann::json& buffer)
+{
+    auto extensions = buffer.find("extensions");
+    if (extensions == buffer.end() || !extensions->is_object())
+    { return false; }
+
+    auto meshopt = extensions->find(EXT_MESHOPT);
+    if (meshopt == extensions->end() || !meshopt->is_object())
+    { return false; }
+
+    return meshopt->value("fallback", false);
+}
+
+//-----------------------------------------------------------------------------
+//      JSONを解析します.
+//-----------------------------------------------------------------------------
+bool ParseJSON
+(
+    const char*         path,
+    const char*         pJson,
+    size_t              jsonSize,
+    tinygltf::Model&    model,
+    int&                binBuffer,
+    const uint8_t*      pBinData,
+    size_t&             binSize
+)
+{
+    auto json = nlohmann::json::parse(pJson, pJson + jsonSize, nullptr, false);
+    if (json.is_discarded() || !json.is_object())
     {
-        tinygltf::TinyGLTF loader;
-        std::string err;
-        std::string warn;
+        ELOGA("Error : JSON Parse Failed. path = %s", path);
+        return false;
+    }
 
-        loader.SetImageLoader(DummyLoadImage,  nullptr);
-        loader.SetImageWriter(DummyWriteImage, nullptr);
+    // BINチャンクを参照するバッファを1バイトのデータURIに差し替えて, tinygltf にコピーさせない.
+    // (tinygltf は空のデータURIを受け付けない).
+    auto buffers = json.find("buffers");
+    if (buffers != json.end() && buffers->is_array())
+    {
+        for(size_t i=0; i<buffers->size(); ++i)
+        {
+            auto& buffer = (*buffers)[i];
+            if (buffer.find("uri") != buffer.end())
+            { continue; }
+
+            // EXT_meshopt_compression の代替バッファは実体が無いので, 参照されない前提で差し替えるだけ.
+            if (IsFallbackBuffer(buffer))
+            {
+                buffer["uri"]        = "data:application/octet-stream;base64,AA==";
+                buffer["byteLength"] = 1;
+                continue;
+            }
+
+            auto byteLength = buffer.value("byteLength", size_t(0));
+            if (binBuffer != -1 || pBinData == nullptr || byteLength > binSize)
+            {
+                ELOGA("Error : Invalid GLB Buffer. path = %s, index = %zu", path, i);
+                return false;
+            }
+
+            binBuffer            = int(i);
+            binSize              = byteLength;
+            buffer["uri"]        = "data:application/octet-stream;base64,AA==";
+            buffer["byteLength"] = 1;
+        }
+    }
 
-        if (!loader.LoadASCIIFromFile(&gltfModel, &err, &warn, path))
+    // 埋め込み画像は使用しないので, バッファビュー参照を外す.
+    auto images = json.find("images");
+    if (images != json.end() && images->is_array())
+    {
+        for(auto& image : *images)
         {
-            if (!warn.empty())
-            { WLOGA("Warning : %s", warn.c_str()); }
+            if (image.find("bufferView") == image.end())
+            { continue; }
+
+            image.erase("bufferView");
+            image.erase("mimeType");
+            image["uri"] = "";
+        }
+    }
+
+    auto text = json.dump();
+
+    tinygltf::TinyGLTF loader;
+    std::string err;
+    std::string warn;
+
+    loader.SetImageLoader(DummyLoadImage,  nullptr);
+    loader.SetImageWriter(DummyWriteImage, nullptr);
+
+    if (!loader.LoadASCIIFromString(&model, &err, &warn, text.c_str(), uint32_t(text.size()), asdx::GetDirectoryPathA(path)))
+    {
+        if (!warn.empty())
+        { WLOGA("Warning : %s", warn.c_str()); }
+
+        ELOGA("Error : TinyGLTF::LoadASCIIFromString() Failed. err = %s", err.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      glTFファイルをメモリマップでロードします.
+//-----------------------------------------------------------------------------
+bool LoadGLTF(const char* path, MappedFile& file, tinygltf::Model& model)
+{
+    if (!file.Open(path))
+    { return false; }
+
+    int    binBuffer = -1;
+    size_t binSize   = 0;
+    auto   pJson     = reinterpret_cast<const char*>(file.GetData());
+    return ParseJSON(path, pJson, file.GetSize(), model, binBuffer, nullptr, binSize);
+}
+
+//-----------------------------------------------------------------------------
+//      GLBファイルをメモリマップでロードします.
+//-----------------------------------------------------------------------------
+bool LoadGLB
+(
+    const char*         path,
+    MappedFile&         file,
+    tinygltf::Model&    model,
+    int&                binBuffer,
+    const uint8_t*&     pBinData,
+    size_t&             binSize
+)
+{
+    binBuffer = -1;
+    pBinData  = nullptr;
+    binSize   = 0;
+
+    if (!file.Open(path))
+    { return false; }
+
+    auto pData = file.GetData();
+    auto size  = file.GetSize();
+
+    auto readU32 = [&](size_t offset)
+    {
+        uint32_t value;
+        memcpy(&value, pData + offset, sizeof(value));
+        return value;
+    };
+
+    // ヘッダーチェック.
+    if (size < GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE
+     || readU32(0) != GLB_MAGIC
+     || readU32(4) != 2
+     || readU32(8) > size)
+    {
+        ELOGA("Error : Invalid GLB Header. path = %s", path);
+        return false;
+    }
+
+    auto totalSize = size_t(readU32(8));
+
+    // JSONチャンク.
+    auto jsonSize = size_t(readU32(GLB_HEADER_SIZE + 0));
+    auto jsonType = readU32(GLB_HEADER_SIZE + 4);
+    auto pJson    = reinterpret_cast<const char*>(pData + GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE);
+    if (jsonType != GLB_CHUNK_JSON || GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + jsonSize > totalSize)
+    {
+        ELOGA("Error : Invalid GLB JSON Chunk. path = %s", path);
+        return false;
+    }
 
-            ELOGA("Error : TinyGLTF::LoadASCIIFromFile() Failed. err = %s", err.c_str());
+    // BINチャンク(省略可). コピーせずマップされた領域を直接参照する.
+    auto binOffset = GLB_HEADER_SIZE + GLB_CHUNK_HEADER_SIZE + jsonSize;
+    if (binOffset + GLB_CHUNK_HEADER_SIZE <= totalSize && readU32(binOffset + 4) == GLB_CHUNK_BIN)
+    {
+        auto chunkSize = size_t(readU32(binOffset));
+        if (binOffset + GLB_CHUNK_HEADER_SIZE + chunkSize > totalSize)
+        {
+            ELOGA("Error : Invalid GLB BIN Chunk. path = %s", path);
             return false;
         }
+
+        pBinData = pData + binOffset + GLB_CHUNK_HEADER_SIZE;
+        binSize  = chunkSize;
     }
-    else if (ext == "glb")
+
+    return ParseJSON(path, pJson, jsonSize, model, binBuffer, pBinData, binSize);
+}
+
+//-----------------------------------------------------------------------------
+//      8bit符号なし整数を浮動小数に変換します.
+//-----------------------------------------------------------------------------
+void ConvertU8ToFloat(const uint8_t* pSrc, float* pDst, size_t count, float scale)
+{
+    size_t i = 0;
+
+    auto zero = _mm_setzero_si128();
+    auto s    = _mm_set1_ps(scale);
+    for(; i + 16 <= count; i += 16)
+    {
+        auto v  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+        auto lo = _mm_unpacklo_epi8(v, zero);
+        auto hi = _mm_unpackhi_epi8(v, zero);
+
+        _mm_storeu_ps(pDst + i +  0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), s));
+        _mm_storeu_ps(pDst + i +  4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), s));
+        _mm_storeu_ps(pDst + i +  8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), s));
+        _mm_storeu_ps(pDst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), s));
+    }
+
+    for(; i<count; ++i)
+    { pDst[i] = float(pSrc[i]) * scale; }
+}
+
+//-----------------------------------------------------------------------------
+//      16bit符号なし整数を浮動小数に変換します.
+//-----------------------------------------------------------------------------
+void ConvertU16ToFloat(const uint16_t* pSrc, float* pDst, size_t count, float scale)
+{
+    size_t i = 0;
+
+    auto zero = _mm_setzero_si128();
+    auto s    = _mm_set1_ps(scale);
+    for(; i + 8 <= count; i += 8)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i));
+
+        _mm_storeu_ps(pDst + i + 0, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), s));
+        _mm_storeu_ps(pDst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), s));
+    }
+
+    for(; i<count; ++i)
+    { pDst[i] = float(pSrc[i]) * scale; }
+}
+
+//-----------------------------------------------------------------------------
+//      要素を変換しながらコピーします.
+//-----------------------------------------------------------------------------
+template<typename Src, typename Dst, typename Convert>
+void DecodeElements
+(
+    const uint8_t*  pSrc,
+    size_t          stride,
+    size_t          count,
+    uint32_t        srcComponents,
+    Dst*            pDst,
+    uint32_t        dstComponents,
+    Dst             fill,
+    Convert         convert
+)
+{
+    auto n = (srcComponents < dstComponents) ? srcComponents : dstComponents;
+
+    for(size_t i=0; i<count; ++i)
+    {
+        Src src[4];
+        memcpy(src, pSrc + stride * i, sizeof(Src) * n);
+
+        auto dst = pDst + i * dstComponents;
+
+        uint32_t c = 0;
+        for(; c<n; ++c)
+        { dst[c] = convert(src[c]); }
+
+        for(; c<dstComponents; ++c)
+        { dst[c] = fill; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      浮動小数に変換しながらコピーします.
+//-----------------------------------------------------------------------------
+bool DecodeFloat
+(
+    const uint8_t*  pSrc,
+    size_t          stride,
+    size_t          count,
+    int             componentType,
+    bool            normalized,
+    uint32_t        srcComponents,
+    float*          pDst,
+    uint32_t        dstComponents,
+    float           fill
+)
+{
+    auto packed = (srcComponents == dstComponents)
+               && (stride == size_t(tinygltf::GetComponentSizeInBytes(componentType)) * srcComponents);
+
+    switch(componentType)
     {
-        tinygltf::TinyGLTF loader;
-        std::string err;
-        std::string warn;
+    case TINYGLTF_COMPONENT_TYPE_FLOAT:
+        {
+            if (packed)
+            { memcpy(pDst, pSrc, sizeof(float) * count * dstComponents); }
+            else
+            { DecodeElements<float>(pSrc, stride, count, srcComponents, pDst, dstComponents, fill, [](float v) { return v; }); }
+        }
+        break;
+
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        {
+            auto scale = normalized ? 1.0f / 255.0f : 1.0f;
+            if (packed)
+            { ConvertU8ToFloat(pSrc, pDst, count * dstComponents, scale); }
+            else
+            { DecodeElements<uint8_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, fill, [scale](uint8_t v) { return float(v) * scale; }); }
+        }
+        break;
 
-        loader.SetImageLoader(DummyLoadImage,  nullptr);
-        loader.SetImageWriter(DummyWriteImage, nullptr);
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        {
+            auto scale = normalized ? 1.0f / 65535.0f : 1.0f;
+            if (packed)
+            { ConvertU16ToFloat(reinterpret_cast<const uint16_t*>(pSrc), pDst, count * dstComponents, scale); }
+            else
+            { DecodeElements<uint16_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, fill, [scale](uint16_t v) { return float(v) * scale; }); }
+        }
+        break;
 
-        if (!loader.LoadBinaryFromFile(&gltfModel, &err, &warn, path))
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
         {
-            if (!warn.empty())
-            { WLOGA("Warning : %s", warn.c_str()); }
+            // 符号付き正規化は -128 を -1.0 にクランプする.
+            if (normalized)
+            { DecodeElements<int8_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, fill, [](int8_t v) { auto f = float(v) / 127.0f; return (f < -1.0f) ? -1.0f : f; }); }
+            else
+            { DecodeElements<int8_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, fill, [](int8_t v) { return float(v); }); }
+        }
+        break;
 
-            ELOGA("Error : TinyGLTF::LoadBinaryFromFile() Failed. err = %s", err.c_str());
-            return false;
+    case TINYGLTF_COMPONENT_TYPE_SHORT:
+        {
+            if (normalized)
+            { DecodeElements<int16_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, fill, [](int16_t v) { auto f = float(v) / 32767.0f; return (f < -1.0f) ? -1.0f : f; }); }
+            else
+            { DecodeElements<int16_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, fill, [](int16_t v) { return float(v); }); }
         }
+        break;
+
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        { DecodeElements<uint32_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, fill, [](uint32_t v) { return float(v); }); }
+        break;
+
+    default:
+        return false;
     }
-    else
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      整数に変換しながらコピーします.
+//-----------------------------------------------------------------------------
+template<typename Dst>
+bool DecodeInteger
+(
+    const uint8_t*  pSrc,
+    size_t          stride,
+    size_t          count,
+    int             componentType,
+    uint32_t        srcComponents,
+    Dst*            pDst,
+    uint32_t        dstComponents
+)
+{
+    auto packed = (srcComponents == dstComponents) && (stride == sizeof(Dst) * srcComponents);
+
+    switch(componentType)
     {
-        ELOGA("Error : Unsupported Extension.");
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        { DecodeElements<uint8_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, Dst(0), [](uint8_t v) { return Dst(v); }); }
+        break;
+
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+        {
+            if (packed && sizeof(Dst) == sizeof(uint16_t))
+            { memcpy(pDst, pSrc, sizeof(Dst) * count * dstComponents); }
+            else
+            { DecodeElements<uint16_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, Dst(0), [](uint16_t v) { return Dst(v); }); }
+        }
+        break;
+
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+        {
+            if (packed && sizeof(Dst) == sizeof(uint32_t))
+            { memcpy(pDst, pSrc, sizeof(Dst) * count * dstComponents); }
+            else
+            { DecodeElements<uint32_t>(pSrc, stride, count, srcComponents, pDst, dstComponents, Dst(0), [](uint32_t v) { return Dst(v); }); }
+        }
+        break;
+
+    default:
         return false;
     }
 
-    auto meshCount = gltfModel.meshes.size();
+    return true;
+}
 
-    std::vector<asdx::Matrix>   transforms;
-    transforms.resize(meshCount);
+//-----------------------------------------------------------------------------
+//      EXT_meshopt_compression で圧縮されたバッファビューを展開します.
+//-----------------------------------------------------------------------------
+bool DecodeMeshopt
+(
+    const uint8_t*      pSrc,
+    size_t              srcSize,
+    const std::string&  mode,
+    const std::string&  filter,
+    size_t              count,
+    size_t              stride,
+    uint8_t*            pDst
+)
+{
+    if (mode == "ATTRIBUTES")
+    {
+        if (stride == 0 || stride % 4 != 0 || stride > 256)
+        { return false; }
 
-    // 行列初期化.
-    for(size_t i=0; i<meshCount; ++i)
+        if (meshopt_decodeVertexBuffer(pDst, count, stride, pSrc, srcSize) != 0)
+        { return false; }
+
+        if (filter == "OCTAHEDRAL")
+        {
+            if (stride != 4 && stride != 8)
+            { return false; }
+            meshopt_decodeFilterOct(pDst, count, stride);
+        }
+        else if (filter == "QUATERNION")
+        {
+            if (stride != 8)
+            { return false; }
+            meshopt_decodeFilterQuat(pDst, count, stride);
+        }
+        else if (filter == "EXPONENTIAL")
+        { meshopt_decodeFilterExp(pDst, count, stride); }
+        else if (!filter.empty() && filter != "NONE")
+        { return false; }
+
+        return true;
+    }
+
+    // インデックスにはフィルタは適用されない.
+    if (stride != 2 && stride != 4)
+    { return false; }
+
+    if (mode == "TRIANGLES")
+    { return (count % 3 == 0) && meshopt_decodeIndexBuffer(pDst, count, stride, pSrc, srcSize) == 0; }
+
+    if (mode == "INDICES")
+    { return meshopt_decodeIndexSequence(pDst, count, stride, pSrc, srcSize) == 0; }
+
+    return false;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// AccessorReader class
+///////////////////////////////////////////////////////////////////////////////
+class AccessorReader
+{
+public:
+    //-------------------------------------------------------------------------
+    //! @brief      コンストラクタです.
+    //-------------------------------------------------------------------------
+    explicit AccessorReader(const tinygltf::Model& model)
+    : m_Model(model)
+    {
+        m_Buffers.resize(model.buffers.size());
+        for(size_t i=0; i<model.buffers.size(); ++i)
+        {
+            m_Buffers[i].pData = model.buffers[i].data.data();
+            m_Buffers[i].Size  = model.buffers[i].data.size();
+        }
+
+        m_Views.resize(model.bufferViews.size(), BufferData{ nullptr, 0 });
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      バッファの参照先を差し替えます.
+    //-------------------------------------------------------------------------
+    void SetBufferData(int index, const uint8_t* pData, size_t size)
     {
-        transforms[i].Identity();
+        if (index < 0 || size_t(index) >= m_Buffers.size())
+        { return; }
+
+        m_Buffers[index].pData = pData;
+        m_Buffers[index].Size  = size;
     }
 
-    for(size_t i=0; i<gltfModel.nodes.size(); ++i)
+    //-------------------------------------------------------------------------
+    //! @brief      EXT_meshopt_compression で圧縮されたバッファビューを展開します.
+    //!
+    //! @note       SetBufferData() の後, 読み込み前に呼び出してください.
+    //!             展開はバッファビュー単位で並列に行います.
+    //-------------------------------------------------------------------------
+    bool DecodeCompressedViews()
     {
-        auto& srcNode = gltfModel.nodes[i];
-        auto meshId = srcNode.mesh;
-        if (meshId != -1)
+        struct DecodeJob
         {
-            if (srcNode.matrix.size() == 16)
+            size_t          View;
+            const uint8_t*  pSrc;
+            size_t          SrcSize;
+            std::string     Mode;
+            std::string     Filter;
+            size_t          Count;
+            size_t          Stride;
+            size_t          Offset;
+        };
+
+        std::vector<DecodeJob> jobs;
+        size_t totalSize = 0;
+
+        for(size_t i=0; i<m_Model.bufferViews.size(); ++i)
+        {
+            const auto& view = m_Model.bufferViews[i];
+            auto itr = view.extensions.find(EXT_MESHOPT);
+            if (itr == view.extensions.end())
+            { continue; }
+
+            const auto& ext = itr->second;
+            const auto& buffer     = ext.Get("buffer");
+            const auto& byteOffset = ext.Get("byteOffset");
+            const auto& byteLength = ext.Get("byteLength");
+            const auto& byteStride = ext.Get("byteStride");
+            const auto& count      = ext.Get("count");
+            const auto& mode       = ext.Get("mode");
+            const auto& filter     = ext.Get("filter");
+
+            if (!buffer.IsNumber() || !byteLength.IsNumber() || !byteStride.IsNumber() || !count.IsNumber() || !mode.IsString())
             {
-                transforms[i].row[0] = asdx::Vector4(float(srcNode.matrix[0]),  float(srcNode.matrix[1]),  float(srcNode.matrix[2]),  float(srcNode.matrix[3]));
-                transforms[i].row[1] = asdx::Vector4(float(srcNode.matrix[4]),  float(srcNode.matrix[5]),  float(srcNode.matrix[6]),  float(srcNode.matrix[7]));
-                transforms[i].row[2] = asdx::Vector4(float(srcNode.matrix[8]),  float(srcNode.matrix[9]),  float(srcNode.matrix[10]), float(srcNode.matrix[11]));
-                transforms[i].row[3] = asdx::Vector4(float(srcNode.matrix[12]), float(srcNode.matrix[13]), float(srcNode.matrix[14]), float(srcNode.matrix[15]));
+                ELOGA("Error : Invalid %s. bufferView = %zu", EXT_MESHOPT, i);
+                return false;
             }
-            else
+
+            DecodeJob job = {};
+            job.View    = i;
+            job.SrcSize = size_t(byteLength.GetNumberAsDouble());
+            job.Count   = size_t(count.GetNumberAsDouble());
+            job.Stride  = size_t(byteStride.GetNumberAsInt());
+            job.Mode    = mode.Get<std::string>();
+            job.Filter  = filter.IsString() ? filter.Get<std::string>() : "NONE";
+            job.Offset  = totalSize;
+
+            auto bufferIndex = buffer.GetNumberAsInt();
+            auto srcOffset   = byteOffset.IsNumber() ? size_t(byteOffset.GetNumberAsDouble()) : 0;
+            if (bufferIndex < 0 || size_t(bufferIndex) >= m_Buffers.size()
+             || srcOffset + job.SrcSize > m_Buffers[bufferIndex].Size
+             || job.Count * job.Stride < view.byteLength)
+            {
+                ELOGA("Error : Invalid %s Range. bufferView = %zu", EXT_MESHOPT, i);
+                return false;
+            }
+
+            job.pSrc = m_Buffers[bufferIndex].pData + srcOffset;
+            jobs.push_back(job);
+
+            // SIMD で扱いやすいよう 16 バイト境界に揃える.
+            totalSize += (job.Count * job.Stride + 15) & ~size_t(15);
+        }
+
+        if (jobs.empty())
+        { return true; }
+
+        m_Decoded.resize(totalSize);
+
+        std::atomic<bool> failed(false);
+        ParallelFor(jobs.size(), [&](size_t index)
+        {
+            const auto& job = jobs[index];
+            if (!DecodeMeshopt(job.pSrc, job.SrcSize, job.Mode, job.Filter, job.Count, job.Stride, m_Decoded.data() + job.Offset))
             {
-                asdx::Matrix matrix = asdx::Matrix::CreateIdentity();
-
-                if (srcNode.scale.size() == 3)
-                {
-                    matrix *= asdx::Matrix::CreateScale(
-                        float(srcNode.scale[0]),
-                        float(srcNode.scale[1]),
-                        float(srcNode.scale[2]));
-                }
-
-                if (srcNode.rotation.size() == 4)
-                {
-                    float angleRad;
-                    float axis[3];
-                    QuatToAngleAxis(srcNode.rotation, angleRad, axis);
-
-                    matrix *= asdx::Matrix::CreateFromAxisAngle(
-                        asdx::Vector3(axis[0], axis[1], axis[2]), angleRad);
-                }
-
-                if (srcNode.translation.size() == 3)
-                {
-                    matrix *= asdx::Matrix::CreateTranslation(
-                        float(srcNode.translation[0]),
-                        float(srcNode.translation[1]),
-                        float(srcNode.translation[2]));
-                }
-
-                transforms[i] = matrix;
+                ELOGA("Error : %s Decode Failed. bufferView = %zu", EXT_MESHOPT, job.View);
+                failed = true;
             }
+        });
+
+        if (failed)
+        { return false; }
+
+        // 展開結果をバッファビューの参照先とする.
+        for(const auto& job : jobs)
+        {
+            m_Views[job.View].pData = m_Decoded.data() + job.Offset;
+            m_Views[job.View].Size  = job.Count * job.Stride;
         }
+
+        return true;
     }
 
+    //-------------------------------------------------------------------------
+    //! @brief      要素数を取得します.
+    //-------------------------------------------------------------------------
+    size_t GetCount(int index) const
+    {
+        if (index < 0 || size_t(index) >= m_Model.accessors.size())
+        { return 0; }
 
-    // メッシュ変換.
-    for(size_t i=0; i<meshCount; ++i)
+        return m_Model.accessors[index].count;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      浮動小数として読み込みます.
+    //!
+    //! @param[in]      index           アクセサ番号です.
+    //! @param[out]     pDst            格納先です. GetCount() * dstComponents 個の要素が必要です.
+    //! @param[in]      dstComponents   格納先の成分数です.
+    //! @param[in]      fill            アクセサに無い成分を埋める値です.
+    //-------------------------------------------------------------------------
+    bool ReadFloat(int index, float* pDst, uint32_t dstComponents, float fill = 0.0f) const
+    {
+        return Read(index, pDst, dstComponents, [&](const uint8_t* pSrc, size_t stride, size_t count, int componentType, uint32_t srcComponents, float* pOut)
+        {
+            const auto& accessor = m_Model.accessors[index];
+            return DecodeFloat(pSrc, stride, count, componentType, accessor.normalized, srcComponents, pOut, dstComponents, fill);
+        });
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      整数として読み込みます.
+    //!
+    //! @param[in]      index           アクセサ番号です.
+    //! @param[out]     pDst            格納先です. GetCount() * dstComponents 個の要素が必要です.
+    //! @param[in]      dstComponents   格納先の成分数です.
+    //-------------------------------------------------------------------------
+    template<typename Dst>
+    bool ReadInteger(int index, Dst* pDst, uint32_t dstComponents) const
+    {
+        return Read(index, pDst, dstComponents, [&](const uint8_t* pSrc, size_t stride, size_t count, int componentType, uint32_t srcComponents, Dst* pOut)
+        {
+            return DecodeInteger(pSrc, stride, count, componentType, srcComponents, pOut, dstComponents);
+        });
+    }
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    // BufferData structure
+    ///////////////////////////////////////////////////////////////////////////
+    struct BufferData
+    {
+        const uint8_t*  pData;
+        size_t          Size;
+    };
+
+    const tinygltf::Model&      m_Model;
+    std::vector<BufferData>     m_Buffers;
+    std::vector<BufferData>     m_Views;        // 展開済みバッファビュー.
+    std::vector<uint8_t>        m_Decoded;
+
+    //-------------------------------------------------------------------------
+    //! @brief      バッファビューの先頭ポインタを取得します.
+    //-------------------------------------------------------------------------
+    const uint8_t* GetViewData
+    (
+        int     viewIndex,
+        size_t  byteOffset,
+        size_t  stride,
+        size_t  count,
+        size_t  elementSize
+    ) const
+    {
+        if (viewIndex < 0 || size_t(viewIndex) >= m_Model.bufferViews.size())
+        { return nullptr; }
+
+        const auto& view = m_Model.bufferViews[viewIndex];
+        auto size = (count > 0) ? stride * (count - 1) + elementSize : 0;
+
+        // 展開済みのバッファビューはビュー先頭からのオフセットで参照する.
+        const auto& decoded = m_Views[viewIndex];
+        if (decoded.pData != nullptr)
+        {
+            if (byteOffset + size > view.byteLength || byteOffset + size > decoded.Size)
+            { return nullptr; }
+
+            return decoded.pData + byteOffset;
+        }
+
+        if (view.buffer < 0 || size_t(view.buffer) >= m_Buffers.size())
+        { return nullptr; }
+
+        const auto& buffer = m_Buffers[view.buffer];
+
+        // 範囲外参照をチェック.
+        auto offset = view.byteOffset + byteOffset;
+        if (byteOffset + size > view.byteLength || offset + size > buffer.Size)
+        { return nullptr; }
+
+        return buffer.pData + offset;
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      読み込み処理を行います.
+    //-------------------------------------------------------------------------
+    template<typename Dst, typename Decode>
+    bool Read(int index, Dst* pDst, uint32_t dstComponents, Decode decode) const
     {
-        auto& srcMesh = gltfModel.meshes[i];
+        if (index < 0 || size_t(index) >= m_Model.accessors.size())
+        {
+            ELOGA("Error : Invalid Accessor. index = %d", index);
+            return false;
+        }
 
-        auto transformsT = asdx::Matrix::Transpose(transforms[i]);
+        const auto& accessor = m_Model.accessors[index];
+        if (accessor.count == 0)
+        { return true; }
 
-        auto primitiveIndex = 0;
-        for(auto& primitive : srcMesh.primitives)
+        auto componentSize = tinygltf::GetComponentSizeInBytes(uint32_t(accessor.componentType));
+        auto components    = tinygltf::GetNumComponentsInType(uint32_t(accessor.type));
+        if (componentSize <= 0 || components <= 0 || components > 4)
         {
-            asdx::ResMesh dstMesh;
-            dstMesh.MeshName = srcMesh.name + std::to_string(primitiveIndex);
-            dstMesh.MaterialName = gltfModel.materials[primitive.material].name;
+            ELOGA("Error : Unsupported Accessor Type. index = %d", index);
+            return false;
+        }
 
-            auto notFound = primitive.attributes.end();
+        auto elementSize = size_t(componentSize) * size_t(components);
 
-            // 位置座標.
-            auto attr = primitive.attributes.find(TAG_POSITION);
-            if (attr != notFound)
+        // 本体. バッファビューが無い場合はゼロで初期化.
+        if (accessor.bufferView < 0)
+        {
+            memset(pDst, 0, sizeof(Dst) * accessor.count * dstComponents);
+        }
+        else
+        {
+            auto stride = accessor.ByteStride(m_Model.bufferViews[accessor.bufferView]);
+            if (stride <= 0)
             {
-                auto& accessor  = gltfModel.accessors[attr->second];
-                auto& view      = gltfModel.bufferViews[accessor.bufferView];
-                auto& buffer    = gltfModel.buffers[view.buffer];
-                auto offset     = accessor.byteOffset + view.byteOffset;
-
-                const auto ptr = reinterpret_cast<asdx::Vector3*>(buffer.data.data() + offset);
-                dstMesh.Positions.resize(accessor.count);
-
-                for(size_t idx=0; idx<accessor.count; ++idx)
-                {
-                    dstMesh.Positions[idx] = ptr[idx];
-                    dstMesh.Positions[idx] = asdx::Vector3::TransformCoord(dstMesh.Positions[idx], transforms[i]);
-                }
+                ELOGA("Error : Invalid Byte Stride. index = %d", index);
+                return false;
             }
 
-            // 法線ベクトル.
-            attr = primitive.attributes.find(TAG_NORMAL);
-            if (attr != notFound)
+            auto pSrc = GetViewData(accessor.bufferView, accessor.byteOffset, size_t(stride), accessor.count, elementSize);
+            if (pSrc == nullptr || !decode(pSrc, size_t(stride), accessor.count, accessor.componentType, uint32_t(components), pDst))
             {
-                auto& accessor  = gltfModel.accessors[attr->second];
-                auto& view      = gltfModel.bufferViews[accessor.bufferView];
-                auto& buffer    = gltfModel.buffers[view.buffer];
-                auto offset     = accessor.byteOffset + view.byteOffset;
-
-                const auto ptr = reinterpret_cast<asdx::Vector3*>(buffer.data.data() + offset);
-                dstMesh.Normals.resize(accessor.count);
-
-                for(size_t idx=0; idx<accessor.count; ++idx)
-                {
-                    dstMesh.Normals[idx] = ptr[idx];
-                    dstMesh.Normals[idx] = asdx::Vector3::TransformNormal(dstMesh.Normals[idx], transformsT);
-                    dstMesh.Normals[idx] = asdx::Vector3::SafeNormalize(dstMesh.Normals[idx], dstMesh.Normals[idx]);
-                }
+                ELOGA("Error : Accessor Decode Failed. index = %d", index);
+                return false;
             }
+        }
 
-            // 接線ベクトル.
-            attr = primitive.attributes.find(TAG_TANGENT);
-            if (attr != notFound)
+        // 疎アクセサの値を差し替え.
+        if (accessor.sparse.isSparse && accessor.sparse.count > 0)
+        {
+            const auto& sparse = accessor.sparse;
+            auto count     = size_t(sparse.count);
+            auto indexSize = tinygltf::GetComponentSizeInBytes(uint32_t(sparse.indices.componentType));
+            if (indexSize <= 0)
             {
-                auto& accessor  = gltfModel.accessors[attr->second];
-                auto& view      = gltfModel.bufferViews[accessor.bufferView];
-                auto& buffer    = gltfModel.buffers[view.buffer];
-                auto offset     = accessor.byteOffset + view.byteOffset;
-
-                const auto ptr = reinterpret_cast<asdx::Vector3*>(buffer.data.data() + offset);
-                dstMesh.Tangents.resize(accessor.count);
-
-                for(size_t idx=0; idx<accessor.count; ++idx)
-                {
-                    dstMesh.Tangents[idx] = ptr[idx];
-                    dstMesh.Tangents[idx] = asdx::Vector3::TransformNormal(dstMesh.Tangents[idx], transformsT);
-                    dstMesh.Tangents[idx] = asdx::Vector3::SafeNormalize(dstMesh.Tangents[idx], dstMesh.Tangents[idx]);
-                }
-
-                memcpy(dstMesh.Tangents.data(), ptr, accessor.count * sizeof(asdx::Vector3));
+                ELOGA("Error : Invalid Sparse Index Type. index = %d", index);
+                return false;
             }
 
-            // 頂点カラー.
-            attr = primitive.attributes.find(TAG_COLOR);
-            if (attr != notFound)
+            auto pIndices = GetViewData(sparse.indices.bufferView, size_t(sparse.indices.byteOffset), size_t(indexSize), count, size_t(indexSize));
+            auto pValues  = GetViewData(sparse.values .bufferView, size_t(sparse.values .byteOffset), elementSize, count, elementSize);
+            if (pIndices == nullptr || pValues == nullptr)
             {
-                auto& accessor  = gltfModel.accessors[attr->second];
-                auto& view      = gltfModel.bufferViews[accessor.bufferView];
-                auto& buffer    = gltfModel.buffers[view.buffer];
-                auto offset     = accessor.byteOffset + view.byteOffset;
-
-                dstMesh.Tangents.resize(accessor.count);
-
-                if (accessor.count == 4)
-                {
-                    switch(accessor.componentType)
-                    {
-                    case TINYGLTF_COMPONENT_TYPE_FLOAT:
-                        {
-                            const auto ptr = buffer.data.data() + offset;
-                            memcpy(dstMesh.Tangents.data(), ptr, accessor.count * sizeof(asdx::Vector4));
-                        }
-                        break;
-
-                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                        {
-                            const auto ptr = buffer.data.data() + offset;
-                            for(size_t idx=0; idx<accessor.count; ++idx)
-                            {
-                                dstMesh.Colors[idx].x = float(ptr[idx * 4 + 0]) / 255.0f;
-                                dstMesh.Colors[idx].y = float(ptr[idx * 4 + 1]) / 255.0f;
-                                dstMesh.Colors[idx].z = float(ptr[idx * 4 + 2]) / 255.0f;
-                                dstMesh.Colors[idx].w = float(ptr[idx * 4 + 3]) / 255.0f;
-                            }
-                        }
-                        break;
-                    }
-                }
-                else if (accessor.count == 3)
-                {
-                    switch(accessor.componentType)
-                    {
-                    case TINYGLTF_COMPONENT_TYPE_FLOAT:
-                        {
-                            const auto ptr = reinterpret_cast<float*>(buffer.data.data() + offset);
-                            for(size_t idx=0; idx<accessor.count; ++idx)
-                            {
-                                dstMesh.Colors[idx].x = ptr[idx * 3 + 0];
-                                dstMesh.Colors[idx].y = ptr[idx * 3 + 1];
-                                dstMesh.Colors[idx].z = ptr[idx * 3 + 2];
-                                dstMesh.Colors[idx].w = 1.0f;
-                            }
-                        }
-                        break;
-
-                    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                        {
-                            const auto ptr = buffer.data.data() + offset;
-                            for(size_t idx=0; idx<accessor.count; ++idx)
-                            {
-                                dstMesh.Colors[idx].x = float(ptr[idx * 3 + 0]) / 255.0f;
-                                dstMesh.Colors[idx].y = float(ptr[idx * 3 + 1]) / 255.0f;
-                                dstMesh.Colors[idx].z = float(ptr[idx * 3 + 2]) / 255.0f;
-                                dstMesh.Colors[idx].w = 1.0f;
-                            }
-                        } 
-                        break;
-                    }
-                }
+                ELOGA("Error : Invalid Sparse Accessor. index = %d", index);
+                return false;
             }
 
-            // ボーンインデックス.
-            attr = primitive.attributes.find(TAG_BONEINDEX);
-            if (attr != notFound)
+            std::vector<uint32_t> indices(count);
+            if (!DecodeInteger(pIndices, size_t(indexSize), count, sparse.indices.componentType, 1, indices.data(), 1))
             {
-                auto& accessor  = gltfModel.accessors[attr->second];
-                auto& view      = gltfModel.bufferViews[accessor.bufferView];
-                auto& buffer    = gltfModel.buffers[view.buffer];
-                auto offset     = accessor.byteOffset + view.byteOffset;
-
-                dstMesh.BoneIndices.resize(accessor.count);
-
-                switch(accessor.componentType)
-                {
-                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                    {
-                        const auto ptr = buffer.data.data() + offset;
-                        for(size_t idx=0; idx<accessor.count; ++idx)
-                        {
-                            dstMesh.BoneIndices[idx].x = uint16_t(ptr[idx * 4 + 0]);
-                            dstMesh.BoneIndices[idx].y = uint16_t(ptr[idx * 4 + 1]);
-                            dstMesh.BoneIndices[idx].z = uint16_t(ptr[idx * 4 + 2]);
-                            dstMesh.BoneIndices[idx].w = uint16_t(ptr[idx * 4 + 3]);
-                        }
-                    }
-                    break;
-
-                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-                    {
-                        const auto ptr = buffer.data.data() + offset;
-                        memcpy(dstMesh.BoneIndices.data(), ptr, accessor.count * sizeof(asdx::ResBoneIndex));
-                    }
-                    break;
-                }
+                ELOGA("Error : Sparse Index Decode Failed. index = %d", index);
+                return false;
             }
 
-            // ボーンウェイト.
-            attr = primitive.attributes.find(TAG_BONEWEIGHT);
-            if (attr != notFound)
+            std::vector<Dst> values(count * dstComponents);
+            if (!decode(pValues, elementSize, count, accessor.componentType, uint32_t(components), values.data()))
             {
-                auto& accessor  = gltfModel.accessors[attr->second];
-                auto& view      = gltfModel.bufferViews[accessor.bufferView];
-                auto& buffer    = gltfModel.buffers[view.buffer];
-                auto offset     = accessor.byteOffset + view.byteOffset;
-
-                const auto ptr = buffer.data.data() + offset;
-                dstMesh.BoneWeights.resize(accessor.count);
-                memcpy(dstMesh.BoneWeights.data(), ptr, accessor.count * sizeof(asdx::Vector4));
+                ELOGA("Error : Sparse Value Decode Failed. index = %d", index);
+                return false;
             }
 
-            // テクスチャ座標.
-            for(auto layer = 0; layer<MAX_LAYER_COUNT; layer++)
+            for(size_t i=0; i<count; ++i)
             {
-                attr = primitive.attributes.find(TAG_TEXCOORD[layer]);
-                if (attr == notFound)
+                if (indices[i] >= accessor.count)
                 { continue; }
 
-                auto& accessor  = gltfModel.accessors[attr->second];
-                auto& view      = gltfModel.bufferViews[accessor.bufferView];
-                auto& buffer    = gltfModel.buffers[view.buffer];
-                auto offset     = accessor.byteOffset + view.byteOffset;
-
-                dstMesh.TexCoords[layer].resize(accessor.count);
-
-                switch(accessor.componentType)
-                {
-                case TINYGLTF_COMPONENT_TYPE_FLOAT:
-                    {
-                        const auto ptr = buffer.data.data() + offset;
-                        memcpy(dstMesh.TexCoords[layer].data(), ptr, accessor.count * sizeof(asdx::Vector2));
-                    }
-                    break;
-
-                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                    {
-                        const auto ptr = buffer.data.data() + offset;
-                        for(size_t idx=0; idx<accessor.count; ++idx)
-                        {
-                            dstMesh.TexCoords[layer][idx].x = float(ptr[idx * 2 + 0]) / 255.0f;
-                            dstMesh.TexCoords[layer][idx].y = float(ptr[idx * 2 + 1]) / 255.0f;
-                        }
-                    }
-                    break;
-
-                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-                    {
-                        const auto ptr = reinterpret_cast<uint16_t*>(buffer.data.data() + offset);
-                        for(size_t idx=0; idx<accessor.count; ++idx)
-                        {
-                            dstMesh.TexCoords[layer][idx].x = float(ptr[idx * 2 + 0]) / 65535.0f;
-                            dstMesh.TexCoords[layer][idx].y = float(ptr[idx * 2 + 1]) / 65535.0f;
-                        }
-                    }
-                    break;
-                }
+                memcpy(pDst + size_t(indices[i]) * dstComponents, values.data() + i * dstComponents, sizeof(Dst) * dstComponents);
             }
+        }
+
+        return true;
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      KHR_texture_transform のテクスチャ座標変換行列を取得します.
+//-----------------------------------------------------------------------------
+bool GetTextureTransform
+(
+    const tinygltf::Model&  model,
+    int                     materialIndex,
+    int                     layer,
+    float                   (&result)[6]
+)
+{
+    if (materialIndex < 0 || size_t(materialIndex) >= model.materials.size())
+    { return false; }
+
+    const auto& material = model.materials[materialIndex];
+
+    struct Slot
+    {
+        int                             Index;
+        int                             TexCoord;
+        const tinygltf::ExtensionMap*   pExtensions;
+    };
+
+    const Slot slots[] = {
+        { material.pbrMetallicRoughness.baseColorTexture        .index, material.pbrMetallicRoughness.baseColorTexture        .texCoord, &material.pbrMetallicRoughness.baseColorTexture        .extensions },
+        { material.pbrMetallicRoughness.metallicRoughnessTexture.index, material.pbrMetallicRoughness.metallicRoughnessTexture.texCoord, &material.pbrMetallicRoughness.metallicRoughnessTexture.extensions },
+        { material.normalTexture                                .index, material.normalTexture                                .texCoord, &material.normalTexture                                .extensions },
+        { material.occlusionTexture                             .index, material.occlusionTexture                             .texCoord, &material.occlusionTexture                             .extensions },
+        { material.emissiveTexture                              .index, material.emissiveTexture                              .texCoord, &material.emissiveTexture                              .extensions },
+    };
+
+    // 最初に見つかった変換を採用する.
+    for(const auto& slot : slots)
+    {
+        if (slot.Index < 0)
+        { continue; }
+
+        auto itr = slot.pExtensions->find(KHR_TEXTURE_TRANSFORM);
+        if (itr == slot.pExtensions->end())
+        { continue; }
+
+        const auto& ext      = itr->second;
+        const auto& texCoord = ext.Get("texCoord");
+        auto set = texCoord.IsNumber() ? texCoord.GetNumberAsInt() : slot.TexCoord;
+        if (set != layer)
+        { continue; }
+
+        const auto& offset   = ext.Get("offset");
+        const auto& rotation = ext.Get("rotation");
+        const auto& scale    = ext.Get("scale");
+
+        auto ox = (offset.ArrayLen() == 2) ? float(offset.Get(0).GetNumberAsDouble()) : 0.0f;
+        auto oy = (offset.ArrayLen() == 2) ? float(offset.Get(1).GetNumberAsDouble()) : 0.0f;
+        auto sx = (scale .ArrayLen() == 2) ? float(scale .Get(0).GetNumberAsDouble()) : 1.0f;
+        auto sy = (scale .ArrayLen() == 2) ? float(scale .Get(1).GetNumberAsDouble()) : 1.0f;
+        auto r  = rotation.IsNumber() ? float(rotation.GetNumberAsDouble()) : 0.0f;
+        auto c  = cosf(r);
+        auto s  = sinf(r);
+
+        // T * R * S.
+        result[0] =  c * sx; result[1] = s * sy; result[2] = ox;
+        result[3] = -s * sx; result[4] = c * sy; result[5] = oy;
+        return true;
+    }
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+//      方向ベクトルを正規化します.
+//-----------------------------------------------------------------------------
+void NormalizeDirections(asdx::Vector3* pValues, size_t count)
+{
+    for(size_t i=0; i<count; ++i)
+    {
+        auto& v = pValues[i];
+
+        auto value = _mm_setr_ps(v.x, v.y, v.z, 0.0f);
+
+        // 長さの2乗を全要素に求める.
+        auto sq  = _mm_mul_ps(value, value);
+        auto sum = _mm_add_ps(sq, _mm_shuffle_ps(sq, sq, _MM_SHUFFLE(2, 3, 0, 1)));
+        sum      = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+
+        // ゼロベクトルはそのまま.
+        if (_mm_cvtss_f32(sum) > 0.0f)
+        { value = _mm_div_ps(value, _mm_sqrt_ps(sum)); }
 
-            // 頂点インデックス.
+        float temp[4];
+        _mm_storeu_ps(temp, value);
+        v.x = temp[0];
+        v.y = temp[1];
+        v.z = temp[2];
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      プリミティブを変換します.
+//-----------------------------------------------------------------------------
+bool ConvertPrimitive
+(
+    const tinygltf::Model&      gltfModel,
+    const AccessorReader&       reader,
+    const tinygltf::Primitive&  primitive,
+    asdx::ResMesh&              dstMesh
+)
+{
+    if (primitive.material >= 0)
+    { dstMesh.MaterialName = gltfModel.materials[primitive.material].name; }
+
+    auto notFound = primitive.attributes.end();
+
+    // 位置座標.
+    auto attr = primitive.attributes.find(TAG_POSITION);
+    if (attr != notFound)
+    {
+        dstMesh.Positions.resize(reader.GetCount(attr->second));
+        if (!reader.ReadFloat(attr->second, reinterpret_cast<float*>(dstMesh.Positions.data()), 3))
+        { return false; }
+    }
+
+    // 法線ベクトル.
+    attr = primitive.attributes.find(TAG_NORMAL);
+    if (attr != notFound)
+    {
+        dstMesh.Normals.resize(reader.GetCount(attr->second));
+        if (!reader.ReadFloat(attr->second, reinterpret_cast<float*>(dstMesh.Normals.data()), 3))
+        { return false; }
+
+        // 正規化整数や量子化・フィルタ済みの値は単位長にならないので正規化し直す.
+        NormalizeDirections(dstMesh.Normals.data(), dstMesh.Normals.size());
+    }
+
+    // 接線ベクトル(w成分の従法線の符号は使用しない).
+    attr = primitive.attributes.find(TAG_TANGENT);
+    if (attr != notFound)
+    {
+        dstMesh.Tangents.resize(reader.GetCount(attr->second));
+        if (!reader.ReadFloat(attr->second, reinterpret_cast<float*>(dstMesh.Tangents.data()), 3))
+        { return false; }
+
+        NormalizeDirections(dstMesh.Tangents.data(), dstMesh.Tangents.size());
+    }
+
+    // 頂点カラー(RGBの場合はアルファを1で埋める).
+    attr = primitive.attributes.find(TAG_COLOR);
+    if (attr != notFound)
+    {
+        dstMesh.Colors.resize(reader.GetCount(attr->second));
+        if (!reader.ReadFloat(attr->second, reinterpret_cast<float*>(dstMesh.Colors.data()), 4, 1.0f))
+        { return false; }
+    }
+
+    // ボーンインデックス.
+    attr = primitive.attributes.find(TAG_BONEINDEX);
+    if (attr != notFound)
+    {
+        dstMesh.BoneIndices.resize(reader.GetCount(attr->second));
+        if (!reader.ReadInteger(attr->second, reinterpret_cast<uint16_t*>(dstMesh.BoneIndices.data()), 4))
+        { return false; }
+    }
+
+    // ボーンウェイト.
+    attr = primitive.attributes.find(TAG_BONEWEIGHT);
+    if (attr != notFound)
+    {
+        dstMesh.BoneWeights.resize(reader.GetCount(attr->second));
+        if (!reader.ReadFloat(attr->second, reinterpret_cast<float*>(dstMesh.BoneWeights.data()), 4))
+        { return false; }
+    }
+
+    // テクスチャ座標.
+    for(auto layer = 0; layer<MAX_LAYER_COUNT; layer++)
+    {
+        attr = primitive.attributes.find(TAG_TEXCOORD[layer]);
+        if (attr == notFound)
+        { continue; }
+
+        auto& texcoords = dstMesh.TexCoords[layer];
+        texcoords.resize(reader.GetCount(attr->second));
+        if (!reader.ReadFloat(attr->second, reinterpret_cast<float*>(texcoords.data()), 2))
+        { return false; }
+
+        // 量子化されたテクスチャ座標 (KHR_mesh_quantization) は KHR_texture_transform で逆量子化する.
+        float m[6];
+        if (gltfModel.accessors[attr->second].componentType != TINYGLTF_COMPONENT_TYPE_FLOAT
+         && GetTextureTransform(gltfModel, primitive.material, layer, m))
+        {
+            for(auto& uv : texcoords)
             {
-                auto& accessor  = gltfModel.accessors[primitive.indices];
-                auto& view      = gltfModel.bufferViews[accessor.bufferView];
-                auto& buffer    = gltfModel.buffers[view.buffer];
-                auto offset     = accessor.byteOffset + view.byteOffset;
-
-                dstMesh.Indices.resize(accessor.count);
-
-                switch(accessor.componentType)
-                {
-                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-                    {
-                        const auto ptr = reinterpret_cast<uint32_t*>(buffer.data.data() + offset);
-                        memcpy(dstMesh.Indices.data(), ptr, accessor.count * sizeof(uint32_t));
-                    }
-                    break;
-
-                case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-                    {
-                        const auto ptr = reinterpret_cast<uint16_t*>(buffer.data.data() + offset);
-                        for(size_t idx=0; idx<accessor.count; ++idx)
-                        {
-                            dstMesh.Indices[idx] = uint32_t(ptr[idx]);
-                        }
-                    }
-                    break;
-                }
+                auto u = uv.x;
+                auto v = uv.y;
+                uv.x = m[0] * u + m[1] * v + m[2];
+                uv.y = m[3] * u + m[4] * v + m[5];
             }
+        }
+    }
+
+    // 頂点インデックス.
+    if (primitive.indices >= 0)
+    {
+        dstMesh.Indices.resize(reader.GetCount(primitive.indices));
+        if (!reader.ReadInteger(primitive.indices, dstMesh.Indices.data(), 1))
+        { return false; }
+    }
+    else
+    {
+        // インデックスが無い場合は連番.
+        dstMesh.Indices.resize(dstMesh.Positions.size());
+        for(size_t idx=0; idx<dstMesh.Indices.size(); ++idx)
+        { dstMesh.Indices[idx] = uint32_t(idx); }
+    }
 
-            // 法線データが無ければ生成.
-            if (dstMesh.Normals.empty())
-            { asdx::CalcNormals(dstMesh); }
+    // 法線・接線データが無ければ生成.
+    if (!GenerateTangentSpace(dstMesh))
+    { return false; }
 
-            // 接線データが無ければ生成を試みる.
-            if (dstMesh.Tangents.empty())
-            { asdx::CalcTangents(dstMesh); }
+    return true;
+}
 
-            // メッシュを追加.
-            model.Meshes.emplace_back(dstMesh);
+} // namespace
 
-            // プリミティブ番号インクリメント.
-            primitiveIndex++;
+
+///////////////////////////////////////////////////////////////////////////////
+// GLTFLoader class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      ファイルをロードします.
+//-----------------------------------------------------------------------------
+bool GLTFLoader::Load(const char* path, asdx::ResModel& model)
+{
+    m_Instances.clear();
+
+    auto ext = asdx::GetExtA(path);
+
+    tinygltf::Model gltfModel;
+    MappedFile      file;
+    int             binBuffer = -1;
+    const uint8_t*  pBinData  = nullptr;
+    size_t          binSize   = 0;
+
+    if (ext == "gltf")
+    {
+        if (!LoadGLTF(path, file, gltfModel))
+        {
+            ELOGA("Error : GLTF Load Failed. path = %s", path);
+            return false;
+        }
+    }
+    else if (ext == "glb")
+    {
+        if (!LoadGLB(path, file, gltfModel, binBuffer, pBinData, binSize))
+        {
+            ELOGA("Error : GLB Load Failed. path = %s", path);
+            return false;
         }
     }
+    else
+    {
+        ELOGA("Error : Unsupported Extension.");
+        return false;
+    }
+
+    auto meshCount = gltfModel.meshes.size();
+
+    // メッシュはローカル空間のまま保持し, ノードの参照はインスタンスとして扱う.
+    std::vector<std::vector<asdx::Matrix>> instances;
+    CollectInstances(gltfModel, instances);
+
+    // メッシュ変換.
+    AccessorReader reader(gltfModel);
+    if (binBuffer >= 0)
+    { reader.SetBufferData(binBuffer, pBinData, binSize); }
+
+    if (!reader.DecodeCompressedViews())
+    {
+        ELOGA("Error : Compressed BufferView Decode Failed. path = %s", path);
+        return false;
+    }
+
+    // 出力先を先に確保し, プリミティブ単位で並列に変換する.
+    struct PrimitiveJob
+    {
+        uint32_t    Mesh;
+        uint32_t    Primitive;
+    };
+
+    std::vector<PrimitiveJob> jobs;
+    for(size_t i=0; i<meshCount; ++i)
+    {
+        auto primitiveCount = gltfModel.meshes[i].primitives.size();
+        for(size_t j=0; j<primitiveCount; ++j)
+        { jobs.push_back(PrimitiveJob{ uint32_t(i), uint32_t(j) }); }
+    }
+
+    auto meshOffset = model.Meshes.size();
+    model.Meshes.resize(meshOffset + jobs.size());
+
+    std::atomic<bool> failed(false);
+    ParallelFor(jobs.size(), [&](size_t index)
+    {
+        if (failed)
+        { return; }
+
+        const auto& job     = jobs[index];
+        const auto& srcMesh = gltfModel.meshes[job.Mesh];
+        auto&       dstMesh = model.Meshes[meshOffset + index];
+
+        dstMesh.MeshName = srcMesh.name + std::to_string(job.Primitive);
+
+        if (!ConvertPrimitive(gltfModel, reader, srcMesh.primitives[job.Primitive], dstMesh))
+        { failed = true; }
+    });
+
+    if (failed)
+    {
+        ELOGA("Error : Primitive Convert Failed. path = %s", path);
+        model.Meshes.resize(meshOffset);
+        return false;
+    }
+
+    m_Instances.resize(model.Meshes.size());
+    for(size_t i=0; i<jobs.size(); ++i)
+    { m_Instances[meshOffset + i] = instances[jobs[i].Mesh]; }
 
     auto materialCount = gltfModel.materials.size();
     model.Materials.resize(materialCount);
@@ -615,4 +1456,10 @@ bool GLTFLoader::Load(const char* path, asdx::ResModel& model)
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+//-----------------------------------------------------------------------------
+//      インスタンス行列を取得します.
+//-----------------------------------------------------------------------------
+const std::vector<std::vector<asdx::Matrix>>& GLTFLoader::GetInstances() const
+{ return m_Instances; }
\ No newline at end of file
@@ -0,0 +1,110 @@
+﻿//-----------------------------------------------------------------------------
+// File : MappedFile.cpp
+// Desc : Memory Mapped File.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MappedFile.h>
+#include <asdxLogger.h>
+#include <Windows.h>
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MappedFile class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      デストラクタです.
+//-----------------------------------------------------------------------------
+MappedFile::~MappedFile()
+{ Close(); }
+
+//-----------------------------------------------------------------------------
+//      ファイルを読み取り専用でマッピングします.
+//-----------------------------------------------------------------------------
+bool MappedFile::Open(const char* path)
+{
+    Close();
+
+    if (path == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    auto hFile = CreateFileA(
+        path,
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+        nullptr);
+    if (hFile == INVALID_HANDLE_VALUE)
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+
+    m_hFile = hFile;
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(m_hFile, &size))
+    {
+        ELOGA("Error : GetFileSizeEx() Failed. path = %s", path);
+        Close();
+        return false;
+    }
+
+    // 空ファイルはマッピングできないので, サイズ0として成功扱いにする.
+    if (size.QuadPart == 0)
+    { return true; }
+
+    m_hMapping = CreateFileMappingA(m_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_hMapping == nullptr)
+    {
+        ELOGA("Error : CreateFileMapping() Failed. path = %s", path);
+        Close();
+        return false;
+    }
+
+    m_pData = static_cast<const uint8_t*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_pData == nullptr)
+    {
+        ELOGA("Error : MapViewOfFile() Failed. path = %s", path);
+        Close();
+        return false;
+    }
+
+    m_Size = size_t(size.QuadPart);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      マッピングを解除します.
+//-----------------------------------------------------------------------------
+void MappedFile::Close()
+{
+    if (m_pData != nullptr)
+    {
+        UnmapViewOfFile(m_pData);
+        m_pData = nullptr;
+    }
+
+    if (m_hMapping != nullptr)
+    {
+        CloseHandle(m_hMapping);
+        m_hMapping = nullptr;
+    }
+
+    if (m_hFile != nullptr)
+    {
+        CloseHandle(m_hFile);
+        m_hFile = nullptr;
+    }
+
+    m_Size = 0;
+}
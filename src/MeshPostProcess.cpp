@@ -0,0 +1,604 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshPostProcess.cpp
+// Desc : Post Import Mesh Processing.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MeshPostProcess.h>
+#include <ParallelFor.h>
+#include <meshoptimizer.h>
+#include <asdxLogger.h>
+#include <atomic>
+#include <cstring>
+
+#if ENABLE_MESH_BENCHMARK
+#include <Benchmark.h>
+#include <cmath>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kCacheSize = 16;  // ACMR/ATVR 計測に使う FIFO キャッシュサイズ.
+
+
+//-----------------------------------------------------------------------------
+//      ストリームを追加します.
+//-----------------------------------------------------------------------------
+template<typename T>
+void AddStream(const std::vector<T>& values, std::vector<meshopt_Stream>& streams)
+{
+    if (values.empty())
+    { return; }
+
+    meshopt_Stream stream = { values.data(), sizeof(T), sizeof(T) };
+    streams.push_back(stream);
+}
+
+//-----------------------------------------------------------------------------
+//      リマップテーブルに従って頂点ストリームを並べ替えます.
+//-----------------------------------------------------------------------------
+template<typename T>
+void RemapStream(std::vector<T>& values, const std::vector<uint32_t>& remap, size_t vertexCount)
+{
+    if (values.empty())
+    { return; }
+
+    std::vector<T> result(vertexCount);
+    meshopt_remapVertexBuffer(result.data(), values.data(), values.size(), sizeof(T), remap.data());
+    values.swap(result);
+}
+
+//-----------------------------------------------------------------------------
+//      全頂点ストリームを並べ替えます.
+//-----------------------------------------------------------------------------
+void RemapVertices(asdx::ResMesh& mesh, const std::vector<uint32_t>& remap, size_t vertexCount)
+{
+    RemapStream(mesh.Positions,     remap, vertexCount);
+    RemapStream(mesh.Normals,       remap, vertexCount);
+    RemapStream(mesh.Tangents,      remap, vertexCount);
+    RemapStream(mesh.Colors,        remap, vertexCount);
+    RemapStream(mesh.TexCoords[0],  remap, vertexCount);
+    RemapStream(mesh.TexCoords[1],  remap, vertexCount);
+    RemapStream(mesh.TexCoords[2],  remap, vertexCount);
+    RemapStream(mesh.TexCoords[3],  remap, vertexCount);
+    RemapStream(mesh.BoneIndices,   remap, vertexCount);
+    RemapStream(mesh.BoneWeights,   remap, vertexCount);
+
+    meshopt_remapIndexBuffer(mesh.Indices.data(), mesh.Indices.data(), mesh.Indices.size(), remap.data());
+}
+
+//-----------------------------------------------------------------------------
+//      LODを生成します.
+//-----------------------------------------------------------------------------
+void GenerateLods(const asdx::ResMesh& mesh, const MeshPostProcessOption& option, std::vector<MeshLod>& lods)
+{
+    auto vertexCount = mesh.Positions.size();
+    auto indexCount  = mesh.Indices.size();
+    auto pPositions  = &mesh.Positions[0].x;
+    auto stride      = sizeof(asdx::Vector3);
+
+    // 相対誤差をオブジェクト空間の距離に換算する係数.
+    auto scale = meshopt_simplifyScale(pPositions, vertexCount, stride);
+
+    // 属性を考慮する場合は法線とテクスチャ座標を詰める.
+    std::vector<float> attributes;
+    float   weights[5]     = { 0.5f, 0.5f, 0.5f, 1.0f, 1.0f };
+    size_t  attributeCount = 0;
+    if (option.LodAttributes)
+    {
+        auto hasNormal   = !mesh.Normals.empty();
+        auto hasTexCoord = !mesh.TexCoords[0].empty();
+        attributeCount = (hasNormal ? 3 : 0) + (hasTexCoord ? 2 : 0);
+        if (!hasNormal)
+        {
+            weights[0] = weights[3];
+            weights[1] = weights[4];
+        }
+
+        attributes.reserve(vertexCount * attributeCount);
+        for(size_t i=0; i<vertexCount && attributeCount > 0; ++i)
+        {
+            if (hasNormal)
+            {
+                attributes.push_back(mesh.Normals[i].x);
+                attributes.push_back(mesh.Normals[i].y);
+                attributes.push_back(mesh.Normals[i].z);
+            }
+            if (hasTexCoord)
+            {
+                attributes.push_back(mesh.TexCoords[0][i].x);
+                attributes.push_back(mesh.TexCoords[0][i].y);
+            }
+        }
+    }
+
+    lods.clear();
+
+    auto prevCount = indexCount;
+    auto prevError = 0.0f;
+    for(auto i=0u; i<option.LodCount; ++i)
+    {
+        auto targetCount = size_t(double(prevCount) * option.LodRatio) / 3 * 3;
+        if (targetCount < 3)
+        { break; }
+
+        // 誤差の基準を揃えるため, 常にLOD0から簡略化する.
+        MeshLod lod;
+        lod.Indices.resize(indexCount);
+
+        auto error = 0.0f;
+        size_t count = 0;
+        if (attributeCount > 0)
+        {
+            count = meshopt_simplifyWithAttributes(
+                lod.Indices.data(),
+                mesh.Indices.data(),
+                indexCount,
+                pPositions,
+                vertexCount,
+                stride,
+                attributes.data(),
+                sizeof(float) * attributeCount,
+                weights,
+                attributeCount,
+                nullptr,
+                targetCount,
+                option.LodTargetError,
+                0,
+                &error);
+        }
+        else
+        {
+            count = meshopt_simplify(
+                lod.Indices.data(),
+                mesh.Indices.data(),
+                indexCount,
+                pPositions,
+                vertexCount,
+                stride,
+                targetCount,
+                option.LodTargetError,
+                0,
+                &error);
+        }
+
+        // 許容誤差に達して削減が進まなくなったら打ち切る.
+        if (count == 0 || count * 10 > prevCount * 9)
+        { break; }
+
+        lod.Indices.resize(count);
+        lod.Indices.shrink_to_fit();
+
+        // 選択時に粗いLODほど誤差が大きいことを前提にするため単調増加にしておく.
+        lod.Error = error * scale;
+        if (lod.Error < prevError)
+        { lod.Error = prevError; }
+
+        prevCount = count;
+        prevError = lod.Error;
+        lods.push_back(std::move(lod));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットを生成します.
+//-----------------------------------------------------------------------------
+void BuildMeshlets(const asdx::ResMesh& mesh, const MeshPostProcessOption& option, MeshAuxData& aux)
+{
+    auto vertexCount  = mesh.Positions.size();
+    auto indexCount   = mesh.Indices.size();
+    auto pPositions   = &mesh.Positions[0].x;
+    auto stride       = sizeof(asdx::Vector3);
+    auto maxVertices  = size_t(option.MeshletMaxVertices);
+    auto maxTriangles = size_t(option.MeshletMaxTriangles);
+
+    auto maxMeshlets = meshopt_buildMeshletsBound(indexCount, maxVertices, maxTriangles);
+
+    std::vector<meshopt_Meshlet> meshlets        (maxMeshlets);
+    std::vector<uint32_t>        meshletVertices (maxMeshlets * maxVertices);
+    std::vector<uint8_t>         meshletTriangles(maxMeshlets * maxTriangles * 3);
+
+    auto count = meshopt_buildMeshlets(
+        meshlets.data(),
+        meshletVertices.data(),
+        meshletTriangles.data(),
+        mesh.Indices.data(),
+        indexCount,
+        pPositions,
+        vertexCount,
+        stride,
+        maxVertices,
+        maxTriangles,
+        option.MeshletConeWeight);
+
+    aux.Meshlets.clear();
+    aux.MeshletVertices.clear();
+    aux.MeshletTriangles.clear();
+    aux.Bounds.clear();
+
+    if (count == 0)
+    { return; }
+
+    // 末尾の未使用領域を切り詰める (三角形は4バイト境界に揃えて詰められている).
+    const auto& last = meshlets[count - 1];
+    meshletVertices .resize(last.vertex_offset + last.vertex_count);
+    meshletTriangles.resize(last.triangle_offset + ((last.triangle_count * 3 + 3) & ~3));
+
+    aux.Meshlets.resize(count);
+    aux.Bounds  .resize(count);
+    for(size_t i=0; i<count; ++i)
+    {
+        const auto& src = meshlets[i];
+
+        auto& dst = aux.Meshlets[i];
+        dst.VertexOffset   = src.vertex_offset;
+        dst.TriangleOffset = src.triangle_offset;
+        dst.VertexCount    = src.vertex_count;
+        dst.TriangleCount  = src.triangle_count;
+
+        auto bounds = meshopt_computeMeshletBounds(
+            &meshletVertices[src.vertex_offset],
+            &meshletTriangles[src.triangle_offset],
+            src.triangle_count,
+            pPositions,
+            vertexCount,
+            stride);
+
+        auto& cull = aux.Bounds[i];
+        cull.Center     = asdx::Vector3(bounds.center[0], bounds.center[1], bounds.center[2]);
+        cull.Radius     = bounds.radius;
+        cull.ConeApex   = asdx::Vector3(bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2]);
+        cull.ConeCutoff = bounds.cone_cutoff;
+        cull.ConeAxis   = asdx::Vector3(bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2]);
+        cull.Reserved   = 0.0f;
+    }
+
+    aux.MeshletVertices .swap(meshletVertices);
+    aux.MeshletTriangles.swap(meshletTriangles);
+}
+
+//-----------------------------------------------------------------------------
+//      頂点ストリームの要素数が揃っているかチェックします.
+//-----------------------------------------------------------------------------
+bool IsValidStreams(const asdx::ResMesh& mesh)
+{
+    auto count = mesh.Positions.size();
+    auto check = [count](size_t size)
+    { return size == 0 || size == count; };
+
+    return check(mesh.Normals.size())
+        && check(mesh.Tangents.size())
+        && check(mesh.Colors.size())
+        && check(mesh.TexCoords[0].size())
+        && check(mesh.TexCoords[1].size())
+        && check(mesh.TexCoords[2].size())
+        && check(mesh.TexCoords[3].size())
+        && check(mesh.BoneIndices.size())
+        && check(mesh.BoneWeights.size());
+}
+
+//-----------------------------------------------------------------------------
+//      インデックスが三角形リストとして正しいかチェックします.
+//-----------------------------------------------------------------------------
+bool IsValidIndices(const asdx::ResMesh& mesh)
+{
+    auto vertexCount = mesh.Positions.size();
+
+    // 非インデックスのメッシュは連番を振るので頂点数で判定する.
+    if (mesh.Indices.empty())
+    { return (vertexCount % 3) == 0; }
+
+    if ((mesh.Indices.size() % 3) != 0)
+    { return false; }
+
+    for(auto index : mesh.Indices)
+    {
+        if (index >= vertexCount)
+        { return false; }
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshPostProcessOption structure
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      キャッシュのキーに使うハッシュ値を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MeshPostProcessOption::GetHash() const
+{
+    uint32_t threshold = 0;
+    memcpy(&threshold, &OverdrawThreshold, sizeof(threshold));
+
+    uint32_t flags = 0;
+    flags |= Deduplicate ? 0x1 : 0;
+    flags |= VertexCache ? 0x2 : 0;
+    flags |= Overdraw    ? 0x4 : 0;
+    flags |= VertexFetch ? 0x8 : 0;
+    flags |= GenerateLod ? 0x10 : 0;
+    flags |= LodAttributes ? 0x20 : 0;
+    flags |= GenerateMeshlet ? 0x40 : 0;
+
+    uint32_t lodRatio = 0;
+    uint32_t lodError = 0;
+    memcpy(&lodRatio, &LodRatio, sizeof(lodRatio));
+    memcpy(&lodError, &LodTargetError, sizeof(lodError));
+
+    uint32_t coneWeight = 0;
+    memcpy(&coneWeight, &MeshletConeWeight, sizeof(coneWeight));
+
+    // FNV-1a.
+    uint32_t hash = 2166136261u;
+    for(auto value : { flags, threshold, LodCount, lodRatio, lodError, MeshletMaxVertices, MeshletMaxTriangles, coneWeight })
+    {
+        for(auto i=0; i<4; ++i)
+        {
+            hash ^= (value >> (i * 8)) & 0xFF;
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+
+//-----------------------------------------------------------------------------
+//      インポートしたメッシュを最適化します.
+//-----------------------------------------------------------------------------
+bool PostProcessMesh
+(
+    asdx::ResMesh&                  mesh,
+    const MeshPostProcessOption&    option,
+    MeshAuxData*                    pAux,
+    MeshPostProcessStats*           pStats
+)
+{
+    if (!IsValidStreams(mesh))
+    { return false; }
+
+    if (pAux != nullptr)
+    { *pAux = MeshAuxData(); }
+
+    auto vertexCount = mesh.Positions.size();
+    if (vertexCount == 0)
+    { return true; }
+
+    // meshoptimizer は範囲外のインデックスを検証しないので, 呼び出す前に弾いてメッシュはそのまま残す.
+    if (!IsValidIndices(mesh))
+    {
+        ELOGA("Error : Invalid Mesh Indices. mesh = %s, indexCount = %zu, vertexCount = %zu",
+            mesh.MeshName.c_str(), mesh.Indices.size(), vertexCount);
+        return false;
+    }
+
+    // 非インデックスのメッシュは連番を振る.
+    if (mesh.Indices.empty())
+    {
+        mesh.Indices.resize(vertexCount);
+        for(size_t i=0; i<vertexCount; ++i)
+        { mesh.Indices[i] = uint32_t(i); }
+    }
+
+    auto indexCount = mesh.Indices.size();
+
+    if (pStats != nullptr)
+    {
+        auto stats = meshopt_analyzeVertexCache(mesh.Indices.data(), indexCount, vertexCount, kCacheSize, 0, 0);
+        pStats->VertexCountBefore = uint32_t(vertexCount);
+        pStats->IndexCount        = uint32_t(indexCount);
+        pStats->AcmrBefore        = stats.acmr;
+        pStats->AtvrBefore        = stats.atvr;
+    }
+
+    std::vector<uint32_t> remap(vertexCount);
+
+    // 重複頂点の統合.
+    if (option.Deduplicate)
+    {
+        std::vector<meshopt_Stream> streams;
+        AddStream(mesh.Positions,    streams);
+        AddStream(mesh.Normals,      streams);
+        AddStream(mesh.Tangents,     streams);
+        AddStream(mesh.Colors,       streams);
+        AddStream(mesh.TexCoords[0], streams);
+        AddStream(mesh.TexCoords[1], streams);
+        AddStream(mesh.TexCoords[2], streams);
+        AddStream(mesh.TexCoords[3], streams);
+        AddStream(mesh.BoneIndices,  streams);
+        AddStream(mesh.BoneWeights,  streams);
+
+        auto uniqueCount = meshopt_generateVertexRemapMulti(
+            remap.data(), mesh.Indices.data(), indexCount, vertexCount, streams.data(), streams.size());
+
+        RemapVertices(mesh, remap, uniqueCount);
+        vertexCount = uniqueCount;
+    }
+
+    // LOD生成 (各LODは全頂点を共有する).
+    std::vector<MeshLod> lods;
+    if (option.GenerateLod && pAux != nullptr)
+    { GenerateLods(mesh, option, lods); }
+
+    // 頂点キャッシュとオーバードローの最適化 (LODごとに行う).
+    auto optimize = [&](std::vector<uint32_t>& indices)
+    {
+        if (!option.VertexCache)
+        { return; }
+
+        meshopt_optimizeVertexCache(indices.data(), indices.data(), indices.size(), vertexCount);
+
+        // 頂点キャッシュ最適化済みの順序を前提とする.
+        if (option.Overdraw)
+        {
+            meshopt_optimizeOverdraw(
+                indices.data(),
+                indices.data(),
+                indices.size(),
+                &mesh.Positions[0].x,
+                vertexCount,
+                sizeof(asdx::Vector3),
+                option.OverdrawThreshold);
+        }
+    };
+
+    optimize(mesh.Indices);
+    for(auto& lod : lods)
+    { optimize(lod.Indices); }
+
+    // 頂点フェッチ最適化 (参照されない頂点もここで除去される).
+    // LODの頂点はLOD0の頂点の部分集合なので, LOD0の順序で並べる.
+    if (option.VertexFetch)
+    {
+        auto usedCount = meshopt_optimizeVertexFetchRemap(remap.data(), mesh.Indices.data(), indexCount, vertexCount);
+        RemapVertices(mesh, remap, usedCount);
+        for(auto& lod : lods)
+        { meshopt_remapIndexBuffer(lod.Indices.data(), lod.Indices.data(), lod.Indices.size(), remap.data()); }
+        vertexCount = usedCount;
+    }
+
+    if (pAux != nullptr)
+    {
+        pAux->Lods.swap(lods);
+
+        // 最終的な頂点順とインデックス順から作る.
+        if (option.GenerateMeshlet)
+        { BuildMeshlets(mesh, option, *pAux); }
+    }
+
+    if (pStats != nullptr)
+    {
+        auto stats = meshopt_analyzeVertexCache(mesh.Indices.data(), indexCount, vertexCount, kCacheSize, 0, 0);
+        pStats->VertexCountAfter = uint32_t(vertexCount);
+        pStats->AcmrAfter        = stats.acmr;
+        pStats->AtvrAfter        = stats.atvr;
+        pStats->LodCount         = (pAux != nullptr) ? uint32_t(pAux->Lods.size()) : 0;
+        pStats->MeshletCount     = (pAux != nullptr) ? uint32_t(pAux->Meshlets.size()) : 0;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      モデル内の全メッシュを並列に最適化します.
+//-----------------------------------------------------------------------------
+bool PostProcessModel
+(
+    asdx::ResModel&                     model,
+    const MeshPostProcessOption&        option,
+    std::vector<MeshAuxData>*           pAux,
+    std::vector<MeshPostProcessStats>*  pStats
+)
+{
+    if (pAux != nullptr)
+    {
+        pAux->clear();
+        pAux->resize(model.Meshes.size());
+    }
+
+    if (pStats != nullptr)
+    {
+        pStats->clear();
+        pStats->resize(model.Meshes.size());
+    }
+
+    std::atomic<bool> result(true);
+    ParallelFor(model.Meshes.size(), [&](size_t i)
+    {
+        auto pMeshAux   = (pAux   != nullptr) ? &(*pAux)[i]   : nullptr;
+        auto pMeshStats = (pStats != nullptr) ? &(*pStats)[i] : nullptr;
+        if (!PostProcessMesh(model.Meshes[i], option, pMeshAux, pMeshStats))
+        { result = false; }
+    });
+
+    return result;
+}
+
+#if ENABLE_MESH_BENCHMARK
+//-----------------------------------------------------------------------------
+//      LOD生成の処理時間を計測します.
+//-----------------------------------------------------------------------------
+bool BenchmarkLod(uint32_t loopCount)
+{
+    // スキャンデータを想定した凹凸のあるグリッド (一辺の分割数).
+    const uint32_t kDivisions[] = { 128, 256, 512, 1024 };
+
+    for(auto div : kDivisions)
+    {
+        asdx::ResMesh source;
+        auto side = div + 1;
+        source.Positions   .resize(side * side);
+        source.Normals     .resize(side * side);
+        source.TexCoords[0].resize(side * side);
+        for(auto y=0u; y<side; ++y)
+        {
+            for(auto x=0u; x<side; ++x)
+            {
+                auto u = float(x) / float(div);
+                auto v = float(y) / float(div);
+                auto h = 0.05f * sinf(u * 31.0f) * cosf(v * 17.0f) + 0.01f * sinf((u + v) * 113.0f);
+
+                auto idx = y * side + x;
+                source.Positions   [idx] = asdx::Vector3(u, h, v);
+                source.Normals     [idx] = asdx::Vector3(0.0f, 1.0f, 0.0f);
+                source.TexCoords[0][idx] = asdx::Vector2(u, v);
+            }
+        }
+
+        source.Indices.reserve(div * div * 6);
+        for(auto y=0u; y<div; ++y)
+        {
+            for(auto x=0u; x<div; ++x)
+            {
+                auto i0 = y * side + x;
+                auto i1 = i0 + 1;
+                auto i2 = i0 + side;
+                auto i3 = i2 + 1;
+                source.Indices.insert(source.Indices.end(), { i0, i2, i1, i1, i2, i3 });
+            }
+        }
+
+        ILOGA("Info : LOD Benchmark. triangles = %zu", source.Indices.size() / 3);
+
+        for(auto attributes : { false, true })
+        {
+            // LOD生成のみを計測する.
+            MeshPostProcessOption option;
+            option.Deduplicate   = false;
+            option.VertexCache   = false;
+            option.Overdraw      = false;
+            option.VertexFetch   = false;
+            option.GenerateLod   = true;
+            option.LodAttributes = attributes;
+
+            double        best;
+            MeshAuxData   aux;
+            asdx::ResMesh mesh;
+            if (!MeasureBest(loopCount,
+                [&]() { mesh = source; },
+                [&]() { return PostProcessMesh(mesh, option, &aux); },
+                best))
+            { return false; }
+
+            LogBenchmark(attributes ? "attribute" : "index only", best);
+            for(size_t i=0; i<aux.Lods.size(); ++i)
+            {
+                ILOGA("        LOD%zu : triangles = %zu, error = %f",
+                    i + 1, aux.Lods[i].Indices.size() / 3, aux.Lods[i].Error);
+            }
+        }
+    }
+
+    return true;
+}
+#endif
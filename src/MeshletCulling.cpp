@@ -0,0 +1,279 @@
+﻿//-----------------------------------------------------------------------------
+// File : MeshletCulling.cpp
+// Desc : CPU Meshlet Culling.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MeshletCulling.h>
+#include <cmath>
+
+#if ENABLE_MESH_BENCHMARK
+#include <Benchmark.h>
+#include <OBJLoader.h>
+#include <cfloat>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      平面を正規化します.
+//-----------------------------------------------------------------------------
+asdx::Vector4 NormalizePlane(float a, float b, float c, float d)
+{
+    auto length = sqrtf(a * a + b * b + c * c);
+    auto scale  = (length > 0.0f) ? 1.0f / length : 0.0f;
+    return asdx::Vector4(a * scale, b * scale, c * scale, d * scale);
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      カリング用のビューを作成します.
+//-----------------------------------------------------------------------------
+MeshletCullingView CreateMeshletCullingView
+(
+    const asdx::Matrix&     world,
+    const asdx::Matrix&     viewProj,
+    const asdx::Vector3&    cameraPos
+)
+{
+    // 行ベクトル規約なので, クリップ座標は列との内積になる.
+    auto m = world * viewProj;
+    auto p = reinterpret_cast<const float*>(&m);
+    auto column = [p](int index)
+    { return asdx::Vector4(p[index], p[4 + index], p[8 + index], p[12 + index]); };
+
+    auto c0 = column(0);
+    auto c1 = column(1);
+    auto c2 = column(2);
+    auto c3 = column(3);
+
+    MeshletCullingView result;
+    result.Planes[0] = NormalizePlane(c3.x + c0.x, c3.y + c0.y, c3.z + c0.z, c3.w + c0.w);    // 左.
+    result.Planes[1] = NormalizePlane(c3.x - c0.x, c3.y - c0.y, c3.z - c0.z, c3.w - c0.w);    // 右.
+    result.Planes[2] = NormalizePlane(c3.x + c1.x, c3.y + c1.y, c3.z + c1.z, c3.w + c1.w);    // 下.
+    result.Planes[3] = NormalizePlane(c3.x - c1.x, c3.y - c1.y, c3.z - c1.z, c3.w - c1.w);    // 上.
+    result.Planes[4] = NormalizePlane(c2.x, c2.y, c2.z, c2.w);                                // 近.
+    result.Planes[5] = NormalizePlane(c3.x - c2.x, c3.y - c2.y, c3.z - c2.z, c3.w - c2.w);    // 遠.
+    result.CameraPos = asdx::Vector3::TransformCoord(cameraPos, asdx::Matrix::Invert(world));
+
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュレットをカリングします.
+//-----------------------------------------------------------------------------
+uint32_t CullMeshlets
+(
+    const MeshAuxData&          aux,
+    const MeshletCullingView&   view,
+    std::vector<uint32_t>&      visible,
+    MeshletCullingStats*        pStats
+)
+{
+    visible.clear();
+    visible.reserve(aux.Meshlets.size());
+
+    MeshletCullingStats stats;
+
+    auto count = uint32_t(aux.Meshlets.size());
+    for(auto i=0u; i<count; ++i)
+    {
+        const auto& bounds = aux.Bounds[i];
+        auto triangles = aux.Meshlets[i].TriangleCount;
+
+        stats.TriangleCount += triangles;
+
+        // 視錐台カリング (バウンディング球).
+        auto outside = false;
+        for(auto j=0; j<6; ++j)
+        {
+            const auto& plane = view.Planes[j];
+            auto distance = plane.x * bounds.Center.x
+                          + plane.y * bounds.Center.y
+                          + plane.z * bounds.Center.z
+                          + plane.w;
+            if (distance < -bounds.Radius)
+            {
+                outside = true;
+                break;
+            }
+        }
+
+        if (outside)
+        {
+            stats.FrustumCulled += triangles;
+            continue;
+        }
+
+        // 背面カリング (法線コーン).
+        auto dx = bounds.Center.x - view.CameraPos.x;
+        auto dy = bounds.Center.y - view.CameraPos.y;
+        auto dz = bounds.Center.z - view.CameraPos.z;
+        auto d  = dx * bounds.ConeAxis.x + dy * bounds.ConeAxis.y + dz * bounds.ConeAxis.z;
+        if (d >= bounds.ConeCutoff * sqrtf(dx * dx + dy * dy + dz * dz) + bounds.Radius)
+        {
+            stats.ConeCulled += triangles;
+            continue;
+        }
+
+        visible.push_back(i);
+        stats.VisibleTriangles += triangles;
+    }
+
+    stats.MeshletCount    = count;
+    stats.VisibleMeshlets = uint32_t(visible.size());
+
+    if (pStats != nullptr)
+    { *pStats = stats; }
+
+    return stats.VisibleMeshlets;
+}
+
+#if ENABLE_MESH_BENCHMARK
+//-----------------------------------------------------------------------------
+//      メッシュレット生成とカリングの処理時間, 三角形の除外率を計測します.
+//-----------------------------------------------------------------------------
+bool BenchmarkMeshlet(const char* path, uint32_t loopCount)
+{
+    asdx::ResModel model;
+    if (path != nullptr)
+    {
+        OBJLoader loader;
+        if (!loader.Load(path, model))
+        {
+            ELOGA("Error : OBJLoader::Load() Failed. path = %s", path);
+            return false;
+        }
+    }
+    else
+    {
+        // 凹凸のある球 (法線の向きがばらつくので法線コーンの効果が分かる).
+        const uint32_t kSlices = 512;
+        const uint32_t kStacks = 256;
+
+        model.Meshes.resize(1);
+        auto& mesh = model.Meshes[0];
+        for(auto y=0u; y<=kStacks; ++y)
+        {
+            for(auto x=0u; x<=kSlices; ++x)
+            {
+                auto theta = 3.14159265f * float(y) / float(kStacks);
+                auto phi   = 6.28318531f * float(x) / float(kSlices);
+                auto r     = 1.0f + 0.02f * sinf(theta * 40.0f) * cosf(phi * 40.0f);
+                mesh.Positions.push_back(asdx::Vector3(
+                    r * sinf(theta) * cosf(phi),
+                    r * cosf(theta),
+                    r * sinf(theta) * sinf(phi)));
+            }
+        }
+        for(auto y=0u; y<kStacks; ++y)
+        {
+            for(auto x=0u; x<kSlices; ++x)
+            {
+                auto i0 = y * (kSlices + 1) + x;
+                auto i1 = i0 + 1;
+                auto i2 = i0 + kSlices + 1;
+                auto i3 = i2 + 1;
+                mesh.Indices.insert(mesh.Indices.end(), { i0, i1, i2, i1, i3, i2 });
+            }
+        }
+    }
+
+    MeshPostProcessOption option;
+    option.GenerateLod     = false;
+    option.GenerateMeshlet = true;
+
+    std::vector<MeshAuxData> aux(model.Meshes.size());
+
+    // 生成時間 (メッシュレット以外の後処理も含む).
+    double         buildTime;
+    asdx::ResModel temp;
+    if (!MeasureBest(loopCount,
+        [&]() { temp = model; },
+        [&]() { return PostProcessModel(temp, option, &aux); },
+        buildTime))
+    { return false; }
+
+    model.Meshes.swap(temp.Meshes);
+
+    // 全体のバウンディング球を求める.
+    asdx::Vector3 mini( FLT_MAX,  FLT_MAX,  FLT_MAX);
+    asdx::Vector3 maxi(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+    size_t meshletCount = 0;
+    for(const auto& mesh : model.Meshes)
+    {
+        for(const auto& p : mesh.Positions)
+        {
+            mini = asdx::Vector3::Min(mini, p);
+            maxi = asdx::Vector3::Max(maxi, p);
+        }
+    }
+    for(const auto& item : aux)
+    { meshletCount += item.Meshlets.size(); }
+
+    auto center = (mini + maxi) * 0.5f;
+    auto radius = (maxi - mini).Length() * 0.5f;
+
+    ILOGA("Info : Meshlet Benchmark. meshlets = %zu", meshletCount);
+    LogBenchmark("build", buildTime);
+
+    // モデルを周回するカメラで計測する.
+    const uint32_t kViewCount = 8;
+    auto proj = asdx::Matrix::CreatePerspectiveFieldOfView(asdx::ToRadian(60.0f), 16.0f / 9.0f, radius * 0.01f, radius * 10.0f);
+
+    std::vector<uint32_t> visible;
+    uint64_t totalTriangles = 0;
+    uint64_t frustumCulled  = 0;
+    uint64_t coneCulled     = 0;
+    auto     cullTime       = 0.0;
+
+    for(auto v=0u; v<kViewCount; ++v)
+    {
+        // 近づいた視点では視錐台カリング, 遠い視点では背面カリングが主に効く.
+        auto angle    = 6.28318531f * float(v) / float(kViewCount);
+        auto distance = radius * ((v & 0x1) ? 3.0f : 0.7f);
+        auto eye      = center + asdx::Vector3(cosf(angle), 0.3f, sinf(angle)) * distance;
+        auto view     = asdx::Matrix::CreateLookAt(eye, center, asdx::Vector3(0.0f, 1.0f, 0.0f));
+
+        double best;
+        if (!MeasureBest(loopCount, [&]()
+        {
+            for(size_t j=0; j<aux.size(); ++j)
+            {
+                auto cullingView = CreateMeshletCullingView(asdx::Matrix::CreateIdentity(), view * proj, eye);
+                CullMeshlets(aux[j], cullingView, visible);
+            }
+            return true;
+        }, best))
+        { return false; }
+        cullTime += best;
+
+        for(size_t j=0; j<aux.size(); ++j)
+        {
+            MeshletCullingStats stats;
+            auto cullingView = CreateMeshletCullingView(asdx::Matrix::CreateIdentity(), view * proj, eye);
+            CullMeshlets(aux[j], cullingView, visible, &stats);
+
+            totalTriangles += stats.TriangleCount;
+            frustumCulled  += stats.FrustumCulled;
+            coneCulled     += stats.ConeCulled;
+        }
+    }
+
+    if (totalTriangles == 0)
+    { return false; }
+
+    LogBenchmark("cull", cullTime / kViewCount, 0.0, "per view");
+    ILOGA("    frustum    : %.1lf %% triangles rejected", 100.0 * double(frustumCulled) / double(totalTriangles));
+    ILOGA("    cone       : %.1lf %% triangles rejected", 100.0 * double(coneCulled) / double(totalTriangles));
+    ILOGA("    total      : %.1lf %% triangles rejected", 100.0 * double(frustumCulled + coneCulled) / double(totalTriangles));
+
+    return true;
+}
+#endif
@@ -0,0 +1,735 @@
+﻿//-----------------------------------------------------------------------------
+// File : ModelCache.cpp
+// Desc : Binary Model Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <ModelCache.h>
+#include <MappedFile.h>
+#include <ParallelFor.h>
+#include <asdxLogger.h>
+#include <asdxMisc.h>
+#include <meshoptimizer.h>
+#include <cstring>
+#include <cstdio>
+#include <Windows.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t   kMagic          = 0x4143454D;   // 'MECA'
+static const uint64_t   kAlignment      = 16;           // 各ストリームの配置境界.
+static const uint64_t   kMaxVertexRatio = 1024;         // 頂点圧縮の最大展開率(制御ビット 2bit あたり最大 256 バイト).
+
+///////////////////////////////////////////////////////////////////////////////
+// STREAM_TYPE
+///////////////////////////////////////////////////////////////////////////////
+enum STREAM_TYPE
+{
+    STREAM_MESH_NAME,
+    STREAM_MATERIAL_NAME,
+    STREAM_POSITION,
+    STREAM_NORMAL,
+    STREAM_TANGENT,
+    STREAM_COLOR,
+    STREAM_TEXCOORD0,
+    STREAM_TEXCOORD1,
+    STREAM_TEXCOORD2,
+    STREAM_TEXCOORD3,
+    STREAM_INDEX,
+    STREAM_BONE_INDEX,
+    STREAM_BONE_WEIGHT,
+    STREAM_INSTANCE,
+    STREAM_LOD_TABLE,
+    STREAM_LOD_INDEX,
+    STREAM_MESHLET,
+    STREAM_MESHLET_VERTEX,
+    STREAM_MESHLET_TRIANGLE,
+    STREAM_MESHLET_BOUNDS,
+    STREAM_COUNT,
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// STREAM_CODEC
+///////////////////////////////////////////////////////////////////////////////
+enum STREAM_CODEC
+{
+    STREAM_CODEC_RAW,       // 無圧縮.
+    STREAM_CODEC_VERTEX,    // meshopt_encodeVertexBuffer.
+    STREAM_CODEC_INDEX,     // meshopt_encodeIndexBuffer.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// CacheHeader structure
+///////////////////////////////////////////////////////////////////////////////
+struct CacheHeader
+{
+    uint32_t    Magic;
+    uint32_t    FormatVersion;
+    uint32_t    ImporterVersion;
+    uint32_t    StreamCount;        // STREAM_COUNT (メッシュエントリのサイズ確認用).
+    uint32_t    OptionHash;         // 後処理オプションのハッシュ値.
+    uint32_t    Reserved;
+    uint64_t    SourceSize;         // 元ファイルのサイズ.
+    uint64_t    SourceTime;         // 元ファイルの更新日時.
+    uint64_t    FileSize;           // キャッシュファイル全体のサイズ(書き込み途中の検出用).
+    uint64_t    PathOffset;         // 元ファイルパス.
+    uint64_t    PathLength;
+    uint64_t    MeshOffset;         // MeshEntry の配列.
+    uint64_t    MeshCount;
+    uint64_t    MaterialOffset;     // マテリアルのバイト列.
+    uint64_t    MaterialSize;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// StreamEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct StreamEntry
+{
+    uint64_t    Offset;
+    uint64_t    Count;              // 展開後の要素数.
+    uint64_t    Size;               // ファイル上のバイト数.
+    uint32_t    Codec;              // STREAM_CODEC.
+    uint32_t    Reserved;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// LodEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct LodEntry
+{
+    uint32_t    IndexCount;         // STREAM_LOD_INDEX 内の要素数(LOD順に連結).
+    float       Error;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// MeshEntry structure
+///////////////////////////////////////////////////////////////////////////////
+struct MeshEntry
+{
+    StreamEntry Streams[STREAM_COUNT];
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Writer class
+///////////////////////////////////////////////////////////////////////////////
+class Writer
+{
+public:
+    std::vector<uint8_t>    Data;
+
+    // 境界を揃えてデータを追加し, オフセットを返却します.
+    uint64_t Append(const void* pData, size_t size, uint64_t alignment = kAlignment)
+    {
+        auto offset = (uint64_t(Data.size()) + alignment - 1) & ~(alignment - 1);
+        Data.resize(size_t(offset) + size);
+        if (size > 0)
+        { memcpy(Data.data() + offset, pData, size); }
+        return offset;
+    }
+
+    template<typename T>
+    StreamEntry Append(const std::vector<T>& values)
+    {
+        StreamEntry entry = {};
+        entry.Count  = values.size();
+        entry.Size   = sizeof(T) * values.size();
+        entry.Offset = Append(values.data(), size_t(entry.Size));
+        return entry;
+    }
+
+    StreamEntry Append(const std::string& value)
+    {
+        StreamEntry entry = {};
+        entry.Count  = value.size();
+        entry.Size   = value.size();
+        entry.Offset = Append(value.data(), value.size(), 1);
+        return entry;
+    }
+
+    // 頂点コーデックで圧縮して追加します. 縮まない場合は無圧縮で格納します.
+    template<typename T>
+    StreamEntry AppendVertices(const std::vector<T>& values)
+    {
+        static_assert(sizeof(T) % 4 == 0 && sizeof(T) <= 256, "Invalid Vertex Size.");
+        if (values.empty())
+        { return Append(values); }
+
+        m_Encoded.resize(meshopt_encodeVertexBufferBound(values.size(), sizeof(T)));
+        auto size = meshopt_encodeVertexBuffer(
+            m_Encoded.data(), m_Encoded.size(), values.data(), values.size(), sizeof(T));
+        if (size == 0 || size >= sizeof(T) * values.size())
+        { return Append(values); }
+
+        StreamEntry entry = {};
+        entry.Count  = values.size();
+        entry.Size   = size;
+        entry.Codec  = STREAM_CODEC_VERTEX;
+        entry.Offset = Append(m_Encoded.data(), size);
+        return entry;
+    }
+
+    // インデックスコーデックで圧縮して追加します. 三角形リストでない場合は無圧縮で格納します.
+    StreamEntry AppendIndices(const std::vector<uint32_t>& indices, size_t vertexCount)
+    {
+        if (indices.empty() || indices.size() % 3 != 0)
+        { return Append(indices); }
+
+        m_Encoded.resize(meshopt_encodeIndexBufferBound(indices.size(), vertexCount));
+        auto size = meshopt_encodeIndexBuffer(
+            m_Encoded.data(), m_Encoded.size(), indices.data(), indices.size());
+        if (size == 0 || size >= sizeof(uint32_t) * indices.size())
+        { return Append(indices); }
+
+        StreamEntry entry = {};
+        entry.Count  = indices.size();
+        entry.Size   = size;
+        entry.Codec  = STREAM_CODEC_INDEX;
+        entry.Offset = Append(m_Encoded.data(), size);
+        return entry;
+    }
+
+    // 可変長データ用 (境界揃え無し).
+    void Write(const void* pData, size_t size)
+    { Append(pData, size, 1); }
+
+    void Write(uint32_t value)
+    { Write(&value, sizeof(value)); }
+
+    void Write(const std::string& value)
+    {
+        Write(uint32_t(value.size()));
+        Write(value.data(), value.size());
+    }
+
+private:
+    std::vector<uint8_t>    m_Encoded;  // 圧縮用の作業領域.
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Reader class
+///////////////////////////////////////////////////////////////////////////////
+class Reader
+{
+public:
+    Reader(const uint8_t* pData, uint64_t size)
+    : m_pData(pData)
+    , m_Size (size)
+    { /* DO_NOTHING */ }
+
+    // ストリームをコピーします. 圧縮されている場合は展開します.
+    template<typename T>
+    bool Copy(const StreamEntry& entry, std::vector<T>& values) const
+    {
+        if (!IsValid(entry.Offset, entry.Size, 1))
+        { return false; }
+
+        auto pSrc = m_pData + entry.Offset;
+        switch(entry.Codec)
+        {
+        case STREAM_CODEC_RAW:
+            {
+                if (entry.Size != sizeof(T) * entry.Count)
+                { return false; }
+
+                values.resize(size_t(entry.Count));
+                if (entry.Count > 0)
+                { memcpy(values.data(), pSrc, size_t(entry.Size)); }
+            }
+            return true;
+
+        case STREAM_CODEC_VERTEX:
+            {
+                // 展開率の上限を超える要素数は壊れているとみなし, 巨大な確保をしないよう弾く.
+                if (entry.Count > entry.Size * kMaxVertexRatio / sizeof(T))
+                { return false; }
+
+                values.resize(size_t(entry.Count));
+                return meshopt_decodeVertexBuffer(
+                    values.data(), values.size(), sizeof(T), pSrc, size_t(entry.Size)) == 0;
+            }
+
+        case STREAM_CODEC_INDEX:
+            {
+                // 1三角形あたり最低1バイトは必要なので, 壊れた要素数で巨大な確保をしないよう弾く.
+                if (sizeof(T) != sizeof(uint32_t) || entry.Count > entry.Size * 3)
+                { return false; }
+
+                values.resize(size_t(entry.Count));
+                return meshopt_decodeIndexBuffer(
+                    values.data(), values.size(), sizeof(T), pSrc, size_t(entry.Size)) == 0;
+            }
+        }
+
+        return false;
+    }
+
+    bool Copy(const StreamEntry& entry, std::string& value) const
+    {
+        if (entry.Codec != STREAM_CODEC_RAW || !IsValid(entry.Offset, entry.Count, 1))
+        { return false; }
+
+        value.assign(reinterpret_cast<const char*>(m_pData + entry.Offset), size_t(entry.Count));
+        return true;
+    }
+
+    // 可変長データを先頭から順に読み取ります.
+    bool Read(void* pData, size_t size)
+    {
+        if (!IsValid(m_Cursor, size, 1))
+        { return false; }
+
+        memcpy(pData, m_pData + m_Cursor, size);
+        m_Cursor += size;
+        return true;
+    }
+
+    bool Read(uint32_t& value)
+    { return Read(&value, sizeof(value)); }
+
+    // 要素数を読み取ります. 各要素が最低 minSize バイトを必要とするとして残りサイズに収まらない場合は失敗します.
+    bool ReadCount(uint32_t& count, uint64_t minSize)
+    { return Read(count) && IsValid(m_Cursor, count, minSize); }
+
+    bool Read(std::string& value)
+    {
+        uint32_t length = 0;
+        if (!Read(length) || !IsValid(m_Cursor, length, 1))
+        { return false; }
+
+        value.assign(reinterpret_cast<const char*>(m_pData + m_Cursor), length);
+        m_Cursor += length;
+        return true;
+    }
+
+    void Seek(uint64_t offset, uint64_t size)
+    {
+        m_Cursor = offset;
+        m_Size   = (IsValid(offset, size, 1)) ? offset + size : 0;
+    }
+
+    bool IsValid(uint64_t offset, uint64_t count, uint64_t stride) const
+    {
+        if (offset > m_Size)
+        { return false; }
+        return count <= (m_Size - offset) / stride;
+    }
+
+private:
+    const uint8_t*  m_pData;
+    uint64_t        m_Size;
+    uint64_t        m_Cursor = 0;
+};
+
+//-----------------------------------------------------------------------------
+//      ファイルのサイズと更新日時を取得します.
+//-----------------------------------------------------------------------------
+bool GetFileStamp(const char* path, uint64_t& size, uint64_t& time)
+{
+    WIN32_FILE_ATTRIBUTE_DATA data = {};
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data))
+    { return false; }
+
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+    { return false; }
+
+    size = (uint64_t(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    time = (uint64_t(data.ftLastWriteTime.dwHighDateTime) << 32) | data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      マテリアルを書き出します.
+//-----------------------------------------------------------------------------
+void WriteMaterials(const std::vector<asdx::ResMaterial>& materials, Writer& writer)
+{
+    for(const auto& material : materials)
+    {
+        writer.Write(material.Name);
+
+        writer.Write(uint32_t(material.Props.size()));
+        for(const auto& prop : material.Props)
+        {
+            writer.Write(prop.Name);
+            writer.Write(uint32_t(prop.Type));
+            writer.Write(&prop.Value, sizeof(prop.Value));
+        }
+
+        writer.Write(uint32_t(material.Textures.size()));
+        for(const auto& texture : material.Textures)
+        {
+            writer.Write(texture.Name);
+            writer.Write(texture.Path);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      マテリアルを読み込みます.
+//-----------------------------------------------------------------------------
+bool ReadMaterials(Reader& reader, std::vector<asdx::ResMaterial>& materials)
+{
+    for(auto& material : materials)
+    {
+        if (!reader.Read(material.Name))
+        { return false; }
+
+        // 名前の長さ + 型 + 値.
+        uint32_t count = 0;
+        if (!reader.ReadCount(count, sizeof(uint32_t) * 2 + sizeof(material.Props[0].Value)))
+        { return false; }
+
+        material.Props.resize(count);
+        for(auto& prop : material.Props)
+        {
+            uint32_t type = 0;
+            if (!reader.Read(prop.Name)
+             || !reader.Read(type)
+             || !reader.Read(&prop.Value, sizeof(prop.Value)))
+            { return false; }
+
+            prop.Type = static_cast<decltype(prop.Type)>(type);
+        }
+
+        // 名前の長さ + パスの長さ.
+        if (!reader.ReadCount(count, sizeof(uint32_t) * 2))
+        { return false; }
+
+        material.Textures.resize(count);
+        for(auto& texture : material.Textures)
+        {
+            if (!reader.Read(texture.Name) || !reader.Read(texture.Path))
+            { return false; }
+        }
+    }
+
+    return true;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// ModelCache class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      キャッシュファイルのパスを取得します.
+//-----------------------------------------------------------------------------
+std::string ModelCache::GetPath(const char* cacheDir, const char* sourcePath)
+{
+    std::string source(sourcePath);
+    auto pos  = source.find_last_of("/\\");
+    auto name = (pos == std::string::npos) ? source : source.substr(pos + 1);
+
+    // 別フォルダの同名ファイルと衝突しないよう, 正規化したフルパスのハッシュを付ける.
+    char fullPath[MAX_PATH] = {};
+    auto length = GetFullPathNameA(sourcePath, MAX_PATH, fullPath, nullptr);
+    std::string normalized = (length > 0 && length < MAX_PATH) ? fullPath : source;
+
+    uint32_t hash = 2166136261u;   // FNV-1a.
+    for(auto c : normalized)
+    {
+        if (c == '/')
+        { c = '\\'; }
+        else if ('A' <= c && c <= 'Z')
+        { c = char(c - 'A' + 'a'); }
+
+        hash ^= uint8_t(c);
+        hash *= 16777619u;
+    }
+
+    char suffix[16] = {};
+    sprintf_s(suffix, ".%08x", hash);
+
+    std::string result(cacheDir);
+    if (!result.empty() && result.back() != '/' && result.back() != '\\')
+    { result += '\\'; }
+
+    result += name;
+    result += suffix;
+    result += ".mecache";
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュを読み込みます.
+//-----------------------------------------------------------------------------
+bool ModelCache::Load
+(
+    const char*                             cachePath,
+    const char*                             sourcePath,
+    uint32_t                                optionHash,
+    asdx::ResModel&                         model,
+    std::vector<std::vector<asdx::Matrix>>& instances,
+    std::vector<MeshAuxData>&               aux
+)
+{
+    if (cachePath == nullptr || sourcePath == nullptr)
+    { return false; }
+
+    // キャッシュが無いのは正常なので, マッピング前に存在を確認しておく.
+    uint64_t sourceSize = 0;
+    uint64_t sourceTime = 0;
+    uint64_t cacheSize  = 0;
+    uint64_t cacheTime  = 0;
+    if (!GetFileStamp(sourcePath, sourceSize, sourceTime)
+     || !GetFileStamp(cachePath,  cacheSize,  cacheTime))
+    { return false; }
+
+    MappedFile file;
+    if (!file.Open(cachePath))
+    { return false; }
+
+    auto pData = file.GetData();
+    auto size  = uint64_t(file.GetSize());
+    if (size < sizeof(CacheHeader))
+    { return false; }
+
+    CacheHeader header;
+    memcpy(&header, pData, sizeof(header));
+
+    // 形式とキーの確認.
+    if (header.Magic           != kMagic
+     || header.FormatVersion   != FormatVersion
+     || header.ImporterVersion != ImporterVersion
+     || header.StreamCount     != STREAM_COUNT
+     || header.OptionHash      != optionHash
+     || header.FileSize        != size
+     || header.SourceSize      != sourceSize
+     || header.SourceTime      != sourceTime)
+    { return false; }
+
+    Reader reader(pData, size);
+
+    std::string path;
+    if (!reader.Copy(StreamEntry{ header.PathOffset, header.PathLength, header.PathLength, STREAM_CODEC_RAW, 0 }, path)
+     || _stricmp(path.c_str(), sourcePath) != 0)
+    { return false; }
+
+    if (!reader.IsValid(header.MeshOffset, header.MeshCount, sizeof(MeshEntry)))
+    { return false; }
+
+    auto meshCount = size_t(header.MeshCount);
+    std::vector<MeshEntry> entries(meshCount);
+    if (meshCount > 0)
+    { memcpy(entries.data(), pData + header.MeshOffset, sizeof(MeshEntry) * meshCount); }
+
+    model.Meshes.resize(meshCount);
+    instances.resize(meshCount);
+    aux.clear();
+    aux.resize(meshCount);
+
+    // ページフォルトを重ねるためメッシュ単位で並列にコピーする.
+    std::atomic<bool> failed(false);
+    ParallelFor(meshCount, [&](size_t i)
+    {
+        const auto& streams = entries[i].Streams;
+        auto& mesh = model.Meshes[i];
+
+        auto result = reader.Copy(streams[STREAM_MESH_NAME],     mesh.MeshName)
+                   && reader.Copy(streams[STREAM_MATERIAL_NAME], mesh.MaterialName)
+                   && reader.Copy(streams[STREAM_POSITION],      mesh.Positions)
+                   && reader.Copy(streams[STREAM_NORMAL],        mesh.Normals)
+                   && reader.Copy(streams[STREAM_TANGENT],       mesh.Tangents)
+                   && reader.Copy(streams[STREAM_COLOR],         mesh.Colors)
+                   && reader.Copy(streams[STREAM_TEXCOORD0],     mesh.TexCoords[0])
+                   && reader.Copy(streams[STREAM_TEXCOORD1],     mesh.TexCoords[1])
+                   && reader.Copy(streams[STREAM_TEXCOORD2],     mesh.TexCoords[2])
+                   && reader.Copy(streams[STREAM_TEXCOORD3],     mesh.TexCoords[3])
+                   && reader.Copy(streams[STREAM_INDEX],         mesh.Indices)
+                   && reader.Copy(streams[STREAM_BONE_INDEX],    mesh.BoneIndices)
+                   && reader.Copy(streams[STREAM_BONE_WEIGHT],   mesh.BoneWeights)
+                   && reader.Copy(streams[STREAM_INSTANCE],      instances[i]);
+
+        // LODは連結したインデックスを分割する.
+        std::vector<LodEntry> lods;
+        std::vector<uint32_t> lodIndices;
+        result = result
+              && reader.Copy(streams[STREAM_LOD_TABLE],         lods)
+              && reader.Copy(streams[STREAM_LOD_INDEX],         lodIndices)
+              && reader.Copy(streams[STREAM_MESHLET],           aux[i].Meshlets)
+              && reader.Copy(streams[STREAM_MESHLET_VERTEX],    aux[i].MeshletVertices)
+              && reader.Copy(streams[STREAM_MESHLET_TRIANGLE],  aux[i].MeshletTriangles)
+              && reader.Copy(streams[STREAM_MESHLET_BOUNDS],    aux[i].Bounds)
+              && aux[i].Meshlets.size() == aux[i].Bounds.size();
+
+        size_t offset = 0;
+        aux[i].Lods.resize(lods.size());
+        for(size_t j=0; j<lods.size() && result; ++j)
+        {
+            auto count = size_t(lods[j].IndexCount);
+            if (count > lodIndices.size() - offset)
+            {
+                result = false;
+                break;
+            }
+
+            auto& lod = aux[i].Lods[j];
+            lod.Error = lods[j].Error;
+            lod.Indices.assign(lodIndices.begin() + offset, lodIndices.begin() + offset + count);
+            offset += count;
+        }
+
+        if (!result)
+        { failed = true; }
+    });
+
+    if (failed)
+    {
+        WLOGA("Warning : Model Cache Broken. path = %s", cachePath);
+        return false;
+    }
+
+    // マテリアル.
+    // 名前の長さ + プロパティ数 + テクスチャ数.
+    uint32_t materialCount = 0;
+    reader.Seek(header.MaterialOffset, header.MaterialSize);
+    if (!reader.ReadCount(materialCount, sizeof(uint32_t) * 3))
+    {
+        WLOGA("Warning : Model Cache Broken. path = %s", cachePath);
+        return false;
+    }
+
+    model.Materials.resize(materialCount);
+    if (!ReadMaterials(reader, model.Materials))
+    {
+        WLOGA("Warning : Model Cache Broken. path = %s", cachePath);
+        return false;
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      キャッシュを書き出します.
+//-----------------------------------------------------------------------------
+bool ModelCache::Save
+(
+    const char*                                     cachePath,
+    const char*                                     sourcePath,
+    uint32_t                                        optionHash,
+    const asdx::ResModel&                           model,
+    const std::vector<std::vector<asdx::Matrix>>&   instances,
+    const std::vector<MeshAuxData>&                 aux
+)
+{
+    if (cachePath == nullptr || sourcePath == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
+
+    CacheHeader header = {};
+    header.Magic           = kMagic;
+    header.FormatVersion   = FormatVersion;
+    header.ImporterVersion = ImporterVersion;
+    header.StreamCount     = STREAM_COUNT;
+    header.OptionHash      = optionHash;
+    if (!GetFileStamp(sourcePath, header.SourceSize, header.SourceTime))
+    {
+        ELOGA("Error : File Not Found. path = %s", sourcePath);
+        return false;
+    }
+
+    Writer writer;
+    writer.Append(&header, sizeof(header));
+
+    std::string path(sourcePath);
+    auto pathEntry = writer.Append(path);
+    header.PathOffset = pathEntry.Offset;
+    header.PathLength = pathEntry.Count;
+
+    // メッシュテーブルは後で埋める.
+    std::vector<MeshEntry> entries(model.Meshes.size());
+    header.MeshCount  = entries.size();
+    header.MeshOffset = writer.Append(entries.data(), sizeof(MeshEntry) * entries.size());
+
+    static const std::vector<asdx::Matrix> kEmpty;
+    static const MeshAuxData kEmptyAux;
+    std::vector<LodEntry> lods;
+    std::vector<uint32_t> lodIndices;
+    for(size_t i=0; i<model.Meshes.size(); ++i)
+    {
+        const auto& mesh = model.Meshes[i];
+        auto& streams = entries[i].Streams;
+
+        streams[STREAM_MESH_NAME]     = writer.Append(mesh.MeshName);
+        streams[STREAM_MATERIAL_NAME] = writer.Append(mesh.MaterialName);
+        streams[STREAM_POSITION]      = writer.AppendVertices(mesh.Positions);
+        streams[STREAM_NORMAL]        = writer.AppendVertices(mesh.Normals);
+        streams[STREAM_TANGENT]       = writer.AppendVertices(mesh.Tangents);
+        streams[STREAM_COLOR]         = writer.AppendVertices(mesh.Colors);
+        streams[STREAM_TEXCOORD0]     = writer.AppendVertices(mesh.TexCoords[0]);
+        streams[STREAM_TEXCOORD1]     = writer.AppendVertices(mesh.TexCoords[1]);
+        streams[STREAM_TEXCOORD2]     = writer.AppendVertices(mesh.TexCoords[2]);
+        streams[STREAM_TEXCOORD3]     = writer.AppendVertices(mesh.TexCoords[3]);
+        streams[STREAM_INDEX]         = writer.AppendIndices(mesh.Indices, mesh.Positions.size());
+        streams[STREAM_BONE_INDEX]    = writer.AppendVertices(mesh.BoneIndices);
+        streams[STREAM_BONE_WEIGHT]   = writer.AppendVertices(mesh.BoneWeights);
+        streams[STREAM_INSTANCE]      = writer.Append((i < instances.size()) ? instances[i] : kEmpty);
+
+        const auto& meshAux = (i < aux.size()) ? aux[i] : kEmptyAux;
+
+        lods.clear();
+        lodIndices.clear();
+        for(const auto& lod : meshAux.Lods)
+        {
+            lods.push_back(LodEntry{ uint32_t(lod.Indices.size()), lod.Error });
+            lodIndices.insert(lodIndices.end(), lod.Indices.begin(), lod.Indices.end());
+        }
+        streams[STREAM_LOD_TABLE]         = writer.Append(lods);
+        streams[STREAM_LOD_INDEX]         = writer.AppendIndices(lodIndices, mesh.Positions.size());
+        streams[STREAM_MESHLET]           = writer.Append(meshAux.Meshlets);
+        streams[STREAM_MESHLET_VERTEX]    = writer.Append(meshAux.MeshletVertices);
+        streams[STREAM_MESHLET_TRIANGLE]  = writer.Append(meshAux.MeshletTriangles);
+        streams[STREAM_MESHLET_BOUNDS]    = writer.Append(meshAux.Bounds);
+    }
+
+    if (!entries.empty())
+    { memcpy(writer.Data.data() + header.MeshOffset, entries.data(), sizeof(MeshEntry) * entries.size()); }
+
+    header.MaterialOffset = writer.Append(nullptr, 0);
+    writer.Write(uint32_t(model.Materials.size()));
+    WriteMaterials(model.Materials, writer);
+    header.MaterialSize = writer.Data.size() - header.MaterialOffset;
+
+    header.FileSize = writer.Data.size();
+    memcpy(writer.Data.data(), &header, sizeof(header));
+
+    // 書き込み途中のファイルを残さないよう, 一時ファイルから置き換える.
+    auto tempPath = std::string(cachePath) + ".tmp";
+
+    FILE* pFile = nullptr;
+    auto err = fopen_s(&pFile, tempPath.c_str(), "wb");
+    if (err != 0 || pFile == nullptr)
+    {
+        ELOGA("Error : File Open Failed. path = %s", tempPath.c_str());
+        return false;
+    }
+
+    auto written = fwrite(writer.Data.data(), 1, writer.Data.size(), pFile);
+    fclose(pFile);
+
+    if (written != writer.Data.size())
+    {
+        ELOGA("Error : File Write Failed. path = %s", tempPath.c_str());
+        DeleteFileA(tempPath.c_str());
+        return false;
+    }
+
+    if (!MoveFileExA(tempPath.c_str(), cachePath, MOVEFILE_REPLACE_EXISTING))
+    {
+        ELOGA("Error : MoveFileEx() Failed. path = %s", cachePath);
+        DeleteFileA(tempPath.c_str());
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,758 @@
+﻿//-----------------------------------------------------------------------------
+// File : MotionClip.cpp
+// Desc : Reduced And Quantized Motion Clip.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MotionClip.h>
+#include <algorithm>
+#include <cmath>
+#include <emmintrin.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t   kMaxSpan        = 256;                  // 1区間の最大フレーム数(削減コストの上限).
+static const float      kSqrt2          = 1.41421356237f;
+static const float      kRotationScale  = 32767.0f;             // smallest-three の各成分は15bit.
+static const float      kRangeScale     = 65535.0f;
+static const uint16_t   kIdentityKey[3] = { 0xC000, 0xC000, 0x4000 };  // 単位クォータニオン (w を落とした smallest-three).
+
+
+//-----------------------------------------------------------------------------
+//      キーの値が元の値の許容誤差に収まるかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsNear(const float* pKey, const float* pValue, uint32_t stride, float tolerance, bool rotation)
+{
+    // q と -q は同じ回転を表すので, 符号を揃えて比較.
+    auto sign = 1.0f;
+    if (rotation)
+    {
+        auto dot = 0.0f;
+        for(auto c=0u; c<stride; ++c)
+        { dot += pKey[c] * pValue[c]; }
+        sign = (dot < 0.0f) ? -1.0f : 1.0f;
+    }
+
+    for(auto c=0u; c<stride; ++c)
+    {
+        if (fabsf(pKey[c] * sign - pValue[c]) > tolerance)
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      区間 [s, e] を線形補間して許容誤差に収まるかチェックします.
+//-----------------------------------------------------------------------------
+bool IsFit
+(
+    const float*    pDecoded,
+    const float*    pValues,
+    uint32_t        stride,
+    uint32_t        s,
+    uint32_t        e,
+    float           tolerance,
+    bool            rotation
+)
+{
+    // 端点はデコード後の値を使い, サンプリング時と同じ補間を再現する.
+    const float* a = pDecoded + s * stride;
+    const float* b = pDecoded + e * stride;
+    auto inv = 1.0f / float(e - s);
+
+    // 回転は最短経路で補間.
+    auto sign = 1.0f;
+    if (rotation)
+    {
+        auto dot = 0.0f;
+        for(auto c=0u; c<stride; ++c)
+        { dot += a[c] * b[c]; }
+        sign = (dot < 0.0f) ? -1.0f : 1.0f;
+    }
+
+    float lerp[4];
+    for(auto f=s+1; f<=e; ++f)
+    {
+        auto t = float(f - s) * inv;
+
+        auto length = 0.0f;
+        for(auto c=0u; c<stride; ++c)
+        {
+            lerp[c] = a[c] + (b[c] * sign - a[c]) * t;
+            length += lerp[c] * lerp[c];
+        }
+
+        // クォータニオンはサンプリング時と同じく正規化して比較.
+        if (rotation && length > 0.0f)
+        {
+            auto scale = 1.0f / sqrtf(length);
+            for(auto c=0u; c<stride; ++c)
+            { lerp[c] *= scale; }
+        }
+
+        if (!IsNear(lerp, pValues + f * stride, stride, tolerance, rotation))
+        { return false; }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      線形補間で再現できるキーを間引きます.
+//-----------------------------------------------------------------------------
+void ReduceKeys
+(
+    const float*            pDecoded,
+    const float*            pValues,
+    uint32_t                count,
+    uint32_t                stride,
+    float                   tolerance,
+    bool                    rotation,
+    std::vector<uint32_t>&  keys
+)
+{
+    keys.clear();
+    keys.push_back(0);
+
+    // 定数チャンネルは1キーのみ.
+    auto constant = true;
+    for(auto f=0u; f<count && constant; ++f)
+    { constant = IsNear(pDecoded, pValues + f * stride, stride, tolerance, rotation); }
+
+    if (constant)
+    { return; }
+
+    // 許容誤差に収まる限り区間を伸ばす.
+    // 量子化誤差だけで許容誤差を超えるフレームは, どの区間にも収まらないため毎フレームがキーになる.
+    auto s = 0u;
+    while(s + 1 < count)
+    {
+        auto best = s + 1;
+        for(auto e=s+2; e<count && e-s<=kMaxSpan; ++e)
+        {
+            if (!IsFit(pDecoded, pValues, stride, s, e, tolerance, rotation))
+            { break; }
+            best = e;
+        }
+
+        keys.push_back(best);
+        s = best;
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      全フレームを範囲量子化でエンコードします.
+//-----------------------------------------------------------------------------
+void EncodeRange
+(
+    const float*            pValues,
+    uint32_t                count,
+    std::vector<uint16_t>&  values,
+    float                   (&mini)[3],
+    float                   (&ext)[3]
+)
+{
+    // キー削減の前に量子化するので, 範囲は全フレームから求める.
+    for(auto c=0; c<3; ++c)
+    {
+        auto lo = pValues[c];
+        auto hi = lo;
+        for(auto f=1u; f<count; ++f)
+        {
+            auto v = pValues[f * 3 + c];
+            lo = (v < lo) ? v : lo;
+            hi = (v > hi) ? v : hi;
+        }
+        mini[c] = lo;
+        ext [c] = hi - lo;
+    }
+
+    values.resize(count * 3);
+    for(auto f=0u; f<count; ++f)
+    {
+        for(auto c=0; c<3; ++c)
+        {
+            auto t = (ext[c] > 0.0f) ? (pValues[f * 3 + c] - mini[c]) / ext[c] : 0.0f;
+            values[f * 3 + c] = uint16_t(t * kRangeScale + 0.5f);
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      範囲量子化をデコードします.
+//-----------------------------------------------------------------------------
+inline void DecodeRange(const uint16_t* pValue, const float* mini, const float* ext, float* pResult)
+{
+    const float kInv = 1.0f / kRangeScale;
+    pResult[0] = mini[0] + float(pValue[0]) * kInv * ext[0];
+    pResult[1] = mini[1] + float(pValue[1]) * kInv * ext[1];
+    pResult[2] = mini[2] + float(pValue[2]) * kInv * ext[2];
+}
+
+//-----------------------------------------------------------------------------
+//      全フレームのクォータニオンを smallest-three 形式でエンコードします.
+//-----------------------------------------------------------------------------
+void EncodeRotation
+(
+    const float*            pValues,
+    uint32_t                count,
+    std::vector<uint16_t>&  values
+)
+{
+    values.resize(count * 3);
+    for(auto f=0u; f<count; ++f)
+    {
+        const float* q = pValues + f * 4;
+
+        // 絶対値が最大の成分を落とし, 符号を正に揃える.
+        auto largest = 0u;
+        for(auto c=1u; c<4; ++c)
+        {
+            if (fabsf(q[c]) > fabsf(q[largest]))
+            { largest = c; }
+        }
+        auto sign = (q[largest] < 0.0f) ? -1.0f : 1.0f;
+
+        uint16_t packed[3];
+        auto index = 0;
+        for(auto c=0u; c<4; ++c)
+        {
+            if (c == largest)
+            { continue; }
+
+            // [-1/sqrt(2), 1/sqrt(2)] を [0, 1] に変換.
+            auto t = (q[c] * sign * kSqrt2) * 0.5f + 0.5f;
+            t = (t < 0.0f) ? 0.0f : (t > 1.0f) ? 1.0f : t;
+            packed[index++] = uint16_t(t * kRotationScale + 0.5f);
+        }
+
+        // 落とした成分の番号を上位ビットに格納.
+        values[f * 3 + 0] = uint16_t(packed[0] | ((largest >> 1) << 15));
+        values[f * 3 + 1] = uint16_t(packed[1] | ((largest & 0x1) << 15));
+        values[f * 3 + 2] = packed[2];
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      smallest-three 形式のクォータニオンをデコードします.
+//-----------------------------------------------------------------------------
+inline void DecodeRotation(const uint16_t* pValue, float* pResult)
+{
+    const float kInv = 1.0f / kRotationScale;
+
+    auto largest = ((pValue[0] >> 15) << 1) | (pValue[1] >> 15);
+
+    float v[3];
+    v[0] = (float(pValue[0] & 0x7FFF) * kInv * 2.0f - 1.0f) / kSqrt2;
+    v[1] = (float(pValue[1] & 0x7FFF) * kInv * 2.0f - 1.0f) / kSqrt2;
+    v[2] = (float(pValue[2] & 0x7FFF) * kInv * 2.0f - 1.0f) / kSqrt2;
+
+    auto w = 1.0f - v[0] * v[0] - v[1] * v[1] - v[2] * v[2];
+
+    auto index = 0;
+    for(auto c=0; c<4; ++c)
+    {
+        if (c == largest)
+        { pResult[c] = (w > 0.0f) ? sqrtf(w) : 0.0f; }
+        else
+        { pResult[c] = v[index++]; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      エンコード済みの全フレームからキーを取り出します.
+//-----------------------------------------------------------------------------
+void SelectKeys
+(
+    const std::vector<uint16_t>&    encoded,
+    const std::vector<uint32_t>&    keys,
+    std::vector<uint16_t>&          frames,
+    std::vector<uint16_t>&          values
+)
+{
+    frames.resize(keys.size());
+    values.resize(keys.size() * 3);
+    for(size_t i=0; i<keys.size(); ++i)
+    {
+        frames[i] = uint16_t(keys[i]);
+        for(auto c=0; c<3; ++c)
+        { values[i * 3 + c] = encoded[keys[i] * 3 + c]; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      チャンネルをサンプリングします.
+//-----------------------------------------------------------------------------
+void SampleChannel
+(
+    const std::vector<uint16_t>&    frames,
+    const std::vector<uint16_t>&    values,
+    const float*                    mini,
+    const float*                    ext,
+    float                           frame,
+    bool                            rotation,
+    float*                          pResult
+)
+{
+    auto decode = [&](size_t key, float* pValue)
+    {
+        if (rotation)
+        { DecodeRotation(&values[key * 3], pValue); }
+        else
+        { DecodeRange(&values[key * 3], mini, ext, pValue); }
+    };
+
+    auto count = frames.size();
+    if (count == 1 || frame <= float(frames[0]))
+    {
+        decode(0, pResult);
+        return;
+    }
+
+    if (frame >= float(frames[count - 1]))
+    {
+        decode(count - 1, pResult);
+        return;
+    }
+
+    // frames[i] <= frame < frames[i + 1] となる区間を二分探索.
+    auto itr = std::upper_bound(frames.begin(), frames.end(), frame,
+        [](float lhs, uint16_t rhs) { return lhs < float(rhs); });
+    auto i = size_t(itr - frames.begin()) - 1;
+
+    float a[4];
+    float b[4];
+    decode(i,     a);
+    decode(i + 1, b);
+
+    auto t = (frame - float(frames[i])) / float(frames[i + 1] - frames[i]);
+
+    if (rotation)
+    {
+        // 最短経路で補間して正規化 (nlerp).
+        auto dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        auto sign = (dot < 0.0f) ? -1.0f : 1.0f;
+
+        auto length = 0.0f;
+        for(auto c=0; c<4; ++c)
+        {
+            pResult[c] = a[c] + (b[c] * sign - a[c]) * t;
+            length += pResult[c] * pResult[c];
+        }
+
+        auto inv = (length > 0.0f) ? 1.0f / sqrtf(length) : 1.0f;
+        for(auto c=0; c<4; ++c)
+        { pResult[c] *= inv; }
+    }
+    else
+    {
+        for(auto c=0; c<3; ++c)
+        { pResult[c] = a[c] + (b[c] - a[c]) * t; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      frames[i] <= frame < frames[i + 1] となるキーを探索します.
+//-----------------------------------------------------------------------------
+float FindKey
+(
+    const std::vector<uint16_t>&    frames,
+    float                           frame,
+    uint16_t&                       cursor,
+    size_t&                         i0,
+    size_t&                         i1
+)
+{
+    const uint32_t kMaxStep = 4;    // これ以上離れていたら二分探索.
+
+    auto count = frames.size();
+    if (count == 1 || frame <= float(frames[0]))
+    {
+        cursor = 0;
+        i0 = i1 = 0;
+        return 0.0f;
+    }
+
+    if (frame >= float(frames[count - 1]))
+    {
+        cursor = uint16_t(count - 1);
+        i0 = i1 = count - 1;
+        return 0.0f;
+    }
+
+    // 再生中はほぼ同じ区間か直後の区間になる.
+    size_t i = (cursor < count - 1) ? cursor : count - 2;
+    auto found = false;
+    if (float(frames[i]) <= frame)
+    {
+        for(auto step=0u; step<kMaxStep && i+1<count; ++step, ++i)
+        {
+            if (frame < float(frames[i + 1]))
+            {
+                found = true;
+                break;
+            }
+        }
+    }
+
+    if (!found)
+    {
+        auto itr = std::upper_bound(frames.begin(), frames.end(), frame,
+            [](float lhs, uint16_t rhs) { return lhs < float(rhs); });
+        i = size_t(itr - frames.begin()) - 1;
+    }
+
+    cursor = uint16_t(i);
+    i0 = i;
+    i1 = i + 1;
+    return (frame - float(frames[i])) / float(frames[i + 1] - frames[i]);
+}
+
+//-----------------------------------------------------------------------------
+//      チャンネルのメモリサイズを取得します.
+//-----------------------------------------------------------------------------
+size_t GetChannelSize(const std::vector<uint16_t>& frames, const std::vector<uint16_t>& values)
+{ return (frames.size() + values.size()) * sizeof(uint16_t) + sizeof(float) * 6; }
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MotionClip class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool MotionClip::Init(uint32_t boneCount, uint32_t frameCount)
+{
+    Term();
+
+    if (frameCount == 0 || frameCount > MaxFrameCount)
+    { return false; }
+
+    m_Tracks.resize(boneCount);
+    m_FrameCount = frameCount;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void MotionClip::Term()
+{
+    m_Tracks.clear();
+    m_Tracks.shrink_to_fit();
+    m_FrameCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      ボーンのトラックを設定します.
+//-----------------------------------------------------------------------------
+void MotionClip::SetTrack
+(
+    uint32_t                bone,
+    const std::string&      name,
+    const MotionPose*       pPoses,
+    const MotionTolerance&  tolerance
+)
+{
+    auto& track = m_Tracks[bone];
+    track.Name = name;
+
+    // チャンネルごとの連続配列に分解.
+    std::vector<float> translations(m_FrameCount * 3);
+    std::vector<float> rotations   (m_FrameCount * 4);
+    std::vector<float> scales      (m_FrameCount * 3);
+    for(auto f=0u; f<m_FrameCount; ++f)
+    {
+        const auto& pose = pPoses[f];
+        translations[f * 3 + 0] = pose.Translation.x;
+        translations[f * 3 + 1] = pose.Translation.y;
+        translations[f * 3 + 2] = pose.Translation.z;
+
+        scales[f * 3 + 0] = pose.Scale.x;
+        scales[f * 3 + 1] = pose.Scale.y;
+        scales[f * 3 + 2] = pose.Scale.z;
+
+        // 正規化して, 前フレームと同じ半球に揃える.
+        float q[4] = { pose.Rotation.x, pose.Rotation.y, pose.Rotation.z, pose.Rotation.w };
+        auto length = sqrtf(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+        auto inv    = 1.0f;
+        if (length > 0.0f)
+        { inv = 1.0f / length; }
+        else
+        { q[3] = 1.0f; }
+
+        auto sign = 1.0f;
+        if (f > 0)
+        {
+            const float* prev = &rotations[(f - 1) * 4];
+            auto dot = prev[0] * q[0] + prev[1] * q[1] + prev[2] * q[2] + prev[3] * q[3];
+            sign = (dot < 0.0f) ? -1.0f : 1.0f;
+        }
+
+        for(auto c=0; c<4; ++c)
+        { rotations[f * 4 + c] = q[c] * inv * sign; }
+    }
+
+    // 先に全フレームを量子化し, デコード後の値で許容誤差を判定してからキーを選ぶ.
+    std::vector<uint32_t> keys;
+    std::vector<uint16_t> encoded;
+    std::vector<float>    decoded(m_FrameCount * 4);
+
+    EncodeRange(translations.data(), m_FrameCount, encoded, track.Translation.Min, track.Translation.Ext);
+    for(auto f=0u; f<m_FrameCount; ++f)
+    { DecodeRange(&encoded[f * 3], track.Translation.Min, track.Translation.Ext, &decoded[f * 3]); }
+    ReduceKeys(decoded.data(), translations.data(), m_FrameCount, 3, tolerance.Translation, false, keys);
+    SelectKeys(encoded, keys, track.Translation.Frames, track.Translation.Values);
+
+    EncodeRotation(rotations.data(), m_FrameCount, encoded);
+    for(auto f=0u; f<m_FrameCount; ++f)
+    { DecodeRotation(&encoded[f * 3], &decoded[f * 4]); }
+    ReduceKeys(decoded.data(), rotations.data(), m_FrameCount, 4, tolerance.Rotation, true, keys);
+    SelectKeys(encoded, keys, track.Rotation.Frames, track.Rotation.Values);
+
+    EncodeRange(scales.data(), m_FrameCount, encoded, track.Scale.Min, track.Scale.Ext);
+    for(auto f=0u; f<m_FrameCount; ++f)
+    { DecodeRange(&encoded[f * 3], track.Scale.Min, track.Scale.Ext, &decoded[f * 3]); }
+    ReduceKeys(decoded.data(), scales.data(), m_FrameCount, 3, tolerance.Scale, false, keys);
+    SelectKeys(encoded, keys, track.Scale.Frames, track.Scale.Values);
+}
+
+//-----------------------------------------------------------------------------
+//      全ボーンの姿勢をサンプリングします.
+//-----------------------------------------------------------------------------
+void MotionClip::Sample(float frame, MotionPose* pPoses) const
+{
+    for(size_t i=0; i<m_Tracks.size(); ++i)
+    { pPoses[i] = Sample(uint32_t(i), frame); }
+}
+
+//-----------------------------------------------------------------------------
+//      ボーンの姿勢をサンプリングします.
+//-----------------------------------------------------------------------------
+MotionPose MotionClip::Sample(uint32_t bone, float frame) const
+{
+    const auto& track = m_Tracks[bone];
+
+    float t[3];
+    float r[4];
+    float s[3];
+    SampleChannel(track.Translation.Frames, track.Translation.Values, track.Translation.Min, track.Translation.Ext, frame, false, t);
+    SampleChannel(track.Rotation   .Frames, track.Rotation   .Values, nullptr,               nullptr,               frame, true,  r);
+    SampleChannel(track.Scale      .Frames, track.Scale      .Values, track.Scale.Min,       track.Scale.Ext,       frame, false, s);
+
+    MotionPose result;
+    result.Translation = asdx::Vector3(t[0], t[1], t[2]);
+    result.Rotation    = asdx::Quaternion(r[0], r[1], r[2], r[3]);
+    result.Scale       = asdx::Vector3(s[0], s[1], s[2]);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      連続する4ボーンの姿勢をSIMDでサンプリングします.
+//-----------------------------------------------------------------------------
+void MotionClip::SampleBlock
+(
+    uint32_t            firstBone,
+    float               frame,
+    uint16_t*           pCursors,
+    MotionPoseBlock&    result
+) const
+{
+    const auto kLanes = MotionPoseBlock::Size;
+
+    // 端数のレーンは単位姿勢.
+    static const uint16_t kZeroKey [3] = { 0, 0, 0 };
+    static const float    kZero    [3] = { 0.0f, 0.0f, 0.0f };
+    static const float    kOne     [3] = { 1.0f, 1.0f, 1.0f };
+
+    // レーンごとに区間端のキーを指すポインタを集める.
+    // (スカラーで書いた値をベクトルで読み直すとストアフォワーディングが効かないため, 値は直接レジスタに組み立てる)
+    const uint16_t* pKeys[3][2][kLanes];
+    const float*    pMin [3][kLanes];
+    const float*    pExt [3][kLanes];
+    float           weight[3][kLanes];
+
+    for(auto lane=0u; lane<kLanes; ++lane)
+    {
+        auto bone = firstBone + lane;
+        if (bone >= m_Tracks.size())
+        {
+            for(auto ch=0; ch<3; ++ch)
+            {
+                pKeys[ch][0][lane] = pKeys[ch][1][lane] = (ch == 1) ? kIdentityKey : kZeroKey;
+                pMin [ch][lane]    = (ch == 2) ? kOne : kZero;
+                pExt [ch][lane]    = kZero;
+                weight[ch][lane]   = 0.0f;
+            }
+            continue;
+        }
+
+        const auto& track = m_Tracks[bone];
+        const Channel* channels[3] = { &track.Translation, &track.Rotation, &track.Scale };
+
+        for(auto ch=0; ch<3; ++ch)
+        {
+            const auto& channel = *channels[ch];
+
+            size_t i0, i1;
+            weight[ch][lane]   = FindKey(channel.Frames, frame, pCursors[lane * 3 + ch], i0, i1);
+            pKeys[ch][0][lane] = &channel.Values[i0 * 3];
+            pKeys[ch][1][lane] = &channel.Values[i1 * 3];
+            pMin [ch][lane]    = channel.Min;
+            pExt [ch][lane]    = channel.Ext;
+        }
+    }
+
+    auto loadKey = [&](int ch, int key, int c)
+    {
+        const auto& p = pKeys[ch][key];
+        return _mm_setr_epi32(p[0][c], p[1][c], p[2][c], p[3][c]);
+    };
+
+    auto loadWeight = [&](int ch)
+    { return _mm_setr_ps(weight[ch][0], weight[ch][1], weight[ch][2], weight[ch][3]); };
+
+    // 範囲量子化のデコードと線形補間.
+    const auto kInvRange = _mm_set1_ps(1.0f / kRangeScale);
+    auto decodeRange = [&](int ch, float (&dst)[3][kLanes])
+    {
+        auto t = loadWeight(ch);
+        for(auto c=0; c<3; ++c)
+        {
+            auto lo    = _mm_setr_ps(pMin[ch][0][c], pMin[ch][1][c], pMin[ch][2][c], pMin[ch][3][c]);
+            auto ext   = _mm_setr_ps(pExt[ch][0][c], pExt[ch][1][c], pExt[ch][2][c], pExt[ch][3][c]);
+            auto scale = _mm_mul_ps(ext, kInvRange);
+            auto a = _mm_add_ps(lo, _mm_mul_ps(_mm_cvtepi32_ps(loadKey(ch, 0, c)), scale));
+            auto b = _mm_add_ps(lo, _mm_mul_ps(_mm_cvtepi32_ps(loadKey(ch, 1, c)), scale));
+            _mm_store_ps(dst[c], _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t)));
+        }
+    };
+
+    decodeRange(0, result.Translation);
+    decodeRange(2, result.Scale);
+
+    // smallest-three のデコード.
+    auto select = [](__m128 mask, __m128 a, __m128 b)
+    { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); };
+
+    auto decodeRotation = [&](int key, __m128 (&q)[4])
+    {
+        const auto kMask   = _mm_set1_epi32(0x7FFF);
+        const auto kScale  = _mm_set1_ps(2.0f / (kRotationScale * kSqrt2));
+        const auto kOffset = _mm_set1_ps(1.0f / kSqrt2);
+
+        auto p0 = loadKey(1, key, 0);
+        auto p1 = loadKey(1, key, 1);
+        auto p2 = loadKey(1, key, 2);
+
+        auto largest = _mm_or_si128(_mm_slli_epi32(_mm_srli_epi32(p0, 15), 1), _mm_srli_epi32(p1, 15));
+
+        auto v0 = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p0, kMask)), kScale), kOffset);
+        auto v1 = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p1, kMask)), kScale), kOffset);
+        auto v2 = _mm_sub_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(p2, kMask)), kScale), kOffset);
+
+        auto w = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(v0, v0));
+        w = _mm_sub_ps(w, _mm_mul_ps(v1, v1));
+        w = _mm_sub_ps(w, _mm_mul_ps(v2, v2));
+        w = _mm_sqrt_ps(_mm_max_ps(w, _mm_setzero_ps()));
+
+        auto e0 = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(0)));
+        auto e1 = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(1)));
+        auto e2 = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(2)));
+        auto e3 = _mm_castsi128_ps(_mm_cmpeq_epi32(largest, _mm_set1_epi32(3)));
+
+        // 落とした成分の位置に w を挿入する.
+        q[0] = select(e0, w, v0);
+        q[1] = select(e0, v0, select(e1, w, v1));
+        q[2] = select(_mm_or_ps(e0, e1), v1, select(e2, w, v2));
+        q[3] = select(e3, w, v2);
+    };
+
+    __m128 qa[4];
+    __m128 qb[4];
+    decodeRotation(0, qa);
+    decodeRotation(1, qb);
+
+    // 最短経路で補間して正規化 (nlerp).
+    auto dot = _mm_mul_ps(qa[0], qb[0]);
+    dot = _mm_add_ps(dot, _mm_mul_ps(qa[1], qb[1]));
+    dot = _mm_add_ps(dot, _mm_mul_ps(qa[2], qb[2]));
+    dot = _mm_add_ps(dot, _mm_mul_ps(qa[3], qb[3]));
+    auto flip = _mm_and_ps(dot, _mm_set1_ps(-0.0f));
+
+    auto t = loadWeight(1);
+    __m128 q[4];
+    for(auto c=0; c<4; ++c)
+    {
+        auto b = _mm_xor_ps(qb[c], flip);
+        q[c] = _mm_add_ps(qa[c], _mm_mul_ps(_mm_sub_ps(b, qa[c]), t));
+    }
+
+    auto length = _mm_mul_ps(q[0], q[0]);
+    length = _mm_add_ps(length, _mm_mul_ps(q[1], q[1]));
+    length = _mm_add_ps(length, _mm_mul_ps(q[2], q[2]));
+    length = _mm_add_ps(length, _mm_mul_ps(q[3], q[3]));
+    auto inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(length));
+
+    for(auto c=0; c<4; ++c)
+    { _mm_store_ps(result.Rotation[c], _mm_mul_ps(q[c], inv)); }
+}
+
+//-----------------------------------------------------------------------------
+//      ボーン数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MotionClip::GetBoneCount() const
+{ return uint32_t(m_Tracks.size()); }
+
+//-----------------------------------------------------------------------------
+//      フレーム数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MotionClip::GetFrameCount() const
+{ return m_FrameCount; }
+
+//-----------------------------------------------------------------------------
+//      ボーン名を取得します.
+//-----------------------------------------------------------------------------
+const std::string& MotionClip::GetBoneName(uint32_t bone) const
+{ return m_Tracks[bone].Name; }
+
+//-----------------------------------------------------------------------------
+//      全チャンネルのキー数の合計を取得します.
+//-----------------------------------------------------------------------------
+size_t MotionClip::GetKeyCount() const
+{
+    size_t count = 0;
+    for(const auto& track : m_Tracks)
+    {
+        count += track.Translation.Frames.size();
+        count += track.Rotation   .Frames.size();
+        count += track.Scale      .Frames.size();
+    }
+    return count;
+}
+
+//-----------------------------------------------------------------------------
+//      キーデータのメモリサイズを取得します.
+//-----------------------------------------------------------------------------
+size_t MotionClip::GetMemorySize() const
+{
+    size_t size = 0;
+    for(const auto& track : m_Tracks)
+    {
+        size += GetChannelSize(track.Translation.Frames, track.Translation.Values);
+        size += GetChannelSize(track.Rotation   .Frames, track.Rotation   .Values);
+        size += GetChannelSize(track.Scale      .Frames, track.Scale      .Values);
+    }
+    return size;
+}
@@ -0,0 +1,351 @@
+﻿//-----------------------------------------------------------------------------
+// File : MotionSampler.cpp
+// Desc : SIMD Motion Sampler And Matrix Palette Evaluator.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <MotionSampler.h>
+#include <ParallelFor.h>
+#include <xmmintrin.h>
+
+#if ENABLE_MOTION_BENCHMARK
+#include <Benchmark.h>
+#include <cmath>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kBlocksPerTask = 64;  // 1タスクで処理するブロック数(256ボーン).
+
+static_assert(sizeof(asdx::Matrix) == sizeof(float) * 16, "Matrix must be 16 floats.");
+
+
+//-----------------------------------------------------------------------------
+//      4x4 の係数と行ベクトルの積和を求めます.
+//-----------------------------------------------------------------------------
+inline __m128 MulRow(const float* row, __m128 m0, __m128 m1, __m128 m2, __m128 m3)
+{
+    auto result = _mm_mul_ps(_mm_set1_ps(row[0]), m0);
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[1]), m1));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[2]), m2));
+    result = _mm_add_ps(result, _mm_mul_ps(_mm_set1_ps(row[3]), m3));
+    return result;
+}
+
+} // namespace
+
+
+///////////////////////////////////////////////////////////////////////////////
+// MotionSampler class
+///////////////////////////////////////////////////////////////////////////////
+
+//-----------------------------------------------------------------------------
+//      初期化処理を行います.
+//-----------------------------------------------------------------------------
+bool MotionSampler::Init(const MotionClip* pClip, const asdx::Matrix* pInvBindPoses)
+{
+    Term();
+
+    if (pClip == nullptr || pClip->GetBoneCount() == 0)
+    { return false; }
+
+    m_pClip     = pClip;
+    m_BoneCount = pClip->GetBoneCount();
+
+    m_InvBindPoses.resize(m_BoneCount);
+    for(auto i=0u; i<m_BoneCount; ++i)
+    {
+        if (pInvBindPoses != nullptr)
+        { m_InvBindPoses[i] = pInvBindPoses[i]; }
+        else
+        { m_InvBindPoses[i] = asdx::Matrix::CreateIdentity(); }
+    }
+
+    m_Palette.resize(m_BoneCount);
+    m_Cursors.resize(GetBlockCount() * BlockSize * 3, 0);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void MotionSampler::Term()
+{
+    m_InvBindPoses.clear();
+    m_InvBindPoses.shrink_to_fit();
+
+    m_Palette.clear();
+    m_Palette.shrink_to_fit();
+
+    m_Cursors.clear();
+    m_Cursors.shrink_to_fit();
+
+    m_pClip     = nullptr;
+    m_BoneCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+//      全ボーンをサンプリングしてスキニング行列を更新します.
+//-----------------------------------------------------------------------------
+void MotionSampler::Update(float frame, bool multiThread)
+{
+    auto blockCount = GetBlockCount();
+    if (!multiThread || blockCount <= kBlocksPerTask)
+    {
+        Update(frame, 0, blockCount);
+        return;
+    }
+
+    auto taskCount = (blockCount + kBlocksPerTask - 1) / kBlocksPerTask;
+    ParallelFor(taskCount, [&](size_t task)
+    {
+        auto first = uint32_t(task) * kBlocksPerTask;
+        auto count = blockCount - first;
+        if (count > kBlocksPerTask)
+        { count = kBlocksPerTask; }
+
+        Update(frame, first, count);
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      指定範囲のボーンをサンプリングしてスキニング行列を更新します.
+//-----------------------------------------------------------------------------
+void MotionSampler::Update(float frame, uint32_t firstBlock, uint32_t blockCount)
+{
+    const auto one = _mm_set1_ps(1.0f);
+    const auto two = _mm_set1_ps(2.0f);
+
+    MotionPoseBlock pose;
+
+    for(auto block=firstBlock; block<firstBlock+blockCount; ++block)
+    {
+        auto base = block * BlockSize;
+
+        // 4ボーン分の T/R/S を成分ごとにサンプリング.
+        m_pClip->SampleBlock(base, frame, &m_Cursors[base * 3], pose);
+
+        auto x = _mm_load_ps(pose.Rotation[0]);
+        auto y = _mm_load_ps(pose.Rotation[1]);
+        auto z = _mm_load_ps(pose.Rotation[2]);
+        auto w = _mm_load_ps(pose.Rotation[3]);
+
+        auto sx = _mm_load_ps(pose.Scale[0]);
+        auto sy = _mm_load_ps(pose.Scale[1]);
+        auto sz = _mm_load_ps(pose.Scale[2]);
+
+        // TRS -> 行列 (行ベクトル形式, M = S * R * T).
+        auto xx = _mm_mul_ps(x, x);
+        auto yy = _mm_mul_ps(y, y);
+        auto zz = _mm_mul_ps(z, z);
+        auto xy = _mm_mul_ps(x, y);
+        auto xz = _mm_mul_ps(x, z);
+        auto yz = _mm_mul_ps(y, z);
+        auto xw = _mm_mul_ps(x, w);
+        auto yw = _mm_mul_ps(y, w);
+        auto zw = _mm_mul_ps(z, w);
+
+        auto m00 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(yy, zz))), sx);
+        auto m01 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, zw)), sx);
+        auto m02 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, yw)), sx);
+        auto m03 = _mm_setzero_ps();
+
+        auto m10 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, zw)), sy);
+        auto m11 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, zz))), sy);
+        auto m12 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, xw)), sy);
+        auto m13 = _mm_setzero_ps();
+
+        auto m20 = _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, yw)), sz);
+        auto m21 = _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, xw)), sz);
+        auto m22 = _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(xx, yy))), sz);
+        auto m23 = _mm_setzero_ps();
+
+        auto m30 = _mm_load_ps(pose.Translation[0]);
+        auto m31 = _mm_load_ps(pose.Translation[1]);
+        auto m32 = _mm_load_ps(pose.Translation[2]);
+        auto m33 = one;
+
+        // SoA からボーンごとの行に並べ替える.
+        _MM_TRANSPOSE4_PS(m00, m01, m02, m03);
+        _MM_TRANSPOSE4_PS(m10, m11, m12, m13);
+        _MM_TRANSPOSE4_PS(m20, m21, m22, m23);
+        _MM_TRANSPOSE4_PS(m30, m31, m32, m33);
+
+        const __m128 rows[BlockSize][4] = {
+            { m00, m10, m20, m30 },
+            { m01, m11, m21, m31 },
+            { m02, m12, m22, m32 },
+            { m03, m13, m23, m33 },
+        };
+
+        // スキニング行列 = 逆バインド行列 * 姿勢行列.
+        for(auto lane=0u; lane<BlockSize; ++lane)
+        {
+            auto bone = base + lane;
+            if (bone >= m_BoneCount)
+            { break; }
+
+            const float* ib  = reinterpret_cast<const float*>(&m_InvBindPoses[bone]);
+            float*       dst = reinterpret_cast<float*>(&m_Palette[bone]);
+            const auto&  m   = rows[lane];
+
+            _mm_storeu_ps(dst +  0, MulRow(ib +  0, m[0], m[1], m[2], m[3]));
+            _mm_storeu_ps(dst +  4, MulRow(ib +  4, m[0], m[1], m[2], m[3]));
+            _mm_storeu_ps(dst +  8, MulRow(ib +  8, m[0], m[1], m[2], m[3]));
+            _mm_storeu_ps(dst + 12, MulRow(ib + 12, m[0], m[1], m[2], m[3]));
+        }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      ボーン数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MotionSampler::GetBoneCount() const
+{ return m_BoneCount; }
+
+//-----------------------------------------------------------------------------
+//      ブロック数を取得します.
+//-----------------------------------------------------------------------------
+uint32_t MotionSampler::GetBlockCount() const
+{ return (m_BoneCount + BlockSize - 1) / BlockSize; }
+
+//-----------------------------------------------------------------------------
+//      スキニング行列を取得します.
+//-----------------------------------------------------------------------------
+const asdx::Matrix* MotionSampler::GetPalette() const
+{ return m_Palette.data(); }
+
+#if ENABLE_MOTION_BENCHMARK
+//-----------------------------------------------------------------------------
+//      1k～10kボーンでのサンプリングスループットを計測します.
+//-----------------------------------------------------------------------------
+bool MotionSampler::Benchmark(uint32_t loopCount)
+{
+    const uint32_t kFrameCount  = 240;
+    const uint32_t kBoneCount[] = { 1000, 2500, 5000, 10000 };
+
+    // 比較用のスカラー実装 (MotionClip::Sample + 行列合成).
+    auto compose = [](const MotionPose& pose, const asdx::Matrix& invBind)
+    {
+        auto x = pose.Rotation.x;
+        auto y = pose.Rotation.y;
+        auto z = pose.Rotation.z;
+        auto w = pose.Rotation.w;
+
+        asdx::Matrix m = asdx::Matrix::CreateIdentity();
+        float* r = reinterpret_cast<float*>(&m);
+        r[ 0] = (1.0f - 2.0f * (y * y + z * z)) * pose.Scale.x;
+        r[ 1] = (2.0f * (x * y + z * w)) * pose.Scale.x;
+        r[ 2] = (2.0f * (x * z - y * w)) * pose.Scale.x;
+        r[ 4] = (2.0f * (x * y - z * w)) * pose.Scale.y;
+        r[ 5] = (1.0f - 2.0f * (x * x + z * z)) * pose.Scale.y;
+        r[ 6] = (2.0f * (y * z + x * w)) * pose.Scale.y;
+        r[ 8] = (2.0f * (x * z + y * w)) * pose.Scale.z;
+        r[ 9] = (2.0f * (y * z - x * w)) * pose.Scale.z;
+        r[10] = (1.0f - 2.0f * (x * x + y * y)) * pose.Scale.z;
+        r[12] = pose.Translation.x;
+        r[13] = pose.Translation.y;
+        r[14] = pose.Translation.z;
+        return invBind * m;
+    };
+
+    for(auto boneCount : kBoneCount)
+    {
+        // 疑似的なモーションを生成.
+        MotionClip clip;
+        if (!clip.Init(boneCount, kFrameCount))
+        { return false; }
+
+        std::vector<asdx::Matrix> invBindPoses(boneCount);
+        ParallelFor(boneCount, [&](size_t bone)
+        {
+            std::vector<MotionPose> poses(kFrameCount);
+            auto phase = float(bone) * 0.37f;
+            for(auto f=0u; f<kFrameCount; ++f)
+            {
+                auto time  = float(f) / 60.0f;
+                auto angle = sinf(time * 2.0f + phase) * 0.5f;
+                auto s     = sinf(angle);
+                auto c     = cosf(angle);
+
+                poses[f].Translation = asdx::Vector3(float(bone % 100), sinf(time + phase), float(bone / 100));
+                poses[f].Rotation    = asdx::Quaternion(s * 0.6f, s * 0.8f, 0.0f, c);
+                poses[f].Scale       = asdx::Vector3(1.0f, 1.0f, 1.0f);
+            }
+            clip.SetTrack(uint32_t(bone), "bone", poses.data());
+
+            invBindPoses[bone] = asdx::Matrix::CreateTranslation(-float(bone % 100), 0.0f, -float(bone / 100));
+        });
+
+        MotionSampler sampler;
+        if (!sampler.Init(&clip, invBindPoses.data()))
+        { return false; }
+
+        std::vector<asdx::Matrix> reference(boneCount);
+
+        double scalarTime;
+        double serialTime;
+        double parallelTime;
+
+        // 1ループで全フレームを再生し, 1フレームあたりの時間を求める.
+        auto measure = [&](auto func, double& result)
+        {
+            auto ret = MeasureBest(loopCount, [&]()
+            {
+                for(auto f=0u; f<kFrameCount; ++f)
+                { func(float(f) + 0.5f); }
+                return true;
+            }, result);
+
+            result /= double(kFrameCount);
+            return ret;
+        };
+
+        auto ret = measure([&](float frame)
+        {
+            for(auto bone=0u; bone<boneCount; ++bone)
+            { reference[bone] = compose(clip.Sample(bone, frame), invBindPoses[bone]); }
+        }, scalarTime);
+
+        ret = ret && measure([&](float frame) { sampler.Update(frame, false); }, serialTime);
+        ret = ret && measure([&](float frame) { sampler.Update(frame, true);  }, parallelTime);
+        if (!ret)
+        { return false; }
+
+        // 最終フレームの結果をスカラー実装と比較.
+        auto maxError = 0.0f;
+        for(auto bone=0u; bone<boneCount; ++bone)
+        {
+            const float* lhs = reinterpret_cast<const float*>(&reference[bone]);
+            const float* rhs = reinterpret_cast<const float*>(&sampler.GetPalette()[bone]);
+            for(auto c=0; c<16; ++c)
+            {
+                auto error = fabsf(lhs[c] - rhs[c]);
+                if (error > maxError)
+                { maxError = error; }
+            }
+        }
+
+        ILOGA("Info : Motion Benchmark. bones = %u, frames = %u, keys = %zu, memory = %zu bytes",
+            boneCount, kFrameCount, clip.GetKeyCount(), clip.GetMemorySize());
+        LogBenchmark("scalar",   scalarTime,   0.0,        "per frame");
+        LogBenchmark("simd",     serialTime,   scalarTime, "per frame");
+        LogBenchmark("parallel", parallelTime, scalarTime, "per frame");
+
+        if (maxError > 1e-4f)
+        {
+            ELOGA("Error : Motion Benchmark Result Mismatch. error = %f", maxError);
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
@@ -8,16 +8,32 @@
 // Includes
 //-----------------------------------------------------------------------------
 #include <OBJLoader.h>
+#include <MappedFile.h>
+#include <TangentSpace.h>
 #include <asdxMisc.h>
 #include <asdxLogger.h>
-#include <fstream>
 #include <algorithm>
+#include <charconv>
+#include <cstring>
 #include <tuple>
+#include <future>
+#include <thread>
+#include <unordered_map>
+
+#if ENABLE_OBJ_BENCHMARK
+#include <Benchmark.h>
+#include <fstream>
+#include <cstdio>
+#endif
 
 //-----------------------------------------------------------------------------
 // Constant Values.
 //-----------------------------------------------------------------------------
-static const uint32_t OBJ_BUFFER_LENGTH = 2048;
+static const uint32_t OBJ_BUFFER_LENGTH   = 2048;
+static const size_t   OBJ_MIN_CHUNK_SIZE  = 4 * 1024 * 1024;   // 並列解析する際の最小チャンクサイズ.
+static const uint32_t RELATIVE_P          = 0x1;
+static const uint32_t RELATIVE_T          = 0x2;
+static const uint32_t RELATIVE_N          = 0x4;
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -41,28 +57,794 @@ struct IndexOBJ
     uint32_t    N;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// GeometryOBJ structure
+///////////////////////////////////////////////////////////////////////////////
+struct GeometryOBJ
+{
+    std::vector<asdx::Vector3>  Positions;
+    std::vector<asdx::Vector2>  TexCoords;
+    std::vector<asdx::Vector3>  Normals;
+    std::vector<IndexOBJ>       Indices;
+    std::vector<SubsetOBJ>      Subsets;
+    std::vector<std::string>    MaterialLibs;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// RelativeIndexOBJ structure
+///////////////////////////////////////////////////////////////////////////////
+struct RelativeIndexOBJ
+{
+    uint32_t    Corner;     //!< チャンク内の頂点番号.
+    uint32_t    Mask;       //!< 相対参照している要素(RELATIVE_P, RELATIVE_T, RELATIVE_N).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// ChunkOBJ structure
+///////////////////////////////////////////////////////////////////////////////
+struct ChunkOBJ
+{
+    std::vector<asdx::Vector3>      Positions;
+    std::vector<asdx::Vector2>      TexCoords;
+    std::vector<asdx::Vector3>      Normals;
+    std::vector<IndexOBJ>           Indices;                    //!< 正の参照は確定値, 負の参照はチャンク先頭からのオフセット.
+    std::vector<RelativeIndexOBJ>   RelativeIndices;            //!< 結合時に確定が必要な頂点.
+    std::vector<SubsetOBJ>          Subsets;                    //!< IndexStart はチャンク内ローカル.
+    std::vector<std::string>        MaterialLibs;
+    uint32_t                        LeadingIndexCount    = 0;   //!< 最初の usemtl より前のインデックス数.
+    bool                            FirstGroupLocal      = false;
+    std::string                     TrailingGroup;              //!< 最後の usemtl 以降に指定されたグループ名.
+    bool                            TrailingGroupChanged = false;
+    uint32_t                        PositionBase         = 0;
+    uint32_t                        TexCoordBase         = 0;
+    uint32_t                        NormalBase           = 0;
+    uint32_t                        IndexBase            = 0;
+};
+
+
+namespace {
+
 //-----------------------------------------------------------------------------
-//      ロードします.
+//      空白文字かどうかチェックします.
 //-----------------------------------------------------------------------------
-bool OBJLoader::Load(const char* path, asdx::ResModel& model)
+inline bool IsSpace(char c)
+{ return c == ' ' || c == '\t' || c == '\r'; }
+
+//-----------------------------------------------------------------------------
+//      空白文字を読み飛ばします.
+//-----------------------------------------------------------------------------
+inline const char* SkipSpace(const char* ptr, const char* end)
 {
-    if (path == nullptr)
+    while(ptr != end && IsSpace(*ptr))
+    { ptr++; }
+    return ptr;
+}
+
+//-----------------------------------------------------------------------------
+//      トークンの終端を探します.
+//-----------------------------------------------------------------------------
+inline const char* FindTokenEnd(const char* ptr, const char* end)
+{
+    while(ptr != end && !IsSpace(*ptr))
+    { ptr++; }
+    return ptr;
+}
+
+//-----------------------------------------------------------------------------
+//      キーワードと一致するかチェックします.
+//-----------------------------------------------------------------------------
+inline bool IsKeyword(const char* token, size_t length, const char* keyword)
+{ return length == strlen(keyword) && memcmp(token, keyword, length) == 0; }
+
+//-----------------------------------------------------------------------------
+//      浮動小数を解析します.
+//-----------------------------------------------------------------------------
+inline const char* ParseFloat(const char* ptr, const char* end, float& value)
+{
+    ptr = SkipSpace(ptr, end);
+
+    // from_chars は '+' 記号を受け付けないので読み飛ばす.
+    if (ptr != end && *ptr == '+')
+    { ptr++; }
+
+    auto ret = std::from_chars(ptr, end, value);
+    if (ret.ec != std::errc())
     {
-        ELOGA("Error : Invalid Argument.");
-        return false;
+        value = 0.0f;
+        return FindTokenEnd(ptr, end);
     }
 
-    // ディレクトリパス取得.
-    m_DirectoryPath = asdx::GetDirectoryPathA(path);
+    return ret.ptr;
+}
 
-    // OBJファイルをロード.
-    return LoadOBJ(path, model);
+//-----------------------------------------------------------------------------
+//      整数を解析します.
+//-----------------------------------------------------------------------------
+inline const char* ParseInt(const char* ptr, const char* end, int32_t& value)
+{
+    auto sign = 1;
+    if (ptr != end && (*ptr == '-' || *ptr == '+'))
+    {
+        sign = (*ptr == '-') ? -1 : 1;
+        ptr++;
+    }
+
+    int32_t result = 0;
+    while(ptr != end && '0' <= *ptr && *ptr <= '9')
+    {
+        result = result * 10 + (*ptr - '0');
+        ptr++;
+    }
+
+    value = result * sign;
+    return ptr;
 }
 
 //-----------------------------------------------------------------------------
-//      OBJファイルをロードします.
+//      文字列トークンを解析します.
 //-----------------------------------------------------------------------------
-bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
+inline const char* ParseString(const char* ptr, const char* end, std::string& value)
+{
+    ptr = SkipSpace(ptr, end);
+    auto tail = FindTokenEnd(ptr, end);
+    value.assign(ptr, tail);
+    return tail;
+}
+
+//-----------------------------------------------------------------------------
+//      OBJ形式のインデックスを変換します.
+//-----------------------------------------------------------------------------
+inline uint32_t ResolveIndex(int32_t index, size_t localCount, bool& relative)
+{
+    // 正の値は1始まりの絶対参照なのでそのまま確定できる.
+    relative = false;
+    if (index > 0)
+    { return uint32_t(index - 1); }
+
+    // 負の値は末尾からの相対参照. チャンク先頭からのオフセットとして保持し, 結合時に確定する.
+    if (index < 0)
+    {
+        relative = true;
+        return uint32_t(int32_t(int64_t(localCount) + index));
+    }
+
+    return UINT32_MAX;
+}
+
+//-----------------------------------------------------------------------------
+//      面の頂点を解析します.
+//-----------------------------------------------------------------------------
+inline const char* ParseCorner
+(
+    const char*     ptr,
+    const char*     end,
+    const ChunkOBJ& chunk,
+    IndexOBJ&       corner,
+    uint32_t&       mask
+)
+{
+    int32_t value    = 0;
+    bool    relative = false;
+
+    corner.P = UINT32_MAX;
+    corner.T = UINT32_MAX;
+    corner.N = UINT32_MAX;
+    mask     = 0;
+
+    // 位置座標インデックス.
+    ptr = ParseInt(ptr, end, value);
+    corner.P = ResolveIndex(value, chunk.Positions.size(), relative);
+    if (relative)
+    { mask |= RELATIVE_P; }
+
+    if (ptr != end && *ptr == '/')
+    {
+        ptr++;
+
+        // テクスチャ座標インデックス.
+        if (ptr != end && *ptr != '/')
+        {
+            ptr = ParseInt(ptr, end, value);
+            corner.T = ResolveIndex(value, chunk.TexCoords.size(), relative);
+            if (relative)
+            { mask |= RELATIVE_T; }
+        }
+
+        // 法線インデックス.
+        if (ptr != end && *ptr == '/')
+        {
+            ptr++;
+            ptr = ParseInt(ptr, end, value);
+            corner.N = ResolveIndex(value, chunk.Normals.size(), relative);
+            if (relative)
+            { mask |= RELATIVE_N; }
+        }
+    }
+
+    return ptr;
+}
+
+//-----------------------------------------------------------------------------
+//      面の頂点を追加します.
+//-----------------------------------------------------------------------------
+inline void PushCorner(ChunkOBJ& chunk, const IndexOBJ& corner, uint32_t mask)
+{
+    if (mask != 0)
+    {
+        RelativeIndexOBJ relative = { uint32_t(chunk.Indices.size()), mask };
+        chunk.RelativeIndices.push_back(relative);
+    }
+
+    chunk.Indices.push_back(corner);
+}
+
+//-----------------------------------------------------------------------------
+//      行単位に揃えたチャンクを解析します.
+//-----------------------------------------------------------------------------
+void ParseChunk(const char* data, size_t size, ChunkOBJ& chunk)
+{
+    auto ptr = data;
+    auto end = data + size;
+
+    std::string group;
+    bool        groupChanged = false;
+
+    while(ptr < end)
+    {
+        // 行末を探す.
+        auto lineEnd = static_cast<const char*>(memchr(ptr, '\n', size_t(end - ptr)));
+        if (lineEnd == nullptr)
+        { lineEnd = end; }
+
+        auto token    = SkipSpace(ptr, lineEnd);
+        auto tokenEnd = FindTokenEnd(token, lineEnd);
+        auto length   = size_t(tokenEnd - token);
+        auto cur      = tokenEnd;
+
+        ptr = (lineEnd == end) ? end : lineEnd + 1;
+
+        if (length == 0 || token[0] == '#')
+        { continue; }
+
+        if (IsKeyword(token, length, "v"))
+        {
+            asdx::Vector3 v;
+            cur = ParseFloat(cur, lineEnd, v.x);
+            cur = ParseFloat(cur, lineEnd, v.y);
+            cur = ParseFloat(cur, lineEnd, v.z);
+            chunk.Positions.push_back(v);
+        }
+        else if (IsKeyword(token, length, "vt"))
+        {
+            asdx::Vector2 vt;
+            cur = ParseFloat(cur, lineEnd, vt.x);
+            cur = ParseFloat(cur, lineEnd, vt.y);
+            chunk.TexCoords.push_back(vt);
+        }
+        else if (IsKeyword(token, length, "vn"))
+        {
+            asdx::Vector3 vn;
+            cur = ParseFloat(cur, lineEnd, vn.x);
+            cur = ParseFloat(cur, lineEnd, vn.y);
+            cur = ParseFloat(cur, lineEnd, vn.z);
+            chunk.Normals.push_back(vn);
+        }
+        else if (IsKeyword(token, length, "g"))
+        {
+            ParseString(cur, lineEnd, group);
+            groupChanged = true;
+        }
+        else if (IsKeyword(token, length, "f"))
+        {
+            IndexOBJ first     = {};
+            IndexOBJ prev      = {};
+            uint32_t firstMask = 0;
+            uint32_t prevMask  = 0;
+            uint32_t count     = 0;
+
+            for(;;)
+            {
+                cur = SkipSpace(cur, lineEnd);
+                if (cur == lineEnd)
+                { break; }
+
+                IndexOBJ corner;
+                uint32_t mask;
+                auto next = ParseCorner(cur, lineEnd, chunk, corner, mask);
+                if (next == cur || (corner.P == UINT32_MAX && (mask & RELATIVE_P) == 0))
+                { break; }
+                cur = next;
+
+                // 多角形は扇状に三角形分割する.
+                if (count == 0)
+                {
+                    first     = corner;
+                    firstMask = mask;
+                }
+                else if (count >= 2)
+                {
+                    PushCorner(chunk, first,  firstMask);
+                    PushCorner(chunk, prev,   prevMask);
+                    PushCorner(chunk, corner, mask);
+                }
+
+                prev     = corner;
+                prevMask = mask;
+                count++;
+            }
+        }
+        else if (IsKeyword(token, length, "mtllib"))
+        {
+            std::string path;
+            ParseString(cur, lineEnd, path);
+            if (!path.empty())
+            { chunk.MaterialLibs.push_back(path); }
+        }
+        else if (IsKeyword(token, length, "usemtl"))
+        {
+            SubsetOBJ subset = {};
+            ParseString(cur, lineEnd, subset.MaterialName);
+
+            // グループ名はチャンク内で確定できない場合があるので, 結合時に決定する.
+            subset.MeshName   = group;
+            subset.IndexStart = uint32_t(chunk.Indices.size());
+
+            if (chunk.Subsets.empty())
+            {
+                chunk.LeadingIndexCount = subset.IndexStart;
+                chunk.FirstGroupLocal   = groupChanged;
+            }
+            else
+            {
+                auto& last = chunk.Subsets.back();
+                last.IndexCount = subset.IndexStart - last.IndexStart;
+            }
+
+            chunk.Subsets.push_back(subset);
+            group.clear();
+            groupChanged = false;
+        }
+    }
+
+    if (chunk.Subsets.empty())
+    {
+        chunk.LeadingIndexCount = uint32_t(chunk.Indices.size());
+    }
+    else
+    {
+        auto& last = chunk.Subsets.back();
+        last.IndexCount = uint32_t(chunk.Indices.size()) - last.IndexStart;
+    }
+
+    chunk.TrailingGroup        = group;
+    chunk.TrailingGroupChanged = groupChanged;
+}
+
+//-----------------------------------------------------------------------------
+//      相対参照を確定し, 範囲内かチェックします.
+//-----------------------------------------------------------------------------
+inline bool ResolveRelative(uint32_t base, uint32_t& index, size_t count)
+{
+    auto value = int64_t(base) + int32_t(index);
+    if (value < 0 || value >= int64_t(count))
+    { return false; }
+
+    index = uint32_t(value);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      チャンクを結合先にコピーします.
+//-----------------------------------------------------------------------------
+bool CopyChunk(ChunkOBJ& chunk, GeometryOBJ& geometry)
+{
+    std::copy(chunk.Positions.begin(), chunk.Positions.end(), geometry.Positions.begin() + chunk.PositionBase);
+    std::copy(chunk.TexCoords.begin(), chunk.TexCoords.end(), geometry.TexCoords.begin() + chunk.TexCoordBase);
+    std::copy(chunk.Normals  .begin(), chunk.Normals  .end(), geometry.Normals  .begin() + chunk.NormalBase);
+
+    auto pDst = geometry.Indices.data() + chunk.IndexBase;
+    std::copy(chunk.Indices.begin(), chunk.Indices.end(), pDst);
+
+    // 相対参照をチャンク先頭のオフセット分ずらして確定. 先頭より前を指す参照はエラー.
+    auto valid = true;
+    for(const auto& relative : chunk.RelativeIndices)
+    {
+        auto& corner = pDst[relative.Corner];
+
+        if (relative.Mask & RELATIVE_P)
+        { valid &= ResolveRelative(chunk.PositionBase, corner.P, geometry.Positions.size()); }
+        if (relative.Mask & RELATIVE_T)
+        { valid &= ResolveRelative(chunk.TexCoordBase, corner.T, geometry.TexCoords.size()); }
+        if (relative.Mask & RELATIVE_N)
+        { valid &= ResolveRelative(chunk.NormalBase, corner.N, geometry.Normals.size()); }
+    }
+
+    // 絶対参照も含めて範囲外の参照が無いかチェック.
+    for(size_t i=0; valid && i<chunk.Indices.size(); ++i)
+    {
+        const auto& corner = pDst[i];
+        valid = (corner.P < geometry.Positions.size())
+             && (corner.T == UINT32_MAX || corner.T < geometry.TexCoords.size())
+             && (corner.N == UINT32_MAX || corner.N < geometry.Normals  .size());
+    }
+
+    // 結合後は不要なので解放.
+    chunk.Positions      .clear(); chunk.Positions      .shrink_to_fit();
+    chunk.TexCoords      .clear(); chunk.TexCoords      .shrink_to_fit();
+    chunk.Normals        .clear(); chunk.Normals        .shrink_to_fit();
+    chunk.Indices        .clear(); chunk.Indices        .shrink_to_fit();
+    chunk.RelativeIndices.clear(); chunk.RelativeIndices.shrink_to_fit();
+
+    return valid;
+}
+
+//-----------------------------------------------------------------------------
+//      メモリ上のOBJデータを解析します.
+//-----------------------------------------------------------------------------
+bool ParseOBJ(const char* data, size_t size, GeometryOBJ& geometry, bool parallel)
+{
+    // 行単位に揃えてチャンク分割.
+    std::vector<std::pair<size_t, size_t>> ranges;
+    {
+        size_t count = 1;
+        if (parallel)
+        {
+            auto threadCount = size_t(std::thread::hardware_concurrency());
+            auto maxCount    = size / OBJ_MIN_CHUNK_SIZE;
+            count = (threadCount < maxCount) ? threadCount : maxCount;
+            if (count == 0)
+            { count = 1; }
+        }
+
+        size_t begin = 0;
+        for(size_t i=0; i<count && begin < size; ++i)
+        {
+            size_t end = (i + 1 == count) ? size : size * (i + 1) / count;
+            if (end < begin)
+            { end = begin; }
+
+            if (end < size)
+            {
+                auto lineEnd = static_cast<const char*>(memchr(data + end, '\n', size - end));
+                end = (lineEnd == nullptr) ? size : size_t(lineEnd - data) + 1;
+            }
+
+            ranges.push_back(std::make_pair(begin, end));
+            begin = end;
+        }
+    }
+
+    std::vector<ChunkOBJ> chunks(ranges.size());
+
+    // 各チャンクを並列に解析.
+    if (chunks.size() == 1)
+    {
+        ParseChunk(data + ranges[0].first, ranges[0].second - ranges[0].first, chunks[0]);
+    }
+    else
+    {
+        std::vector<std::future<void>> tasks;
+        tasks.reserve(chunks.size());
+        for(size_t i=0; i<chunks.size(); ++i)
+        {
+            tasks.push_back(std::async(std::launch::async, [&, i]()
+            {
+                ParseChunk(data + ranges[i].first, ranges[i].second - ranges[i].first, chunks[i]);
+            }));
+        }
+
+        for(auto& task : tasks)
+        { task.wait(); }
+    }
+
+    // プレフィックスサムで各チャンクの格納先を決定.
+    size_t positionCount = 0;
+    size_t texcoordCount = 0;
+    size_t normalCount   = 0;
+    size_t indexCount    = 0;
+    for(auto& chunk : chunks)
+    {
+        chunk.PositionBase = uint32_t(positionCount);
+        chunk.TexCoordBase = uint32_t(texcoordCount);
+        chunk.NormalBase   = uint32_t(normalCount);
+        chunk.IndexBase    = uint32_t(indexCount);
+
+        positionCount += chunk.Positions.size();
+        texcoordCount += chunk.TexCoords.size();
+        normalCount   += chunk.Normals  .size();
+        indexCount    += chunk.Indices  .size();
+    }
+
+    geometry.Positions.resize(positionCount);
+    geometry.TexCoords.resize(texcoordCount);
+    geometry.Normals  .resize(normalCount);
+    geometry.Indices  .resize(indexCount);
+
+    // サブセット, マテリアルライブラリ, グループ名は出現順に逐次結合.
+    std::string group;
+    for(auto& chunk : chunks)
+    {
+        // usemtl より前の面は直前のサブセットに含まれる.
+        if (!geometry.Subsets.empty())
+        { geometry.Subsets.back().IndexCount += chunk.LeadingIndexCount; }
+
+        for(size_t i=0; i<chunk.Subsets.size(); ++i)
+        {
+            auto subset = chunk.Subsets[i];
+            subset.IndexStart += chunk.IndexBase;
+
+            // 先頭サブセットのグループが前のチャンクで指定されている場合.
+            if (i == 0 && !chunk.FirstGroupLocal)
+            { subset.MeshName = group; }
+
+            if (subset.MeshName.empty())
+            { subset.MeshName = "group" + std::to_string(geometry.Subsets.size()); }
+
+            geometry.Subsets.push_back(subset);
+            group.clear();
+        }
+
+        if (chunk.TrailingGroupChanged)
+        { group = chunk.TrailingGroup; }
+
+        geometry.MaterialLibs.insert(geometry.MaterialLibs.end(), chunk.MaterialLibs.begin(), chunk.MaterialLibs.end());
+    }
+
+    // 頂点データとインデックスを並列にコピー.
+    if (chunks.size() == 1)
+    {
+        return CopyChunk(chunks[0], geometry);
+    }
+
+    std::vector<std::future<bool>> tasks;
+    tasks.reserve(chunks.size());
+    for(size_t i=0; i<chunks.size(); ++i)
+    {
+        tasks.push_back(std::async(std::launch::async, [&, i]()
+        {
+            return CopyChunk(chunks[i], geometry);
+        }));
+    }
+
+    auto valid = true;
+    for(auto& task : tasks)
+    { valid &= task.get(); }
+
+    return valid;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// VertexMapOBJ class
+///////////////////////////////////////////////////////////////////////////////
+class VertexMapOBJ
+{
+public:
+    //-------------------------------------------------------------------------
+    //! @brief      初期化処理を行います.
+    //!
+    //! @param[in]      count       登録される最大要素数です.
+    //-------------------------------------------------------------------------
+    void Init(size_t count)
+    {
+        // 負荷率が 0.5 以下になるように2の累乗で確保.
+        size_t capacity = 16;
+        while(capacity < count * 2)
+        { capacity <<= 1; }
+
+        m_Mask = capacity - 1;
+        m_Keys  .resize(capacity);
+        m_Values.assign(capacity, UINT32_MAX);
+    }
+
+    //-------------------------------------------------------------------------
+    //! @brief      検索し, 見つからなければ登録します.
+    //!
+    //! @param[in]      key         キーです.
+    //! @param[in]      value       未登録の場合に登録する値です.
+    //! @return     登録済みの値, または新規に登録した値を返却します.
+    //-------------------------------------------------------------------------
+    uint32_t FindOrAdd(const IndexOBJ& key, uint32_t value)
+    {
+        auto slot = CalcHash(key) & m_Mask;
+        for(;;)
+        {
+            auto& stored = m_Values[slot];
+            if (stored == UINT32_MAX)
+            {
+                m_Keys[slot] = key;
+                stored = value;
+                return value;
+            }
+
+            const auto& k = m_Keys[slot];
+            if (k.P == key.P && k.T == key.T && k.N == key.N)
+            { return stored; }
+
+            // 線形探査.
+            slot = (slot + 1) & m_Mask;
+        }
+    }
+
+private:
+    size_t                  m_Mask = 0;
+    std::vector<IndexOBJ>   m_Keys;
+    std::vector<uint32_t>   m_Values;
+
+    //-------------------------------------------------------------------------
+    //! @brief      ハッシュ値を計算します.
+    //-------------------------------------------------------------------------
+    static size_t CalcHash(const IndexOBJ& key)
+    {
+        auto h = uint64_t(key.P) * 0x9E3779B97F4A7C15ull;
+        h ^= uint64_t(key.T) * 0xC2B2AE3D27D4EB4Full + (h >> 29);
+        h ^= uint64_t(key.N) * 0x165667B19E3779F9ull + (h >> 32);
+        return size_t(h ^ (h >> 31));
+    }
+};
+
+//-----------------------------------------------------------------------------
+//      出力データを組み立てます.
+//-----------------------------------------------------------------------------
+bool BuildMeshes(const GeometryOBJ& geometry, asdx::ResModel& model)
+{
+    const auto& subsets = geometry.Subsets;
+
+    // マテリアル名をIDに変換し, マテリアルごとのインデックス数を数える.
+    std::unordered_map<std::string, uint32_t> materialIds;
+    std::vector<const std::string*>           materialNames;
+    std::vector<uint32_t>                     subsetMaterials(subsets.size());
+    std::vector<uint32_t>                     indexCounts;
+    std::vector<uint32_t>                     subsetCounts;
+
+    for(size_t i=0; i<subsets.size(); ++i)
+    {
+        auto itr = materialIds.find(subsets[i].MaterialName);
+        if (itr == materialIds.end())
+        {
+            auto id = uint32_t(materialNames.size());
+            itr = materialIds.insert(std::make_pair(subsets[i].MaterialName, id)).first;
+            materialNames.push_back(&itr->first);
+            indexCounts .push_back(0);
+            subsetCounts.push_back(0);
+        }
+
+        auto id = itr->second;
+        subsetMaterials[i] = id;
+        indexCounts [id] += subsets[i].IndexCount;
+        subsetCounts[id]++;
+    }
+
+    auto materialCount = uint32_t(materialNames.size());
+
+    // サブセットをマテリアルごとに振り分け(出現順を保持).
+    std::vector<uint32_t> subsetOffsets(materialCount + 1, 0);
+    for(uint32_t id=0; id<materialCount; ++id)
+    { subsetOffsets[id + 1] = subsetOffsets[id] + subsetCounts[id]; }
+
+    std::vector<uint32_t> bucket(subsets.size());
+    {
+        auto cursor = subsetOffsets;
+        for(size_t i=0; i<subsets.size(); ++i)
+        { bucket[cursor[subsetMaterials[i]]++] = uint32_t(i); }
+    }
+
+    // 出力順はマテリアル名順.
+    std::vector<uint32_t> order(materialCount);
+    for(uint32_t id=0; id<materialCount; ++id)
+    { order[id] = id; }
+
+    std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs)
+    { return *materialNames[lhs] < *materialNames[rhs]; });
+
+    VertexMapOBJ          vertexMap;
+    std::vector<IndexOBJ> vertices;
+
+    model.Meshes.reserve(model.Meshes.size() + materialCount);
+
+    for(uint32_t meshIndex=0; meshIndex<materialCount; ++meshIndex)
+    {
+        auto id    = order[meshIndex];
+        auto count = indexCounts[id];
+
+        model.Meshes.emplace_back();
+        auto& dstMesh = model.Meshes.back();
+
+        dstMesh.MeshName     = "mesh";
+        dstMesh.MeshName     += std::to_string(meshIndex);
+        dstMesh.MaterialName = *materialNames[id];
+
+        // (P, T, N) の組が同じ頂点は共有する.
+        vertexMap.Init(count);
+        vertices.clear();
+        vertices.reserve(count);
+        dstMesh.Indices.resize(count);
+
+        bool hasTexCoord = false;
+        bool hasNormal   = false;
+
+        auto pIndices = dstMesh.Indices.data();
+        for(auto i=subsetOffsets[id]; i<subsetOffsets[id + 1]; ++i)
+        {
+            const auto& subset = subsets[bucket[i]];
+            for(size_t j=0; j<subset.IndexCount; ++j)
+            {
+                const auto& f = geometry.Indices[j + subset.IndexStart];
+                assert(f.P != UINT32_MAX);
+
+                auto index = vertexMap.FindOrAdd(f, uint32_t(vertices.size()));
+                if (index == vertices.size())
+                {
+                    vertices.push_back(f);
+                    hasTexCoord |= (f.T != UINT32_MAX);
+                    hasNormal   |= (f.N != UINT32_MAX);
+                }
+
+                *pIndices = index;
+                pIndices++;
+            }
+        }
+
+        // 頂点データを一括で確保して書き込む. 参照が欠けている頂点はゼロで埋める.
+        auto vertexCount = vertices.size();
+        dstMesh.Positions.resize(vertexCount);
+        if (hasTexCoord)
+        { dstMesh.TexCoords[0].resize(vertexCount, asdx::Vector2(0.0f, 0.0f)); }
+        if (hasNormal)
+        { dstMesh.Normals.resize(vertexCount, asdx::Vector3(0.0f, 0.0f, 0.0f)); }
+
+        auto missingNormal = false;
+        for(size_t i=0; i<vertexCount; ++i)
+        {
+            const auto& f = vertices[i];
+            dstMesh.Positions[i] = geometry.Positions[f.P];
+
+            if (f.T != UINT32_MAX)
+            { dstMesh.TexCoords[0][i] = geometry.TexCoords[f.T]; }
+
+            if (f.N != UINT32_MAX)
+            { dstMesh.Normals[i] = geometry.Normals[f.N]; }
+            else
+            { missingNormal = true; }
+        }
+
+        // 法線の参照が欠けている頂点は, 接する面の法線を面積で重み付けして補う.
+        if (hasNormal && missingNormal)
+        {
+            const auto& indices = dstMesh.Indices;
+            for(size_t i=0; i + 2<indices.size(); i+=3)
+            {
+                auto i0 = indices[i + 0];
+                auto i1 = indices[i + 1];
+                auto i2 = indices[i + 2];
+
+                const auto& p0 = dstMesh.Positions[i0];
+                auto n = asdx::Vector3::Cross(dstMesh.Positions[i1] - p0, dstMesh.Positions[i2] - p0);
+
+                if (vertices[i0].N == UINT32_MAX) { dstMesh.Normals[i0] = dstMesh.Normals[i0] + n; }
+                if (vertices[i1].N == UINT32_MAX) { dstMesh.Normals[i1] = dstMesh.Normals[i1] + n; }
+                if (vertices[i2].N == UINT32_MAX) { dstMesh.Normals[i2] = dstMesh.Normals[i2] + n; }
+            }
+
+            for(size_t i=0; i<vertexCount; ++i)
+            {
+                if (vertices[i].N == UINT32_MAX)
+                { dstMesh.Normals[i] = asdx::Vector3::SafeNormalize(dstMesh.Normals[i], asdx::Vector3(0.0f, 1.0f, 0.0f)); }
+            }
+        }
+
+        // 法線・接線データが無ければ生成.
+        if (!GenerateTangentSpace(dstMesh))
+        { return false; }
+    }
+
+    return true;
+}
+
+#if ENABLE_OBJ_BENCHMARK
+//-----------------------------------------------------------------------------
+//      std::ifstream を用いた旧実装でOBJデータを解析します(比較用).
+//-----------------------------------------------------------------------------
+bool ParseOBJLegacy(const char* path, GeometryOBJ& geometry)
 {
     std::ifstream stream;
     stream.open(path, std::ios::in);
@@ -75,12 +857,12 @@ bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
 
     char buf[OBJ_BUFFER_LENGTH] = {};
 
-    std::vector<asdx::Vector3> positions;
-    std::vector<asdx::Vector2> texcoords;
-    std::vector<asdx::Vector3> normals;
-    std::vector<IndexOBJ>      indices;
-    std::vector<SubsetOBJ>     subsets;
-    std::string                group;
+    auto& positions = geometry.Positions;
+    auto& texcoords = geometry.TexCoords;
+    auto& normals   = geometry.Normals;
+    auto& indices   = geometry.Indices;
+    auto& subsets   = geometry.Subsets;
+    std::string group;
 
     uint32_t    faceIndex = 0;
     uint32_t    faceCount = 0;
@@ -125,14 +907,12 @@ bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
             uint32_t n[4] = { UINT32_MAX, UINT32_MAX, UINT32_MAX, UINT32_MAX };
 
             uint32_t count = 0;
-            uint32_t index = 0;
 
             faceIndex++;
             faceCount++;
 
             for(auto i=0; i<4; ++i)
             {
-                // 位置座標インデックス.
                 stream >> ip;
                 p[i] = ip - 1;
 
@@ -140,14 +920,12 @@ bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
                 {
                     stream.ignore();
 
-                    // テクスチャ座標インデックス.
                     if ('/' != stream.peek())
                     {
                         stream >> it;
                         t[i] = it - 1;
                     }
 
-                    // 法線インデックス.
                     if ('/' == stream.peek())
                     {
                         stream.ignore();
@@ -169,11 +947,8 @@ bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
                     break;
             }
 
-            // 四角形.
             if (count > 3 && p[3] != UINT32_MAX)
             {
-                assert(count == 4);
-
                 faceIndex++;
                 faceCount++;
 
@@ -188,16 +963,10 @@ bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
         }
         else if (0 == strcmp(buf, "mtllib"))
         {
-            char path[256] = {};
+            std::string path;
             stream >> path;
-            if (strlen(path) > 0)
-            {
-                if (!LoadMTL(path, model))
-                {
-                    ELOGA("Error : Material Load Failed.");
-                    return false;
-                }
-            }
+            if (!path.empty())
+            { geometry.MaterialLibs.push_back(path); }
         }
         else if (0 == strcmp(buf, "usemtl"))
         {
@@ -232,80 +1001,74 @@ bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
     }
 
     stream.close();
+    return true;
+}
+#endif
 
-    // 出力データを組み立て.
-    {
-        std::stable_sort(subsets.begin(), subsets.end(), 
-            [](const SubsetOBJ& lhs, const SubsetOBJ& rhs)
-            {
-                return std::tie(lhs.MaterialName, lhs.IndexStart) < std::tie(rhs.MaterialName, rhs.IndexStart);
-            });
-
-        std::string   matName;
-        asdx::ResMesh dstMesh;
+} // namespace
 
-        uint32_t index     = 0;
-        uint32_t meshIndex = 0;
 
-        for(size_t i=0; i<subsets.size(); ++i)
-        {
-            if (matName != subsets[i].MaterialName)
-            {
-                if (!matName.empty())
-                {
-                    // 法線データが無ければ生成.
-                    if (dstMesh.Normals.empty())
-                    { asdx::CalcNormals(dstMesh); }
-
-                    // 接線データが無ければ生成を試みる.
-                    if (dstMesh.Tangents.empty())
-                    { asdx::CalcTangents(dstMesh); }
-
-                    model.Meshes.emplace_back(dstMesh);
-                    dstMesh = asdx::ResMesh();
-                    index = 0;
-                }
+///////////////////////////////////////////////////////////////////////////////
+// OBJLoader class
+///////////////////////////////////////////////////////////////////////////////
 
-                dstMesh.MeshName     = "mesh";
-                dstMesh.MeshName     += std::to_string(meshIndex);
-                dstMesh.MaterialName = subsets[i].MaterialName;
+//-----------------------------------------------------------------------------
+//      ロードします.
+//-----------------------------------------------------------------------------
+bool OBJLoader::Load(const char* path, asdx::ResModel& model)
+{
+    if (path == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
 
-                matName = dstMesh.MaterialName;
-                meshIndex++;
-            }
+    // ディレクトリパス取得.
+    m_DirectoryPath = asdx::GetDirectoryPathA(path);
 
-            for(size_t j=0; j<subsets[i].IndexCount; ++j)
-            {
-                const auto& f = indices[j + subsets[i].IndexStart];
+    // OBJファイルをロード.
+    return LoadOBJ(path, model);
+}
 
-                assert(f.P != UINT32_MAX);
-                dstMesh.Positions.push_back(positions[f.P]);
+//-----------------------------------------------------------------------------
+//      OBJファイルをロードします.
+//-----------------------------------------------------------------------------
+bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
+{
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
 
-                if (f.T != UINT32_MAX)
-                { dstMesh.TexCoords[0].push_back(texcoords[f.T]); }
+    GeometryOBJ geometry;
+    auto valid = ParseOBJ(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), geometry, true);
 
-                if (f.N != UINT32_MAX)
-                { dstMesh.Normals.push_back(normals[f.N]); }
+    // 解析が終わったのでマッピングを解除.
+    file.Close();
 
-                dstMesh.Indices.push_back(index);
-                index++;
-            }
-        }
+    if (!valid)
+    {
+        ELOGA("Error : Face Index Out Of Range. path = %s", path);
+        return false;
+    }
 
-        if (!matName.empty())
+    for(size_t i=0; i<geometry.MaterialLibs.size(); ++i)
+    {
+        if (!LoadMTL(geometry.MaterialLibs[i].c_str(), model))
         {
-            // 法線データが無ければ生成.
-            if (dstMesh.Normals.empty())
-            { asdx::CalcNormals(dstMesh); }
-
-            // 接線データが無ければ生成を試みる.
-            if (dstMesh.Tangents.empty())
-            { asdx::CalcTangents(dstMesh); }
-
-            model.Meshes.emplace_back(dstMesh);
+            ELOGA("Error : Material Load Failed.");
+            return false;
         }
     }
 
+    if (!BuildMeshes(geometry, model))
+    {
+        ELOGA("Error : Build Meshes Failed. path = %s", path);
+        return false;
+    }
+
     return true;
 }
 
@@ -314,152 +1077,220 @@ bool OBJLoader::LoadOBJ(const char* path, asdx::ResModel& model)
 //-----------------------------------------------------------------------------
 bool OBJLoader::LoadMTL(const char* path, asdx::ResModel& model)
 {
-    std::ifstream stream;
-
     std::string filename = m_DirectoryPath + "/" + path;
 
-    stream.open(filename.c_str(), std::ios::in);
-
-    if (!stream.is_open())
+    MappedFile file;
+    if (!file.Open(filename.c_str()))
     {
         ELOGA("Error : File Open Failed. path = %s", path);
         return false;
     }
 
-    char buf[OBJ_BUFFER_LENGTH] = {};
-    int32_t index = -1;
+    auto ptr = reinterpret_cast<const char*>(file.GetData());
+    auto end = ptr + file.GetSize();
 
-    for(;;)
+    asdx::ResMaterial* pMaterial = nullptr;
+
+    // テクスチャを追加します.
+    auto addTexture = [&](const char* tag, const char* cur, const char* lineEnd)
     {
-        stream >> buf;
+        asdx::ResTexturePath tex = {};
+        tex.Name = tag;
+        ParseString(cur, lineEnd, tex.Path);
 
-        if (!stream || stream.eof())
-            break;
+        pMaterial->Textures.push_back(tex);
+    };
 
-        if (0 == strcmp(buf, "newmtl"))
-        {
-            index++;
-            asdx::ResMaterial mat;
-            model.Materials.push_back(mat);
-            stream >> model.Materials[index].Name;
-        }
-        else if (0 == strcmp(buf, "Ka"))
-        {
-            asdx::ResProperty prop = {};
-            prop.Name = asdx::TAG_AMBIENT;
-            prop.Type = asdx::PROPERTY_TYPE_FLOAT3;
-            stream >> prop.Value.Float3.x >> prop.Value.Float3.y >> prop.Value.Float3.z;
+    // 3成分のプロパティを追加します.
+    auto addFloat3 = [&](const char* tag, const char* cur, const char* lineEnd)
+    {
+        asdx::ResProperty prop = {};
+        prop.Name = tag;
+        prop.Type = asdx::PROPERTY_TYPE_FLOAT3;
+        cur = ParseFloat(cur, lineEnd, prop.Value.Float3.x);
+        cur = ParseFloat(cur, lineEnd, prop.Value.Float3.y);
+        cur = ParseFloat(cur, lineEnd, prop.Value.Float3.z);
+
+        pMaterial->Props.push_back(prop);
+    };
+
+    // 1成分のプロパティを追加します.
+    auto addFloat = [&](const char* tag, const char* cur, const char* lineEnd)
+    {
+        asdx::ResProperty prop = {};
+        prop.Name = tag;
+        prop.Type = asdx::PROPERTY_TYPE_FLOAT;
+        ParseFloat(cur, lineEnd, prop.Value.Float);
 
-            model.Materials[index].Props.push_back(prop);
-        }
-        else if (0 == strcmp(buf, "Kd"))
-        {
-            asdx::ResProperty prop = {};
-            prop.Name = asdx::TAG_DIFFUSE;
-            prop.Type = asdx::PROPERTY_TYPE_FLOAT3;
-            stream >> prop.Value.Float3.x >> prop.Value.Float3.y >> prop.Value.Float3.z;
+        pMaterial->Props.push_back(prop);
+    };
 
-            model.Materials[index].Props.push_back(prop);
-        }
-        else if (0 == strcmp(buf, "Ks"))
-        {
-            asdx::ResProperty prop = {};
-            prop.Name = asdx::TAG_SPECULAR;
-            prop.Type = asdx::PROPERTY_TYPE_FLOAT3;
-            stream >> prop.Value.Float3.x >> prop.Value.Float3.y >> prop.Value.Float3.z;
+    while(ptr < end)
+    {
+        auto lineEnd = static_cast<const char*>(memchr(ptr, '\n', size_t(end - ptr)));
+        if (lineEnd == nullptr)
+        { lineEnd = end; }
 
-            model.Materials[index].Props.push_back(prop);
-        }
-        else if (0 == strcmp(buf, "Ke"))
-        {
-            asdx::ResProperty prop = {};
-            prop.Name = asdx::TAG_EMISSIVE;
-            prop.Type = asdx::PROPERTY_TYPE_FLOAT3;
-            stream >> prop.Value.Float3.x >> prop.Value.Float3.y >> prop.Value.Float3.z;
+        auto token    = SkipSpace(ptr, lineEnd);
+        auto tokenEnd = FindTokenEnd(token, lineEnd);
+        auto length   = size_t(tokenEnd - token);
+        auto cur      = tokenEnd;
 
-            model.Materials[index].Props.push_back(prop);
-        }
-        else if (0 == strcmp(buf, "d") || 0 == strcmp(buf, "Tr"))
-        {
-            asdx::ResProperty prop = {};
-            prop.Name = asdx::TAG_ALPHA;
-            prop.Type = asdx::PROPERTY_TYPE_FLOAT;
-            stream >> prop.Value.Float;
+        ptr = (lineEnd == end) ? end : lineEnd + 1;
 
-            model.Materials[index].Props.push_back(prop);
-        }
-        else if (0 == strcmp(buf, "Ns"))
-        {
-            asdx::ResProperty prop = {};
-            prop.Name = asdx::TAG_SHININESS;
-            prop.Type = asdx::PROPERTY_TYPE_FLOAT;
-            stream >> prop.Value.Float;
+        if (length == 0 || token[0] == '#')
+        { continue; }
 
-            model.Materials[index].Props.push_back(prop);
-        }
-        else if (0 == strcmp(buf, "map_Ka"))
+        if (IsKeyword(token, length, "newmtl"))
         {
-            asdx::ResTexturePath tex = {};
-            tex.Name = asdx::TAG_AMBIENT;
-            stream >> tex.Path;
-
-            model.Materials[index].Textures.push_back(tex);
+            model.Materials.push_back(asdx::ResMaterial());
+            pMaterial = &model.Materials.back();
+            ParseString(cur, lineEnd, pMaterial->Name);
+            continue;
         }
-        else if (0 == strcmp(buf, "map_Kd"))
-        {
-            asdx::ResTexturePath tex = {};
-            tex.Name = asdx::TAG_DIFFUSE;
-            stream >> tex.Path;
 
-            model.Materials[index].Textures.push_back(tex);
-        }
-        else if (0 == strcmp(buf, "map_Ks"))
-        {
-            asdx::ResTexturePath tex = {};
-            tex.Name = asdx::TAG_SPECULAR;
-            stream >> tex.Path;
+        // newmtl より前の記述は無視.
+        if (pMaterial == nullptr)
+        { continue; }
+
+        if (IsKeyword(token, length, "Ka"))
+        { addFloat3(asdx::TAG_AMBIENT, cur, lineEnd); }
+        else if (IsKeyword(token, length, "Kd"))
+        { addFloat3(asdx::TAG_DIFFUSE, cur, lineEnd); }
+        else if (IsKeyword(token, length, "Ks"))
+        { addFloat3(asdx::TAG_SPECULAR, cur, lineEnd); }
+        else if (IsKeyword(token, length, "Ke"))
+        { addFloat3(asdx::TAG_EMISSIVE, cur, lineEnd); }
+        else if (IsKeyword(token, length, "d") || IsKeyword(token, length, "Tr"))
+        { addFloat(asdx::TAG_ALPHA, cur, lineEnd); }
+        else if (IsKeyword(token, length, "Ns"))
+        { addFloat(asdx::TAG_SHININESS, cur, lineEnd); }
+        else if (IsKeyword(token, length, "map_Ka"))
+        { addTexture(asdx::TAG_AMBIENT, cur, lineEnd); }
+        else if (IsKeyword(token, length, "map_Kd"))
+        { addTexture(asdx::TAG_DIFFUSE, cur, lineEnd); }
+        else if (IsKeyword(token, length, "map_Ks"))
+        { addTexture(asdx::TAG_SPECULAR, cur, lineEnd); }
+        else if ((length == 8 && _strnicmp(token, "map_bump", length) == 0) || IsKeyword(token, length, "bump"))
+        { addTexture(asdx::TAG_BUMP, cur, lineEnd); }
+        else if (IsKeyword(token, length, "disp"))
+        { addTexture(asdx::TAG_DISPLACEMENT, cur, lineEnd); }
+        else if (IsKeyword(token, length, "norm"))
+        { addTexture(asdx::TAG_NORMAL, cur, lineEnd); }
+        else if (IsKeyword(token, length, "map_ORM"))
+        { addTexture(asdx::TAG_ORM, cur, lineEnd); }
+    }
 
-            model.Materials[index].Textures.push_back(tex);
-        }
-        else if (0 == _stricmp(buf, "map_bump") || 0 == strcmp(buf, "bump"))
-        {
-            asdx::ResTexturePath tex = {};
-            tex.Name = asdx::TAG_BUMP;
-            stream >> tex.Path;
+    // 正常終了.
+    return true;
+}
 
-            model.Materials[index].Textures.push_back(tex);
-        }
-        else if (0 == strcmp(buf, "disp"))
-        {
-            asdx::ResTexturePath tex = {};
-            tex.Name = asdx::TAG_DISPLACEMENT;
-            stream >> tex.Path;
+#if ENABLE_OBJ_BENCHMARK
+//-----------------------------------------------------------------------------
+//      旧実装と解析スループットを比較します.
+//-----------------------------------------------------------------------------
+bool OBJLoader::Benchmark(const char* path, uint32_t loopCount)
+{
+    if (path == nullptr)
+    {
+        ELOGA("Error : Invalid Argument.");
+        return false;
+    }
 
-            model.Materials[index].Textures.push_back(tex);
-        }
-        else if (0 == strcmp(buf, "norm"))
-        {
-            asdx::ResTexturePath tex = {};
-            tex.Name = asdx::TAG_NORMAL;
-            stream >> tex.Path;
+    MappedFile file;
+    if (!file.Open(path))
+    {
+        ELOGA("Error : File Open Failed. path = %s", path);
+        return false;
+    }
+    auto fileSize = double(file.GetSize());
+    file.Close();
 
-            model.Materials[index].Textures.push_back(tex);
-        }
-        else if (0 == strcmp(buf, "map_ORM"))
-        {
-            asdx::ResTexturePath tex = {};
-            tex.Name = asdx::TAG_ORM;
-            stream >> tex.Path;
+    double legacyTime;
+    double serialTime;
+    double parallelTime;
 
-            model.Materials[index].Textures.push_back(tex);
-        }
+    GeometryOBJ legacy;
+    GeometryOBJ serial;
+    GeometryOBJ parallel;
 
-        stream.ignore(OBJ_BUFFER_LENGTH, '\n');
+    if (!MeasureBest(loopCount,
+        [&]() { legacy = GeometryOBJ(); },
+        [&]() { return ParseOBJLegacy(path, legacy); },
+        legacyTime))
+    { return false; }
+
+    // マッピングも計測に含める.
+    auto parse = [&](GeometryOBJ& geometry, bool multiThread)
+    {
+        if (!file.Open(path))
+        { return false; }
+        auto valid = ParseOBJ(reinterpret_cast<const char*>(file.GetData()), file.GetSize(), geometry, multiThread);
+        file.Close();
+        return valid;
+    };
+
+    if (!MeasureBest(loopCount,
+        [&]() { serial = GeometryOBJ(); },
+        [&]() { return parse(serial, false); },
+        serialTime))
+    { return false; }
+
+    if (!MeasureBest(loopCount,
+        [&]() { parallel = GeometryOBJ(); },
+        [&]() { return parse(parallel, true); },
+        parallelTime))
+    { return false; }
+
+    auto sizeMB = fileSize / (1024.0 * 1024.0);
+    auto report = [&](const char* label, double time, double baseline)
+    {
+        char note[32];
+        sprintf_s(note, "(%.2lf MB/s)", sizeMB / time);
+        LogBenchmark(label, time, baseline, note);
+    };
+
+    ILOGA("Info : OBJ Benchmark. path = %s, size = %.2lf MB", path, sizeMB);
+    report("legacy",   legacyTime,   0.0);
+    report("serial",   serialTime,   legacyTime);
+    report("parallel", parallelTime, legacyTime);
+
+    // 頂点データは旧実装と一致するはず(三角形分割の修正分はインデックス数が異なる場合がある).
+    if (legacy.Positions.size() != serial.Positions.size()
+     || legacy.TexCoords.size() != serial.TexCoords.size()
+     || legacy.Normals  .size() != serial.Normals  .size()
+     || legacy.Subsets  .size() != serial.Subsets  .size())
+    { WLOGA("Warning : OBJ Benchmark Result Mismatch. legacy vs serial."); }
+
+    // 並列版は逐次版と完全に一致しなければならない.
+    auto equal = [](const auto& lhs, const auto& rhs)
+    {
+        using T = typename std::decay<decltype(lhs)>::type::value_type;
+        return lhs.size() == rhs.size()
+            && (lhs.empty() || memcmp(lhs.data(), rhs.data(), sizeof(T) * lhs.size()) == 0);
+    };
+
+    auto same = equal(serial.Positions, parallel.Positions)
+             && equal(serial.TexCoords, parallel.TexCoords)
+             && equal(serial.Normals,   parallel.Normals)
+             && equal(serial.Indices,   parallel.Indices)
+             && serial.MaterialLibs   == parallel.MaterialLibs
+             && serial.Subsets.size() == parallel.Subsets.size();
+
+    for(size_t i=0; same && i<serial.Subsets.size(); ++i)
+    {
+        const auto& lhs = serial  .Subsets[i];
+        const auto& rhs = parallel.Subsets[i];
+        same = std::tie(lhs.MeshName, lhs.MaterialName, lhs.IndexStart, lhs.IndexCount)
+            == std::tie(rhs.MeshName, rhs.MaterialName, rhs.IndexStart, rhs.IndexCount);
     }
 
-    // ファイルを閉じる.
-    stream.close();
+    if (!same)
+    {
+        ELOGA("Error : OBJ Benchmark Result Mismatch. serial vs parallel.");
+        return false;
+    }
 
-    // 正常終了.
     return true;
 }
+#endif
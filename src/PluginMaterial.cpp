@@ -12,6 +12,7 @@
 #include <asdxMisc.h>
 #include <asdxRenderState.h>
 #include <asdxDeviceContext.h>
+#include <future>
 
 
 namespace {
@@ -115,18 +116,37 @@ bool PluginMaterial::Load(const char* path)
     }
 #endif
 
-    if (!m_LightingShader.Compile(
-        parser.GetSourceCode(), parser.GetSourceCodeSize(), "LightingPS"))
-    {
-        ELOG("Error : LightingPS Func Compile Failed.");
-        return false;
-    }
+    // 宣言からバインディングレイアウトを構築.
+    // 構築できない場合はコンパイル時にリフレクションで構築される.
+    m_LightingShader .SetupLayout(parser);
+    m_ShadowingShader.SetupLayout(parser);
 
-    if (!m_ShadowingShader.Compile(
-        parser.GetSourceCode(), parser.GetSourceCodeSize(), "ShadowingPS"))
+    // 最初のテクニックの最初のパスで宣言されたレンダリングステートを登録.
+    // 同一内容のステートは全マテリアルで共有される.
+    if (!parser.GetTechniques().empty() && !parser.GetTechniques()[0].Pass.empty())
     {
-        ELOG("Error : ShadowingPS Func Compile Failed.");
-        return false;
+        auto& pass  = parser.GetTechniques()[0].Pass[0];
+        auto& cache = RenderStateCache::Instance();
+
+        auto bs = parser.GetBlendStates().find(pass.BlendState);
+        if (bs != parser.GetBlendStates().end())
+        { m_BlendState = cache.RegisterBS(bs->second); }
+
+        auto rs = parser.GetRasterizerStates().find(pass.RasterizerState);
+        if (rs != parser.GetRasterizerStates().end())
+        { m_RasterizerState = cache.RegisterRS(rs->second); }
+
+        auto dss = parser.GetDepthStencilStates().find(pass.DepthStencilState);
+        if (dss != parser.GetDepthStencilStates().end())
+        { m_DepthStencilState = cache.RegisterDSS(dss->second); }
+
+        // エディタ上の設定よりシェーダの宣言が優先されるので, どちらが使われるかを明示しておく.
+        if (HasBlendState())
+        { ILOGA("Info : BlendState \"%s\" declared in shader overrides editor setting. material = %s", pass.BlendState.c_str(), m_Name.c_str()); }
+        if (HasRasterizerState())
+        { ILOGA("Info : RasterizerState \"%s\" declared in shader overrides editor setting. material = %s", pass.RasterizerState.c_str(), m_Name.c_str()); }
+        if (HasDepthStencilState())
+        { ILOGA("Info : DepthStencilState \"%s\" declared in shader overrides editor setting. material = %s", pass.DepthStencilState.c_str(), m_Name.c_str()); }
     }
 
     m_Properties = parser.GetProperties();
@@ -147,6 +167,28 @@ bool PluginMaterial::Load(const char* path)
         }
     }
 
+    // レイアウトはコンパイル結果に依存しないので, 2つのシェーダを並列にコンパイル.
+    auto shadowing = std::async(std::launch::async, [&]()
+    {
+        return m_ShadowingShader.Compile(
+            parser.GetSourceCode(), parser.GetSourceCodeSize(), "ShadowingPS");
+    });
+
+    auto lighting = m_LightingShader.Compile(
+        parser.GetSourceCode(), parser.GetSourceCodeSize(), "LightingPS");
+
+    if (!shadowing.get())
+    {
+        ELOG("Error : ShadowingPS Func Compile Failed.");
+        return false;
+    }
+
+    if (!lighting)
+    {
+        ELOG("Error : LightingPS Func Compile Failed.");
+        return false;
+    }
+
     m_ShaderPath = asdx::ToFullPath(path);
 
     return true;
@@ -171,6 +213,10 @@ void PluginMaterial::Term()
     m_EditableCB     .Reset();
     m_Name           .clear();
     m_ShaderPath     .clear();
+
+    m_BlendState        = kInvalidRenderStateHandle;
+    m_RasterizerState   = kInvalidRenderStateHandle;
+    m_DepthStencilState = kInvalidRenderStateHandle;
 }
 
 //-----------------------------------------------------------------------------
@@ -316,3 +362,21 @@ bool PluginMaterial::FindSlotUAV(const std::string& name, uint32_t& slot, bool l
 //-----------------------------------------------------------------------------
 const std::string& PluginMaterial::GetShaderPath() const
 { return m_ShaderPath; }
+
+//-----------------------------------------------------------------------------
+//      シェーダ側でブレンドステートが宣言されているかどうか?
+//-----------------------------------------------------------------------------
+bool PluginMaterial::HasBlendState() const
+{ return m_BlendState != kInvalidRenderStateHandle; }
+
+//-----------------------------------------------------------------------------
+//      シェーダ側でラスタライザーステートが宣言されているかどうか?
+//-----------------------------------------------------------------------------
+bool PluginMaterial::HasRasterizerState() const
+{ return m_RasterizerState != kInvalidRenderStateHandle; }
+
+//-----------------------------------------------------------------------------
+//      シェーダ側で深度ステンシルステートが宣言されているかどうか?
+//-----------------------------------------------------------------------------
+bool PluginMaterial::HasDepthStencilState() const
+{ return m_DepthStencilState != kInvalidRenderStateHandle; }
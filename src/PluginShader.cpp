@@ -52,6 +52,299 @@ void OutputErrorShader(const char* sourceCode, size_t size)
     fclose(file);
 }
 
+//-----------------------------------------------------------------------------
+//      定数バッファメンバーのサイズを取得します.
+//-----------------------------------------------------------------------------
+bool GetMemberSize
+(
+    asura::MEMBER_TYPE      type,
+    asura::TYPE_MODIFIER    modifier,
+    uint32_t&               size,
+    bool&                   matrix
+)
+{
+    if (type < asura::MEMBER_TYPE_BOOL || type >= asura::MEMBER_TYPE_STRUCT)
+    { return false; }
+
+    // MEMBER_TYPEは基本型ごとに次の19種類が並んでいる.
+    // T, T1x2, T1x3, T1x4, T2, T2x1, ..., T4, T4x1, T4x2, T4x3, T4x4
+    // 行数 0 はベクトル型を表す.
+    static const uint8_t kRows[] = { 0, 1, 1, 1, 0, 2, 2, 2, 2, 0, 3, 3, 3, 3, 0, 4, 4, 4, 4 };
+    static const uint8_t kCols[] = { 1, 2, 3, 4, 2, 1, 2, 3, 4, 3, 1, 2, 3, 4, 4, 1, 2, 3, 4 };
+    static const uint32_t kTypeCount = _countof(kRows);
+
+    auto idx   = uint32_t(type - asura::MEMBER_TYPE_BOOL);
+    auto base  = idx / kTypeCount;
+    auto sub   = idx % kTypeCount;
+    auto bytes = (base == (asura::MEMBER_TYPE_DOUBLE - asura::MEMBER_TYPE_BOOL) / kTypeCount) ? 8u : 4u;
+
+    auto rows = kRows[sub];
+    auto cols = kCols[sub];
+
+    if (rows == 0)
+    {
+        size   = cols * bytes;
+        matrix = false;
+
+        // 1レジスタに収まらないものはリフレクションに任せる.
+        return size <= 16;
+    }
+
+    // 行列はレジスタ単位で配置される(デフォルトは列優先).
+    auto rowMajor = (modifier & asura::TYPE_MODIFIER_ROW_MAJOR) != 0;
+    auto regs = rowMajor ? rows : cols;
+    auto elem = rowMajor ? cols : rows;
+    size   = (regs - 1) * 16 + elem * bytes;
+    matrix = true;
+
+    return elem * bytes <= 16;
+}
+
+//-----------------------------------------------------------------------------
+//      メンバー名から配列の要素数を取り出します.
+//-----------------------------------------------------------------------------
+bool ParseArrayCount(const std::string& name, std::string& baseName, uint32_t& count)
+{
+    baseName = name;
+    count    = 0;
+
+    auto begin = name.find('[');
+    if (begin == std::string::npos)
+    { return true; }
+
+    // 1次元で要素数が数値のものだけ扱う. 多次元配列やマクロによる要素数はリフレクションに任せる.
+    auto end = name.find(']', begin);
+    if (end == std::string::npos || end + 1 != name.size() || end == begin + 1)
+    { return false; }
+
+    uint32_t value = 0;
+    for(auto i=begin + 1; i<end; ++i)
+    {
+        if (name[i] < '0' || name[i] > '9' || value > 0xFFFF)
+        { return false; }
+
+        value = value * 10 + uint32_t(name[i] - '0');
+    }
+
+    if (value == 0)
+    { return false; }
+
+    baseName = name.substr(0, begin);
+    count    = value;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      定数バッファ情報を構築します.
+//-----------------------------------------------------------------------------
+bool BuildBufferInfo(const asura::ConstantBuffer& buffer, PluginShader::BufferInfo& info)
+{
+    uint32_t cursor = 0;
+
+    for(auto& member : buffer.Members)
+    {
+        uint32_t size   = 0;
+        bool     matrix = false;
+        if (!GetMemberSize(member.Type, member.Modifier, size, matrix))
+        { return false; }
+
+        std::string name;
+        uint32_t    arrayCount = 0;
+        if (!ParseArrayCount(member.Name, name, arrayCount))
+        { return false; }
+
+        // 配列の各要素は16byte境界から配置される (最後の要素のみ詰める).
+        if (arrayCount > 0)
+        {
+            size   = asdx::RoundUp(size, 16) * (arrayCount - 1) + size;
+            matrix = true;
+        }
+
+        auto offset = member.PackOffset;
+        if (offset == uint32_t(-1))
+        {
+            // 16byte境界をまたぐ場合と行列は次のレジスタから配置.
+            offset = cursor;
+            if (matrix || (offset % 16) + size > 16)
+            { offset = asdx::RoundUp(offset, 16); }
+        }
+
+        PluginShader::MemberInfo memberInfo;
+        memberInfo.Offset = offset;
+        memberInfo.Size   = size;
+        info.MemberTable[name] = memberInfo;
+
+        cursor = (offset + size > cursor) ? offset + size : cursor;
+    }
+
+    info.BufferSize = asdx::RoundUp(cursor, 16);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      シェーダリフレクションからバインディングレイアウトを構築します.
+//-----------------------------------------------------------------------------
+bool ReflectLayout
+(
+    ID3DBlob*                                           pBlob,
+    std::map<std::string, uint8_t>&                     tableCBV,
+    std::map<std::string, uint8_t>&                     tableSRV,
+    std::map<std::string, uint8_t>&                     tableUAV,
+    std::map<std::string, PluginShader::BufferInfo>&    bufferInfo
+)
+{
+    asdx::RefPtr<ID3D11ShaderReflection> pReflection;
+
+    // シェーダリフレクション生成.
+    auto hr = D3DReflect(
+        pBlob->GetBufferPointer(),
+        pBlob->GetBufferSize(),
+        IID_PPV_ARGS(pReflection.GetAddress()));
+    if (FAILED(hr))
+    {
+        ELOGA("Error : D3DReflect() Failed. errcode = 0x%x", hr);
+        return false;
+    }
+
+    D3D11_SHADER_DESC shaderDesc = {};
+    hr = pReflection->GetDesc(&shaderDesc);
+    if (FAILED(hr))
+    {
+        ELOGA("Error : ID3D11ShaderReflection::GetDesc() Failed. errcode = 0x%x", hr);
+        return false;
+    }
+
+    for(auto i=0u; i<shaderDesc.ConstantBuffers; ++i)
+    {
+        auto reflectionCB = pReflection->GetConstantBufferByIndex(i);
+        if (reflectionCB == nullptr)
+        { continue; }
+
+        D3D11_SHADER_BUFFER_DESC bufferDesc = {};
+        hr = reflectionCB->GetDesc(&bufferDesc);
+        if (FAILED(hr))
+        { continue; }
+
+        PluginShader::BufferInfo info;
+        info.BufferSize = bufferDesc.Size;
+
+        for(auto j=0u; j<bufferDesc.Variables; ++j)
+        {
+            auto reflectionVariable = reflectionCB->GetVariableByIndex(j);
+            if (reflectionVariable == nullptr)
+            { continue; }
+
+            D3D11_SHADER_VARIABLE_DESC variableDesc = {};
+            hr = reflectionVariable->GetDesc(&variableDesc);
+            if (FAILED(hr))
+            { continue; }
+
+            PluginShader::MemberInfo member;
+            member.Offset = variableDesc.StartOffset;
+            member.Size   = variableDesc.Size;
+            info.MemberTable[variableDesc.Name] = member;
+        }
+
+        bufferInfo[bufferDesc.Name] = info;
+    }
+
+    for(auto i=0u; i<shaderDesc.BoundResources; ++i)
+    {
+        D3D11_SHADER_INPUT_BIND_DESC bindDesc = {};
+        hr = pReflection->GetResourceBindingDesc(i, &bindDesc);
+        if (FAILED(hr))
+        { continue; }
+
+        switch(bindDesc.Type)
+        {
+        case D3D_SIT_CBUFFER:
+        case D3D_SIT_TBUFFER:
+            tableCBV[bindDesc.Name] = uint8_t(bindDesc.BindPoint);
+            break;
+
+        case D3D_SIT_TEXTURE:
+        case D3D_SIT_STRUCTURED:
+        case D3D_SIT_BYTEADDRESS:
+            tableSRV[bindDesc.Name] = uint8_t(bindDesc.BindPoint);
+            break;
+
+        case D3D_SIT_UAV_RWTYPED:
+        case D3D_SIT_UAV_RWSTRUCTURED:
+        case D3D_SIT_UAV_APPEND_STRUCTURED:
+        case D3D_SIT_UAV_CONSUME_STRUCTURED:
+        case D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER:
+            tableUAV[bindDesc.Name] = uint8_t(bindDesc.BindPoint);
+            break;
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      位置座標以外の頂点属性を参照するかどうかシェーダリフレクションから調べます.
+//-----------------------------------------------------------------------------
+bool ReflectReadsAttributes(ID3DBlob* pBlob)
+{
+    asdx::RefPtr<ID3D11ShaderReflection> pReflection;
+
+    // 調べられない場合は参照するものとして扱う.
+    auto hr = D3DReflect(
+        pBlob->GetBufferPointer(),
+        pBlob->GetBufferSize(),
+        IID_PPV_ARGS(pReflection.GetAddress()));
+    if (FAILED(hr))
+    { return true; }
+
+    D3D11_SHADER_DESC shaderDesc = {};
+    hr = pReflection->GetDesc(&shaderDesc);
+    if (FAILED(hr))
+    { return true; }
+
+    for(auto i=0u; i<shaderDesc.InputParameters; ++i)
+    {
+        D3D11_SIGNATURE_PARAMETER_DESC paramDesc = {};
+        hr = pReflection->GetInputParameterDesc(i, &paramDesc);
+        if (FAILED(hr))
+        { return true; }
+
+        // SV_POSITION などのシステム値は頂点属性ではない.
+        if (paramDesc.SystemValueType != D3D_NAME_UNDEFINED)
+        { continue; }
+
+        if (paramDesc.ReadWriteMask != 0)
+        { return true; }
+    }
+
+    return false;
+}
+
+#if defined(DEBUG) || defined(_DEBUG)
+//-----------------------------------------------------------------------------
+//      レジスタテーブルがリフレクション結果と一致するか検証します.
+//-----------------------------------------------------------------------------
+bool ValidateTable
+(
+    const char*                             tag,
+    const std::map<std::string, uint8_t>&   declared,
+    const std::map<std::string, uint8_t>&   reflected
+)
+{
+    auto result = true;
+    for(auto& itr : reflected)
+    {
+        auto found = declared.find(itr.first);
+        if (found == declared.end() || found->second != itr.second)
+        {
+            ELOGA("Error : Binding Layout Mismatch. %s = %s, reflected slot = %u",
+                tag, itr.first.c_str(), uint32_t(itr.second));
+            result = false;
+        }
+    }
+    return result;
+}
+#endif
+
 
 } // namespace
 
@@ -72,6 +365,61 @@ PluginShader::PluginShader()
 PluginShader::~PluginShader()
 { Term(); }
 
+//-----------------------------------------------------------------------------
+//      解析結果からバインディングレイアウトを構築します.
+//-----------------------------------------------------------------------------
+bool PluginShader::SetupLayout(const asura::FxParser& parser)
+{
+    std::map<std::string, uint8_t>      tableCBV;
+    std::map<std::string, uint8_t>      tableSRV;
+    std::map<std::string, uint8_t>      tableUAV;
+    std::map<std::string, BufferInfo>   bufferInfo;
+
+    m_HasLayout = false;
+
+    for(auto& itr : parser.GetConstantBuffers())
+    {
+        auto& buffer = itr.second;
+
+        // レジスタ指定が無いものはコンパイラ次第なので確定できない.
+        if (buffer.Register == uint32_t(-1))
+        { return false; }
+
+        BufferInfo info;
+        if (!BuildBufferInfo(buffer, info))
+        { return false; }
+
+        tableCBV  [buffer.Name] = uint8_t(buffer.Register);
+        bufferInfo[buffer.Name] = info;
+    }
+
+    for(auto& itr : parser.GetResources())
+    {
+        auto& res = itr.second;
+
+        // サンプラーはBind()で固定設定.
+        if (res.ResourceType == asura::RESOURCE_TYPE_SAMPLER_STATE
+         || res.ResourceType == asura::RESOURCE_TYPE_SAMPLER_COMPRISON_STATE)
+        { continue; }
+
+        if (res.Register == uint32_t(-1))
+        { return false; }
+
+        if (res.ResourceType <= asura::RESOURCE_TYPE_BYTEADDRESS_BUFFER)
+        { tableSRV[res.Name] = uint8_t(res.Register); }
+        else
+        { tableUAV[res.Name] = uint8_t(res.Register); }
+    }
+
+    m_TableCBV   = std::move(tableCBV);
+    m_TableSRV   = std::move(tableSRV);
+    m_TableUAV   = std::move(tableUAV);
+    m_BufferInfo = std::move(bufferInfo);
+    m_HasLayout  = true;
+
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 //      コンパイルします.
 //-----------------------------------------------------------------------------
@@ -116,93 +464,47 @@ bool PluginShader::Compile(const char* sourceCode, size_t size, const char* entr
         return false;
     }
 
-    asdx::RefPtr<ID3D11ShaderReflection> pReflection;
-
-    // シェーダリフレクション生成.
-    hr = D3DReflect(
-        pBlob->GetBufferPointer(),
-        pBlob->GetBufferSize(),
-        IID_PPV_ARGS(pReflection.GetAddress()));
-    if (FAILED(hr))
+    if (!m_HasLayout)
     {
-        ELOGA("Error : D3DReflect() Failed. errcode = 0x%x", hr);
-        return false;
+        // 宣言から確定できなかったので, リフレクションで辞書を作成.
+        if (!ReflectLayout(pBlob.GetPtr(), m_TableCBV, m_TableSRV, m_TableUAV, m_BufferInfo))
+        { return false; }
     }
-
-    // 辞書を作成.
+#if defined(DEBUG) || defined(_DEBUG)
+    else
     {
-        D3D11_SHADER_DESC shaderDesc = {};
-        hr = pReflection->GetDesc(&shaderDesc);
-        if (FAILED(hr))
+        // 宣言から構築したレイアウトをリフレクション結果で検証.
+        std::map<std::string, uint8_t>      tableCBV;
+        std::map<std::string, uint8_t>      tableSRV;
+        std::map<std::string, uint8_t>      tableUAV;
+        std::map<std::string, BufferInfo>   bufferInfo;
+        if (ReflectLayout(pBlob.GetPtr(), tableCBV, tableSRV, tableUAV, bufferInfo))
         {
-            ELOGA("Error : ID3D11ShaderReflection::GetDesc() Failed. errcode = 0x%x", hr);
-            return false;
-        }
+            ValidateTable("CBV", m_TableCBV, tableCBV);
+            ValidateTable("SRV", m_TableSRV, tableSRV);
+            ValidateTable("UAV", m_TableUAV, tableUAV);
 
-        for(auto i=0u; i<shaderDesc.ConstantBuffers; ++i)
-        {
-            auto reflectionCB = pReflection->GetConstantBufferByIndex(i);
-            if (pReflection == nullptr)
-            { continue; }
-
-            D3D11_SHADER_BUFFER_DESC bufferDesc = {};
-            hr = reflectionCB->GetDesc(&bufferDesc);
-            if (FAILED(hr))
-            { continue; }
-
-            BufferInfo info;
-            info.BufferSize = bufferDesc.Size;
-
-            for(auto j=0u; j<bufferDesc.Variables; ++j)
+            for(auto& buffer : bufferInfo)
             {
-                auto reflectionVariable = reflectionCB->GetVariableByIndex(j);
-                if (reflectionVariable == nullptr)
+                auto found = m_BufferInfo.find(buffer.first);
+                if (found == m_BufferInfo.end())
                 { continue; }
 
-                D3D11_SHADER_VARIABLE_DESC variableDesc = {};
-                hr = reflectionVariable->GetDesc(&variableDesc);
-                if (FAILED(hr))
-                { continue; }
-
-                MemberInfo member;
-                member.Offset = variableDesc.StartOffset;
-                member.Size   = variableDesc.Size;
-                info.MemberTable[variableDesc.Name] = member;
-            }
-
-            m_BufferInfo[bufferDesc.Name] = info;
-        }
-
-        for(auto i=0u; i<shaderDesc.BoundResources; ++i)
-        {
-            D3D11_SHADER_INPUT_BIND_DESC bindDesc = {};
-            hr = pReflection->GetResourceBindingDesc(i, &bindDesc);
-            if (FAILED(hr))
-            { continue; }
-
-            switch(bindDesc.Type)
-            {
-            case D3D_SIT_CBUFFER:
-            case D3D_SIT_TBUFFER:
-                m_TableCBV[bindDesc.Name] = uint8_t(bindDesc.BindPoint);
-                break;
-
-            case D3D_SIT_TEXTURE:
-            case D3D_SIT_STRUCTURED:
-            case D3D_SIT_BYTEADDRESS:
-                m_TableSRV[bindDesc.Name] = uint8_t(bindDesc.BindPoint);
-                break;
-
-            case D3D_SIT_UAV_RWTYPED:
-            case D3D_SIT_UAV_RWSTRUCTURED:
-            case D3D_SIT_UAV_APPEND_STRUCTURED:
-            case D3D_SIT_UAV_CONSUME_STRUCTURED:
-            case D3D_SIT_UAV_RWSTRUCTURED_WITH_COUNTER:
-                m_TableUAV[bindDesc.Name] = uint8_t(bindDesc.BindPoint);
-                break;
+                for(auto& member : buffer.second.MemberTable)
+                {
+                    auto itr = found->second.MemberTable.find(member.first);
+                    if (itr == found->second.MemberTable.end()
+                     || itr->second.Offset != member.second.Offset
+                     || itr->second.Size   != member.second.Size)
+                    {
+                        ELOGA("Error : Constant Buffer Layout Mismatch. buffer = %s, member = %s, reflected offset = %u, size = %u",
+                            buffer.first.c_str(), member.first.c_str(), member.second.Offset, member.second.Size);
+                    }
+                }
             }
         }
     }
+#endif
 
     auto pDevice = asdx::DeviceContext::Instance().GetDevice();
     hr = pDevice->CreatePixelShader(
@@ -218,6 +520,9 @@ bool PluginShader::Compile(const char* sourceCode, size_t size, const char* entr
 
     m_EntryPoint = entryPoint;
 
+    // 頂点属性を参照しなければシャドウパスで位置座標のみのストリームが使える.
+    m_ReadsAttributes = ReflectReadsAttributes(pBlob.GetPtr());
+
     return true;
 }
 
@@ -231,6 +536,8 @@ void PluginShader::Term()
     m_TableSRV      .clear();
     m_TableUAV      .clear();
     m_PS            .Reset();
+    m_HasLayout     = false;
+    m_ReadsAttributes = true;
 }
 
 //-----------------------------------------------------------------------------
@@ -327,3 +634,9 @@ const std::map<std::string, uint8_t>& PluginShader::GetTableUAV() const
 
 const std::map<std::string, PluginShader::BufferInfo>& PluginShader::GetBufferInfo() const
 { return m_BufferInfo; }
+
+//-----------------------------------------------------------------------------
+//      位置座標以外の頂点属性を参照するかどうか?
+//-----------------------------------------------------------------------------
+bool PluginShader::ReadsAttributes() const
+{ return m_ReadsAttributes; }
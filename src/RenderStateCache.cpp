@@ -0,0 +1,431 @@
+﻿//-----------------------------------------------------------------------------
+// File : RenderStateCache.cpp
+// Desc : Render State Cache.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <RenderStateCache.h>
+#include <asdxLogger.h>
+#include <asdxDeviceContext.h>
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+//      ブレンドタイプを変換します.
+//-----------------------------------------------------------------------------
+D3D11_BLEND ToNative(asura::BLEND_TYPE type)
+{
+    switch(type)
+    {
+    case asura::BLEND_TYPE_ZERO:            return D3D11_BLEND_ZERO;
+    case asura::BLEND_TYPE_ONE:             return D3D11_BLEND_ONE;
+    case asura::BLEND_TYPE_SRC_COLOR:       return D3D11_BLEND_SRC_COLOR;
+    case asura::BLEND_TYPE_INV_SRC_COLOR:   return D3D11_BLEND_INV_SRC_COLOR;
+    case asura::BLEND_TYPE_SRC_ALPHA:       return D3D11_BLEND_SRC_ALPHA;
+    case asura::BLEND_TYPE_INV_SRC_ALPHA:   return D3D11_BLEND_INV_SRC_ALPHA;
+    case asura::BLEND_TYPE_DST_ALPHA:       return D3D11_BLEND_DEST_ALPHA;
+    case asura::BLEND_TYPE_INV_DST_ALPHA:   return D3D11_BLEND_INV_DEST_ALPHA;
+    case asura::BLEND_TYPE_DST_COLOR:       return D3D11_BLEND_DEST_COLOR;
+    case asura::BLEND_TYPE_INV_DST_COLOR:   return D3D11_BLEND_INV_DEST_COLOR;
+    }
+
+    return D3D11_BLEND_ONE;
+}
+
+//-----------------------------------------------------------------------------
+//      ブレンド演算子を変換します.
+//-----------------------------------------------------------------------------
+D3D11_BLEND_OP ToNative(asura::BLEND_OP_TYPE type)
+{
+    switch(type)
+    {
+    case asura::BLEND_OP_TYPE_ADD:      return D3D11_BLEND_OP_ADD;
+    case asura::BLEND_OP_TYPE_SUB:      return D3D11_BLEND_OP_SUBTRACT;
+    case asura::BLEND_OP_TYPE_REV_SUB:  return D3D11_BLEND_OP_REV_SUBTRACT;
+    case asura::BLEND_OP_TYPE_MIN:      return D3D11_BLEND_OP_MIN;
+    case asura::BLEND_OP_TYPE_MAX:      return D3D11_BLEND_OP_MAX;
+    }
+
+    return D3D11_BLEND_OP_ADD;
+}
+
+//-----------------------------------------------------------------------------
+//      カリングタイプを変換します.
+//-----------------------------------------------------------------------------
+D3D11_CULL_MODE ToNative(asura::CULL_TYPE type)
+{
+    switch(type)
+    {
+    case asura::CULL_TYPE_NONE:     return D3D11_CULL_NONE;
+    case asura::CULL_TYPE_FRONT:    return D3D11_CULL_FRONT;
+    case asura::CULL_TYPE_BACK:     return D3D11_CULL_BACK;
+    }
+
+    return D3D11_CULL_NONE;
+}
+
+//-----------------------------------------------------------------------------
+//      比較関数を変換します.
+//-----------------------------------------------------------------------------
+D3D11_COMPARISON_FUNC ToNative(asura::COMPARE_TYPE type)
+{
+    switch(type)
+    {
+    case asura::COMPARE_TYPE_NEVER:     return D3D11_COMPARISON_NEVER;
+    case asura::COMPARE_TYPE_LESS:      return D3D11_COMPARISON_LESS;
+    case asura::COMPARE_TYPE_EQUAL:     return D3D11_COMPARISON_EQUAL;
+    case asura::COMPARE_TYPE_LEQUAL:    return D3D11_COMPARISON_LESS_EQUAL;
+    case asura::COMPARE_TYPE_GREATER:   return D3D11_COMPARISON_GREATER;
+    case asura::COMPARE_TYPE_NEQUAL:    return D3D11_COMPARISON_NOT_EQUAL;
+    case asura::COMPARE_TYPE_GEQUAL:    return D3D11_COMPARISON_GREATER_EQUAL;
+    case asura::COMPARE_TYPE_ALWAYS:    return D3D11_COMPARISON_ALWAYS;
+    }
+
+    return D3D11_COMPARISON_ALWAYS;
+}
+
+//-----------------------------------------------------------------------------
+//      ステンシル操作を変換します.
+//-----------------------------------------------------------------------------
+D3D11_STENCIL_OP ToNative(asura::STENCIL_OP_TYPE type)
+{
+    switch(type)
+    {
+    case asura::STENCIL_OP_KEEP:        return D3D11_STENCIL_OP_KEEP;
+    case asura::STENCIL_OP_ZERO:        return D3D11_STENCIL_OP_ZERO;
+    case asura::STENCIL_OP_REPLACE:     return D3D11_STENCIL_OP_REPLACE;
+    case asura::STENCIL_OP_INCR_SAT:    return D3D11_STENCIL_OP_INCR_SAT;
+    case asura::STENCIL_OP_DECR_SAT:    return D3D11_STENCIL_OP_DECR_SAT;
+    case asura::STENCIL_OP_INVERT:      return D3D11_STENCIL_OP_INVERT;
+    case asura::STENCIL_OP_INCR:        return D3D11_STENCIL_OP_INCR;
+    case asura::STENCIL_OP_DECR:        return D3D11_STENCIL_OP_DECR;
+    }
+
+    return D3D11_STENCIL_OP_KEEP;
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      ブレンドステートをネイティブ形式に変換します.
+//-----------------------------------------------------------------------------
+D3D11_BLEND_DESC ToNativeDesc(const asura::BlendState& state)
+{
+    // ハッシュ計算のためにパディングも含めてゼロクリアしておく.
+    D3D11_BLEND_DESC desc;
+    memset(&desc, 0, sizeof(desc));
+
+    desc.AlphaToCoverageEnable  = state.AlphaToCoverageEnable ? TRUE : FALSE;
+    desc.IndependentBlendEnable = FALSE;
+
+    for(auto i=0; i<D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; ++i)
+    {
+        auto& target = desc.RenderTarget[i];
+        target.BlendEnable              = state.BlendEnable ? TRUE : FALSE;
+        target.SrcBlend                 = ToNative(state.SrcBlend);
+        target.DestBlend                = ToNative(state.DstBlend);
+        target.BlendOp                  = ToNative(state.BlendOp);
+        target.SrcBlendAlpha            = ToNative(state.SrcBlendAlpha);
+        target.DestBlendAlpha           = ToNative(state.DstBlendAlpha);
+        target.BlendOpAlpha             = ToNative(state.BlendOpAlpha);
+        target.RenderTargetWriteMask    = state.RenderTargetWriteMask & D3D11_COLOR_WRITE_ENABLE_ALL;
+    }
+
+    return desc;
+}
+
+//-----------------------------------------------------------------------------
+//      ラスタライザーステートをネイティブ形式に変換します.
+//-----------------------------------------------------------------------------
+D3D11_RASTERIZER_DESC ToNativeDesc(const asura::RasterizerState& state)
+{
+    D3D11_RASTERIZER_DESC desc;
+    memset(&desc, 0, sizeof(desc));
+
+    // コンサバティブラスタライゼーションは D3D11_RASTERIZER_DESC では指定できないので無視する.
+    desc.FillMode               = (state.PolygonMode == asura::POLYGON_MODE_WIREFRAME)
+                                ? D3D11_FILL_WIREFRAME : D3D11_FILL_SOLID;
+    desc.CullMode               = ToNative(state.CullMode);
+    desc.FrontCounterClockwise  = state.FrontCCW ? TRUE : FALSE;
+    desc.DepthBias              = INT(state.DepthBias);
+    desc.DepthBiasClamp         = state.DepthBiasClamp;
+    desc.SlopeScaledDepthBias   = state.SlopeScaledDepthBias;
+    desc.DepthClipEnable        = state.DepthClipEnable ? TRUE : FALSE;
+    desc.ScissorEnable          = FALSE;
+    desc.MultisampleEnable      = FALSE;
+    desc.AntialiasedLineEnable  = FALSE;
+
+    // -0.0f と 0.0f が別ステートにならないように正規化.
+    if (desc.DepthBiasClamp == 0.0f)
+    { desc.DepthBiasClamp = 0.0f; }
+    if (desc.SlopeScaledDepthBias == 0.0f)
+    { desc.SlopeScaledDepthBias = 0.0f; }
+
+    return desc;
+}
+
+//-----------------------------------------------------------------------------
+//      深度ステンシルステートをネイティブ形式に変換します.
+//-----------------------------------------------------------------------------
+D3D11_DEPTH_STENCIL_DESC ToNativeDesc(const asura::DepthStencilState& state)
+{
+    D3D11_DEPTH_STENCIL_DESC desc;
+    memset(&desc, 0, sizeof(desc));
+
+    desc.DepthEnable        = state.DepthEnable ? TRUE : FALSE;
+    desc.DepthWriteMask     = (state.DepthWriteMask == asura::DEPTH_WRITE_MASK_ALL)
+                            ? D3D11_DEPTH_WRITE_MASK_ALL : D3D11_DEPTH_WRITE_MASK_ZERO;
+    desc.DepthFunc          = ToNative(state.DepthFunc);
+    desc.StencilEnable      = state.StencilEnable ? TRUE : FALSE;
+    desc.StencilReadMask    = state.StencilReadMask;
+    desc.StencilWriteMask   = state.StencilWriteMask;
+
+    desc.FrontFace.StencilFailOp        = ToNative(state.FrontFaceStencilFail);
+    desc.FrontFace.StencilDepthFailOp   = ToNative(state.FrontFaceStencilDepthFail);
+    desc.FrontFace.StencilPassOp        = ToNative(state.FrontFaceStencilPass);
+    desc.FrontFace.StencilFunc          = ToNative(state.FrontFaceStencilFunc);
+
+    desc.BackFace.StencilFailOp         = ToNative(state.BackFaceStencilFail);
+    desc.BackFace.StencilDepthFailOp    = ToNative(state.BackFaceStencilDepthFail);
+    desc.BackFace.StencilPassOp         = ToNative(state.BackFaceStencilPass);
+    desc.BackFace.StencilFunc           = ToNative(state.BackFaceStencilFunc);
+
+    return desc;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+// RenderStateCache class
+///////////////////////////////////////////////////////////////////////////////
+RenderStateCache RenderStateCache::s_Instance = {};
+
+//-----------------------------------------------------------------------------
+//      シングルトンインスタンスを取得します.
+//-----------------------------------------------------------------------------
+RenderStateCache& RenderStateCache::Instance()
+{ return s_Instance; }
+
+//-----------------------------------------------------------------------------
+//      終了処理を行います.
+//-----------------------------------------------------------------------------
+void RenderStateCache::Term()
+{
+    m_BS .clear();
+    m_RS .clear();
+    m_DSS.clear();
+
+    m_BlendTable       .Clear();
+    m_RasterizerTable  .Clear();
+    m_DepthStencilTable.Clear();
+}
+
+//-----------------------------------------------------------------------------
+//      ブレンドステートを登録します.
+//-----------------------------------------------------------------------------
+RenderStateHandle RenderStateCache::RegisterBS(const asura::BlendState& state)
+{
+    auto desc  = ToNativeDesc(state);
+    auto added = false;
+    auto handle = m_BlendTable.Register(desc, &added);
+    if (!added)
+    { return handle; }
+
+    // ハンドルとオブジェクトの番号を一致させる.
+    m_BS.resize(m_BlendTable.GetCount());
+
+    auto pDevice = asdx::DeviceContext::Instance().GetDevice();
+    auto hr = pDevice->CreateBlendState(&desc, m_BS[handle].GetAddress());
+    if (FAILED(hr))
+    {
+        ELOGA("Error : ID3D11Device::CreateBlendState() Failed. errcode = 0x%x", hr);
+
+        // 同じ記述で再登録された際に空のオブジェクトを返さないよう登録を取り消す.
+        m_BlendTable.RemoveLast();
+        m_BS.pop_back();
+        return kInvalidRenderStateHandle;
+    }
+
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+//      ラスタライザーステートを登録します.
+//-----------------------------------------------------------------------------
+RenderStateHandle RenderStateCache::RegisterRS(const asura::RasterizerState& state)
+{
+    auto desc  = ToNativeDesc(state);
+    auto added = false;
+    auto handle = m_RasterizerTable.Register(desc, &added);
+    if (!added)
+    { return handle; }
+
+    m_RS.resize(m_RasterizerTable.GetCount());
+
+    auto pDevice = asdx::DeviceContext::Instance().GetDevice();
+    auto hr = pDevice->CreateRasterizerState(&desc, m_RS[handle].GetAddress());
+    if (FAILED(hr))
+    {
+        ELOGA("Error : ID3D11Device::CreateRasterizerState() Failed. errcode = 0x%x", hr);
+
+        // 同じ記述で再登録された際に空のオブジェクトを返さないよう登録を取り消す.
+        m_RasterizerTable.RemoveLast();
+        m_RS.pop_back();
+        return kInvalidRenderStateHandle;
+    }
+
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+//      深度ステンシルステートを登録します.
+//-----------------------------------------------------------------------------
+RenderStateHandle RenderStateCache::RegisterDSS(const asura::DepthStencilState& state)
+{
+    auto desc  = ToNativeDesc(state);
+    auto added = false;
+    auto handle = m_DepthStencilTable.Register(desc, &added);
+    if (!added)
+    { return handle; }
+
+    m_DSS.resize(m_DepthStencilTable.GetCount());
+
+    auto pDevice = asdx::DeviceContext::Instance().GetDevice();
+    auto hr = pDevice->CreateDepthStencilState(&desc, m_DSS[handle].GetAddress());
+    if (FAILED(hr))
+    {
+        ELOGA("Error : ID3D11Device::CreateDepthStencilState() Failed. errcode = 0x%x", hr);
+
+        // 同じ記述で再登録された際に空のオブジェクトを返さないよう登録を取り消す.
+        m_DepthStencilTable.RemoveLast();
+        m_DSS.pop_back();
+        return kInvalidRenderStateHandle;
+    }
+
+    return handle;
+}
+
+//-----------------------------------------------------------------------------
+//      ブレンドステートを取得します.
+//-----------------------------------------------------------------------------
+ID3D11BlendState* RenderStateCache::GetBS(RenderStateHandle handle) const
+{
+    if (handle >= m_BS.size())
+    { return nullptr; }
+
+    return m_BS[handle].GetPtr();
+}
+
+//-----------------------------------------------------------------------------
+//      ラスタライザーステートを取得します.
+//-----------------------------------------------------------------------------
+ID3D11RasterizerState* RenderStateCache::GetRS(RenderStateHandle handle) const
+{
+    if (handle >= m_RS.size())
+    { return nullptr; }
+
+    return m_RS[handle].GetPtr();
+}
+
+//-----------------------------------------------------------------------------
+//      深度ステンシルステートを取得します.
+//-----------------------------------------------------------------------------
+ID3D11DepthStencilState* RenderStateCache::GetDSS(RenderStateHandle handle) const
+{
+    if (handle >= m_DSS.size())
+    { return nullptr; }
+
+    return m_DSS[handle].GetPtr();
+}
+
+#if ENABLE_RENDER_STATE_TEST
+//-----------------------------------------------------------------------------
+//      ステートの変換と重複排除をデバイス無しでテストします.
+//-----------------------------------------------------------------------------
+bool TestRenderStateTable()
+{
+    auto result = true;
+    auto check  = [&result](bool condition, const char* label)
+    {
+        if (!condition)
+        {
+            ELOGA("Error : RenderState Test Failed. case = %s", label);
+            result = false;
+        }
+    };
+
+    // 同一内容のブレンドステートは同じハンドルになる.
+    {
+        RenderStateTable<D3D11_BLEND_DESC> table;
+
+        asura::BlendState a;
+        asura::BlendState b;
+        asura::BlendState c;
+        c.BlendEnable = true;
+        c.SrcBlend    = asura::BLEND_TYPE_SRC_ALPHA;
+        c.DstBlend    = asura::BLEND_TYPE_INV_SRC_ALPHA;
+
+        auto addedA = false;
+        auto addedB = false;
+        auto addedC = false;
+        auto handleA = table.Register(ToNativeDesc(a), &addedA);
+        auto handleB = table.Register(ToNativeDesc(b), &addedB);
+        auto handleC = table.Register(ToNativeDesc(c), &addedC);
+
+        check(addedA && !addedB && addedC,              "blend added flag");
+        check(handleA == handleB,                       "blend dedup");
+        check(handleA != handleC,                       "blend distinct");
+        check(table.GetCount() == 2,                    "blend count");
+        check(table.GetDesc(handleC).RenderTarget[0].SrcBlend == D3D11_BLEND_SRC_ALPHA, "blend desc");
+        check(table.GetDesc(handleA).RenderTarget[0].RenderTargetWriteMask == D3D11_COLOR_WRITE_ENABLE_ALL, "blend write mask");
+    }
+
+    // -0.0f と 0.0f のバイアスは同じラスタライザーステートになる.
+    {
+        RenderStateTable<D3D11_RASTERIZER_DESC> table;
+
+        asura::RasterizerState a;
+        asura::RasterizerState b;
+        a.CullMode              = asura::CULL_TYPE_BACK;
+        b.CullMode              = asura::CULL_TYPE_BACK;
+        b.DepthBiasClamp        = -0.0f;
+        b.SlopeScaledDepthBias  = -0.0f;
+
+        auto handleA = table.Register(ToNativeDesc(a));
+        auto handleB = table.Register(ToNativeDesc(b));
+
+        check(handleA == handleB,                               "rasterizer signed zero");
+        check(table.GetDesc(handleA).CullMode == D3D11_CULL_BACK, "rasterizer cull mode");
+    }
+
+    // 取り消した記述は再登録時に新規扱いとなり, 同じハンドルが再利用される.
+    {
+        RenderStateTable<D3D11_DEPTH_STENCIL_DESC> table;
+
+        asura::DepthStencilState a;
+        asura::DepthStencilState b;
+        b.DepthWriteMask = asura::DEPTH_WRITE_MASK_ZERO;
+
+        auto handleA = table.Register(ToNativeDesc(a));
+        auto handleB = table.Register(ToNativeDesc(b));
+        table.RemoveLast();
+
+        auto added   = false;
+        auto handleC = table.Register(ToNativeDesc(b), &added);
+
+        check(table.GetCount() == 2,                    "depth count");
+        check(added && handleB == handleC,              "depth remove last");
+        check(table.Register(ToNativeDesc(a)) == handleA, "depth keep first");
+        check(table.GetDesc(handleC).DepthWriteMask == D3D11_DEPTH_WRITE_MASK_ZERO, "depth write mask");
+    }
+
+    if (result)
+    { ILOGA("Info : RenderState Test Passed."); }
+
+    return result;
+}
+#endif//ENABLE_RENDER_STATE_TEST
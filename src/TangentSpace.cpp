@@ -0,0 +1,573 @@
+﻿//-----------------------------------------------------------------------------
+// File : TangentSpace.cpp
+// Desc : Normal And Tangent Generation.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <TangentSpace.h>
+#include <ParallelFor.h>
+#include <asdxLogger.h>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+#include <emmintrin.h>
+
+#if ENABLE_MESH_BENCHMARK
+#include <Benchmark.h>
+#include <cstdio>
+#include <cstring>
+#endif
+
+
+namespace {
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const size_t kTrianglesPerJob = 4096;    // 4の倍数.
+static const size_t kVerticesPerJob  = 4096;
+
+///////////////////////////////////////////////////////////////////////////////
+// VertexCorners structure
+///////////////////////////////////////////////////////////////////////////////
+struct VertexCorners
+{
+    std::vector<uint32_t>   Offsets;    // 頂点ごとの Corners の開始位置 (頂点数 + 1).
+    std::vector<uint32_t>   Corners;    // 頂点を参照するインデックス位置 (昇順).
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Vector4x4 structure
+///////////////////////////////////////////////////////////////////////////////
+struct Vector4x4
+{
+    __m128  x;
+    __m128  y;
+    __m128  z;
+};
+
+//-----------------------------------------------------------------------------
+//      4頂点を成分ごとに読み込みます.
+//-----------------------------------------------------------------------------
+inline Vector4x4 Gather3(const asdx::Vector3* pSrc, const uint32_t* pIndex)
+{
+    const auto& a = pSrc[pIndex[0]];
+    const auto& b = pSrc[pIndex[1]];
+    const auto& c = pSrc[pIndex[2]];
+    const auto& d = pSrc[pIndex[3]];
+
+    Vector4x4 result;
+    result.x = _mm_setr_ps(a.x, b.x, c.x, d.x);
+    result.y = _mm_setr_ps(a.y, b.y, c.y, d.y);
+    result.z = _mm_setr_ps(a.z, b.z, c.z, d.z);
+    return result;
+}
+
+//-----------------------------------------------------------------------------
+//      4頂点分のテクスチャ座標を成分ごとに読み込みます.
+//-----------------------------------------------------------------------------
+inline void Gather2(const asdx::Vector2* pSrc, const uint32_t* pIndex, __m128& x, __m128& y)
+{
+    const auto& a = pSrc[pIndex[0]];
+    const auto& b = pSrc[pIndex[1]];
+    const auto& c = pSrc[pIndex[2]];
+    const auto& d = pSrc[pIndex[3]];
+    x = _mm_setr_ps(a.x, b.x, c.x, d.x);
+    y = _mm_setr_ps(a.y, b.y, c.y, d.y);
+}
+
+//-----------------------------------------------------------------------------
+//      4要素ベクトルを4つ読み込み, 成分ごとに並べ替えます.
+//-----------------------------------------------------------------------------
+inline Vector4x4 Gather4(const asdx::Vector4* pSrc, const uint32_t* pIndex)
+{
+    auto x = _mm_loadu_ps(&pSrc[pIndex[0]].x);
+    auto y = _mm_loadu_ps(&pSrc[pIndex[1]].x);
+    auto z = _mm_loadu_ps(&pSrc[pIndex[2]].x);
+    auto w = _mm_loadu_ps(&pSrc[pIndex[3]].x);
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    return Vector4x4{ x, y, z };
+}
+
+//-----------------------------------------------------------------------------
+//      成分ごとの4ベクトルを転置して格納します.
+//-----------------------------------------------------------------------------
+inline void Store4(const Vector4x4& value, asdx::Vector4* pResult)
+{
+    // 頂点ごとの合計でキャッシュラインを1つだけ読むよう, 要素ごとに並べ替える.
+    auto x = value.x;
+    auto y = value.y;
+    auto z = value.z;
+    auto w = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(&pResult[0].x, x);
+    _mm_storeu_ps(&pResult[1].x, y);
+    _mm_storeu_ps(&pResult[2].x, z);
+    _mm_storeu_ps(&pResult[3].x, w);
+}
+
+inline Vector4x4 Sub(const Vector4x4& a, const Vector4x4& b)
+{ return Vector4x4{ _mm_sub_ps(a.x, b.x), _mm_sub_ps(a.y, b.y), _mm_sub_ps(a.z, b.z) }; }
+
+inline Vector4x4 Scale(const Vector4x4& a, __m128 s)
+{ return Vector4x4{ _mm_mul_ps(a.x, s), _mm_mul_ps(a.y, s), _mm_mul_ps(a.z, s) }; }
+
+inline __m128 Dot(const Vector4x4& a, const Vector4x4& b)
+{ return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a.x, b.x), _mm_mul_ps(a.y, b.y)), _mm_mul_ps(a.z, b.z)); }
+
+inline Vector4x4 Cross(const Vector4x4& a, const Vector4x4& b)
+{
+    return Vector4x4{
+        _mm_sub_ps(_mm_mul_ps(a.y, b.z), _mm_mul_ps(a.z, b.y)),
+        _mm_sub_ps(_mm_mul_ps(a.z, b.x), _mm_mul_ps(a.x, b.z)),
+        _mm_sub_ps(_mm_mul_ps(a.x, b.y), _mm_mul_ps(a.y, b.x)) };
+}
+
+//-----------------------------------------------------------------------------
+//      長さがゼロでなければ正規化します (MikkTSpace の NotZero() と同じ判定).
+//-----------------------------------------------------------------------------
+inline Vector4x4 NormalizeSafe(const Vector4x4& v)
+{
+    auto len   = _mm_sqrt_ps(Dot(v, v));
+    auto valid = _mm_cmpgt_ps(len, _mm_set1_ps(FLT_MIN));
+    auto scale = _mm_or_ps(
+        _mm_and_ps   (valid, _mm_div_ps(_mm_set1_ps(1.0f), len)),
+        _mm_andnot_ps(valid, _mm_set1_ps(1.0f)));
+    return Scale(v, scale);
+}
+
+//-----------------------------------------------------------------------------
+//      ベクトルを法線の接平面に射影します.
+//-----------------------------------------------------------------------------
+inline Vector4x4 ProjectToPlane(const Vector4x4& v, const Vector4x4& n)
+{ return Sub(v, Scale(n, Dot(n, v))); }
+
+//-----------------------------------------------------------------------------
+//      2ベクトルのなす角の余弦を求めます.
+//-----------------------------------------------------------------------------
+inline __m128 Cosine(const Vector4x4& a, const Vector4x4& b)
+{
+    // それぞれ正規化してから内積を取るのと同じ. 長さがゼロなら直交扱い.
+    const auto kMin = _mm_set1_ps(FLT_MIN * FLT_MIN);
+    auto aa = Dot(a, a);
+    auto bb = Dot(b, b);
+    auto valid = _mm_and_ps(_mm_cmpgt_ps(aa, kMin), _mm_cmpgt_ps(bb, kMin));
+    auto c = _mm_div_ps(Dot(a, b), _mm_sqrt_ps(_mm_mul_ps(aa, bb)));
+    c = _mm_max_ps(_mm_min_ps(c, _mm_set1_ps(1.0f)), _mm_set1_ps(-1.0f));
+    return _mm_and_ps(valid, c);
+}
+
+//-----------------------------------------------------------------------------
+//      [-1, 1] の範囲の逆余弦を求めます.
+//-----------------------------------------------------------------------------
+inline __m128 Acos4(__m128 x)
+{
+    // Abramowitz and Stegun 4.4.46 (誤差 2e-8 以下).
+    const auto kSignMask = _mm_set1_ps(-0.0f);
+    auto negative = _mm_cmplt_ps(x, _mm_setzero_ps());
+    auto a = _mm_andnot_ps(kSignMask, x);
+
+    auto p = _mm_set1_ps(-0.0012624911f);
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps( 0.0066700901f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(-0.0170881256f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps( 0.0308918810f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(-0.0501743046f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps( 0.0889789874f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps(-0.2145988016f));
+    p = _mm_add_ps(_mm_mul_ps(p, a), _mm_set1_ps( 1.5707963050f));
+
+    auto r = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(_mm_set1_ps(1.0f), a)), p);
+
+    // acos(-x) = pi - acos(x).
+    auto mirrored = _mm_sub_ps(_mm_set1_ps(3.14159265f), r);
+    return _mm_or_ps(_mm_and_ps(negative, mirrored), _mm_andnot_ps(negative, r));
+}
+
+//-----------------------------------------------------------------------------
+//      4三角形分のインデックスを読み込みます.
+//-----------------------------------------------------------------------------
+inline void LoadTriangles4(const uint32_t* pIndices, size_t first, size_t triangleCount, uint32_t (&corner)[3][4])
+{
+    // 端数は最後の三角形を繰り返す (格納先は4の倍数で確保済み).
+    for(auto lane=0; lane<4; ++lane)
+    {
+        auto t = first + lane;
+        if (t >= triangleCount)
+        { t = triangleCount - 1; }
+
+        corner[0][lane] = pIndices[t * 3 + 0];
+        corner[1][lane] = pIndices[t * 3 + 1];
+        corner[2][lane] = pIndices[t * 3 + 2];
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      4三角形分の面法線を求めます.
+//-----------------------------------------------------------------------------
+void ComputeFaceNormal4
+(
+    const asdx::ResMesh&    mesh,
+    size_t                  first,
+    size_t                  triangleCount,
+    asdx::Vector4*          pResult
+)
+{
+    uint32_t corner[3][4];
+    LoadTriangles4(mesh.Indices.data(), first, triangleCount, corner);
+
+    auto p0 = Gather3(mesh.Positions.data(), corner[0]);
+    auto p1 = Gather3(mesh.Positions.data(), corner[1]);
+    auto p2 = Gather3(mesh.Positions.data(), corner[2]);
+
+    // 外積の長さが面積の2倍になるので, そのまま合計すれば面積の重み付けになる.
+    Store4(Cross(Sub(p1, p0), Sub(p2, p0)), pResult + first);
+}
+
+//-----------------------------------------------------------------------------
+//      4三角形分の角ごとの接線を求めます.
+//-----------------------------------------------------------------------------
+void ComputeCornerTangent4
+(
+    const asdx::ResMesh&    mesh,
+    const asdx::Vector4*    pNormals,
+    size_t                  first,
+    size_t                  triangleCount,
+    asdx::Vector4*          pResult
+)
+{
+    uint32_t corner[3][4];
+    LoadTriangles4(mesh.Indices.data(), first, triangleCount, corner);
+
+    Vector4x4 p[3];
+    p[0] = Gather3(mesh.Positions.data(), corner[0]);
+    p[1] = Gather3(mesh.Positions.data(), corner[1]);
+    p[2] = Gather3(mesh.Positions.data(), corner[2]);
+
+    __m128 t0x, t0y, t1x, t1y, t2x, t2y;
+    Gather2(mesh.TexCoords[0].data(), corner[0], t0x, t0y);
+    Gather2(mesh.TexCoords[0].data(), corner[1], t1x, t1y);
+    Gather2(mesh.TexCoords[0].data(), corner[2], t2x, t2y);
+
+    auto t21x = _mm_sub_ps(t1x, t0x);
+    auto t21y = _mm_sub_ps(t1y, t0y);
+    auto t31x = _mm_sub_ps(t2x, t0x);
+    auto t31y = _mm_sub_ps(t2y, t0y);
+
+    auto d1 = Sub(p[1], p[0]);
+    auto d2 = Sub(p[2], p[0]);
+
+    // MikkTSpace の InitTriInfo() と同じく, 符号付きUV面積で向きを揃えて正規化する.
+    auto area = _mm_sub_ps(_mm_mul_ps(t21x, t31y), _mm_mul_ps(t21y, t31x));
+    auto os   = Sub(Scale(d1, t31y), Scale(d2, t21y));
+    auto len  = _mm_sqrt_ps(Dot(os, os));
+
+    const auto kMin      = _mm_set1_ps(FLT_MIN);
+    const auto kSignMask = _mm_set1_ps(-0.0f);
+
+    auto valid = _mm_and_ps(
+        _mm_cmpgt_ps(_mm_andnot_ps(kSignMask, area), kMin),
+        _mm_cmpgt_ps(len, kMin));
+
+    // 負の面積は -1, それ以外は +1. UVが縮退した面は寄与しない.
+    auto sign  = _mm_or_ps(_mm_set1_ps(1.0f), _mm_and_ps(_mm_cmplt_ps(area, _mm_setzero_ps()), kSignMask));
+    auto scale = _mm_and_ps(valid, _mm_div_ps(sign, len));
+    os = Scale(os, scale);
+
+    // MikkTSpace の GenerateTSpaces() と同じく, 頂点法線の接平面に射影し, 角の大きさで重み付けする.
+    Vector4x4 contribution[3];
+    for(auto k=0; k<3; ++k)
+    {
+        auto n  = Gather4(pNormals, corner[k]);
+        auto v1 = ProjectToPlane(Sub(p[(k + 2) % 3], p[k]), n);
+        auto v2 = ProjectToPlane(Sub(p[(k + 1) % 3], p[k]), n);
+
+        contribution[k] = Scale(NormalizeSafe(ProjectToPlane(os, n)), Acos4(Cosine(v1, v2)));
+    }
+
+    // 角の並び (三角形 * 3 + k) で格納する.
+    asdx::Vector4 values[3][4];
+    for(auto k=0; k<3; ++k)
+    { Store4(contribution[k], values[k]); }
+
+    auto count = triangleCount - first;
+    if (count > 4)
+    { count = 4; }
+
+    for(size_t lane=0; lane<count; ++lane)
+    {
+        for(auto k=0; k<3; ++k)
+        { pResult[(first + lane) * 3 + k] = values[k][lane]; }
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      頂点から参照しているインデックス位置の一覧を構築します.
+//-----------------------------------------------------------------------------
+void BuildVertexCorners(const uint32_t* pIndices, size_t indexCount, size_t vertexCount, VertexCorners& result)
+{
+    result.Offsets.assign(vertexCount + 1, 0);
+    for(size_t i=0; i<indexCount; ++i)
+    { result.Offsets[pIndices[i] + 1]++; }
+
+    for(size_t i=0; i<vertexCount; ++i)
+    { result.Offsets[i + 1] += result.Offsets[i]; }
+
+    // 昇順に詰めるので, 合計の順序はスレッド数に依存しない.
+    std::vector<uint32_t> cursor(result.Offsets.begin(), result.Offsets.end() - 1);
+    result.Corners.resize(indexCount);
+    for(size_t i=0; i<indexCount; ++i)
+    { result.Corners[cursor[pIndices[i]]++] = uint32_t(i); }
+}
+
+//-----------------------------------------------------------------------------
+//      頂点を参照する角の値を合計します.
+//-----------------------------------------------------------------------------
+inline asdx::Vector3 SumCorners
+(
+    const asdx::Vector4*    pValues,
+    uint32_t                divisor,
+    const VertexCorners&    corners,
+    size_t                  vertex
+)
+{
+    auto sum = _mm_setzero_ps();
+    for(auto i=corners.Offsets[vertex]; i<corners.Offsets[vertex + 1]; ++i)
+    { sum = _mm_add_ps(sum, _mm_loadu_ps(&pValues[corners.Corners[i] / divisor].x)); }
+
+    alignas(16) float result[4];
+    _mm_store_ps(result, sum);
+    return asdx::Vector3(result[0], result[1], result[2]);
+}
+
+//-----------------------------------------------------------------------------
+//      法線に直交する単位ベクトルを求めます.
+//-----------------------------------------------------------------------------
+inline asdx::Vector3 Perpendicular(const asdx::Vector3& n)
+{
+    // Duff et al. "Building an Orthonormal Basis, Revisited".
+    auto s = copysignf(1.0f, n.z);
+    auto a = -1.0f / (s + n.z);
+    auto b = n.x * n.y * a;
+    return asdx::Vector3(1.0f + s * n.x * n.x * a, s * b, -s * n.x);
+}
+
+//-----------------------------------------------------------------------------
+//      頂点ごとの処理を並列に行います.
+//-----------------------------------------------------------------------------
+template<typename Func>
+void ForEachVertex(size_t vertexCount, Func func)
+{
+    auto jobCount = (vertexCount + kVerticesPerJob - 1) / kVerticesPerJob;
+    ParallelFor(jobCount, [&](size_t job)
+    {
+        auto begin = job * kVerticesPerJob;
+        auto end   = begin + kVerticesPerJob;
+        if (end > vertexCount)
+        { end = vertexCount; }
+
+        for(auto v=begin; v<end; ++v)
+        { func(v); }
+    });
+}
+
+//-----------------------------------------------------------------------------
+//      三角形4つ単位の処理を並列に行います.
+//-----------------------------------------------------------------------------
+template<typename Func>
+void ForEachTriangle4(size_t triangleCount, Func func)
+{
+    auto jobCount = (triangleCount + kTrianglesPerJob - 1) / kTrianglesPerJob;
+    ParallelFor(jobCount, [&](size_t job)
+    {
+        auto begin = job * kTrianglesPerJob;
+        auto end   = begin + kTrianglesPerJob;
+        if (end > triangleCount)
+        { end = triangleCount; }
+
+        for(auto t=begin; t<end; t+=4)
+        { func(t); }
+    });
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      持っていない法線ベクトルと接線ベクトルを生成します.
+//-----------------------------------------------------------------------------
+bool GenerateTangentSpace(asdx::ResMesh& mesh)
+{
+    auto generateNormal  = mesh.Normals .empty();
+    auto generateTangent = mesh.Tangents.empty();
+    if (!generateNormal && !generateTangent)
+    { return true; }
+
+    auto vertexCount   = mesh.Positions.size();
+    auto triangleCount = mesh.Indices.size() / 3;
+    auto indexCount    = triangleCount * 3;
+
+    auto hasTexCoord = !mesh.TexCoords[0].empty();
+    if ((!generateNormal && mesh.Normals.size() != vertexCount)
+     || (hasTexCoord && mesh.TexCoords[0].size() != vertexCount))
+    {
+        ELOGA("Error : Invalid Vertex Count. mesh = %s", mesh.MeshName.c_str());
+        return false;
+    }
+
+    for(size_t i=0; i<indexCount; ++i)
+    {
+        if (mesh.Indices[i] >= vertexCount)
+        {
+            ELOGA("Error : Index Out Of Range. mesh = %s", mesh.MeshName.c_str());
+            return false;
+        }
+    }
+
+    // 頂点ごとに面の順で合計するための一覧.
+    VertexCorners corners;
+    BuildVertexCorners(mesh.Indices.data(), indexCount, vertexCount, corners);
+
+    if (generateNormal)
+    {
+        std::vector<asdx::Vector4> faceNormals((triangleCount + 3) & ~size_t(3));
+        ForEachTriangle4(triangleCount, [&](size_t first)
+        { ComputeFaceNormal4(mesh, first, triangleCount, faceNormals.data()); });
+
+        mesh.Normals.resize(vertexCount);
+        ForEachVertex(vertexCount, [&](size_t v)
+        {
+            auto sum = SumCorners(faceNormals.data(), 3, corners, v);
+            mesh.Normals[v] = asdx::Vector3::SafeNormalize(sum, asdx::Vector3(0.0f, 1.0f, 0.0f));
+        });
+    }
+
+    if (generateTangent)
+    {
+        // 角ごとに正規化しないよう, 先に頂点法線を正規化しておく.
+        std::vector<asdx::Vector4> normals(vertexCount);
+        ForEachVertex(vertexCount, [&](size_t v)
+        {
+            auto n = asdx::Vector3::SafeNormalize(mesh.Normals[v], asdx::Vector3(0.0f, 1.0f, 0.0f));
+            normals[v] = asdx::Vector4(n.x, n.y, n.z, 0.0f);
+        });
+
+        std::vector<asdx::Vector4> cornerTangents;
+        if (hasTexCoord)
+        {
+            cornerTangents.resize(indexCount);
+            ForEachTriangle4(triangleCount, [&](size_t first)
+            { ComputeCornerTangent4(mesh, normals.data(), first, triangleCount, cornerTangents.data()); });
+        }
+
+        mesh.Tangents.resize(vertexCount);
+        ForEachVertex(vertexCount, [&](size_t v)
+        {
+            auto n   = asdx::Vector3(normals[v].x, normals[v].y, normals[v].z);
+            auto sum = (hasTexCoord) ? SumCorners(cornerTangents.data(), 1, corners, v) : asdx::Vector3(0.0f, 0.0f, 0.0f);
+            auto len = sum.Length();
+            mesh.Tangents[v] = (len > FLT_MIN) ? sum * (1.0f / len) : Perpendicular(n);
+        });
+    }
+
+    return true;
+}
+
+#if ENABLE_MESH_BENCHMARK
+//-----------------------------------------------------------------------------
+//      法線・接線生成の処理時間と誤差を asdx::CalcNormals(), asdx::CalcTangents() と比較します.
+//-----------------------------------------------------------------------------
+bool BenchmarkTangentSpace(uint32_t loopCount)
+{
+    // 解析的な法線と接線が分かる球.
+    const uint32_t kSlices = 1000;
+    const uint32_t kStacks = 500;
+
+    asdx::ResMesh source;
+    std::vector<asdx::Vector3> expectNormals;
+    std::vector<asdx::Vector3> expectTangents;
+    for(auto y=0u; y<=kStacks; ++y)
+    {
+        for(auto x=0u; x<=kSlices; ++x)
+        {
+            auto u     = float(x) / float(kSlices);
+            auto v     = float(y) / float(kStacks);
+            auto theta = 3.14159265f * v;
+            auto phi   = 6.28318531f * u;
+            auto n     = asdx::Vector3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+            source.Positions   .push_back(n * 10.0f);
+            source.TexCoords[0].push_back(asdx::Vector2(u, v));
+            expectNormals      .push_back(n);
+            expectTangents     .push_back(asdx::Vector3(-sinf(phi), 0.0f, cosf(phi)));
+        }
+    }
+
+    for(auto y=0u; y<kStacks; ++y)
+    {
+        for(auto x=0u; x<kSlices; ++x)
+        {
+            auto i = y * (kSlices + 1) + x;
+            auto j = i + kSlices + 1;
+            source.Indices.insert(source.Indices.end(), { i, i + 1, j, i + 1, j + 1, j });
+        }
+    }
+
+    // 極は法線も接線も定まらないので誤差計測から除く.
+    auto measure = [&](const std::vector<asdx::Vector3>& values, const std::vector<asdx::Vector3>& expect)
+    {
+        auto maxError = 0.0f;
+        for(auto y=1u; y<kStacks; ++y)
+        {
+            for(auto x=0u; x<=kSlices; ++x)
+            {
+                auto i   = y * (kSlices + 1) + x;
+                auto dot = asdx::Vector3::Dot(values[i], expect[i]);
+                auto angle = acosf((dot > 1.0f) ? 1.0f : ((dot < -1.0f) ? -1.0f : dot));
+                if (angle > maxError)
+                { maxError = angle; }
+            }
+        }
+        return maxError * 180.0f / 3.14159265f;
+    };
+
+    double bestBase;
+    double bestOurs;
+    asdx::ResMesh base;
+    asdx::ResMesh ours;
+
+    if (!MeasureBest(loopCount,
+        [&]() { base = source; },
+        [&]() { asdx::CalcNormals(base); asdx::CalcTangents(base); return true; },
+        bestBase))
+    { return false; }
+
+    if (!MeasureBest(loopCount,
+        [&]() { ours = source; },
+        [&]() { return GenerateTangentSpace(ours); },
+        bestOurs))
+    { return false; }
+
+    // 再実行して結果がビット単位で一致するか確認.
+    auto again = source;
+    GenerateTangentSpace(again);
+    auto deterministic = memcmp(again.Normals .data(), ours.Normals .data(), sizeof(asdx::Vector3) * ours.Normals .size()) == 0
+                      && memcmp(again.Tangents.data(), ours.Tangents.data(), sizeof(asdx::Vector3) * ours.Tangents.size()) == 0;
+
+    ILOGA("Info : Tangent Space Benchmark. vertices = %zu, triangles = %zu", source.Positions.size(), source.Indices.size() / 3);
+    auto report = [&](const char* label, double time, double baseline, const asdx::ResMesh& mesh)
+    {
+        char note[96];
+        sprintf_s(note, "(normal %.4f deg, tangent %.4f deg max error)",
+            measure(mesh.Normals, expectNormals), measure(mesh.Tangents, expectTangents));
+        LogBenchmark(label, time, baseline, note);
+    };
+
+    report("asdx",     bestBase, 0.0,      base);
+    report("generate", bestOurs, bestBase, ours);
+    ILOGA("    deterministic = %s", deterministic ? "true" : "false");
+
+    return true;
+}
+#endif
@@ -0,0 +1,613 @@
+﻿//-----------------------------------------------------------------------------
+// File : VertexPacking.cpp
+// Desc : Compact Vertex Format.
+// Copyright(c) Project Asura. All right reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Includes
+//-----------------------------------------------------------------------------
+#include <VertexPacking.h>
+#include <cstring>
+#include <emmintrin.h>
+
+#if ENABLE_MESH_BENCHMARK
+#include <Benchmark.h>
+#include <cmath>
+#endif
+
+
+namespace {
+
+static_assert(sizeof(asdx::Vector2) == sizeof(float) * 2, "Vector2 must be tightly packed.");
+static_assert(sizeof(asdx::Vector3) == sizeof(float) * 3, "Vector3 must be tightly packed.");
+static_assert(sizeof(asdx::Vector4) == sizeof(float) * 4, "Vector4 must be tightly packed.");
+
+//-----------------------------------------------------------------------------
+// Constant Values.
+//-----------------------------------------------------------------------------
+static const uint32_t kDefaultColor     = 0xffffffff;   // 白.
+static const uint32_t kDefaultTexCoord  = 0x00000000;   // (0, 0).
+
+//-----------------------------------------------------------------------------
+//      4頂点分の Vector3 を成分ごとに読み込みます.
+//-----------------------------------------------------------------------------
+inline void Load3x4(const asdx::Vector3* pSrc, __m128& x, __m128& y, __m128& z)
+{
+    auto pf = reinterpret_cast<const float*>(pSrc);
+    auto a = _mm_loadu_ps(pf + 0);  // x0 y0 z0 x1
+    auto b = _mm_loadu_ps(pf + 4);  // y1 z1 x2 y2
+    auto c = _mm_loadu_ps(pf + 8);  // z2 x3 y3 z3
+
+    auto t = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 0, 3, 2));    // x2 y2 z2 x3
+    auto u = _mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 0, 2, 1));    // y0 z0 y1 z1
+    auto v = _mm_shuffle_ps(t, c, _MM_SHUFFLE(3, 2, 2, 1));    // y2 z2 y3 z3
+
+    x = _mm_shuffle_ps(a, t, _MM_SHUFFLE(3, 0, 3, 0));
+    y = _mm_shuffle_ps(u, v, _MM_SHUFFLE(2, 0, 2, 0));
+    z = _mm_shuffle_ps(u, v, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+//-----------------------------------------------------------------------------
+//      4頂点分のベクトルを八面体エンコードします.
+//-----------------------------------------------------------------------------
+inline __m128i EncodeOctahedral4(const asdx::Vector3* pSrc)
+{
+    __m128 x, y, z;
+    Load3x4(pSrc, x, y, z);
+
+    auto signMask = _mm_set1_ps(-0.0f);
+    auto one      = _mm_set1_ps(1.0f);
+
+    // L1ノルムで割って八面体に射影する (ゼロベクトルは (0, 0) になる).
+    auto sum = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(signMask, x), _mm_andnot_ps(signMask, y)), _mm_andnot_ps(signMask, z));
+    auto inv = _mm_div_ps(one, _mm_max_ps(sum, _mm_set1_ps(1e-20f)));
+    auto px  = _mm_mul_ps(x, inv);
+    auto py  = _mm_mul_ps(y, inv);
+
+    // 下半球は対角線で折り返す.
+    auto signX = _mm_or_ps(_mm_and_ps(px, signMask), one);
+    auto signY = _mm_or_ps(_mm_and_ps(py, signMask), one);
+    auto foldX = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, py)), signX);
+    auto foldY = _mm_mul_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, px)), signY);
+    auto lower = _mm_cmplt_ps(z, _mm_setzero_ps());
+    px = _mm_or_ps(_mm_and_ps(lower, foldX), _mm_andnot_ps(lower, px));
+    py = _mm_or_ps(_mm_and_ps(lower, foldY), _mm_andnot_ps(lower, py));
+
+    auto scale = _mm_set1_ps(32767.0f);
+    auto ix = _mm_cvtps_epi32(_mm_mul_ps(px, scale));
+    auto iy = _mm_cvtps_epi32(_mm_mul_ps(py, scale));
+
+    // x0 x1 x2 x3 y0 y1 y2 y3 -> x0 y0 x1 y1 x2 y2 x3 y3.
+    auto packed = _mm_packs_epi32(ix, iy);
+    return _mm_unpacklo_epi16(packed, _mm_srli_si128(packed, 8));
+}
+
+//-----------------------------------------------------------------------------
+//      4頂点分の法線と接線を八面体エンコードします.
+//-----------------------------------------------------------------------------
+inline void EncodeNormalTangent4
+(
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector3*    pTangents,
+    uint32_t*               pResult
+)
+{
+    auto n = EncodeOctahedral4(pNormals);
+    auto t = EncodeOctahedral4(pTangents);
+
+    // 頂点ごとに法線, 接線の順で並べる.
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pResult + 0), _mm_unpacklo_epi32(n, t));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pResult + 4), _mm_unpackhi_epi32(n, t));
+}
+
+//-----------------------------------------------------------------------------
+//      4要素の単精度浮動小数を半精度浮動小数に変換します(最近接偶数丸め).
+//-----------------------------------------------------------------------------
+inline __m128i FloatToHalf4(__m128 value)
+{
+    auto signMask   = _mm_set1_ps(-0.0f);
+    auto sign       = _mm_and_ps(value, signMask);
+    auto absValue   = _mm_xor_ps(value, sign);
+    auto bits       = _mm_castps_si128(absValue);
+
+    // 半精度で表現できない値は無限大, NaN は NaN のままにする.
+    auto isNaN      = _mm_castps_si128(_mm_cmpunord_ps(absValue, absValue));
+    auto isRegular  = _mm_cmpgt_epi32(_mm_set1_epi32((127 + 16) << 23), bits);
+    auto special    = _mm_or_si128(_mm_and_si128(isNaN, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+    // 非正規化数は加算で仮数部を丸める.
+    auto magic      = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    auto isSubnorm  = _mm_cmpgt_epi32(_mm_set1_epi32((127 - 14) << 23), bits);
+    auto subnorm    = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absValue, _mm_castsi128_ps(magic))), magic);
+
+    // 正規化数は指数部のバイアスを調整し, 仮数部を最近接偶数に丸める.
+    auto odd        = _mm_srai_epi32(_mm_slli_epi32(bits, 31 - 13), 31);
+    auto rounded    = _mm_sub_epi32(_mm_add_epi32(bits, _mm_set1_epi32(0xfff - ((127 - 15) << 23))), odd);
+    auto normal     = _mm_srli_epi32(rounded, 13);
+
+    auto finite = _mm_or_si128(_mm_and_si128(isSubnorm, subnorm), _mm_andnot_si128(isSubnorm, normal));
+    auto result = _mm_or_si128(_mm_and_si128(isRegular, finite), _mm_andnot_si128(isRegular, special));
+
+    // 符号を上位ビットまで拡張し, _mm_packs_epi32 で飽和させずに詰められるようにする.
+    return _mm_or_si128(result, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+//-----------------------------------------------------------------------------
+//      4頂点分のテクスチャ座標を変換します.
+//-----------------------------------------------------------------------------
+inline void EncodeHalf2x4(const asdx::Vector2* pSrc, uint32_t* pResult)
+{
+    auto pf = reinterpret_cast<const float*>(pSrc);
+    auto lo = FloatToHalf4(_mm_loadu_ps(pf + 0));
+    auto hi = FloatToHalf4(_mm_loadu_ps(pf + 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pResult), _mm_packs_epi32(lo, hi));
+}
+
+//-----------------------------------------------------------------------------
+//      4頂点分のカラーを変換します.
+//-----------------------------------------------------------------------------
+inline void EncodeColor4(const asdx::Vector4* pSrc, uint32_t* pResult)
+{
+    auto pf    = reinterpret_cast<const float*>(pSrc);
+    auto zero  = _mm_setzero_ps();
+    auto one   = _mm_set1_ps(1.0f);
+    auto scale = _mm_set1_ps(255.0f);
+
+    __m128i c[4];
+    for(auto i=0; i<4; ++i)
+    {
+        auto v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pf + i * 4), zero), one);
+        c[i] = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+    }
+
+    auto packed = _mm_packus_epi16(_mm_packs_epi32(c[0], c[1]), _mm_packs_epi32(c[2], c[3]));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pResult), packed);
+}
+
+//-----------------------------------------------------------------------------
+//      1成分を 0 ～ 65535 に量子化し, 符号付きで詰められるように中央値を引きます.
+//-----------------------------------------------------------------------------
+inline __m128i QuantizeComponent(__m128 value, __m128 mini, __m128 scale)
+{
+    auto v = _mm_mul_ps(_mm_sub_ps(value, mini), scale);
+    v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(65535.0f));
+    return _mm_sub_epi32(_mm_cvtps_epi32(v), _mm_set1_epi32(32768));
+}
+
+//-----------------------------------------------------------------------------
+//      4頂点分の頂点座標を量子化します.
+//-----------------------------------------------------------------------------
+inline void QuantizePosition4
+(
+    const asdx::Vector3*    pSrc,
+    __m128                  mini,
+    __m128                  scale,
+    uint16_t*               pResult
+)
+{
+    __m128 x, y, z;
+    Load3x4(pSrc, x, y, z);
+
+    auto qx = QuantizeComponent(x, _mm_shuffle_ps(mini, mini, _MM_SHUFFLE(0, 0, 0, 0)), _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(0, 0, 0, 0)));
+    auto qy = QuantizeComponent(y, _mm_shuffle_ps(mini, mini, _MM_SHUFFLE(1, 1, 1, 1)), _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(1, 1, 1, 1)));
+    auto qz = QuantizeComponent(z, _mm_shuffle_ps(mini, mini, _MM_SHUFFLE(2, 2, 2, 2)), _mm_shuffle_ps(scale, scale, _MM_SHUFFLE(2, 2, 2, 2)));
+    auto qw = _mm_set1_epi32(-32768);
+
+    // 飽和パック後に最上位ビットを反転して符号なしに戻す.
+    auto flip = _mm_set1_epi16(-32768);
+    auto xy   = _mm_xor_si128(_mm_packs_epi32(qx, qy), flip);      // x0 x1 x2 x3 y0 y1 y2 y3
+    auto zw   = _mm_xor_si128(_mm_packs_epi32(qz, qw), flip);      // z0 z1 z2 z3 w0 w1 w2 w3
+
+    auto a = _mm_unpacklo_epi16(xy, _mm_srli_si128(xy, 8));        // x0 y0 x1 y1 x2 y2 x3 y3
+    auto b = _mm_unpacklo_epi16(zw, _mm_srli_si128(zw, 8));        // z0 w0 z1 w1 z2 w2 z3 w3
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pResult + 0), _mm_unpacklo_epi32(a, b));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pResult + 8), _mm_unpackhi_epi32(a, b));
+}
+
+//-----------------------------------------------------------------------------
+//      頂点座標のAABBを求めます.
+//-----------------------------------------------------------------------------
+void ComputeBounds
+(
+    const asdx::Vector3*    pPositions,
+    size_t                  count,
+    asdx::Vector3&          mini,
+    asdx::Vector3&          maxi
+)
+{
+    mini = maxi = pPositions[0];
+
+    auto minX = _mm_set1_ps(mini.x);
+    auto minY = _mm_set1_ps(mini.y);
+    auto minZ = _mm_set1_ps(mini.z);
+    auto maxX = minX;
+    auto maxY = minY;
+    auto maxZ = minZ;
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z;
+        Load3x4(pPositions + i, x, y, z);
+        minX = _mm_min_ps(minX, x);
+        minY = _mm_min_ps(minY, y);
+        minZ = _mm_min_ps(minZ, z);
+        maxX = _mm_max_ps(maxX, x);
+        maxY = _mm_max_ps(maxY, y);
+        maxZ = _mm_max_ps(maxZ, z);
+    }
+
+    alignas(16) float lo[3][4];
+    alignas(16) float hi[3][4];
+    _mm_store_ps(lo[0], minX);
+    _mm_store_ps(lo[1], minY);
+    _mm_store_ps(lo[2], minZ);
+    _mm_store_ps(hi[0], maxX);
+    _mm_store_ps(hi[1], maxY);
+    _mm_store_ps(hi[2], maxZ);
+
+    for(auto j=0; j<4; ++j)
+    {
+        mini = asdx::Vector3::Min(mini, asdx::Vector3(lo[0][j], lo[1][j], lo[2][j]));
+        maxi = asdx::Vector3::Max(maxi, asdx::Vector3(hi[0][j], hi[1][j], hi[2][j]));
+    }
+
+    for(; i<count; ++i)
+    {
+        mini = asdx::Vector3::Min(mini, pPositions[i]);
+        maxi = asdx::Vector3::Max(maxi, pPositions[i]);
+    }
+}
+
+} // namespace
+
+
+//-----------------------------------------------------------------------------
+//      法線と接線を八面体エンコードします.
+//-----------------------------------------------------------------------------
+void EncodeOctahedral
+(
+    const asdx::Vector3*    pNormals,
+    const asdx::Vector3*    pTangents,
+    size_t                  count,
+    uint32_t*               pResult
+)
+{
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    { EncodeNormalTangent4(pNormals + i, pTangents + i, pResult + i * 2); }
+
+    // 端数はゼロ埋めした一時領域で処理する.
+    if (i < count)
+    {
+        asdx::Vector3 normals [4] = {};
+        asdx::Vector3 tangents[4] = {};
+        uint32_t      result  [8] = {};
+        memcpy(normals,  pNormals  + i, sizeof(asdx::Vector3) * (count - i));
+        memcpy(tangents, pTangents + i, sizeof(asdx::Vector3) * (count - i));
+        EncodeNormalTangent4(normals, tangents, result);
+        memcpy(pResult + i * 2, result, sizeof(uint32_t) * 2 * (count - i));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      テクスチャ座標を半精度浮動小数に変換します.
+//-----------------------------------------------------------------------------
+void EncodeHalf2(const asdx::Vector2* pTexCoords, size_t count, uint32_t* pResult)
+{
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    { EncodeHalf2x4(pTexCoords + i, pResult + i); }
+
+    if (i < count)
+    {
+        asdx::Vector2 texcoords[4] = {};
+        uint32_t      result   [4] = {};
+        memcpy(texcoords, pTexCoords + i, sizeof(asdx::Vector2) * (count - i));
+        EncodeHalf2x4(texcoords, result);
+        memcpy(pResult + i, result, sizeof(uint32_t) * (count - i));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      カラーを8bit正規化整数に変換します.
+//-----------------------------------------------------------------------------
+void EncodeColor(const asdx::Vector4* pColors, size_t count, uint32_t* pResult)
+{
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    { EncodeColor4(pColors + i, pResult + i); }
+
+    if (i < count)
+    {
+        asdx::Vector4 colors[4] = {};
+        uint32_t      result[4] = {};
+        memcpy(colors, pColors + i, sizeof(asdx::Vector4) * (count - i));
+        EncodeColor4(colors, result);
+        memcpy(pResult + i, result, sizeof(uint32_t) * (count - i));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      頂点座標をAABB基準で16bit正規化整数に量子化します.
+//-----------------------------------------------------------------------------
+void QuantizePositions
+(
+    const asdx::Vector3*    pPositions,
+    size_t                  count,
+    const asdx::Vector3&    mini,
+    const asdx::Vector3&    maxi,
+    uint16_t*               pResult
+)
+{
+    // 幅が0の軸は全て0にする.
+    auto ext = maxi - mini;
+    auto sx  = (ext.x > 0.0f) ? 65535.0f / ext.x : 0.0f;
+    auto sy  = (ext.y > 0.0f) ? 65535.0f / ext.y : 0.0f;
+    auto sz  = (ext.z > 0.0f) ? 65535.0f / ext.z : 0.0f;
+
+    auto offset = _mm_setr_ps(mini.x, mini.y, mini.z, 0.0f);
+    auto scale  = _mm_setr_ps(sx, sy, sz, 0.0f);
+
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    { QuantizePosition4(pPositions + i, offset, scale, pResult + i * 4); }
+
+    if (i < count)
+    {
+        asdx::Vector3 positions[4] = {};
+        uint16_t      result  [16] = {};
+        memcpy(positions, pPositions + i, sizeof(asdx::Vector3) * (count - i));
+        QuantizePosition4(positions, offset, scale, result);
+        memcpy(pResult + i * 4, result, sizeof(uint16_t) * 4 * (count - i));
+    }
+}
+
+//-----------------------------------------------------------------------------
+//      メッシュが持つ属性に合わせて頂点データを圧縮します.
+//-----------------------------------------------------------------------------
+bool PackVertices
+(
+    const asdx::ResMesh&    mesh,
+    bool                    quantizePosition,
+    PackedVertexFormat&     format,
+    std::vector<uint8_t>&   data
+)
+{
+    auto count = mesh.Positions.size();
+    if (count == 0 || mesh.Normals.size() != count || mesh.Tangents.size() != count)
+    { return false; }
+
+    format = PackedVertexFormat();
+    format.QuantizedPosition = quantizePosition;
+
+    // ストリームを連続して配置し, 持たない属性は末尾の既定値を参照する.
+    uint32_t size = 0;
+    auto addStream = [&](VERTEX_STREAM stream, uint32_t stride)
+    {
+        format.Offset[stream] = size;
+        format.Stride[stream] = stride;
+        size += stride * uint32_t(count);
+    };
+
+    addStream(VERTEX_STREAM_POSITION, quantizePosition ? sizeof(uint16_t) * 4 : sizeof(asdx::Vector3));
+    addStream(VERTEX_STREAM_NORMAL_TANGENT, sizeof(uint32_t) * 2);
+
+    auto hasColor = (mesh.Colors.size() == count);
+    if (hasColor)
+    { addStream(VERTEX_STREAM_COLOR, sizeof(uint32_t)); }
+
+    bool hasTexCoord[4] = {};
+    for(auto i=0; i<4; ++i)
+    {
+        hasTexCoord[i] = (mesh.TexCoords[i].size() == count);
+        if (hasTexCoord[i])
+        { addStream(VERTEX_STREAM(VERTEX_STREAM_TEXCOORD0 + i), sizeof(uint32_t)); }
+    }
+
+    auto defaultOffset = size;
+    size += sizeof(kDefaultColor) + sizeof(kDefaultTexCoord);
+
+    if (!hasColor)
+    { format.Offset[VERTEX_STREAM_COLOR] = defaultOffset; }
+
+    for(auto i=0; i<4; ++i)
+    {
+        if (!hasTexCoord[i])
+        { format.Offset[VERTEX_STREAM_TEXCOORD0 + i] = defaultOffset + sizeof(kDefaultColor); }
+    }
+
+    data.resize(size);
+    auto pData = data.data();
+
+    if (quantizePosition)
+    {
+        asdx::Vector3 mini, maxi;
+        ComputeBounds(mesh.Positions.data(), count, mini, maxi);
+
+        QuantizePositions(mesh.Positions.data(), count, mini, maxi,
+            reinterpret_cast<uint16_t*>(pData + format.Offset[VERTEX_STREAM_POSITION]));
+
+        format.PositionScale  = maxi - mini;
+        format.PositionOffset = mini;
+    }
+    else
+    {
+        memcpy(pData + format.Offset[VERTEX_STREAM_POSITION], mesh.Positions.data(), sizeof(asdx::Vector3) * count);
+
+        format.PositionScale  = asdx::Vector3(1.0f, 1.0f, 1.0f);
+        format.PositionOffset = asdx::Vector3(0.0f, 0.0f, 0.0f);
+    }
+
+    EncodeOctahedral(mesh.Normals.data(), mesh.Tangents.data(), count,
+        reinterpret_cast<uint32_t*>(pData + format.Offset[VERTEX_STREAM_NORMAL_TANGENT]));
+
+    if (hasColor)
+    {
+        EncodeColor(mesh.Colors.data(), count,
+            reinterpret_cast<uint32_t*>(pData + format.Offset[VERTEX_STREAM_COLOR]));
+    }
+
+    for(auto i=0; i<4; ++i)
+    {
+        if (hasTexCoord[i])
+        {
+            EncodeHalf2(mesh.TexCoords[i].data(), count,
+                reinterpret_cast<uint32_t*>(pData + format.Offset[VERTEX_STREAM_TEXCOORD0 + i]));
+        }
+    }
+
+    memcpy(pData + defaultOffset, &kDefaultColor, sizeof(kDefaultColor));
+    memcpy(pData + defaultOffset + sizeof(kDefaultColor), &kDefaultTexCoord, sizeof(kDefaultTexCoord));
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+//      頂点数に合わせてインデックスを16bitまたは32bitで格納します.
+//-----------------------------------------------------------------------------
+uint32_t PackIndices
+(
+    const uint32_t*         pIndices,
+    size_t                  count,
+    size_t                  vertexCount,
+    std::vector<uint8_t>&   data
+)
+{
+    if (vertexCount > 0x10000)
+    {
+        data.resize(sizeof(uint32_t) * count);
+        if (count > 0)
+        { memcpy(data.data(), pIndices, sizeof(uint32_t) * count); }
+        return sizeof(uint32_t);
+    }
+
+    data.resize(sizeof(uint16_t) * count);
+    auto pResult = reinterpret_cast<uint16_t*>(data.data());
+    for(size_t i=0; i<count; ++i)
+    { pResult[i] = uint16_t(pIndices[i]); }
+
+    return sizeof(uint16_t);
+}
+
+#if ENABLE_MESH_BENCHMARK
+namespace {
+
+//-----------------------------------------------------------------------------
+//      八面体エンコードしたベクトルを復元します.
+//-----------------------------------------------------------------------------
+asdx::Vector3 DecodeOctahedral(uint32_t value)
+{
+    auto x = float(int16_t(value & 0xffff)) / 32767.0f;
+    auto y = float(int16_t(value >> 16))    / 32767.0f;
+    auto z = 1.0f - fabsf(x) - fabsf(y);
+    auto t = (z < 0.0f) ? -z : 0.0f;
+    x += (x >= 0.0f) ? -t : t;
+    y += (y >= 0.0f) ? -t : t;
+    return asdx::Vector3::Normalize(asdx::Vector3(x, y, z));
+}
+
+//-----------------------------------------------------------------------------
+//      半精度浮動小数を単精度浮動小数に変換します.
+//-----------------------------------------------------------------------------
+float HalfToFloat(uint16_t value)
+{
+    auto sign = (value & 0x8000) ? -1.0f : 1.0f;
+    auto exp  = (value >> 10) & 0x1f;
+    auto mant = value & 0x3ff;
+    if (exp == 0)
+    { return sign * ldexpf(float(mant), -24); }
+    if (exp == 31)
+    { return (mant == 0) ? sign * INFINITY : NAN; }
+    return sign * ldexpf(float(mant + 1024), exp - 25);
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+//      頂点圧縮の処理時間, メモリ削減率, 誤差を計測します.
+//-----------------------------------------------------------------------------
+bool BenchmarkVertexPacking(uint32_t loopCount)
+{
+    // UVを1組だけ持つカラー無しの球 (インポートされるメッシュで最も多い構成).
+    const uint32_t kSlices = 1000;
+    const uint32_t kStacks = 500;
+
+    asdx::ResMesh mesh;
+    for(auto y=0u; y<=kStacks; ++y)
+    {
+        for(auto x=0u; x<=kSlices; ++x)
+        {
+            auto u     = float(x) / float(kSlices);
+            auto v     = float(y) / float(kStacks);
+            auto theta = 3.14159265f * v;
+            auto phi   = 6.28318531f * u;
+            auto n     = asdx::Vector3(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi));
+            mesh.Positions.push_back(n * 10.0f);
+            mesh.Normals  .push_back(n);
+            mesh.Tangents .push_back(asdx::Vector3(-sinf(phi), 0.0f, cosf(phi)));
+            mesh.TexCoords[0].push_back(asdx::Vector2(u, v));
+        }
+    }
+
+    auto count = mesh.Positions.size();
+
+    for(auto quantize : { false, true })
+    {
+        PackedVertexFormat   format;
+        std::vector<uint8_t> data;
+
+        double best;
+        if (!MeasureBest(loopCount, [&]() { return PackVertices(mesh, quantize, format, data); }, best))
+        { return false; }
+
+        // 誤差を求める.
+        auto maxNormalError   = 0.0f;
+        auto maxTexCoordError = 0.0f;
+        auto maxPositionError = 0.0f;
+        for(size_t i=0; i<count; ++i)
+        {
+            uint32_t nt[2];
+            memcpy(nt, data.data() + format.Offset[VERTEX_STREAM_NORMAL_TANGENT] + i * 8, sizeof(nt));
+            auto dot = asdx::Vector3::Dot(DecodeOctahedral(nt[0]), mesh.Normals[i]);
+            auto angle = acosf((dot > 1.0f) ? 1.0f : dot);
+            if (angle > maxNormalError)
+            { maxNormalError = angle; }
+
+            uint16_t uv[2];
+            memcpy(uv, data.data() + format.Offset[VERTEX_STREAM_TEXCOORD0] + i * 4, sizeof(uv));
+            auto du = fabsf(HalfToFloat(uv[0]) - mesh.TexCoords[0][i].x);
+            auto dv = fabsf(HalfToFloat(uv[1]) - mesh.TexCoords[0][i].y);
+            if (du > maxTexCoordError) { maxTexCoordError = du; }
+            if (dv > maxTexCoordError) { maxTexCoordError = dv; }
+
+            if (quantize)
+            {
+                uint16_t q[4];
+                memcpy(q, data.data() + format.Offset[VERTEX_STREAM_POSITION] + i * 8, sizeof(q));
+                asdx::Vector3 p(
+                    float(q[0]) / 65535.0f * format.PositionScale.x + format.PositionOffset.x,
+                    float(q[1]) / 65535.0f * format.PositionScale.y + format.PositionOffset.y,
+                    float(q[2]) / 65535.0f * format.PositionScale.z + format.PositionOffset.z);
+                auto d = (p - mesh.Positions[i]).Length();
+                if (d > maxPositionError)
+                { maxPositionError = d; }
+            }
+        }
+
+        // 従来の頂点は全て float の 96 byte.
+        auto before = double(count * 96);
+        ILOGA("Info : Vertex Packing Benchmark (%s position). vertices = %zu", quantize ? "quantized" : "float", count);
+        LogBenchmark("pack", best);
+        ILOGA("    memory     : %.2lf MB -> %.2lf MB (%.2lfx)", before / (1024.0 * 1024.0), double(data.size()) / (1024.0 * 1024.0), before / double(data.size()));
+        ILOGA("    normal     : %.4f deg max error", maxNormalError * 180.0f / 3.14159265f);
+        ILOGA("    texcoord   : %.6f max error", maxTexCoordError);
+        if (quantize)
+        { ILOGA("    position   : %.6f max error (extent 20.0)", maxPositionError); }
+    }
+
+    return true;
+}
+#endif
@@ -32,7 +32,7 @@ WorkSpace::~WorkSpace()
 //-----------------------------------------------------------------------------
 //      ワークスペースを新規作成します.
 //-----------------------------------------------------------------------------
-bool WorkSpace::New(const char* modelPath)
+bool WorkSpace::New(const char* modelPath, const MeshPostProcessOption& option)
 {
     if (modelPath == nullptr || m_Loading)
     { return false; }
@@ -53,8 +53,9 @@ bool WorkSpace::New(const char* modelPath)
     // ロード引数.
     struct LoadArg
     {
-        WorkSpace*      pWorkSpace;
-        std::string     Path;
+        WorkSpace*              pWorkSpace;
+        std::string             Path;
+        MeshPostProcessOption   Option;
     };
 
     // ロード関数.
@@ -67,9 +68,9 @@ bool WorkSpace::New(const char* modelPath)
         auto path = loadArg->Path.c_str();
         auto pWorkSpace = loadArg->pWorkSpace;
 
-        // モデル読み込み.
+        // モデル読み込み (キャッシュはワークスペースの作業ディレクトリに置く).
         pWorkSpace->m_Model = new EditorModel();
-        if (!pWorkSpace->m_Model->Init(path))
+        if (!pWorkSpace->m_Model->Init(path, loadArg->Option, asdx::GetDirectoryPathA(path).c_str()))
         {
             delete pWorkSpace->m_Model;
             pWorkSpace->m_Model     = nullptr;
@@ -132,6 +133,7 @@ bool WorkSpace::New(const char* modelPath)
     auto args = new LoadArg();
     args->pWorkSpace = this;
     args->Path       = filePath.c_str();
+    args->Option     = option;
 
     // 読み込みスレッド開始.
     auto handle = _beginthread(loadFunc, 0, args);
@@ -150,7 +152,7 @@ bool WorkSpace::New(const char* modelPath)
 //-----------------------------------------------------------------------------
 //      ロード処理を行います.
 //-----------------------------------------------------------------------------
-bool WorkSpace::Load(const char* path)
+bool WorkSpace::Load(const char* path, const MeshPostProcessOption& option)
 {
     // ロード中フラグを立てる.
     m_Loading = true;
@@ -226,7 +228,7 @@ bool WorkSpace::Load(const char* path)
 
             // モデルのロード.
             m_Model = new EditorModel();
-            if (!m_Model->Init(modelPath.c_str()))
+            if (!m_Model->Init(modelPath.c_str(), option, m_WorkDir.c_str()))
             {
                 delete m_Model;
                 m_Model = nullptr;
@@ -296,7 +298,7 @@ bool WorkSpace::Load(const char* path)
 //-----------------------------------------------------------------------------
 //      非同期読み込みします.
 //-----------------------------------------------------------------------------
-bool WorkSpace::LoadAsync(const char* path)
+bool WorkSpace::LoadAsync(const char* path, const MeshPostProcessOption& option)
 {
     // 既にロード中の場合は受け付けない.
     if (m_Loading)
@@ -305,8 +307,9 @@ bool WorkSpace::LoadAsync(const char* path)
     // ロード引数.
     struct LoadArg
     {
-        WorkSpace*      pWorkSpace;
-        std::string     Path;
+        WorkSpace*              pWorkSpace;
+        std::string             Path;
+        MeshPostProcessOption   Option;
     };
 
     // ロード関数.
@@ -318,7 +321,7 @@ bool WorkSpace::LoadAsync(const char* path)
 
         auto path = loadArg->Path.c_str();
 
-        if (!loadArg->pWorkSpace->Load(path))
+        if (!loadArg->pWorkSpace->Load(path, loadArg->Option))
         { ELOGA("Error : WorkSpace::Load() Failed. path = %s", path); }
         else
         { ILOGA("Info : WorkSpace::Load() Success. path = %s", path); }
@@ -331,6 +334,7 @@ bool WorkSpace::LoadAsync(const char* path)
     auto args = new LoadArg();
     args->pWorkSpace = this;
     args->Path       = path;
+    args->Option     = option;
 
     // 読み込みスレッド開始.
     auto handle = _beginthread(loadFunc, 0, args);
@@ -13,6 +13,9 @@
     #include <crtdbg.h>
 #endif
 #include <App.h>
+#include <Benchmark.h>
+#include <RenderStateCache.h>
+#include <cstring>
 
 //-----------------------------------------------------------------------------
 //      メインエントリーポイントです.
@@ -23,6 +26,17 @@ int main(int argc, char** argv)
         _CrtSetDbgFlag ( _CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF );
     #endif
 
+    // MaterialEditor.exe -bench_xxx [path] で計測のみを行い終了.
+    int exitCode = 0;
+    if (RunBenchmark(argc, argv, exitCode))
+    { return exitCode; }
+
+#if ENABLE_RENDER_STATE_TEST
+    // MaterialEditor.exe -test_render_state でステート登録のテストのみを行い終了.
+    if (argc >= 2 && strcmp(argv[1], "-test_render_state") == 0)
+    { return TestRenderStateTable() ? 0 : 1; }
+#endif
+
     App().Run();
 
     return 0;